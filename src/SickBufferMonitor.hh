@@ -17,9 +17,13 @@
 #define SICK_BUFFER_MONITOR
 
 /* Dependencies */
+#include <atomic>
 #include <iostream>
 #include <pthread.h>
 #include <unistd.h>
+#include "SickMessage.hh"
+#include "SickProbes.hh"
+#include "SickLogger.hh"
 #include "SickException.hh"
 
 /* Associate the namespace */
@@ -42,9 +46,15 @@ namespace sickpls {
         /** Start the buffer monitor for the device */
         void StartMonitor(unsigned int sick_fd) noexcept(false);
 
-        /** Acquire the most recent message buffered by the monitor */
+        /** Acquire the most recent reply buffered by the monitor */
         bool GetNextMessageFromMonitor(SICK_MSG_CLASS& sick_message) noexcept(false);
 
+        /** Acquire the most recent streamed message buffered by the monitor */
+        bool GetNextStreamMessageFromMonitor(SICK_MSG_CLASS& sick_message) noexcept(false);
+
+        /** Indicates whether a message is one the device streams unrequested (default: none are) */
+        virtual bool IsStreamMessage(const SICK_MSG_CLASS& /* sick_message */) const { return false; }
+
         /** Stop the buffer monitor for the device */
         void StopMonitor() noexcept(false);
 
@@ -56,6 +66,15 @@ namespace sickpls {
         /** Unlock access to the data stream */
         void ReleaseDataStream() noexcept(false);
 
+        /** Gets the number of messages handed to the message container */
+        [[nodiscard]] uint64_t GetNumMessagesReceived() const { return _num_messages_received.load(std::memory_order_relaxed); }
+
+        /** Gets the number of messages replaced before anyone took them */
+        [[nodiscard]] uint64_t GetNumMessagesOverwritten() const { return _num_messages_overwritten.load(std::memory_order_relaxed); }
+
+        /** Gets the number of frames dropped for a bad checksum */
+        [[nodiscard]] uint64_t GetNumChecksumErrors() const { return _num_checksum_errors.load(std::memory_order_relaxed); }
+
         /** A standard destructor */
         ~SickBufferMonitor() noexcept(false);
 
@@ -64,6 +83,11 @@ namespace sickpls {
         /** Sick data stream file descriptor */
         unsigned int _sick_fd{};
 
+        /** Receive counters (only ever written by the monitor thread) */
+        std::atomic<uint64_t> _num_messages_received{0};
+        std::atomic<uint64_t> _num_messages_overwritten{0};
+        std::atomic<uint64_t> _num_checksum_errors{0};
+
         /** Reads n bytes into the destination buffer */
         void
         _readBytes(uint8_t* dest_buffer, int num_bytes_to_read, unsigned int timeout_value = 0) const noexcept(false);
@@ -85,9 +109,15 @@ namespace sickpls {
         /** A mutex for locking the data stream */
         pthread_mutex_t _stream_mutex{};
 
-        /** A container to hold the most recent message */
+        /** A container to hold the most recent reply */
         SICK_MSG_CLASS _recv_msg_container;
 
+        /** A container to hold the most recent streamed message */
+        SICK_MSG_CLASS _stream_msg_container;
+
+        /** Takes the contents of a container (if any) */
+        bool _takeMessage(SICK_MSG_CLASS& container, SICK_MSG_CLASS& sick_message) noexcept(false);
+
         /** Locks access to the message container */
         void _acquireMessageContainer() noexcept(false);
 
@@ -149,12 +179,12 @@ namespace sickpls {
 
             /* Handle thread exception */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
         }
 
             /* A safety net */
         catch (...) {
-            std::cerr << "SickBufferMonitor::SetDataStream: Unknown exception!" << std::endl;
+            SICK_LOG_ERROR("SickBufferMonitor::SetDataStream: Unknown exception!");
             throw;
         }
 
@@ -184,13 +214,40 @@ namespace sickpls {
     }
 
     /**
-     * \brief Checks the message container for the next available Sick message
+     * \brief Checks the reply container for the next available Sick message
      * \param &sick_message The message object that is to be populated with the results
      * \return True if the current contents were acquired, false otherwise
      */
     template<class SICK_MONITOR_CLASS, class SICK_MSG_CLASS>
     bool SickBufferMonitor<SICK_MONITOR_CLASS, SICK_MSG_CLASS>::GetNextMessageFromMonitor(
             SICK_MSG_CLASS& sick_message) noexcept(false) {
+        return _takeMessage(_recv_msg_container, sick_message);
+    }
+
+    /**
+     * \brief Checks the stream container for the next available Sick message
+     * \param &sick_message The message object that is to be populated with the results
+     * \return True if the current contents were acquired, false otherwise
+     *
+     * NOTE: Streamed messages are kept apart from replies so that a thread
+     *       waiting on a reply never consumes a scan and vice versa.
+     */
+    template<class SICK_MONITOR_CLASS, class SICK_MSG_CLASS>
+    bool SickBufferMonitor<SICK_MONITOR_CLASS, SICK_MSG_CLASS>::GetNextStreamMessageFromMonitor(
+            SICK_MSG_CLASS& sick_message) noexcept(false) {
+        return _takeMessage(_stream_msg_container, sick_message);
+    }
+
+    /**
+     * \brief Takes the contents of one of the message containers
+     * \param &container The container to check
+     * \param &sick_message The message object that is to be populated with the results
+     * \return True if the current contents were acquired, false otherwise
+     */
+    template<class SICK_MONITOR_CLASS, class SICK_MSG_CLASS>
+    bool SickBufferMonitor<SICK_MONITOR_CLASS, SICK_MSG_CLASS>::_takeMessage(SICK_MSG_CLASS& container,
+                                                                            SICK_MSG_CLASS& sick_message)
+    noexcept(false) {
 
         bool acquired_message = false;
 
@@ -200,11 +257,17 @@ namespace sickpls {
             _acquireMessageContainer();
 
             /* Check whether the object is populated */
-            if (_recv_msg_container.IsPopulated()) {
+            if (container.IsPopulated()) {
 
                 /* Copy the shared message */
-                sick_message = _recv_msg_container;
-                _recv_msg_container.Clear();
+                sick_message = container;
+                container.Clear();
+                sick_message.SetStageTimestamp(SICK_MESSAGE_STAGE_DEQUEUED, sick_message_clock_nsec());
+                if (SICK_PROBE_ENABLED(message_dequeued)) {
+                    SICK_PROBE(message_dequeued, sick_message.GetMessageLength(),
+                               sick_message.GetStageTimestamp(SICK_MESSAGE_STAGE_ENQUEUED),
+                               sick_message.GetStageTimestamp(SICK_MESSAGE_STAGE_DEQUEUED));
+                }
 
                 /* Set the flag indicating success */
                 acquired_message = true;
@@ -217,13 +280,13 @@ namespace sickpls {
 
             /* Handle a thread exception */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
             throw;
         }
 
             /* Handle an unknown exception */
         catch (...) {
-            std::cerr << "SickBufferMonitor::CheckMessageContainer: Unknown exception!" << std::endl;
+            SICK_LOG_ERROR("SickBufferMonitor::_takeMessage: Unknown exception!");
             throw;
         }
 
@@ -257,12 +320,12 @@ namespace sickpls {
 
             /* Handle thread exception */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
         }
 
             /* A safety net */
         catch (...) {
-            std::cerr << "SickBufferMonitor::StopMonitor: Unknown exception!" << std::endl;
+            SICK_LOG_ERROR("SickBufferMonitor::StopMonitor: Unknown exception!");
             throw;
         }
 
@@ -448,24 +511,43 @@ namespace sickpls {
 
                 /* Update message container contents */
                 buffer_monitor->_acquireMessageContainer();
-                buffer_monitor->_recv_msg_container = curr_message;
+                if (curr_message.IsPopulated()) {
+                    curr_message.SetStageTimestamp(SICK_MESSAGE_STAGE_ENQUEUED, sick_message_clock_nsec());
+                    if (SICK_PROBE_ENABLED(message_handoff)) {
+                        SICK_PROBE(message_handoff, curr_message.GetMessageLength(),
+                                   curr_message.GetStageTimestamp(SICK_MESSAGE_STAGE_ENQUEUED));
+                    }
+                    buffer_monitor->_num_messages_received.fetch_add(1, std::memory_order_relaxed);
+
+                    /* Route the message to the container its consumers wait on */
+                    SICK_MSG_CLASS& container = buffer_monitor->IsStreamMessage(curr_message) ?
+                                                buffer_monitor->_stream_msg_container :
+                                                buffer_monitor->_recv_msg_container;
+                    if (container.IsPopulated()) {
+                        buffer_monitor->_num_messages_overwritten.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    container = curr_message;
+                } else {
+                    buffer_monitor->_recv_msg_container.Clear();
+                    buffer_monitor->_stream_msg_container.Clear();
+                }
                 buffer_monitor->_releaseMessageContainer();
 
             }
 
                 /* Make sure there wasn't a serious error reading from the buffer */
             catch (SickIOException& sick_io_exception) {
-                std::cerr << sick_io_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_io_exception.what());
             }
 
                 /* Catch any thread exceptions */
             catch (SickThreadException& sick_thread_exception) {
-                std::cerr << sick_thread_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_thread_exception.what());
             }
 
                 /* A failsafe */
             catch (...) {
-                std::cerr << "SickBufferMonitor::_bufferMonitorThread: Unknown exception!" << std::endl;
+                SICK_LOG_ERROR("SickBufferMonitor::_bufferMonitorThread: Unknown exception!");
             }
 
             /* sleep a bit! */
@@ -32,6 +32,7 @@
 
 /* Definition dependencies */
 #include <new>
+#include <atomic>
 #include <string>
 #include <iomanip>
 #include <iostream>
@@ -40,6 +41,9 @@
 #include <pthread.h>
 #include <arpa/inet.h>
 #include <sys/time.h>
+#include "SickMessage.hh"
+#include "SickProbes.hh"
+#include "SickLogger.hh"
 #include "SickException.hh"
 
 /* Associate the namespace */
@@ -58,7 +62,16 @@ namespace sickpls {
         SickLIDAR();
 
         /** Indicates whether device is initialized */
-        bool IsInitialized() { return _sick_initialized; }
+        bool IsInitialized() { return _sick_initialized.load(std::memory_order_acquire); }
+
+        /** Gets the number of requests sent (retries included) */
+        [[nodiscard]] uint64_t GetNumRequestsSent() const { return _num_requests_sent.load(std::memory_order_relaxed); }
+
+        /** Gets the number of requests that went unanswered and were sent again */
+        [[nodiscard]] uint64_t GetNumRequestRetries() const { return _num_request_retries.load(std::memory_order_relaxed); }
+
+        /** Gets the number of requests that went unanswered on every try */
+        [[nodiscard]] uint64_t GetNumRequestFailures() const { return _num_request_failures.load(std::memory_order_relaxed); }
 
         /** A virtual destructor */
         virtual ~SickLIDAR();
@@ -69,7 +82,7 @@ namespace sickpls {
         int _sick_fd;
 
         /** A flag to indicated whether the device is properly initialized */
-        bool _sick_initialized;
+        std::atomic<bool> _sick_initialized{false};
 
         /** A pointer to the driver's buffer monitor */
         SICK_MONITOR_CLASS* _sick_buffer_monitor;
@@ -77,6 +90,11 @@ namespace sickpls {
         /** Indicates whether the Sick buffer monitor is running */
         bool _sick_monitor_running;
 
+        /** Request counters */
+        std::atomic<uint64_t> _num_requests_sent{0};
+        std::atomic<uint64_t> _num_request_retries{0};
+        std::atomic<uint64_t> _num_request_failures{0};
+
         /** A method for setting up a general connection */
         virtual void _setupConnection() = 0;
 
@@ -105,6 +123,9 @@ namespace sickpls {
         /** Acquire the next message from the message container */
         void _recvMessage(SICK_MSG_CLASS& sick_message, unsigned int timeout_value) const noexcept(false);
 
+        /** Acquire the next message from the stream container */
+        void _recvStreamMessage(SICK_MSG_CLASS& sick_message, unsigned int timeout_value) const noexcept(false);
+
         /** Search the stream for a payload with a particular "header" byte string */
         void _recvMessage(SICK_MSG_CLASS& sick_message,
                           const uint8_t* byte_sequence,
@@ -132,14 +153,14 @@ namespace sickpls {
      */
     template<class SICK_MONITOR_CLASS, class SICK_MSG_CLASS>
     SickLIDAR<SICK_MONITOR_CLASS, SICK_MSG_CLASS>::SickLIDAR() :
-            _sick_fd(0), _sick_initialized(false), _sick_buffer_monitor(NULL), _sick_monitor_running(false) {
+            _sick_fd(0), _sick_buffer_monitor(NULL), _sick_monitor_running(false) {
 
         try {
             /* Attempt to instantiate a new SickBufferMonitor for the device */
             _sick_buffer_monitor = new SICK_MONITOR_CLASS;
         }
         catch (std::bad_alloc& allocation_exception) {
-            std::cerr << "SickLIDAR::SickLIDAR: Allocation error - " << allocation_exception.what() << std::endl;
+            SICK_LOG_ERROR("SickLIDAR::SickLIDAR: Allocation error - " << allocation_exception.what());
         }
 
     }
@@ -170,13 +191,13 @@ namespace sickpls {
 
             /* Handle a thread exception */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
             throw;
         }
 
             /* Handle a thread exception */
         catch (...) {
-            std::cerr << "SickLIDAR::_startListening: Unknown exception!!!" << std::endl;
+            SICK_LOG_ERROR("SickLIDAR::_startListening: Unknown exception!!!");
             throw;
         }
 
@@ -198,13 +219,13 @@ namespace sickpls {
 
             /* Handle a thread exception */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
             throw;
         }
 
             /* Handle a thread exception */
         catch (...) {
-            std::cerr << "SickLIDAR::_stopListening: Unknown exception!!!" << std::endl;
+            SICK_LOG_ERROR("SickLIDAR::_stopListening: Unknown exception!!!");
             throw;
         }
 
@@ -325,6 +346,38 @@ namespace sickpls {
 
     }
 
+    /**
+     * \brief Attempt to acquire the latest message the device streamed unrequested
+     * \param &sick_message A reference to the container that will hold the most recent message
+     * \param timeout_value The time in usecs to wait before throwing a timeout error
+     */
+    template<class SICK_MONITOR_CLASS, class SICK_MSG_CLASS>
+    void SickLIDAR<SICK_MONITOR_CLASS, SICK_MSG_CLASS>::_recvStreamMessage(SICK_MSG_CLASS& sick_message,
+                                                                           const unsigned int timeout_value) const
+    noexcept(false) {
+
+        /* Timeval structs for handling timeouts */
+        struct timeval beg_time, end_time;
+
+        /* Acquire the elapsed time since epoch */
+        gettimeofday(&beg_time, nullptr);
+
+        /* Check the shared object */
+        while (!_sick_buffer_monitor->GetNextStreamMessageFromMonitor(sick_message)) {
+
+            /* Sleep a little bit */
+            usleep(1000);
+
+            /* Check whether the allowed time has expired */
+            gettimeofday(&end_time, nullptr);
+            if (_computeElapsedTime(beg_time, end_time) > timeout_value) {
+                throw SickTimeoutException("SickLIDAR::_recvStreamMessage: Timeout occurred!");
+            }
+
+        }
+
+    }
+
     /**
      * \brief Attempt to acquire a message having a payload beginning w/ the given byte sequence
      * \param &sick_message A reference to the container that will hold the most recent message
@@ -419,9 +472,21 @@ namespace sickpls {
 
                 /* Send the frame to the unit */
                 _sendMessage(send_message, byte_interval);
+                _num_requests_sent.fetch_add(1, std::memory_order_relaxed);
+
+                /* Only read the clock while a tracer is attached */
+                uint64_t sent_nsec = 0;
+                if (SICK_PROBE_ENABLED(request_sent) || SICK_PROBE_ENABLED(reply_matched)) {
+                    sent_nsec = sick_message_clock_nsec();
+                    SICK_PROBE(request_sent, send_message.GetMessageLength(), byte_sequence[0], i, sent_nsec);
+                }
 
                 /* Wait for the reply! */
                 _recvMessage(recv_message, byte_sequence, byte_sequence_length, timeout_value);
+                if (SICK_PROBE_ENABLED(reply_matched)) {
+                    SICK_PROBE(reply_matched, recv_message.GetPayloadLength(), byte_sequence[0], i, sent_nsec,
+                               sick_message_clock_nsec());
+                }
 
                 /* message was found! */
                 break;
@@ -431,26 +496,32 @@ namespace sickpls {
                 /* Handle a timeout! */
             catch (SickTimeoutException& sick_timeout) {
 
+                if (SICK_PROBE_ENABLED(request_timeout)) {
+                    SICK_PROBE(request_timeout, byte_sequence[0], i, num_tries - i - 1, sick_message_clock_nsec());
+                }
+
                 /* Check if it was found! */
                 if (i == num_tries - 1) {
+                    _num_request_failures.fetch_add(1, std::memory_order_relaxed);
                     throw SickTimeoutException(
                             "SickLIDAR::_sendMessageAndGetReply: Attempted max number of tries w/o success!");
                 }
 
                 /* Display the number of tries remaining! */
-                std::cerr << sick_timeout.what() << " " << num_tries - i - 1 << " tries remaining" << std::endl;
+                _num_request_retries.fetch_add(1, std::memory_order_relaxed);
+                SICK_LOG_WARNING(sick_timeout.what() << " " << num_tries - i - 1 << " tries remaining");
 
             }
 
                 /* Handle write buffer exceptions */
             catch (SickIOException& sick_io_error) {
-                std::cerr << sick_io_error.what() << std::endl;
+                SICK_LOG_ERROR(sick_io_error.what());
                 throw;
             }
 
                 /* A safety net */
             catch (...) {
-                std::cerr << "SickLIDAR::_sendMessageAndGetReply: Unknown exception!!!" << std::endl;
+                SICK_LOG_ERROR("SickLIDAR::_sendMessageAndGetReply: Unknown exception!!!");
                 throw;
             }
 
@@ -0,0 +1,497 @@
+/*!
+ * \file SickLogger.cc
+ * \brief Implements the asynchronous, leveled logger used for the
+ *        drivers' diagnostics.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "SickLogger.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /* Everything below info is hidden unless asked for */
+    std::atomic<sick_log_level_t> SickLogger::_level(SICK_LOG_LEVEL_INFO);
+
+    /* Set when the logger is created */
+    std::terminate_handler SickLogger::_previous_terminate = nullptr;
+
+    /**
+     * \brief Gets the calling thread's kernel id (cached per thread)
+     */
+    static uint64_t sick_log_thread_id() {
+        static thread_local const auto thread_id = (uint64_t) syscall(SYS_gettid);
+        return thread_id;
+    }
+
+    /**
+     * \brief Writes a record
+     * \param &record The record
+     */
+    void SickLogConsoleSink::Write(const sick_log_record_t& record) {
+
+        FILE* const stream = (record.level >= SICK_LOG_LEVEL_WARNING) ? stderr : stdout;
+
+        /* Keep the two streams in order when they share a terminal */
+        if (stream != _last_stream && _last_stream != nullptr) {
+            fflush(_last_stream);
+        }
+        _last_stream = stream;
+
+        fwrite(record.text, 1, record.length, stream);
+        fputc('\n', stream);
+
+    }
+
+    /**
+     * \brief Flushes stdout and stderr
+     */
+    void SickLogConsoleSink::Flush() {
+        fflush(stdout);
+        fflush(stderr);
+    }
+
+    /**
+     * \brief Appends to the given file
+     * \param &path The file (created if needed)
+     */
+    SickLogJsonSink::SickLogJsonSink(const std::string& path) noexcept(false) : _stream(nullptr), _owned(true) {
+
+        if ((_stream = fopen(path.c_str(), "ae")) == nullptr) {
+            throw SickIOException("SickLogJsonSink::SickLogJsonSink: fopen() failed!");
+        }
+
+    }
+
+    /**
+     * \brief Writes a record as one line of JSON
+     * \param &record The record
+     */
+    void SickLogJsonSink::Write(const sick_log_record_t& record) {
+
+        fprintf(_stream, "{\"ts\":%llu.%09llu,\"level\":\"%s\",\"thread\":%llu,\"msg\":\"",
+                (unsigned long long) (record.timestamp_nsec / 1000000000),
+                (unsigned long long) (record.timestamp_nsec % 1000000000),
+                SickLogger::LevelToString(record.level), (unsigned long long) record.thread_id);
+
+        for (uint32_t i = 0; i < record.length; i++) {
+            const auto c = (unsigned char) record.text[i];
+            switch (c) {
+                case '"':
+                    fputs("\\\"", _stream);
+                    break;
+                case '\\':
+                    fputs("\\\\", _stream);
+                    break;
+                case '\n':
+                    fputs("\\n", _stream);
+                    break;
+                case '\t':
+                    fputs("\\t", _stream);
+                    break;
+                default:
+                    if (c < 0x20) {
+                        fprintf(_stream, "\\u%04x", c);
+                    } else {
+                        fputc(c, _stream);
+                    }
+            }
+        }
+
+        fputs("\"}\n", _stream);
+
+    }
+
+    /**
+     * \brief Flushes the stream
+     */
+    void SickLogJsonSink::Flush() {
+        fflush(_stream);
+    }
+
+    /**
+     * \brief Closes the file if it was opened here
+     */
+    SickLogJsonSink::~SickLogJsonSink() {
+        if (_owned && _stream != nullptr) {
+            fclose(_stream);
+        }
+    }
+
+    /**
+     * \brief Gets the logger, starting it on first use
+     *
+     * The logger is never destroyed, so objects torn down at exit may
+     * still log; an exit handler drains the ring and stops the writer.
+     * std::terminate skips exit handlers, so a terminate handler drains
+     * the ring as well.
+     */
+    SickLogger& SickLogger::Instance() {
+
+        static SickLogger* const logger = [] {
+            auto* instance = new SickLogger;
+            atexit([] {
+                try {
+                    Instance().Stop();
+                }
+                catch (...) {}
+            });
+            _previous_terminate = std::set_terminate(_terminateHandler);
+            return instance;
+        }();
+
+        return *logger;
+    }
+
+    /**
+     * \brief Queues a message for the writer thread
+     * \param level The message's severity
+     * \param &message The message (truncated to SICK_LOG_MAX_MESSAGE_LENGTH bytes)
+     *
+     * NOTE: This never blocks. If the ring is full the message is dropped.
+     *       Should the process terminate before the writer catches up, the
+     *       terminate (or exit) handler writes what is still queued.
+     */
+    void SickLogger::Log(const sick_log_level_t level, const std::string& message) {
+
+        /* Without a writer, write through */
+        if (!_writer_running.load(std::memory_order_acquire)) {
+            _writeThrough(level, message);
+            return;
+        }
+
+        /* Claim a slot */
+        sick_log_slot_t* slot;
+        uint64_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            slot = &_slots[pos & (SICK_LOG_QUEUE_LENGTH - 1)];
+            const auto diff = (int64_t) (slot->sequence.load(std::memory_order_acquire) - pos);
+            if (diff == 0) {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                _num_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        /* Fill and publish it */
+        _fillRecord(slot->record, level, message);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+
+        _wakeWriter();
+
+    }
+
+    /**
+     * \brief Replaces the sink
+     * \param sink The new sink (nullptr => discard everything)
+     */
+    void SickLogger::SetSink(std::shared_ptr<SickLogSink> sink) noexcept(false) {
+
+        Flush();
+
+        pthread_mutex_lock(&_sink_mutex);
+        _sink.swap(sink);
+        pthread_mutex_unlock(&_sink_mutex);
+
+        /* The old sink (if no one else holds it) is released here, outside the lock */
+
+    }
+
+    /**
+     * \brief Waits until every message queued so far has been written and flushed
+     */
+    void SickLogger::Flush() noexcept(false) {
+
+        const uint64_t target = _enqueue_pos.load(std::memory_order_acquire);
+
+        if (_writer_running.load(std::memory_order_acquire)) {
+            while (_dequeue_pos.load(std::memory_order_acquire) < target &&
+                   _writer_running.load(std::memory_order_acquire)) {
+                _wake.fetch_add(1, std::memory_order_seq_cst);
+                _wake.notify_one();
+                usleep(1000);
+            }
+        }
+
+        pthread_mutex_lock(&_sink_mutex);
+        _drain();
+        if (_sink) {
+            _sink->Flush();
+        }
+        pthread_mutex_unlock(&_sink_mutex);
+
+    }
+
+    /**
+     * \brief Stops the writer thread; later messages are written synchronously
+     */
+    void SickLogger::Stop() noexcept(false) {
+
+        if (_writer_running.load(std::memory_order_acquire)) {
+
+            _stopping.store(true, std::memory_order_seq_cst);
+            _wake.fetch_add(1, std::memory_order_seq_cst);
+            _wake.notify_one();
+
+            if (pthread_join(_writer_thread_id, nullptr) != 0) {
+                throw SickThreadException("SickLogger::Stop: pthread_join() failed!");
+            }
+
+            _writer_running.store(false, std::memory_order_release);
+
+        }
+
+        /* Pick up anything queued while the writer was exiting */
+        pthread_mutex_lock(&_sink_mutex);
+        _drain();
+        pthread_mutex_unlock(&_sink_mutex);
+
+    }
+
+    /**
+     * \brief Gets a level's name
+     * \param level The level
+     * \return "debug", "info", "warning", "error" or "off"
+     */
+    const char* SickLogger::LevelToString(const sick_log_level_t level) {
+
+        switch (level) {
+            case SICK_LOG_LEVEL_DEBUG:
+                return "debug";
+            case SICK_LOG_LEVEL_INFO:
+                return "info";
+            case SICK_LOG_LEVEL_WARNING:
+                return "warning";
+            case SICK_LOG_LEVEL_ERROR:
+                return "error";
+            default:
+                return "off";
+        }
+
+    }
+
+    /**
+     * \brief Allocates the ring and starts the writer thread
+     */
+    SickLogger::SickLogger() noexcept(false) :
+            _slots(new sick_log_slot_t[SICK_LOG_QUEUE_LENGTH]), _enqueue_pos(0), _dequeue_pos(0), _num_dropped(0),
+            _num_dropped_reported(0), _wake(0), _writer_waiting(false), _writer_thread_id(0),
+            _writer_running(false), _stopping(false), _sink(std::make_shared<SickLogConsoleSink>()) {
+
+        for (uint64_t i = 0; i < SICK_LOG_QUEUE_LENGTH; i++) {
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        if (pthread_mutex_init(&_sink_mutex, nullptr) != 0) {
+            throw SickThreadException("SickLogger::SickLogger: pthread_mutex_init() failed!");
+        }
+
+        /* Without a writer thread the logger still works, just synchronously */
+        if (pthread_create(&_writer_thread_id, nullptr, _writerThread, this) == 0) {
+            _writer_running.store(true, std::memory_order_release);
+        }
+
+    }
+
+    /**
+     * \brief Writes a record, after everything queued ahead of it, and flushes the sink
+     * \param level The message's severity
+     * \param &message The message (truncated to SICK_LOG_MAX_MESSAGE_LENGTH bytes)
+     */
+    void SickLogger::_writeThrough(const sick_log_level_t level, const std::string& message) {
+
+        sick_log_record_t record;
+        _fillRecord(record, level, message);
+
+        pthread_mutex_lock(&_sink_mutex);
+        _drain();
+        if (_sink) {
+            _sink->Write(record);
+            _sink->Flush();
+        }
+        pthread_mutex_unlock(&_sink_mutex);
+
+    }
+
+    /**
+     * \brief Drains the ring, then hands over to the previous terminate handler
+     *
+     * The sink mutex is only waited on briefly: the thread holding it may
+     * be the one terminating.
+     */
+    void SickLogger::_terminateHandler() {
+
+        SickLogger& logger = Instance();
+
+        struct timespec deadline = {};
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 100000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        if (pthread_mutex_timedlock(&logger._sink_mutex, &deadline) == 0) {
+            try {
+                logger._drain();
+            }
+            catch (...) {}
+            pthread_mutex_unlock(&logger._sink_mutex);
+        }
+
+        if (_previous_terminate != nullptr) {
+            _previous_terminate();
+        }
+        abort();
+
+    }
+
+    /**
+     * \brief Fills in a record
+     */
+    void SickLogger::_fillRecord(sick_log_record_t& record, const sick_log_level_t level, const std::string& message) {
+
+        struct timespec now = {};
+        clock_gettime(CLOCK_REALTIME, &now);
+
+        record.level = level;
+        record.timestamp_nsec = (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+        record.thread_id = sick_log_thread_id();
+        record.length = (uint32_t) std::min<size_t>(message.size(), SICK_LOG_MAX_MESSAGE_LENGTH);
+        memcpy(record.text, message.data(), record.length);
+
+    }
+
+    /**
+     * \brief Writes every published record (the sink mutex is held)
+     * \return True if anything was written
+     */
+    bool SickLogger::_drain() {
+
+        bool wrote = false;
+
+        for (;;) {
+
+            const uint64_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+            sick_log_slot_t& slot = _slots[pos & (SICK_LOG_QUEUE_LENGTH - 1)];
+            if ((int64_t) (slot.sequence.load(std::memory_order_acquire) - (pos + 1)) < 0) {
+                break;
+            }
+
+            if (_sink) {
+                _sink->Write(slot.record);
+            }
+            wrote = true;
+
+            /* Hand the slot back to the producers */
+            slot.sequence.store(pos + SICK_LOG_QUEUE_LENGTH, std::memory_order_release);
+            _dequeue_pos.store(pos + 1, std::memory_order_release);
+
+        }
+
+        /* Own up to losses */
+        const uint64_t num_dropped = _num_dropped.load(std::memory_order_relaxed);
+        if (num_dropped != _num_dropped_reported) {
+            sick_log_record_t record;
+            _fillRecord(record, SICK_LOG_LEVEL_WARNING,
+                        "SickLogger: " + std::to_string(num_dropped - _num_dropped_reported) +
+                        " messages dropped (queue full)");
+            if (_sink) {
+                _sink->Write(record);
+            }
+            _num_dropped_reported = num_dropped;
+            wrote = true;
+        }
+
+        if (wrote && _sink) {
+            _sink->Flush();
+        }
+
+        return wrote;
+    }
+
+    /**
+     * \brief Wakes the writer if it is sleeping on an empty ring
+     */
+    void SickLogger::_wakeWriter() {
+
+        /* Order the publication before the check (pairs with the writer's fence) */
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (_writer_waiting.load(std::memory_order_relaxed)) {
+            _wake.fetch_add(1, std::memory_order_relaxed);
+            _wake.notify_one();
+        }
+
+    }
+
+    /**
+     * \brief The writer thread
+     * \param *thread_args The logger
+     */
+    void* SickLogger::_writerThread(void* thread_args) {
+
+        auto* logger = (SickLogger*) thread_args;
+
+        while (!logger->_stopping.load(std::memory_order_acquire)) {
+
+            pthread_mutex_lock(&logger->_sink_mutex);
+            const bool wrote = logger->_drain();
+            pthread_mutex_unlock(&logger->_sink_mutex);
+
+            if (wrote) {
+                continue;
+            }
+
+            /* Sleep until a producer sees us waiting (or a message sneaks in first) */
+            const uint32_t wake = logger->_wake.load(std::memory_order_relaxed);
+            logger->_writer_waiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            const uint64_t pos = logger->_dequeue_pos.load(std::memory_order_relaxed);
+            const sick_log_slot_t& slot = logger->_slots[pos & (SICK_LOG_QUEUE_LENGTH - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != pos + 1 &&
+                !logger->_stopping.load(std::memory_order_acquire)) {
+                logger->_wake.wait(wake, std::memory_order_relaxed);
+            }
+
+            logger->_writer_waiting.store(false, std::memory_order_relaxed);
+
+        }
+
+        pthread_mutex_lock(&logger->_sink_mutex);
+        logger->_drain();
+        pthread_mutex_unlock(&logger->_sink_mutex);
+
+        /* Thread is done */
+        return nullptr;
+
+    }
+
+} /* namespace sickpls */
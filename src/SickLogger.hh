@@ -0,0 +1,281 @@
+/*!
+ * \file SickLogger.hh
+ * \brief Defines the asynchronous, leveled logger used for the
+ *        drivers' diagnostics.
+ *
+ * Diagnostics are written with the SICK_LOG_* macros, e.g.
+ *
+ *   SICK_LOG_ERROR("SickPLS::Initialize: " << sick_io_exception.what());
+ *
+ * A message below the current level costs one relaxed load. Otherwise
+ * it is formatted on the calling thread, copied into a lock-free ring
+ * and written out by a background thread, so no caller ever waits on
+ * console or file I/O. When the ring is full the message is dropped
+ * and counted instead. Defining SICK_DISABLE_LOGGING compiles every
+ * macro (and its arguments) out.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_LOGGER_HH
+#define SICK_LOGGER_HH
+
+/* Definition dependencies */
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <pthread.h>
+
+/* Macro definitions */
+#define SICK_LOG_QUEUE_LENGTH                                               (1024)  ///< Records buffered for the writer (power of two)
+#define SICK_LOG_MAX_MESSAGE_LENGTH                                          (480)  ///< Longer messages are truncated (bytes)
+
+/**
+ * \def SICK_LOG
+ * \brief Logs a streamed message (e.g. "x = " << x) at the given level
+ */
+#ifdef SICK_DISABLE_LOGGING
+#define SICK_LOG(level, message) do {} while (0)
+#else
+#define SICK_LOG(level, message)                                                    \
+    do {                                                                            \
+        if (sickpls::SickLogger::IsEnabled(level)) {                                \
+            std::ostringstream sick_log_stream;                                     \
+            sick_log_stream << message;                                             \
+            sickpls::SickLogger::Instance().Log(level, sick_log_stream.str());      \
+        }                                                                           \
+    } while (0)
+#endif
+
+#define SICK_LOG_DEBUG(message) SICK_LOG(sickpls::SICK_LOG_LEVEL_DEBUG, message)
+#define SICK_LOG_INFO(message) SICK_LOG(sickpls::SICK_LOG_LEVEL_INFO, message)
+#define SICK_LOG_WARNING(message) SICK_LOG(sickpls::SICK_LOG_LEVEL_WARNING, message)
+#define SICK_LOG_ERROR(message) SICK_LOG(sickpls::SICK_LOG_LEVEL_ERROR, message)
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \enum sick_log_level_t
+     * \brief Message severities, in increasing order.
+     */
+    enum sick_log_level_t {
+        SICK_LOG_LEVEL_DEBUG = 0,                                                  ///< Protocol details
+        SICK_LOG_LEVEL_INFO,                                                       ///< Progress (initialization, mode changes)
+        SICK_LOG_LEVEL_WARNING,                                                    ///< Recovered problems (retries, ...)
+        SICK_LOG_LEVEL_ERROR,                                                      ///< Failed operations
+        SICK_LOG_LEVEL_OFF                                                         ///< Suppresses everything (as a threshold)
+    };
+
+    /*!
+     * \struct sick_log_record_tag
+     * \brief A logged message and where it came from.
+     */
+    /*!
+     * \typedef sick_log_record_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_log_record_tag {
+        sick_log_level_t level;                                                    ///< Severity
+        uint64_t timestamp_nsec;                                                   ///< Wall-clock time (CLOCK_REALTIME nsecs)
+        uint64_t thread_id;                                                        ///< Kernel id of the logging thread
+        uint32_t length;                                                           ///< Bytes of text
+        char text[SICK_LOG_MAX_MESSAGE_LENGTH];                                    ///< The message (not NUL terminated)
+    } sick_log_record_t;
+
+    /*!
+     * \brief Where the writer thread sends records
+     *
+     * Write() and Flush() are only ever called by one thread at a time.
+     */
+    class SickLogSink {
+
+    public:
+
+        /** Writes a record */
+        virtual void Write(const sick_log_record_t& record) = 0;
+
+        /** Flushes what was written (called whenever the queue runs dry) */
+        virtual void Flush() {}
+
+        /** A virtual destructor */
+        virtual ~SickLogSink() = default;
+
+    };
+
+    /*!
+     * \brief Writes bare messages to stdout (debug, info) or stderr (warning, error)
+     *
+     * This reproduces the drivers' console output and is the default sink.
+     */
+    class SickLogConsoleSink : public SickLogSink {
+
+    public:
+
+        /** Writes a record */
+        void Write(const sick_log_record_t& record) override;
+
+        /** Flushes stdout and stderr */
+        void Flush() override;
+
+    private:
+
+        /** The stream written last */
+        FILE* _last_stream = nullptr;
+
+    };
+
+    /*!
+     * \brief Writes one JSON object per record, e.g.
+     *        {"ts":1700000000.123456789,"level":"error","thread":4242,"msg":"..."}
+     */
+    class SickLogJsonSink : public SickLogSink {
+
+    public:
+
+        /** Writes to the given stream (not closed) */
+        explicit SickLogJsonSink(FILE* stream) : _stream(stream), _owned(false) {}
+
+        /** Appends to the given file */
+        explicit SickLogJsonSink(const std::string& path) noexcept(false);
+
+        /** Writes a record */
+        void Write(const sick_log_record_t& record) override;
+
+        /** Flushes the stream */
+        void Flush() override;
+
+        /** Closes the file if it was opened here */
+        ~SickLogJsonSink() override;
+
+    private:
+
+        /** The output */
+        FILE* _stream;
+        bool _owned;
+
+    };
+
+    /*!
+     * \brief The process-wide logger
+     *
+     * Producers claim a slot of a bounded multi-producer ring (after Dmitry
+     * Vyukov's design) with a single compare-and-swap and never take a lock;
+     * the writer thread is only woken when it has gone to sleep on an
+     * empty ring, so logging (errors included) never puts console I/O on
+     * the caller's path. If the process terminates (or exits) with
+     * messages still queued, a terminate (or exit) handler writes them.
+     * After Stop() every message is written synchronously.
+     */
+    class SickLogger {
+
+    public:
+
+        /** Gets the logger (started on first use) */
+        static SickLogger& Instance();
+
+        /** Indicates whether messages of the given level are logged */
+        static bool IsEnabled(const sick_log_level_t level) {
+            return level >= _level.load(std::memory_order_relaxed);
+        }
+
+        /** Sets the lowest level that is logged */
+        static void SetLevel(const sick_log_level_t level) { _level.store(level, std::memory_order_relaxed); }
+
+        /** Gets the lowest level that is logged */
+        static sick_log_level_t GetLevel() { return _level.load(std::memory_order_relaxed); }
+
+        /** Queues a message */
+        void Log(sick_log_level_t level, const std::string& message);
+
+        /** Replaces the sink (nullptr => discard everything) */
+        void SetSink(std::shared_ptr<SickLogSink> sink) noexcept(false);
+
+        /** Waits until every message queued so far has been written */
+        void Flush() noexcept(false);
+
+        /** Stops the writer thread after draining the queue */
+        void Stop() noexcept(false);
+
+        /** Gets the number of messages dropped because the queue was full */
+        [[nodiscard]] uint64_t GetNumDropped() const { return _num_dropped.load(std::memory_order_relaxed); }
+
+        /** Gets a level's name */
+        static const char* LevelToString(sick_log_level_t level);
+
+    private:
+
+        /** A ring slot: its sequence number says whose turn it is */
+        typedef struct sick_log_slot_tag {
+            std::atomic<uint64_t> sequence;                                        ///< Position this slot is ready for
+            sick_log_record_t record;                                              ///< The record
+        } sick_log_slot_t;
+
+        /** The lowest level logged */
+        static std::atomic<sick_log_level_t> _level;
+
+        /** The ring */
+        std::unique_ptr<sick_log_slot_t[]> _slots;
+
+        /** Next position to claim / to write */
+        alignas(64) std::atomic<uint64_t> _enqueue_pos;
+        alignas(64) std::atomic<uint64_t> _dequeue_pos;
+
+        /** Messages lost to a full ring, and how many of those were reported */
+        std::atomic<uint64_t> _num_dropped;
+        uint64_t _num_dropped_reported;
+
+        /** Writer wake-up: a futex word and whether the writer sleeps on it */
+        std::atomic<uint32_t> _wake;
+        std::atomic<bool> _writer_waiting;
+
+        /** The writer thread */
+        pthread_t _writer_thread_id;
+        std::atomic<bool> _writer_running;
+        std::atomic<bool> _stopping;
+
+        /** Guards the sink (producers only take it to write through once the writer has stopped) */
+        pthread_mutex_t _sink_mutex{};
+        std::shared_ptr<SickLogSink> _sink;
+
+        /** The terminate handler replaced by ours */
+        static std::terminate_handler _previous_terminate;
+
+        /** A standard constructor */
+        SickLogger() noexcept(false);
+
+        /** Writes a record (after everything queued ahead of it) before returning */
+        void _writeThrough(sick_log_level_t level, const std::string& message);
+
+        /** Drains the ring before handing over to the previous terminate handler */
+        static void _terminateHandler();
+
+        /** Fills in a record */
+        static void _fillRecord(sick_log_record_t& record, sick_log_level_t level, const std::string& message);
+
+        /** Writes every queued record, then flushes the sink (returns false if there were none) */
+        bool _drain();
+
+        /** Wakes the writer if it sleeps */
+        void _wakeWriter();
+
+        /** Entry point for the writer thread */
+        static void* _writerThread(void* thread_args);
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_LOGGER_HH */
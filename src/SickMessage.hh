@@ -18,12 +18,39 @@
 
 /* Dependencies */
 #include <arpa/inet.h>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
 #include <iomanip>
 #include <iostream>
 
 /* Associate the namespace */
 namespace sickpls {
 
+    /*!
+     * \enum sick_message_stage_t
+     * \brief The points in the receive pipeline at which a message is time stamped.
+     */
+    enum sick_message_stage_t {
+        SICK_MESSAGE_STAGE_FIRST_BYTE = 0,                                         ///< First byte of the frame read from the stream
+        SICK_MESSAGE_STAGE_HEADER_FOUND,                                           ///< Frame header matched
+        SICK_MESSAGE_STAGE_CRC_VERIFIED,                                           ///< Checksum verified
+        SICK_MESSAGE_STAGE_ENQUEUED,                                               ///< Handed to the message container
+        SICK_MESSAGE_STAGE_DEQUEUED,                                               ///< Taken from the message container
+        SICK_MESSAGE_STAGE_DECODED,                                                ///< Payload decoded by the driver
+        SICK_MESSAGE_NUM_STAGES                                                    ///< Number of stages
+    };
+
+    /**
+     * \brief Reads the clock used for message stage time stamps
+     * \return Monotonic time (nsecs)
+     */
+    inline uint64_t sick_message_clock_nsec() {
+        struct timespec now = {};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+    }
+
     /**
      * \class SickMessage
      * \brief Provides an abstract parent for all Sick messages
@@ -71,6 +98,12 @@ namespace sickpls {
         /** Indicates whether the message container is populated */
         [[nodiscard]] bool IsPopulated() const { return _populated; };
 
+        /** Records when the message passed a pipeline stage */
+        void SetStageTimestamp(const sick_message_stage_t stage, const uint64_t nsec) { _stage_timestamps[stage] = nsec; }
+
+        /** Gets when the message passed a pipeline stage (0 => not recorded) */
+        [[nodiscard]] uint64_t GetStageTimestamp(const sick_message_stage_t stage) const { return _stage_timestamps[stage]; }
+
         /** Clear the contents of the message container/object */
         virtual void Clear();
 
@@ -94,6 +127,9 @@ namespace sickpls {
         /** Indicates whether the message container/object is populated */
         bool _populated{};
 
+        /** Pipeline stage time stamps (see sick_message_clock_nsec) */
+        uint64_t _stage_timestamps[SICK_MESSAGE_NUM_STAGES]{};
+
     };
 
 
@@ -196,6 +232,7 @@ namespace sickpls {
 
         /* Clear the message buffer */
         memset(_message_buffer, 0, MESSAGE_MAX_LENGTH);
+        memset(_stage_timestamps, 0, sizeof(_stage_timestamps));
 
         /* Set the flag indicating this message object/container is empty */
         _populated = false;
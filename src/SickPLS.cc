@@ -23,11 +23,15 @@
 #include <sys/ioctl.h>
 #include <csignal>
 #include <utility>
+#include <cerrno>
+#include <ctime>
 
 #include "SickPLS.hh"
 #include "SickPLSMessage.hh"
 #include "SickPLSBufferMonitor.hh"
 #include "SickPLSUtility.hh"
+#include "SickProbes.hh"
+#include "SickLogger.hh"
 #include "SickException.hh"
 
 #ifdef HAVE_LINUX_SERIAL_H
@@ -49,7 +53,8 @@ namespace sickpls {
     SickPLS::SickPLS(std::string  sick_device_path) : SickLIDAR<SickPLSBufferMonitor, SickPLSMessage>(),
                                                            _sick_device_path(std::move(sick_device_path)),
                                                            _curr_session_baud(SICK_BAUD_UNKNOWN),
-                                                           _desired_session_baud(SICK_BAUD_UNKNOWN) {
+                                                           _desired_session_baud(SICK_BAUD_UNKNOWN),
+                                                           _sick_bits_per_byte(DEFAULT_SICK_PLS_BITS_PER_BYTE) {
 
         /* Initialize the protected/private structs */
         memset(&_sick_operating_status, 0, sizeof(sick_pls_operating_status_t));
@@ -57,12 +62,34 @@ namespace sickpls {
         memset(&_old_term, 0, sizeof(struct termios));
 
         //start in an unknown mode
-        _sick_operating_status.sick_operating_mode = SICK_OP_MODE_UNKNOWN;
+        _storeSickOpMode(SICK_OP_MODE_UNKNOWN);
 
         //fixed parameters
         _sick_operating_status.sick_measuring_units = SICK_MEASURING_UNITS_CM;
         _sick_operating_status.sick_scan_resolution = SICK_SCAN_RESOLUTION_50;
         _sick_operating_status.sick_scan_angle = SICK_SCAN_ANGLE_180;
+
+        /* Configuration calls nest (e.g. ResetSick re-initializes the device) */
+        pthread_mutexattr_t config_mutex_attr;
+        pthread_mutexattr_init(&config_mutex_attr);
+        pthread_mutexattr_settype(&config_mutex_attr, PTHREAD_MUTEX_RECURSIVE);
+        if (pthread_mutex_init(&_sick_config_mutex, &config_mutex_attr) != 0) {
+            pthread_mutexattr_destroy(&config_mutex_attr);
+            throw SickThreadException("SickPLS::SickPLS: pthread_mutex_init() failed!");
+        }
+        pthread_mutexattr_destroy(&config_mutex_attr);
+
+        /* Scan waiters time out against the monotonic clock */
+        pthread_condattr_t scan_cond_attr;
+        pthread_condattr_init(&scan_cond_attr);
+        pthread_condattr_setclock(&scan_cond_attr, CLOCK_MONOTONIC);
+        if (pthread_mutex_init(&_sick_scan_mutex, nullptr) != 0 ||
+            pthread_cond_init(&_sick_scan_cond, &scan_cond_attr) != 0) {
+            pthread_condattr_destroy(&scan_cond_attr);
+            throw SickThreadException("SickPLS::SickPLS: pthread_cond_init() failed!");
+        }
+        pthread_condattr_destroy(&scan_cond_attr);
+
     }
 
     /**
@@ -79,12 +106,19 @@ namespace sickpls {
 
             /* Catch an I/O exception */
         catch (SickIOException& sick_io_exception) {
-            std::cerr << sick_io_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_io_exception.what());
         }
 
             /* Catch anything else */
         catch (...) {
-            std::cerr << "SickPLS::~SickPLS: Unknown exception!" << std::endl;
+            SICK_LOG_ERROR("SickPLS::~SickPLS: Unknown exception!");
+        }
+
+        /* Destroy the configuration and scan locks */
+        if (pthread_cond_destroy(&_sick_scan_cond) != 0 ||
+            pthread_mutex_destroy(&_sick_scan_mutex) != 0 ||
+            pthread_mutex_destroy(&_sick_config_mutex) != 0) {
+            SICK_LOG_ERROR("SickPLS::~SickPLS: pthread_mutex_destroy() failed!");
         }
 
     }
@@ -95,6 +129,52 @@ namespace sickpls {
      * \param desired_baud_rate Desired session baud rate
      */
     void SickPLS::Initialize(const sick_pls_baud_t desired_baud_rate)
+    noexcept(false) {
+
+        _acquireSickConfig();
+
+        try {
+            _initialize(desired_baud_rate);
+        }
+
+            /* Let other configuration calls in before passing it on */
+        catch (...) {
+            _releaseSickConfig();
+            throw;
+        }
+
+        _releaseSickConfig();
+
+    }
+
+    /**
+     * \brief Uninitializes the PLS by putting it in a mode where it stops streaming data,
+     *        and returns it to the default baud rate (specified in the header).
+     */
+    void
+    SickPLS::Uninitialize() noexcept(false) {
+
+        _acquireSickConfig();
+
+        try {
+            _uninitialize();
+        }
+
+            /* Let other configuration calls in before passing it on */
+        catch (...) {
+            _releaseSickConfig();
+            throw;
+        }
+
+        _releaseSickConfig();
+
+    }
+
+    /**
+     * \brief Initializes the Sick PLS (the configuration lock must be held)
+     * \param desired_baud_rate Desired session baud rate
+     */
+    void SickPLS::_initialize(const sick_pls_baud_t desired_baud_rate)
     noexcept(false) {
 
         /* Buffer the desired baud rate in case we have to reset */
@@ -102,29 +182,28 @@ namespace sickpls {
 
         try {
 
-            std::cout << std::endl << "\t*** Attempting to initialize the Sick PLS..." << std::endl << std::flush;
+            SICK_LOG_INFO("\t*** Attempting to initialize the Sick PLS...");
 
             /* Initialize the serial term for communication */
-            std::cout << "\tAttempting to open device @ " << _sick_device_path << std::endl << std::flush;
+            SICK_LOG_INFO("\tAttempting to open device @ " << _sick_device_path);
             _setupConnection();
-            std::cout << "\t\tDevice opened!" << std::endl << std::flush;
+            SICK_LOG_INFO("\t\tDevice opened!");
 
             /* Start/reset the buffer monitor */
             if (!_sick_monitor_running) {
-                std::cout << "\tAttempting to start buffer monitor..." << std::endl;
+                SICK_LOG_INFO("\tAttempting to start buffer monitor...");
                 _startListening();
-                std::cout << "\t\tBuffer monitor started!" << std::endl;
+                SICK_LOG_INFO("\t\tBuffer monitor started!");
             } else {
-                std::cout << "\tAttempting to reset buffer monitor..." << std::endl;
+                SICK_LOG_INFO("\tAttempting to reset buffer monitor...");
                 _sick_buffer_monitor->SetDataStream(_sick_fd);
-                std::cout << "\t\tBuffer monitor reset!" << std::endl;
+                SICK_LOG_INFO("\t\tBuffer monitor reset!");
             }
 
             try {
 
-                std::cout << "\tAttempting to set session baud rate to "
-                          << SickPLS::SickBaudToString(_desired_session_baud)
-                          << " as requested..." << std::endl;
+                SICK_LOG_INFO("\tAttempting to set session baud rate to "
+                              << SickPLS::SickBaudToString(_desired_session_baud) << " as requested...");
                 _setSessionBaud(_desired_session_baud);
 
             }
@@ -134,25 +213,24 @@ namespace sickpls {
 
                 /* Check whether to do an autodetect */
                 sick_pls_baud_t default_baud = _baudToSickBaud(DEFAULT_SICK_PLS_SICK_BAUD);
-                std::cout << "\tFailed to set requested baud rate..." << std::endl << std::flush;
-                std::cout << "\tAttempting to detect PLS baud rate..." << std::endl << std::flush;
+                SICK_LOG_INFO("\tFailed to set requested baud rate...");
+                SICK_LOG_INFO("\tAttempting to detect PLS baud rate...");
                 if ((default_baud != SICK_BAUD_9600) && _testSickBaud(SICK_BAUD_9600)) {
-                    std::cout << "\t\tDetected PLS baud @ " << SickBaudToString(SICK_BAUD_9600) << "!" << std::endl;
+                    SICK_LOG_INFO("\t\tDetected PLS baud @ " << SickBaudToString(SICK_BAUD_9600) << "!");
                 } else if ((default_baud != SICK_BAUD_19200) && _testSickBaud(SICK_BAUD_19200)) {
-                    std::cout << "\t\tDetected PLS baud @ " << SickBaudToString(SICK_BAUD_19200) << "!" << std::endl;
+                    SICK_LOG_INFO("\t\tDetected PLS baud @ " << SickBaudToString(SICK_BAUD_19200) << "!");
                 } else if ((default_baud != SICK_BAUD_38400) && _testSickBaud(SICK_BAUD_38400)) {
-                    std::cout << "\t\tDetected PLS baud @ " << SickBaudToString(SICK_BAUD_38400) << "!" << std::endl;
+                    SICK_LOG_INFO("\t\tDetected PLS baud @ " << SickBaudToString(SICK_BAUD_38400) << "!");
                 } else if ((default_baud) != SICK_BAUD_500K && _testSickBaud(SICK_BAUD_500K)) {
-                    std::cout << "\t\tDetected PLS baud @ " << SickBaudToString(SICK_BAUD_500K) << "!" << std::endl;
+                    SICK_LOG_INFO("\t\tDetected PLS baud @ " << SickBaudToString(SICK_BAUD_500K) << "!");
                 } else {
                     _stopListening();
                     throw SickIOException("SickPLS::Initialize: failed to detect baud rate!");
                 }
-                std::cout << std::flush;
 
                 /* Try again! */
                 if (_curr_session_baud != _desired_session_baud) {
-                    std::cout << "\tAttempting to setup desired baud (again)..." << std::endl << std::flush;
+                    SICK_LOG_INFO("\tAttempting to setup desired baud (again)...");
                     _setSessionBaud(_desired_session_baud);
                 }
 
@@ -160,11 +238,11 @@ namespace sickpls {
 
                 /* Catch anything else */
             catch (...) {
-                std::cerr << "SickPLS::Initialize: Unknown exception!" << std::endl;
+                SICK_LOG_ERROR("SickPLS::Initialize: Unknown exception!");
                 throw;
             }
 
-            std::cout << "\t\tOperating @ " << SickBaudToString(_curr_session_baud) << std::endl;
+            SICK_LOG_INFO("\t\tOperating @ " << SickBaudToString(_curr_session_baud));
 
             /* Set the device to request range mode */
             _setSickOpModeMonitorRequestValues();
@@ -177,53 +255,51 @@ namespace sickpls {
 
             /* Handle a config exception */
         catch (SickConfigException& sick_config_exception) {
-            std::cerr << sick_config_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_config_exception.what());
             throw;
         }
 
             /* Handle a timeout exception */
         catch (SickTimeoutException& sick_timeout_exception) {
-            std::cerr << sick_timeout_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_timeout_exception.what());
             throw;
         }
 
             /* Handle any I/O exceptions */
         catch (SickIOException& sick_io_exception) {
-            std::cerr << sick_io_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_io_exception.what());
             throw;
         }
 
             /* Handle any thread exceptions */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
             throw;
         }
 
             /* Handle anything else */
         catch (...) {
-            std::cerr << "SickPLS::Initialize: Unknown exception!" << std::endl;
+            SICK_LOG_ERROR("SickPLS::Initialize: Unknown exception!");
             throw;
         }
 
         /* Initialization was successful! */
-        std::cout << "\t*** Init. complete: Sick PLS is online and ready!" << std::endl;
-        std::cout << "\tScan Angle: " << GetSickScanAngle() << " (deg)" << std::endl;
-        std::cout << "\tScan Resolution: " << GetSickScanResolution() << " (deg)" << std::endl;
-        std::cout << "\tMeasuring Units: " << SickMeasuringUnitsToString(GetSickMeasuringUnits()) << std::endl;
-        std::cout << std::endl << std::flush;
+        SICK_LOG_INFO("\t*** Init. complete: Sick PLS is online and ready!");
+        SICK_LOG_INFO("\tScan Angle: " << GetSickScanAngle() << " (deg)");
+        SICK_LOG_INFO("\tScan Resolution: " << GetSickScanResolution() << " (deg)");
+        SICK_LOG_INFO("\tMeasuring Units: " << SickMeasuringUnitsToString(GetSickMeasuringUnits()));
 
     }
 
     /**
-     * \brief Uninitializes the PLS by putting it in a mode where it stops streaming data,
-     *        and returns it to the default baud rate (specified in the header).
+     * \brief Uninitializes the PLS (the configuration lock must be held)
      */
     void
-    SickPLS::Uninitialize() noexcept(false) {
+    SickPLS::_uninitialize() noexcept(false) {
 
         if (_sick_initialized) {
 
-            std::cout << std::endl << "\t*** Attempting to uninitialize the Sick PLS..." << std::endl;
+            SICK_LOG_INFO("\t*** Attempting to uninitialize the Sick PLS...");
 
             try {
 
@@ -235,42 +311,42 @@ namespace sickpls {
 
                 /* Attempt to cancel the buffer monitor */
                 if (_sick_monitor_running) {
-                    std::cout << "\tAttempting to stop buffer monitor..." << std::endl;
+                    SICK_LOG_INFO("\tAttempting to stop buffer monitor...");
                     _stopListening();
-                    std::cout << "\t\tBuffer monitor stopped!" << std::endl;
+                    SICK_LOG_INFO("\t\tBuffer monitor stopped!");
                 }
 
-                std::cout << "\t*** Uninit. complete - Sick PLS is now offline!" << std::endl << std::flush;
+                SICK_LOG_INFO("\t*** Uninit. complete - Sick PLS is now offline!");
 
             }
 
                 /* Handle any config exceptions */
             catch (SickConfigException& sick_config_exception) {
-                std::cerr << sick_config_exception.what() << " (attempting to kill connection anyways)" << std::endl;
+                SICK_LOG_ERROR(sick_config_exception.what() << " (attempting to kill connection anyways)");
                 throw;
             }
 
                 /* Handle a timeout exception */
             catch (SickTimeoutException& sick_timeout_exception) {
-                std::cerr << sick_timeout_exception.what() << " (attempting to kill connection anyways)" << std::endl;
+                SICK_LOG_ERROR(sick_timeout_exception.what() << " (attempting to kill connection anyways)");
                 throw;
             }
 
                 /* Handle any I/O exceptions */
             catch (SickIOException& sick_io_exception) {
-                std::cerr << sick_io_exception.what() << " (attempting to kill connection anyways)" << std::endl;
+                SICK_LOG_ERROR(sick_io_exception.what() << " (attempting to kill connection anyways)");
                 throw;
             }
 
                 /* Handle any thread exceptions */
             catch (SickThreadException& sick_thread_exception) {
-                std::cerr << sick_thread_exception.what() << " (attempting to kill connection anyways)" << std::endl;
+                SICK_LOG_ERROR(sick_thread_exception.what() << " (attempting to kill connection anyways)");
                 throw;
             }
 
                 /* Handle anything else */
             catch (...) {
-                std::cerr << "SickPLS::Unintialize: Unknown exception!!!" << std::endl;
+                SICK_LOG_ERROR("SickPLS::Unintialize: Unknown exception!!!");
                 throw;
             }
 
@@ -349,7 +425,7 @@ namespace sickpls {
         }
 
         /* Return the current operating mode of the device */
-        return (sick_pls_operating_mode_t) _sick_operating_status.sick_operating_mode;
+        return (sick_pls_operating_mode_t) _loadSickOpMode();
 
     }
 
@@ -373,86 +449,337 @@ namespace sickpls {
     void SickPLS::GetSickScan(unsigned int* const measurement_values,
                               unsigned int& num_measurement_values) noexcept(false) {
 
+        uint64_t timestamp_usec;
+        GetSickScan(measurement_values, num_measurement_values, timestamp_usec);
+
+    }
+
+    /**
+     * \brief Returns the most recent measured values and when they arrived
+     * \param *measurement_values Destination buffer for holding the current round of measured values
+     * \param &num_measurement_values Number of values stored in measurement_values
+     * \param &timestamp_usec When the first byte of the scan's frame was read (CLOCK_MONOTONIC usecs)
+     *
+     * NOTE: The stamp trails the end of the mirror revolution by the frame's
+     *       transmission time, which is fixed for a given baud and mode.
+     */
+    void SickPLS::GetSickScan(unsigned int* const measurement_values, unsigned int& num_measurement_values,
+                              uint64_t& timestamp_usec) noexcept(false) {
+
         /* Ensure the device is initialized */
         if (!_sick_initialized) {
             throw SickConfigException("SickPLS::GetSickScan: Sick PLS is not initialized!");
         }
 
-        /* Declare message objects */
-        SickPLSMessage response;
+        try {
 
-        /* Declare some useful variables and a buffer */
-        uint8_t payload_buffer[SickPLSMessage::MESSAGE_PAYLOAD_MAX_LENGTH] = {0};
+            /* Restore original operating mode (only the first caller after a mode change waits on the device) */
+            if (_loadSickOpMode() != SICK_OP_MODE_MONITOR_STREAM_VALUES) {
 
-        try {
+                _acquireSickConfig();
+
+                try {
+                    _setSickOpModeMonitorStreamValues();
+                }
 
-            /* Restore original operating mode */
-            _setSickOpModeMonitorStreamValues();
+                catch (...) {
+                    _releaseSickConfig();
+                    throw;
+                }
 
-            /* Receive a data frame from the stream. */
-            _recvMessage(response, DEFAULT_SICK_PLS_SICK_MESSAGE_TIMEOUT);
+                _releaseSickConfig();
 
-            /* Check that our payload has the proper command byte of 0xB0 */
-            if (response.GetCommandCode() != 0xB0) {
-                throw SickIOException("SickPLS::GetSickScan: Unexpected message!");
             }
 
-            /* Acquire the payload buffer and length*/
-            response.GetPayload(payload_buffer);
+            /* Give up on the scan after the usual message timeout */
+            struct timespec deadline{};
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_sec += DEFAULT_SICK_PLS_SICK_MESSAGE_TIMEOUT / 1000000;
+            deadline.tv_nsec += (long) (DEFAULT_SICK_PLS_SICK_MESSAGE_TIMEOUT % 1000000) * 1000;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
 
-            /* Define a local scan profile object */
-            sick_pls_scan_profile_b0_t sick_scan_profile;
+            if (pthread_mutex_lock(&_sick_scan_mutex) != 0) {
+                throw SickThreadException("SickPLS::GetSickScan: pthread_mutex_lock() failed!");
+            }
 
-            /* Initialize the profile */
-            memset(&sick_scan_profile, 0, sizeof(sick_pls_scan_profile_b0_t));
+            /* Wait for a scan newer than any shared before this call */
+            const uint64_t scan_sequence = _sick_scan_sequence;
+            while (_sick_scan_sequence == scan_sequence) {
+
+                /* Nobody is receiving, so receive the scan for everyone */
+                if (!_sick_scan_receiving) {
+
+                    _sick_scan_receiving = true;
+                    pthread_mutex_unlock(&_sick_scan_mutex);
+
+                    sick_pls_scan_profile_b0_t sick_scan_profile;
+                    uint64_t sick_scan_timestamp_usec = 0;
+
+                    try {
+                        _recvSickScan(sick_scan_profile, sick_scan_timestamp_usec);
+                    }
+
+                        /* Hand the job to one of the waiters */
+                    catch (...) {
+                        pthread_mutex_lock(&_sick_scan_mutex);
+                        _sick_scan_receiving = false;
+                        pthread_cond_broadcast(&_sick_scan_cond);
+                        pthread_mutex_unlock(&_sick_scan_mutex);
+                        throw;
+                    }
+
+                    /* Share it */
+                    pthread_mutex_lock(&_sick_scan_mutex);
+                    _sick_scan_profile = sick_scan_profile;
+                    _sick_scan_timestamp_usec = sick_scan_timestamp_usec;
+                    _sick_scan_sequence++;
+                    _sick_scan_receiving = false;
+                    pthread_cond_broadcast(&_sick_scan_cond);
+
+                } else if (pthread_cond_timedwait(&_sick_scan_cond, &_sick_scan_mutex, &deadline) == ETIMEDOUT &&
+                           _sick_scan_sequence == scan_sequence) {
+                    pthread_mutex_unlock(&_sick_scan_mutex);
+                    _num_scan_timeouts.fetch_add(1, std::memory_order_relaxed);
+                    throw SickTimeoutException("SickPLS::GetSickScan: Timeout occurred!");
+                }
 
-            /* Parse the message payload */
-            _parseSickScanProfileB0(&payload_buffer[1], sick_scan_profile);
+            }
 
             /* Return the request values! */
-            num_measurement_values = sick_scan_profile.sick_num_measurements;
+            timestamp_usec = _sick_scan_timestamp_usec;
+            num_measurement_values = _sick_scan_profile.sick_num_measurements;
 
             for (unsigned int i = 0; i < num_measurement_values; i++) {
 
                 /* Copy the measurement value */
-                measurement_values[i] = sick_scan_profile.sick_measurements[i];
+                measurement_values[i] = _sick_scan_profile.sick_measurements[i];
 
             }
 
+            pthread_mutex_unlock(&_sick_scan_mutex);
+
         }
 
             /* Handle any config exceptions */
         catch (SickConfigException& sick_config_exception) {
-            std::cerr << sick_config_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_config_exception.what());
             throw;
         }
 
             /* Handle a timeout exception */
         catch (SickTimeoutException& sick_timeout_exception) {
-            std::cerr << sick_timeout_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_timeout_exception.what());
             throw;
         }
 
             /* Handle any I/O exceptions */
         catch (SickIOException& sick_io_exception) {
-            std::cerr << sick_io_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_io_exception.what());
             throw;
         }
 
             /* Handle any thread exceptions */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
+            throw;
+        }
+
+            /* Handle anything else */
+        catch (...) {
+            SICK_LOG_ERROR("SickPLS::GetSickScan: Unknown exception!!!");
+            throw;
+        }
+
+    }
+
+    /**
+     * \brief Receives and decodes the next streamed scan
+     * \param &sick_scan_profile The decoded scan
+     * \param &timestamp_usec When the first byte of the scan's frame was read (CLOCK_MONOTONIC usecs)
+     */
+    void SickPLS::_recvSickScan(sick_pls_scan_profile_b0_t& sick_scan_profile, uint64_t& timestamp_usec)
+    noexcept(false) {
+
+        /* Declare message objects */
+        SickPLSMessage response;
+
+        /* Declare some useful variables and a buffer */
+        uint8_t payload_buffer[SickPLSMessage::MESSAGE_PAYLOAD_MAX_LENGTH] = {0};
+
+        /* Receive a data frame from the stream. */
+        try {
+            _recvStreamMessage(response, DEFAULT_SICK_PLS_SICK_MESSAGE_TIMEOUT);
+        }
+
+            /* Count it before passing it on */
+        catch (SickTimeoutException& sick_timeout_exception) {
+            _num_scan_timeouts.fetch_add(1, std::memory_order_relaxed);
+            throw;
+        }
+
+        /* Check that our payload has the proper command byte of 0xB0 */
+        if (response.GetCommandCode() != 0xB0) {
+            throw SickIOException("SickPLS::_recvSickScan: Unexpected message!");
+        }
+
+        /* Acquire the payload buffer and length*/
+        response.GetPayload(payload_buffer);
+
+        /* Initialize the profile */
+        memset(&sick_scan_profile, 0, sizeof(sick_pls_scan_profile_b0_t));
+
+        /* Parse the message payload */
+        _parseSickScanProfileB0(&payload_buffer[1], sick_scan_profile);
+
+        /* Account for where the time went */
+        uint64_t stage_timestamps[SICK_MESSAGE_NUM_STAGES];
+        for (unsigned int i = 0; i < SICK_MESSAGE_NUM_STAGES; i++) {
+            stage_timestamps[i] = response.GetStageTimestamp((sick_message_stage_t) i);
+        }
+        stage_timestamps[SICK_MESSAGE_STAGE_DECODED] = sick_message_clock_nsec();
+        _latency.Record(stage_timestamps);
+        _num_scans.fetch_add(1, std::memory_order_relaxed);
+
+        timestamp_usec = stage_timestamps[SICK_MESSAGE_STAGE_FIRST_BYTE] / 1000;
+
+    }
+
+
+    /**
+     * \brief Gets per-stage receive latency statistics for the scans returned so far
+     * \param &snapshot Summaries of each sick_pls_latency_interval_t (nsecs)
+     *
+     * NOTE: This may be called from any thread while scans are being read.
+     */
+    void SickPLS::GetSickLatencySnapshot(sick_pls_latency_snapshot_t& snapshot) const {
+        _latency.GetSnapshot(snapshot);
+    }
+
+    /**
+     * \brief Discards the receive latency statistics
+     */
+    void SickPLS::ResetSickLatencyStats() {
+        _latency.Reset();
+    }
+
+    /**
+     * \brief Gets running totals of the driver's traffic
+     * \param &counters The totals since construction
+     *
+     * NOTE: This may be called from any thread while scans are being read.
+     */
+    void SickPLS::GetSickCounters(sick_pls_counters_t& counters) const {
+
+        counters.sick_scans = _num_scans.load(std::memory_order_relaxed);
+        counters.sick_messages_received = _sick_buffer_monitor->GetNumMessagesReceived();
+        counters.sick_bytes_received = _sick_buffer_monitor->GetNumBytesReceived();
+        counters.sick_idle_nsec = _sick_buffer_monitor->GetIdleTime();
+        counters.sick_messages_overwritten = _sick_buffer_monitor->GetNumMessagesOverwritten();
+        counters.sick_checksum_errors = _sick_buffer_monitor->GetNumChecksumErrors();
+        counters.sick_requests_sent = GetNumRequestsSent();
+        counters.sick_request_retries = GetNumRequestRetries();
+        counters.sick_request_failures = GetNumRequestFailures();
+        counters.sick_scan_timeouts = _num_scan_timeouts.load(std::memory_order_relaxed);
+
+    }
+
+    /**
+     * \brief Acquire the Sick PLS status
+     * \return SICK_STATUS_OK if the device reports no errors, SICK_STATUS_ERROR otherwise
+     *
+     * NOTE: The reply is matched by its reply code, so this may be called
+     *       while the device is streaming.
+     */
+    SickPLS::sick_pls_status_t SickPLS::GetSickStatus() noexcept(false) {
+
+        /* Ensure the device is initialized */
+        if (!_sick_initialized) {
+            throw SickConfigException("SickPLS::GetSickStatus: Sick PLS is not initialized!");
+        }
+
+        unsigned int num_sick_errors = 0;
+
+        try {
+
+            /* Request the error/test telegram */
+            _acquireSickConfig();
+
+            try {
+                _getSickErrors(&num_sick_errors);
+            }
+
+            catch (...) {
+                _releaseSickConfig();
+                throw;
+            }
+
+            _releaseSickConfig();
+
+        }
+
+            /* Handle a timeout exception */
+        catch (SickTimeoutException& sick_timeout_exception) {
+            SICK_LOG_ERROR(sick_timeout_exception.what());
             throw;
         }
 
             /* Handle anything else */
         catch (...) {
-            std::cerr << "SickPLS::GetSickScan: Unknown exception!!!" << std::endl;
+            SICK_LOG_ERROR("SickPLS::GetSickStatus: Unknown exception!!!");
             throw;
         }
 
+        return (num_sick_errors == 0) ? SICK_STATUS_OK : SICK_STATUS_ERROR;
     }
 
+    /**
+     * \brief Switches the Sick PLS to one of the supported operating modes
+     * \param sick_operating_mode Installation, diagnostic, monitor (request values) or monitor (stream values)
+     *
+     * NOTE: GetSickScan switches the device back to streaming on its own.
+     */
+    void SickPLS::SetSickOperatingMode(const sick_pls_operating_mode_t sick_operating_mode) noexcept(false) {
+
+        /* Ensure the device is initialized */
+        if (!_sick_initialized) {
+            throw SickConfigException("SickPLS::SetSickOperatingMode: Sick PLS is not initialized!");
+        }
+
+        _acquireSickConfig();
+
+        try {
+
+            switch (sick_operating_mode) {
+                case SICK_OP_MODE_INSTALLATION:
+                    _setSickOpModeInstallation();
+                    break;
+                case SICK_OP_MODE_DIAGNOSTIC:
+                    _setSickOpModeDiagnostic();
+                    break;
+                case SICK_OP_MODE_MONITOR_REQUEST_VALUES:
+                    _setSickOpModeMonitorRequestValues();
+                    break;
+                case SICK_OP_MODE_MONITOR_STREAM_VALUES:
+                    _setSickOpModeMonitorStreamValues();
+                    break;
+                default:
+                    throw SickConfigException("SickPLS::SetSickOperatingMode: Unsupported operating mode!");
+            }
+
+        }
+
+            /* Let other configuration calls in before passing it on */
+        catch (...) {
+            _releaseSickConfig();
+            throw;
+        }
+
+        _releaseSickConfig();
+
+    }
 
     /**
      * \brief Reset the Sick PLS active field values
@@ -465,6 +792,27 @@ namespace sickpls {
             throw SickConfigException("SickPLS::ResetSick: Sick PLS is not initialized!");
         }
 
+        _acquireSickConfig();
+
+        try {
+            _resetSick();
+        }
+
+            /* Let other configuration calls in before passing it on */
+        catch (...) {
+            _releaseSickConfig();
+            throw;
+        }
+
+        _releaseSickConfig();
+
+    }
+
+    /**
+     * \brief Resets the Sick PLS (the configuration lock must be held)
+     */
+    void SickPLS::_resetSick() noexcept(false) {
+
         SickPLSMessage message, response;
         uint8_t payload[SickPLSMessage::MESSAGE_PAYLOAD_MAX_LENGTH] = {0};
 
@@ -472,16 +820,16 @@ namespace sickpls {
         payload[0] = 0x10; // Request field reset
         message.BuildMessage(DEFAULT_SICK_PLS_SICK_ADDRESS, payload, 1);
 
-        std::cout << "\tResetting the device..." << std::endl;
-        std::cout << "\tWaiting for Power on message..." << std::endl;
+        SICK_LOG_INFO("\tResetting the device...");
+        SICK_LOG_INFO("\tWaiting for Power on message...");
 
         try {
 
             /* Send the reset command and wait for the reply */
             _sendMessageAndGetReply(message, response, 0x91, (unsigned int) 60e6, DEFAULT_SICK_PLS_NUM_TRIES);
 
-            std::cout << "\t\tPower on message received!" << std::endl;
-            std::cout << "\tWaiting for PLS Ready message..." << std::endl;
+            SICK_LOG_INFO("\t\tPower on message received!");
+            SICK_LOG_INFO("\tWaiting for PLS Ready message...");
 
             /* Set terminal baud to the detected rate to get the PLS ready message */
             _setTerminalBaud(_baudToSickBaud(DEFAULT_SICK_PLS_SICK_BAUD));
@@ -491,42 +839,41 @@ namespace sickpls {
 
             /* Verify the response */
             if (response.GetCommandCode() != 0x90) {
-                std::cerr << "SickPLS::ResetSick: Unexpected reply! (assuming device has been reset!)" << std::endl;
+                SICK_LOG_WARNING("SickPLS::ResetSick: Unexpected reply! (assuming device has been reset!)");
             } else {
-                std::cout << "\t\tPLS Ready message received!" << std::endl;
+                SICK_LOG_INFO("\t\tPLS Ready message received!");
             }
-            std::cout << std::endl;
 
             /* Reinitialize and sync the device */
-            Initialize(_desired_session_baud);
+            _initialize(_desired_session_baud);
 
         }
 
             /* Catch any timeout exceptions */
         catch (SickTimeoutException& sick_timeout_exception) {
-            std::cerr << sick_timeout_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_timeout_exception.what());
             throw;
         }
 
             /* Catch any I/O exceptions */
         catch (SickIOException& sick_io_exception) {
-            std::cerr << sick_io_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_io_exception.what());
             throw;
         }
 
             /* Catch any thread exceptions */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
             throw;
         }
 
             /* Catch anything else */
         catch (...) {
-            std::cerr << "SickPLS::ResetSick: Unknown exception!!!" << std::endl;
+            SICK_LOG_ERROR("SickPLS::ResetSick: Unknown exception!!!");
             throw;
         }
 
-        std::cout << "\tRe-initialization sucessful. PLS is ready to go!" << std::endl;
+        SICK_LOG_INFO("\tRe-initialization sucessful. PLS is ready to go!");
 
     }
 
@@ -761,19 +1108,19 @@ namespace sickpls {
 
             /* Handle any I/O exceptions */
         catch (SickIOException& sick_io_exception) {
-            std::cerr << sick_io_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_io_exception.what());
             throw;
         }
 
             /* Handle any thread exceptions */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
             throw;
         }
 
             /* Handle unknown exceptions */
         catch (...) {
-            std::cerr << "SickPLS::_setupConnection: Unknown exception!" << std::endl;
+            SICK_LOG_ERROR("SickPLS::_setupConnection: Unknown exception!");
             throw;
         }
 
@@ -823,18 +1170,42 @@ namespace sickpls {
 
             /* Handle thread exceptions */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
             throw;
         }
 
             /* A sanity check */
         catch (...) {
-            std::cerr << "SickPLS::_flushTerminalBuffer: Unknown exception!" << std::endl;
+            SICK_LOG_ERROR("SickPLS::_flushTerminalBuffer: Unknown exception!");
             throw;
         }
 
     }
 
+    /**
+     * \brief Locks out other configuration calls
+     */
+    void SickPLS::_acquireSickConfig() noexcept(false) {
+
+        /* Attempt to lock the configuration mutex */
+        if (pthread_mutex_lock(&_sick_config_mutex) != 0) {
+            throw SickThreadException("SickPLS::_acquireSickConfig: pthread_mutex_lock() failed!");
+        }
+
+    }
+
+    /**
+     * \brief Lets other configuration calls proceed
+     */
+    void SickPLS::_releaseSickConfig() noexcept(false) {
+
+        /* Attempt to unlock the configuration mutex */
+        if (pthread_mutex_unlock(&_sick_config_mutex) != 0) {
+            throw SickThreadException("SickPLS::_releaseSickConfig: pthread_mutex_unlock() failed!");
+        }
+
+    }
+
     /**
      * \brief Sends a message and searches for the corresponding reply
      * \param &send_message The message to be sent to the Sick PLS unit
@@ -872,19 +1243,19 @@ namespace sickpls {
 
             /* Handle a thread exception */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
             throw;
         }
 
             /* Handle write buffer exceptions */
         catch (SickIOException& sick_io_error) {
-            std::cerr << sick_io_error.what() << std::endl;
+            SICK_LOG_ERROR(sick_io_error.what());
             throw;
         }
 
             /* A safety net */
         catch (...) {
-            std::cerr << "SickPLS::_sendMessageAndGetReply: Unknown exception!!!" << std::endl;
+            SICK_LOG_ERROR("SickPLS::_sendMessageAndGetReply: Unknown exception!!!");
             throw;
         }
 
@@ -925,19 +1296,19 @@ namespace sickpls {
 
             /* Handle a thread exception */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
             throw;
         }
 
             /* Handle write buffer exceptions */
         catch (SickIOException& sick_io_error) {
-            std::cerr << sick_io_error.what() << std::endl;
+            SICK_LOG_ERROR(sick_io_error.what());
             throw;
         }
 
             /* A safety net */
         catch (...) {
-            std::cerr << "SickPLS::_sendMessageAndGetReply: Unknown exception!!!" << std::endl;
+            SICK_LOG_ERROR("SickPLS::_sendMessageAndGetReply: Unknown exception!!!");
             throw;
         }
 
@@ -954,9 +1325,7 @@ namespace sickpls {
 
         _setSickOpModeInstallation();
 
-        std::cout << "Setting session baud from operating mode: "
-                  << _sick_operating_status.sick_operating_mode
-                  << std::endl;
+        SICK_LOG_DEBUG("Setting session baud from operating mode: " << _loadSickOpMode());
 
         SickPLSMessage message, response;
 
@@ -991,25 +1360,25 @@ namespace sickpls {
 
             /* Catch a timeout */
         catch (SickTimeoutException& sick_timeout_exception) {
-            std::cerr << sick_timeout_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_timeout_exception.what());
             throw;
         }
 
             /* Catch any I/O exceptions */
         catch (SickIOException& sick_io_exception) {
-            std::cerr << sick_io_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_io_exception.what());
             throw;
         }
 
             /* Catch any thread exceptions */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
             throw;
         }
 
             /* Catch anything else */
         catch (...) {
-            std::cerr << "SickPLS::_getSickErrors: Unknown exception!!!" << std::endl;
+            SICK_LOG_ERROR("SickPLS::_getSickErrors: Unknown exception!!!");
             throw;
         }
 
@@ -1029,7 +1398,7 @@ namespace sickpls {
             }
 
             /* Attempt to get status information at the current baud */
-            std::cout << "\t\tChecking " << SickBaudToString(baud_rate) << "..." << std::endl;
+            SICK_LOG_INFO("\t\tChecking " << SickBaudToString(baud_rate) << "...");
 
             /* Set the host terminal baud rate to the test speed */
             _setTerminalBaud(baud_rate);
@@ -1049,7 +1418,7 @@ namespace sickpls {
 
                 /* Catch anything else and throw it away */
             catch (...) {
-                std::cerr << "SickPLS::_testBaudRate: Unknown exception!" << std::endl;
+                SICK_LOG_ERROR("SickPLS::_testBaudRate: Unknown exception!");
                 throw;
             }
 
@@ -1057,19 +1426,19 @@ namespace sickpls {
 
             /* Handle any IO exceptions */
         catch (SickIOException& sick_io_exception) {
-            std::cerr << sick_io_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_io_exception.what());
             throw;
         }
 
             /* Handle thread exceptions */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
             throw;
         }
 
             /* A safety net */
         catch (...) {
-            std::cerr << "SickPLS::_testBaudRate: Unknown exception!!!" << std::endl;
+            SICK_LOG_ERROR("SickPLS::_testBaudRate: Unknown exception!!!");
             throw;
         }
 
@@ -1128,18 +1497,16 @@ namespace sickpls {
 
                 /* We let the next few errors slide in case USB adapter is being used */
                 if (ioctl(_sick_fd, TIOCGSERIAL, &serial) < 0) {
-                    std::cerr << "SickPLS::_setTermSpeed: ioctl() failed while trying to get serial port info!"
-                              << std::endl;
-                    std::cerr << "\tNOTE: This is normal when connected via USB!" << std::endl;
+                    SICK_LOG_WARNING("SickPLS::_setTermSpeed: ioctl() failed while trying to get serial port info!");
+                    SICK_LOG_WARNING("\tNOTE: This is normal when connected via USB!");
                 }
 
                 serial.custom_divisor = 0;
                 serial.flags &= ~ASYNC_SPD_CUST;
 
                 if (ioctl(_sick_fd, TIOCSSERIAL, &serial) < 0) {
-                    std::cerr << "SickPLS::_setTerminalBaud: ioctl() failed while trying to set serial port info!"
-                              << std::endl;
-                    std::cerr << "\tNOTE: This is normal when connected via USB!" << std::endl;
+                    SICK_LOG_WARNING("SickPLS::_setTerminalBaud: ioctl() failed while trying to set serial port info!");
+                    SICK_LOG_WARNING("\tNOTE: This is normal when connected via USB!");
                 }
 
             }
@@ -1206,8 +1573,11 @@ namespace sickpls {
                 throw SickIOException("SickPLS::_setTerminalBaud: Unable to set device attributes!");
             }
 
-            /* Buffer the rate locally */
+            /* Buffer the rate and the character framing locally */
             _curr_session_baud = baud_rate;
+            _sick_bits_per_byte = 1 + ((term.c_cflag & CSIZE) == CS5 ? 5 : (term.c_cflag & CSIZE) == CS6 ? 6 :
+                                       (term.c_cflag & CSIZE) == CS7 ? 7 : 8) +
+                                  ((term.c_cflag & PARENB) ? 1 : 0) + ((term.c_cflag & CSTOPB) ? 2 : 1);
 
             /* Attempt to flush the I/O buffers */
             _flushTerminalBuffer();
@@ -1216,19 +1586,19 @@ namespace sickpls {
 
             /* Catch an IO exception */
         catch (SickIOException sick_io_exception) {
-            std::cerr << sick_io_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_io_exception.what());
             throw;
         }
 
             /* Catch an IO exception */
         catch (SickThreadException sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
             throw;
         }
 
             /* A sanity check */
         catch (...) {
-            std::cerr << "SickPLS::_setTerminalBaud: Unknown exception!!!" << std::endl;
+            SICK_LOG_ERROR("SickPLS::_setTerminalBaud: Unknown exception!!!");
             throw;
         }
 
@@ -1262,29 +1632,30 @@ namespace sickpls {
 
             /* Catch any timeout exceptions */
         catch (SickTimeoutException& sick_timeout_exception) {
-            std::cerr << sick_timeout_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_timeout_exception.what());
             throw;
         }
 
             /* Catch any I/O exceptions */
         catch (SickIOException& sick_io_exception) {
-            std::cerr << sick_io_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_io_exception.what());
             throw;
         }
 
             /* Catch any thread exceptions */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
             throw;
         }
 
             /* Catch anything else */
         catch (...) {
-            std::cerr << "SickPLS::_getSickErrors: Unknown exception!!!" << std::endl;
+            SICK_LOG_ERROR("SickPLS::_getSickErrors: Unknown exception!!!");
             throw;
         }
 
-        /* Extract the payload_length */
+        /* Extract the payload and its length */
+        response.GetPayload(payload_buffer);
         payload_length = response.GetPayloadLength();
 
         /* Compute the number of errors */
@@ -1325,7 +1696,7 @@ namespace sickpls {
         uint8_t sick_password[9] = DEFAULT_SICK_PLS_SICK_PASSWORD;
 
         /* Check if mode should be changed */
-        if (_sick_operating_status.sick_operating_mode != SICK_OP_MODE_INSTALLATION) {
+        if (_loadSickOpMode() != SICK_OP_MODE_INSTALLATION) {
 
             try {
 
@@ -1336,36 +1707,36 @@ namespace sickpls {
 
                 /* Catch any config exceptions */
             catch (SickConfigException& sick_config_exception) {
-                std::cerr << sick_config_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_config_exception.what());
                 throw;
             }
 
                 /* Catch any timeout exceptions */
             catch (SickTimeoutException& sick_timeout_exception) {
-                std::cerr << sick_timeout_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_timeout_exception.what());
                 throw;
             }
 
                 /* Catch any I/O exceptions */
             catch (SickIOException& sick_io_exception) {
-                std::cerr << sick_io_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_io_exception.what());
                 throw;
             }
 
                 /* Catch any thread exceptions */
             catch (SickThreadException& sick_thread_exception) {
-                std::cerr << sick_thread_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_thread_exception.what());
                 throw;
             }
 
                 /* Catch anything else */
             catch (...) {
-                std::cerr << "SickPLS::_setSickOpModeInstallation: Unknown exception!!!" << std::endl;
+                SICK_LOG_ERROR("SickPLS::_setSickOpModeInstallation: Unknown exception!!!");
                 throw;
             }
 
             /* Assign the new operating mode */
-            _sick_operating_status.sick_operating_mode = SICK_OP_MODE_INSTALLATION;
+            _storeSickOpMode(SICK_OP_MODE_INSTALLATION);
         }
 
     }
@@ -1377,9 +1748,9 @@ namespace sickpls {
     noexcept(false) {
 
         /* Check if mode should be changed */
-        if (_sick_operating_status.sick_operating_mode != SICK_OP_MODE_DIAGNOSTIC) {
+        if (_loadSickOpMode() != SICK_OP_MODE_DIAGNOSTIC) {
 
-            std::cout << "\tAttempting to enter diagnostic mode..." << std::endl;
+            SICK_LOG_INFO("\tAttempting to enter diagnostic mode...");
 
             try {
 
@@ -1390,38 +1761,38 @@ namespace sickpls {
 
                 /* Catch any config exceptions */
             catch (SickConfigException& sick_config_exception) {
-                std::cerr << sick_config_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_config_exception.what());
                 throw;
             }
 
                 /* Catch any timeout exceptions */
             catch (SickTimeoutException& sick_timeout_exception) {
-                std::cerr << sick_timeout_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_timeout_exception.what());
                 throw;
             }
 
                 /* Catch any I/O exceptions */
             catch (SickIOException& sick_io_exception) {
-                std::cerr << sick_io_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_io_exception.what());
                 throw;
             }
 
                 /* Catch any thread exceptions */
             catch (SickThreadException& sick_thread_exception) {
-                std::cerr << sick_thread_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_thread_exception.what());
                 throw;
             }
 
                 /* Catch anything else */
             catch (...) {
-                std::cerr << "SickPLS::_setSickOpModeInstallation: Unknown exception!!!" << std::endl;
+                SICK_LOG_ERROR("SickPLS::_setSickOpModeInstallation: Unknown exception!!!");
                 throw;
             }
 
             /* Assign the new operating mode */
-            _sick_operating_status.sick_operating_mode = SICK_OP_MODE_DIAGNOSTIC;
+            _storeSickOpMode(SICK_OP_MODE_DIAGNOSTIC);
 
-            std::cout << "Success!" << std::endl;
+            SICK_LOG_INFO("Success!");
 
         }
 
@@ -1434,7 +1805,7 @@ namespace sickpls {
     noexcept(false) {
 
         /* Check if mode should be changed */
-        if (_sick_operating_status.sick_operating_mode != SICK_OP_MODE_MONITOR_REQUEST_VALUES) {
+        if (_loadSickOpMode() != SICK_OP_MODE_MONITOR_REQUEST_VALUES) {
 
             try {
 
@@ -1445,36 +1816,36 @@ namespace sickpls {
 
                 /* Catch any config exceptions */
             catch (SickConfigException& sick_config_exception) {
-                std::cerr << sick_config_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_config_exception.what());
                 throw;
             }
 
                 /* Catch any timeout exceptions */
             catch (SickTimeoutException& sick_timeout_exception) {
-                std::cerr << sick_timeout_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_timeout_exception.what());
                 throw;
             }
 
                 /* Catch any I/O exceptions */
             catch (SickIOException& sick_io_exception) {
-                std::cerr << sick_io_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_io_exception.what());
                 throw;
             }
 
                 /* Catch any thread exceptions */
             catch (SickThreadException& sick_thread_exception) {
-                std::cerr << sick_thread_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_thread_exception.what());
                 throw;
             }
 
                 /* Catch anything else */
             catch (...) {
-                std::cerr << "SickPLS::_setSickOpModeMonitorRequestValues: Unknown exception!!!" << std::endl;
+                SICK_LOG_ERROR("SickPLS::_setSickOpModeMonitorRequestValues: Unknown exception!!!");
                 throw;
             }
 
             /* Assign the new operating mode */
-            _sick_operating_status.sick_operating_mode = SICK_OP_MODE_MONITOR_REQUEST_VALUES;
+            _storeSickOpMode(SICK_OP_MODE_MONITOR_REQUEST_VALUES);
 
         }
 
@@ -1487,9 +1858,9 @@ namespace sickpls {
     noexcept(false) {
 
         /* Check if mode should be changed */
-        if (_sick_operating_status.sick_operating_mode != SICK_OP_MODE_MONITOR_STREAM_VALUES) {
+        if (_loadSickOpMode() != SICK_OP_MODE_MONITOR_STREAM_VALUES) {
 
-            std::cout << "\tRequesting measured value data stream..." << std::endl;
+            SICK_LOG_INFO("\tRequesting measured value data stream...");
 
             try {
 
@@ -1500,38 +1871,38 @@ namespace sickpls {
 
                 /* Catch any config exceptions */
             catch (SickConfigException& sick_config_exception) {
-                std::cerr << sick_config_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_config_exception.what());
                 throw;
             }
 
                 /* Catch any timeout exceptions */
             catch (SickTimeoutException& sick_timeout_exception) {
-                std::cerr << sick_timeout_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_timeout_exception.what());
                 throw;
             }
 
                 /* Catch any I/O exceptions */
             catch (SickIOException& sick_io_exception) {
-                std::cerr << sick_io_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_io_exception.what());
                 throw;
             }
 
                 /* Catch any thread exceptions */
             catch (SickThreadException& sick_thread_exception) {
-                std::cerr << sick_thread_exception.what() << std::endl;
+                SICK_LOG_ERROR(sick_thread_exception.what());
                 throw;
             }
 
                 /* Catch anything else */
             catch (...) {
-                std::cerr << "SickPLS::_setSickOpModeMonitorStreamValues: Unknown exception!!!" << std::endl;
+                SICK_LOG_ERROR("SickPLS::_setSickOpModeMonitorStreamValues: Unknown exception!!!");
                 throw;
             }
 
             /* Assign the new operating mode */
-            _sick_operating_status.sick_operating_mode = SICK_OP_MODE_MONITOR_STREAM_VALUES;
+            _storeSickOpMode(SICK_OP_MODE_MONITOR_STREAM_VALUES);
 
-            std::cout << "\t\tData stream started!" << std::endl;
+            SICK_LOG_INFO("\t\tData stream started!");
 
         }
 
@@ -1711,6 +2082,9 @@ namespace sickpls {
 
         //    message.Print();
 
+        /* Only read the clock while a tracer is attached */
+        const uint64_t begin_nsec = SICK_PROBE_ENABLED(mode_switch) ? sick_message_clock_nsec() : 0;
+
         try {
 
             /* Attempt to send the message and get the reply */
@@ -1723,25 +2097,25 @@ namespace sickpls {
 
             /* Catch any timeout exceptions */
         catch (SickTimeoutException& sick_timeout_exception) {
-            std::cerr << sick_timeout_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_timeout_exception.what());
             throw;
         }
 
             /* Catch any I/O exceptions */
         catch (SickIOException& sick_io_exception) {
-            std::cerr << sick_io_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_io_exception.what());
             throw;
         }
 
             /* Catch any thread exceptions */
         catch (SickThreadException& sick_thread_exception) {
-            std::cerr << sick_thread_exception.what() << std::endl;
+            SICK_LOG_ERROR(sick_thread_exception.what());
             throw;
         }
 
             /* Catch anything else */
         catch (...) {
-            std::cerr << "SickPLS::_switchSickOperatingMode: Unknown exception!!!" << std::endl;
+            SICK_LOG_ERROR("SickPLS::_switchSickOperatingMode: Unknown exception!!!");
             throw;
         }
 
@@ -1750,6 +2124,10 @@ namespace sickpls {
 
         /* Obtain the response payload */
         response.GetPayload(payload_buffer);
+        if (SICK_PROBE_ENABLED(mode_switch)) {
+            SICK_PROBE(mode_switch, _loadSickOpMode(), sick_mode, payload_buffer[1],
+                       begin_nsec, sick_message_clock_nsec());
+        }
 
         /* Make sure the reply was expected */
         if (payload_buffer[1] != 0x00) {
@@ -1853,7 +2231,7 @@ namespace sickpls {
             case B500000:
                 return SICK_BAUD_500K;
             default:
-                std::cerr << "Unexpected baud rate!" << std::endl;
+                SICK_LOG_WARNING("Unexpected baud rate!");
                 return SICK_BAUD_9600;
         }
 
@@ -19,15 +19,18 @@
 #define SICK_PLS_HH
 
 /* Implementation dependencies */
+#include <atomic>
 #include <string>
 #include <iostream>
 #include <termios.h>
+#include <pthread.h>
 
 #include "SickLIDAR.hh"
 #include "SickException.hh"
 
 #include "SickPLSBufferMonitor.hh"
 #include "SickPLSMessage.hh"
+#include "SickPLSLatency.hh"
 
 /* Macro definitions */
 #define DEFAULT_SICK_PLS_SICK_BAUD                                       (B9600)  ///< Initial baud rate of the PLS (whatever is set in flash)
@@ -40,6 +43,7 @@
 #define DEFAULT_SICK_PLS_BYTE_INTERVAL                                      (55)  ///< Minimum time in microseconds between transmitted bytes
 //#define DEFAULT_SICK_PLS_BYTE_INTERVAL                                      (0)  ///< Minimum time in microseconds between transmitted bytes
 #define DEFAULT_SICK_PLS_NUM_TRIES                                           (3)  ///< The max number of tries before giving up on a request
+#define DEFAULT_SICK_PLS_BITS_PER_BYTE                                      (11)  ///< Start bit, 8 data bits, even parity and a stop bit
 
 /* Associate the namespace */
 namespace sickpls {
@@ -50,6 +54,12 @@ namespace sickpls {
      *
      * This class implements the basic telegram protocol for SickPLS range finders.
      * It allows the setting of such parameters as angular resolution, fov, etc...
+     *
+     * The public methods may be called from several threads at once.
+     * Configuration calls (Initialize, GetSickStatus, SetSickOperatingMode,
+     * ...) are serialized internally, while concurrent GetSickScan callers
+     * share each streamed scan: one of them receives and decodes it and
+     * hands a copy to all of them.
      */
     class SickPLS : public SickLIDAR<SickPLSBufferMonitor, SickPLSMessage> {
 
@@ -199,6 +209,28 @@ namespace sickpls {
         } sick_pls_scan_profile_b0_t;
 
 
+        /*!
+         * \struct sick_pls_counters_tag
+         * \brief Running totals of the driver's traffic.
+         */
+        /*!
+         * \typedef sick_pls_counters_t
+         * \brief Adopt c-style convention
+         */
+        typedef struct sick_pls_counters_tag {
+            uint64_t sick_scans;                                                     ///< Scans decoded by GetSickScan
+            uint64_t sick_messages_received;                                         ///< Frames that passed the CRC check
+            uint64_t sick_bytes_received;                                            ///< Bytes of all frames read (bad CRCs included)
+            uint64_t sick_idle_nsec;                                                 ///< Time between the end of a frame and the next one (nsecs)
+            uint64_t sick_messages_overwritten;                                      ///< Frames replaced before they were read
+            uint64_t sick_checksum_errors;                                           ///< Frames dropped for a bad CRC
+            uint64_t sick_requests_sent;                                             ///< Requests sent (retries included)
+            uint64_t sick_request_retries;                                           ///< Requests sent again after a timeout
+            uint64_t sick_request_failures;                                          ///< Requests unanswered on every try
+            uint64_t sick_scan_timeouts;                                             ///< GetSickScan calls that timed out waiting on the stream
+        } sick_pls_counters_t;
+
+
         /** Constructor */
         explicit SickPLS(std::string sick_device_path);
 
@@ -206,11 +238,11 @@ namespace sickpls {
         ~SickPLS() override;
 
         /** Initializes the Sick */
-        void Initialize(sick_pls_baud_t desired_baud_rate)
+        virtual void Initialize(sick_pls_baud_t desired_baud_rate)
         noexcept(false);
 
         /** Uninitializes the Sick */
-        void Uninitialize() noexcept(false);
+        virtual void Uninitialize() noexcept(false);
 
         /** Gets the Sick PLS device path */
         [[nodiscard]] std::string GetSickDevicePath() const;
@@ -228,13 +260,35 @@ namespace sickpls {
         [[nodiscard]] sick_pls_operating_mode_t GetSickOperatingMode() const noexcept(false);
 
         /** Gets measurement data from the Sick. NOTE: Data can be either range or reflectivity given the Sick mode. */
-        void GetSickScan(unsigned int* measurement_values, unsigned int& num_measurement_values) noexcept(false);
+        virtual void GetSickScan(unsigned int* measurement_values, unsigned int& num_measurement_values) noexcept(false);
+
+        /** Gets measurement data from the Sick along with the time its frame began to arrive */
+        virtual void GetSickScan(unsigned int* measurement_values, unsigned int& num_measurement_values,
+                                 uint64_t& timestamp_usec) noexcept(false);
 
         /** Acquire the Sick PLS status */
-        sick_pls_status_t GetSickStatus() noexcept(false);
+        virtual sick_pls_status_t GetSickStatus() noexcept(false);
+
+        /** Switches the Sick PLS to one of the supported operating modes */
+        virtual void SetSickOperatingMode(sick_pls_operating_mode_t sick_operating_mode) noexcept(false);
 
         /** Resets Sick PLS field values */
-        void ResetSick() noexcept(false);
+        virtual void ResetSick() noexcept(false);
+
+        /** Gets per-stage receive latency statistics for the scans returned so far */
+        void GetSickLatencySnapshot(sick_pls_latency_snapshot_t& snapshot) const;
+
+        /** Discards the receive latency statistics */
+        void ResetSickLatencyStats();
+
+        /** Gets running totals of the driver's traffic */
+        void GetSickCounters(sick_pls_counters_t& counters) const;
+
+        /** Gets the baud rate of the current session */
+        [[nodiscard]] sick_pls_baud_t GetSickSessionBaud() const { return _curr_session_baud.load(std::memory_order_acquire); }
+
+        /** Gets the number of bits on the line per byte (start, data, parity and stop bits) */
+        [[nodiscard]] unsigned int GetSickBitsPerByte() const { return _sick_bits_per_byte; }
 
         /** Get Sick status as a string */
         [[nodiscard]] std::string GetSickStatusAsString() const;
@@ -281,11 +335,14 @@ namespace sickpls {
         std::string _sick_device_path;
 
         /** The baud rate at which to communicate with the Sick */
-        sick_pls_baud_t _curr_session_baud;
+        std::atomic<sick_pls_baud_t> _curr_session_baud;
 
         /** The desired baud rate for communicating w/ the Sick */
         sick_pls_baud_t _desired_session_baud;
 
+        /** Bits per byte of the terminal's character framing */
+        unsigned int _sick_bits_per_byte;
+
 
         /** The operating parameters of the device */
         sick_pls_operating_status_t _sick_operating_status{};
@@ -298,6 +355,62 @@ namespace sickpls {
         /** Stores information about the original terminal settings */
         struct termios _old_term{};
 
+        /** Receive pipeline latencies of decoded scans */
+        SickPLSLatencyRecorder _latency;
+
+        /** Scans decoded by GetSickScan */
+        std::atomic<uint64_t> _num_scans{0};
+
+        /** GetSickScan calls that timed out waiting on the stream */
+        std::atomic<uint64_t> _num_scan_timeouts{0};
+
+        /** A (recursive) mutex serializing configuration of the device */
+        pthread_mutex_t _sick_config_mutex{};
+
+        /** A mutex and condition guarding the scan shared by GetSickScan callers */
+        pthread_mutex_t _sick_scan_mutex{};
+        pthread_cond_t _sick_scan_cond{};
+
+        /** Bumped each time a new scan is shared */
+        uint64_t _sick_scan_sequence{0};
+
+        /** True while a GetSickScan caller is receiving a scan for the others */
+        bool _sick_scan_receiving{false};
+
+        /** The most recently shared scan and when its first byte was read (usecs) */
+        sick_pls_scan_profile_b0_t _sick_scan_profile{};
+        uint64_t _sick_scan_timestamp_usec{0};
+
+        /** Locks out other configuration calls */
+        void _acquireSickConfig() noexcept(false);
+
+        /** Lets other configuration calls proceed */
+        void _releaseSickConfig() noexcept(false);
+
+        /** Reads the cached operating mode (may race a mode switch) */
+        [[nodiscard]] uint8_t _loadSickOpMode() const {
+            return std::atomic_ref<uint8_t>(const_cast<uint8_t&>(_sick_operating_status.sick_operating_mode))
+                    .load(std::memory_order_acquire);
+        }
+
+        /** Updates the cached operating mode */
+        void _storeSickOpMode(const uint8_t sick_operating_mode) {
+            std::atomic_ref<uint8_t>(_sick_operating_status.sick_operating_mode)
+                    .store(sick_operating_mode, std::memory_order_release);
+        }
+
+        /** Initializes the Sick (the configuration lock must be held) */
+        void _initialize(sick_pls_baud_t desired_baud_rate) noexcept(false);
+
+        /** Uninitializes the Sick (the configuration lock must be held) */
+        void _uninitialize() noexcept(false);
+
+        /** Resets the Sick (the configuration lock must be held) */
+        void _resetSick() noexcept(false);
+
+        /** Receives and decodes the next streamed scan */
+        void _recvSickScan(sick_pls_scan_profile_b0_t& sick_scan_profile, uint64_t& timestamp_usec) noexcept(false);
+
         /** Opens the terminal for serial communication. */
         void _setupConnection() noexcept(false) override;
 
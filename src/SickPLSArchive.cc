@@ -0,0 +1,784 @@
+/*!
+ * \file SickPLSArchive.cc
+ * \brief Implements a columnar archive for long recordings of
+ *        Sick PLS scans.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "SickPLSArchive.hh"
+#include "SickLogger.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Gets the size of a block header (fixed part, statistics and column offsets)
+     */
+    static inline size_t sick_pls_archive_block_header_size(const unsigned int num_beams) {
+        return sizeof(sick_pls_archive_block_header_t) + 2 * num_beams * sizeof(uint16_t) +
+               (num_beams + 1) * sizeof(uint32_t);
+    }
+
+    /**
+     * \brief Appends a LEB128 varint
+     */
+    static inline void sick_pls_archive_put_varint(std::vector<uint8_t>& buffer, uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back((uint8_t) (value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back((uint8_t) value);
+    }
+
+    /**
+     * \brief Appends a run of equal zigzag differences
+     */
+    static inline void sick_pls_archive_put_run(std::vector<uint8_t>& buffer, const uint64_t zigzag,
+                                                const uint64_t run) {
+        const uint64_t extra = run - 1;
+        sick_pls_archive_put_varint(buffer, zigzag << 4 | std::min<uint64_t>(extra, 15));
+        if (extra >= 15) {
+            sick_pls_archive_put_varint(buffer, extra - 15);
+        }
+    }
+
+    /**
+     * \brief Reads a LEB128 varint
+     */
+    static inline uint64_t sick_pls_archive_get_varint(const uint8_t*& data, const uint8_t* const end) noexcept(false) {
+        uint64_t value = 0;
+        for (unsigned int shift = 0; shift < 64; shift += 7) {
+            if (data == end) {
+                throw SickIOException("sick_pls_archive_get_varint: Truncated column!");
+            }
+            const uint8_t byte = *data++;
+            value |= (uint64_t) (byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        throw SickIOException("sick_pls_archive_get_varint: Corrupt column!");
+    }
+
+    /**
+     * \brief Reads a run token
+     * \param &zigzag The run's zigzag difference
+     * \return The run length
+     */
+    static inline uint64_t sick_pls_archive_get_run(const uint8_t*& data, const uint8_t* const end,
+                                                    uint64_t& zigzag) noexcept(false) {
+        const uint64_t token = sick_pls_archive_get_varint(data, end);
+        zigzag = token >> 4;
+        uint64_t run = (token & 0xF) + 1;
+        if ((token & 0xF) == 15) {
+            run += sick_pls_archive_get_varint(data, end);
+        }
+        return run;
+    }
+
+    /**
+     * \brief Constructs a writer (nothing is opened until Create())
+     * \param &path The archive's path
+     * \param num_beams Values per scan
+     * \param scans_per_block Scans per full block
+     */
+    SickPLSArchiveWriter::SickPLSArchiveWriter(const std::string& path, const unsigned int num_beams,
+                                               const unsigned int scans_per_block) :
+            _path(path), _num_beams(num_beams), _scans_per_block(scans_per_block), _fd(-1),
+            _num_rows(0), _num_blocks(0), _num_bytes(0) {}
+
+    /**
+     * \brief Creates (truncates) the archive
+     */
+    void SickPLSArchiveWriter::Create() noexcept(false) {
+
+        /* A sanity check */
+        if (_num_beams == 0 || _num_beams > SickPLS::SICK_MAX_NUM_MEASUREMENTS) {
+            throw SickConfigException("SickPLSArchiveWriter::Create: Invalid number of beams!");
+        }
+
+        if (_scans_per_block == 0 || _scans_per_block > SICK_PLS_ARCHIVE_MAX_SCANS_PER_BLOCK) {
+            throw SickConfigException("SickPLSArchiveWriter::Create: Invalid block size!");
+        }
+
+        if (_fd >= 0) {
+            throw SickConfigException("SickPLSArchiveWriter::Create: Archive is already open!");
+        }
+
+        _fd = open(_path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+        if (_fd < 0) {
+            throw SickIOException("SickPLSArchiveWriter::Create: open() failed!");
+        }
+
+        _rows.resize((size_t) _num_beams * _scans_per_block);
+        _timestamps.resize(_scans_per_block);
+        _num_rows = 0;
+        _num_blocks = 0;
+        _num_bytes = 0;
+
+        sick_pls_archive_header_t header = {};
+        header.magic = SICK_PLS_ARCHIVE_MAGIC;
+        header.version = SICK_PLS_ARCHIVE_VERSION;
+        header.num_beams = (uint16_t) _num_beams;
+        header.scans_per_block = _scans_per_block;
+        _write(&header, sizeof(header));
+
+    }
+
+    /**
+     * \brief Appends a decoded scan
+     * \param *values Measurement words
+     * \param num_values Number of values (must match the archive)
+     * \param timestamp_usec The scan's time stamp (usecs)
+     */
+    void SickPLSArchiveWriter::Append(const uint16_t* const values, const unsigned int num_values,
+                                      const uint64_t timestamp_usec) noexcept(false) {
+
+        /* Ensure the archive is open */
+        if (_fd < 0) {
+            throw SickConfigException("SickPLSArchiveWriter::Append: Archive is not open!");
+        }
+
+        if (num_values != _num_beams) {
+            throw SickConfigException("SickPLSArchiveWriter::Append: Scan size does not match the archive!");
+        }
+
+        memcpy(&_rows[(size_t) _num_rows * _num_beams], values, _num_beams * sizeof(uint16_t));
+        _timestamps[_num_rows++] = timestamp_usec;
+
+        if (_num_rows == _scans_per_block) {
+            Flush();
+        }
+
+    }
+
+    /**
+     * \brief Appends a scan as returned by SickPLS::GetSickScan
+     * \param *values Range values (cm)
+     * \param num_values Number of values (must match the archive)
+     * \param timestamp_usec The scan's time stamp (usecs)
+     */
+    void SickPLSArchiveWriter::Append(const unsigned int* const values, const unsigned int num_values,
+                                      const uint64_t timestamp_usec) noexcept(false) {
+
+        /* Ensure the archive is open */
+        if (_fd < 0) {
+            throw SickConfigException("SickPLSArchiveWriter::Append: Archive is not open!");
+        }
+
+        if (num_values != _num_beams) {
+            throw SickConfigException("SickPLSArchiveWriter::Append: Scan size does not match the archive!");
+        }
+
+        uint16_t* const row = &_rows[(size_t) _num_rows * _num_beams];
+        for (unsigned int i = 0; i < _num_beams; i++) {
+            row[i] = (uint16_t) values[i];
+        }
+        _timestamps[_num_rows++] = timestamp_usec;
+
+        if (_num_rows == _scans_per_block) {
+            Flush();
+        }
+
+    }
+
+    /**
+     * \brief Writes out the buffered scans as a (possibly short) block
+     *
+     * NOTE: The buffered scans are dropped even if the block cannot be
+     *       written, so a failed flush loses them rather than leaving a
+     *       full buffer for the next Append to overrun.
+     */
+    void SickPLSArchiveWriter::Flush() noexcept(false) {
+
+        if (_fd < 0 || _num_rows == 0) {
+            return;
+        }
+
+        try {
+            _writeBlock();
+        }
+        catch (...) {
+            _num_rows = 0;
+            throw;
+        }
+
+        _num_rows = 0;
+
+    }
+
+    /**
+     * \brief Encodes the buffered scans as a block and writes it out
+     */
+    void SickPLSArchiveWriter::_writeBlock() noexcept(false) {
+
+        const size_t header_size = sick_pls_archive_block_header_size(_num_beams);
+        _block.assign(header_size, 0);
+
+        /* Time stamps, as differences from the block's earliest one */
+        const uint64_t t_min = *std::min_element(_timestamps.begin(), _timestamps.begin() + _num_rows);
+        const uint64_t t_max = *std::max_element(_timestamps.begin(), _timestamps.begin() + _num_rows);
+
+        if (t_max - t_min >= (1ULL << 58)) {
+            throw SickConfigException("SickPLSArchiveWriter::Flush: Block spans too much time!");
+        }
+
+        uint64_t previous = t_min;
+        uint64_t run_zigzag = 0;
+        uint64_t run = 0;
+        for (unsigned int row = 0; row < _num_rows; row++) {
+            const auto difference = (int64_t) (_timestamps[row] - previous);
+            const uint64_t zigzag = (uint64_t) (difference << 1) ^ (uint64_t) (difference >> 63);
+            previous = _timestamps[row];
+            if (run > 0 && zigzag == run_zigzag) {
+                run++;
+                continue;
+            }
+            if (run > 0) {
+                sick_pls_archive_put_run(_block, run_zigzag, run);
+            }
+            run_zigzag = zigzag;
+            run = 1;
+        }
+        sick_pls_archive_put_run(_block, run_zigzag, run);
+
+        const size_t timestamps_length = _block.size() - header_size;
+
+        /* Beam columns */
+        std::vector<uint32_t> offsets(_num_beams + 1);
+        for (unsigned int beam = 0; beam < _num_beams; beam++) {
+            offsets[beam] = (uint32_t) (_block.size() - header_size);
+            _encodeColumn(beam);
+        }
+        offsets[_num_beams] = (uint32_t) (_block.size() - header_size);
+
+        /* Keep the next block header aligned */
+        _block.resize((_block.size() + 7) & ~(size_t) 7, 0);
+
+        /* Fill in the header */
+        sick_pls_archive_block_header_t header = {};
+        header.magic = SICK_PLS_ARCHIVE_BLOCK_MAGIC;
+        header.num_scans = _num_rows;
+        header.block_size = _block.size();
+        header.t_min = t_min;
+        header.t_max = t_max;
+        header.timestamps_length = (uint32_t) timestamps_length;
+        memcpy(_block.data(), &header, sizeof(header));
+
+        auto* const minimums = (uint16_t*) (_block.data() + sizeof(header));
+        auto* const maximums = minimums + _num_beams;
+        std::fill(minimums, minimums + _num_beams, UINT16_MAX);
+        std::fill(maximums, maximums + _num_beams, 0);
+        for (unsigned int row = 0; row < _num_rows; row++) {
+            const uint16_t* const values = &_rows[(size_t) row * _num_beams];
+            for (unsigned int beam = 0; beam < _num_beams; beam++) {
+                minimums[beam] = std::min(minimums[beam], values[beam]);
+                maximums[beam] = std::max(maximums[beam], values[beam]);
+            }
+        }
+        memcpy(maximums + _num_beams, offsets.data(), offsets.size() * sizeof(uint32_t));
+
+        /* One write per block, so a crash leaves at most a truncated tail */
+        _write(_block.data(), _block.size());
+        _num_blocks++;
+
+    }
+
+    /**
+     * \brief Flushes and closes the archive
+     */
+    void SickPLSArchiveWriter::Close() noexcept(false) {
+
+        if (_fd < 0) {
+            return;
+        }
+
+        Flush();
+
+        const int fd = _fd;
+        _fd = -1;
+        if (close(fd) < 0) {
+            throw SickIOException("SickPLSArchiveWriter::Close: close() failed!");
+        }
+
+    }
+
+    /**
+     * \brief A standard destructor
+     */
+    SickPLSArchiveWriter::~SickPLSArchiveWriter() {
+
+        try {
+            Close();
+        }
+
+            /* Catch anything else */
+        catch (...) {
+            SICK_LOG_ERROR("SickPLSArchiveWriter::~SickPLSArchiveWriter: Unknown exception!");
+        }
+
+    }
+
+    /**
+     * \brief Encodes one beam's column into the current block
+     * \param beam The beam index
+     *
+     * The first scan is differenced against zero.
+     */
+    void SickPLSArchiveWriter::_encodeColumn(const unsigned int beam) {
+
+        uint16_t previous = 0;
+        uint64_t run_zigzag = 0;
+        uint64_t run = 0;
+        for (unsigned int row = 0; row < _num_rows; row++) {
+            const uint16_t value = _rows[(size_t) row * _num_beams + beam];
+            const int difference = (int) value - (int) previous;
+            const uint64_t zigzag = (uint32_t) ((difference << 1) ^ (difference >> 31));
+            previous = value;
+            if (run > 0 && zigzag == run_zigzag) {
+                run++;
+                continue;
+            }
+            if (run > 0) {
+                sick_pls_archive_put_run(_block, run_zigzag, run);
+            }
+            run_zigzag = zigzag;
+            run = 1;
+        }
+        sick_pls_archive_put_run(_block, run_zigzag, run);
+
+    }
+
+    /**
+     * \brief Writes a buffer out
+     * \param *buffer The bytes
+     * \param length Their number
+     */
+    void SickPLSArchiveWriter::_write(const void* const buffer, const size_t length) noexcept(false) {
+
+        const auto* bytes = (const uint8_t*) buffer;
+        size_t remaining = length;
+        while (remaining > 0) {
+            const ssize_t written = write(_fd, bytes, remaining);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw SickIOException("SickPLSArchiveWriter::_write: write() failed!");
+            }
+            bytes += written;
+            remaining -= (size_t) written;
+        }
+
+        _num_bytes += length;
+
+    }
+
+    /**
+     * \brief Constructs a reader (nothing is mapped until Open())
+     * \param &path The archive's path
+     */
+    SickPLSArchiveReader::SickPLSArchiveReader(const std::string& path) :
+            _path(path), _mapping(nullptr), _mapping_size(0), _num_beams(0), _num_scans(0),
+            _cached_block(-1), _num_columns_decoded(0) {}
+
+    /**
+     * \brief Maps the archive and indexes its blocks
+     */
+    void SickPLSArchiveReader::Open() noexcept(false) {
+
+        if (_mapping) {
+            throw SickConfigException("SickPLSArchiveReader::Open: Archive is already open!");
+        }
+
+        const int fd = open(_path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw SickIOException("SickPLSArchiveReader::Open: open() failed!");
+        }
+
+        struct stat file_stat = {};
+        if (fstat(fd, &file_stat) < 0) {
+            close(fd);
+            throw SickIOException("SickPLSArchiveReader::Open: fstat() failed!");
+        }
+
+        const auto size = (size_t) file_stat.st_size;
+        if (size < sizeof(sick_pls_archive_header_t)) {
+            close(fd);
+            throw SickIOException("SickPLSArchiveReader::Open: Not an archive!");
+        }
+
+        void* const mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            throw SickIOException("SickPLSArchiveReader::Open: mmap() failed!");
+        }
+
+        _mapping = (const uint8_t*) mapping;
+        _mapping_size = size;
+
+        /* Validate the header */
+        const auto* const header = (const sick_pls_archive_header_t*) _mapping;
+        if (header->magic != SICK_PLS_ARCHIVE_MAGIC || header->version != SICK_PLS_ARCHIVE_VERSION ||
+            header->num_beams == 0 || header->num_beams > SickPLS::SICK_MAX_NUM_MEASUREMENTS) {
+            Close();
+            throw SickIOException("SickPLSArchiveReader::Open: Not a compatible archive!");
+        }
+
+        _num_beams = header->num_beams;
+        _num_scans = 0;
+        _blocks.clear();
+        _cached_block = -1;
+
+        /* Index the blocks */
+        const size_t header_size = sick_pls_archive_block_header_size(_num_beams);
+        size_t offset = sizeof(sick_pls_archive_header_t);
+        while (_mapping_size - offset >= header_size) {
+
+            const auto* const block = (const sick_pls_archive_block_header_t*) (_mapping + offset);
+            if (block->magic != SICK_PLS_ARCHIVE_BLOCK_MAGIC ||
+                block->num_scans == 0 || block->num_scans > SICK_PLS_ARCHIVE_MAX_SCANS_PER_BLOCK ||
+                block->block_size < header_size || block->block_size > _mapping_size - offset ||
+                block->timestamps_length > block->block_size - header_size) {
+                break;
+            }
+
+            _blocks.push_back(block);
+            _num_scans += block->num_scans;
+            offset += block->block_size;
+
+        }
+
+    }
+
+    /**
+     * \brief Unmaps the archive
+     */
+    void SickPLSArchiveReader::Close() noexcept(false) {
+
+        if (_mapping) {
+            const auto* const mapping = _mapping;
+            _mapping = nullptr;
+            _blocks.clear();
+            _cached_block = -1;
+            if (munmap((void*) mapping, _mapping_size) < 0) {
+                throw SickIOException("SickPLSArchiveReader::Close: munmap() failed!");
+            }
+        }
+
+    }
+
+    /**
+     * \brief Gets the time span of the archive
+     * \param &t_min Earliest time stamp (usecs)
+     * \param &t_max Latest time stamp (usecs)
+     */
+    void SickPLSArchiveReader::GetTimeSpan(uint64_t& t_min, uint64_t& t_max) const noexcept(false) {
+
+        if (_blocks.empty()) {
+            throw SickConfigException("SickPLSArchiveReader::GetTimeSpan: Archive is empty!");
+        }
+
+        t_min = UINT64_MAX;
+        t_max = 0;
+        for (const auto* const block: _blocks) {
+            t_min = std::min(t_min, block->t_min);
+            t_max = std::max(t_max, block->t_max);
+        }
+
+    }
+
+    /**
+     * \brief Gets the number of scans in a block
+     * \param block The block index
+     * \return The block's scan count
+     */
+    unsigned int SickPLSArchiveReader::GetBlockNumScans(const unsigned int block) const noexcept(false) {
+
+        if (block >= _blocks.size()) {
+            throw SickConfigException("SickPLSArchiveReader::GetBlockNumScans: Invalid block!");
+        }
+
+        return _blocks[block]->num_scans;
+    }
+
+    /**
+     * \brief Gets the time span of a block
+     * \param block The block index
+     * \param &t_min Earliest time stamp (usecs)
+     * \param &t_max Latest time stamp (usecs)
+     */
+    void SickPLSArchiveReader::GetBlockTimeSpan(const unsigned int block, uint64_t& t_min,
+                                                uint64_t& t_max) const noexcept(false) {
+
+        if (block >= _blocks.size()) {
+            throw SickConfigException("SickPLSArchiveReader::GetBlockTimeSpan: Invalid block!");
+        }
+
+        t_min = _blocks[block]->t_min;
+        t_max = _blocks[block]->t_max;
+
+    }
+
+    /**
+     * \brief Decodes a block's time stamps
+     * \param block The block index
+     * \param &timestamps Receives one time stamp per scan (usecs)
+     */
+    void SickPLSArchiveReader::ReadTimestamps(const unsigned int block,
+                                              std::vector<uint64_t>& timestamps) noexcept(false) {
+
+        if (block >= _blocks.size()) {
+            throw SickConfigException("SickPLSArchiveReader::ReadTimestamps: Invalid block!");
+        }
+
+        _decodeTimestamps(block, timestamps);
+
+    }
+
+    /**
+     * \brief Selects the scans in [t_start,t_end] whose beam value lies in [min_value,max_value]
+     * \param beam The beam index
+     * \param min_value Smallest value accepted
+     * \param max_value Largest value accepted
+     * \param t_start Start of the time window (usecs)
+     * \param t_end End of the time window (usecs)
+     * \param &matches Matching scans are appended here, in file order
+     * \return The number of matches appended
+     *
+     * Blocks whose time span or beam statistics rule out a match are skipped
+     * without decoding; otherwise only the beam's column and, if it has any
+     * candidates, the time stamps are decoded.
+     */
+    unsigned int SickPLSArchiveReader::Select(const unsigned int beam, const uint16_t min_value,
+                                              const uint16_t max_value, const uint64_t t_start,
+                                              const uint64_t t_end,
+                                              std::vector<sick_pls_archive_match_t>& matches) noexcept(false) {
+
+        /* A sanity check */
+        if (!_mapping) {
+            throw SickConfigException("SickPLSArchiveReader::Select: Archive is not open!");
+        }
+
+        if (beam >= _num_beams) {
+            throw SickConfigException("SickPLSArchiveReader::Select: Invalid beam!");
+        }
+
+        unsigned int num_matches = 0;
+        for (unsigned int i = 0; i < _blocks.size(); i++) {
+
+            const sick_pls_archive_block_header_t* const block = _blocks[i];
+
+            /* Prune by time */
+            if (block->t_max < t_start || block->t_min > t_end) {
+                continue;
+            }
+
+            /* Prune by the beam's statistics */
+            const auto* const minimums = (const uint16_t*) (block + 1);
+            const uint16_t* const maximums = minimums + _num_beams;
+            if (maximums[beam] < min_value || minimums[beam] > max_value) {
+                continue;
+            }
+
+            _column.resize(block->num_scans);
+            _decodeColumn(i, beam, _column.data(), 1);
+
+            bool have_timestamps = false;
+            for (unsigned int row = 0; row < block->num_scans; row++) {
+
+                if (_column[row] < min_value || _column[row] > max_value) {
+                    continue;
+                }
+
+                if (!have_timestamps) {
+                    _decodeTimestamps(i, _timestamps);
+                    have_timestamps = true;
+                }
+
+                if (_timestamps[row] < t_start || _timestamps[row] > t_end) {
+                    continue;
+                }
+
+                matches.push_back({_timestamps[row], i, row, _column[row]});
+                num_matches++;
+
+            }
+
+        }
+
+        return num_matches;
+    }
+
+    /**
+     * \brief Decodes a whole scan
+     * \param block The block index
+     * \param row The scan's position in the block
+     * \param *values Destination (GetNumBeams() words)
+     * \param &num_values The number of values decoded
+     * \param *timestamp_usec If not null, receives the scan's time stamp (usecs)
+     */
+    void SickPLSArchiveReader::ReadScan(const unsigned int block, const unsigned int row, uint16_t* const values,
+                                        unsigned int& num_values, uint64_t* const timestamp_usec) noexcept(false) {
+
+        /* A sanity check */
+        if (!_mapping) {
+            throw SickConfigException("SickPLSArchiveReader::ReadScan: Archive is not open!");
+        }
+
+        if (block >= _blocks.size() || row >= _blocks[block]->num_scans) {
+            throw SickConfigException("SickPLSArchiveReader::ReadScan: Invalid scan!");
+        }
+
+        /* Decode the whole block once for sequential reads */
+        if (_cached_block != (int64_t) block) {
+
+            _cached_block = -1;
+            _cached_rows.resize((size_t) _blocks[block]->num_scans * _num_beams);
+            for (unsigned int beam = 0; beam < _num_beams; beam++) {
+                _decodeColumn(block, beam, &_cached_rows[beam], _num_beams);
+            }
+            _decodeTimestamps(block, _cached_timestamps);
+            _cached_block = block;
+
+        }
+
+        memcpy(values, &_cached_rows[(size_t) row * _num_beams], _num_beams * sizeof(uint16_t));
+        num_values = _num_beams;
+
+        if (timestamp_usec) {
+            *timestamp_usec = _cached_timestamps[row];
+        }
+
+    }
+
+    /**
+     * \brief A standard destructor
+     */
+    SickPLSArchiveReader::~SickPLSArchiveReader() {
+
+        try {
+            Close();
+        }
+
+            /* Catch anything else */
+        catch (...) {
+            SICK_LOG_ERROR("SickPLSArchiveReader::~SickPLSArchiveReader: Unknown exception!");
+        }
+
+    }
+
+    /**
+     * \brief Decodes a block's time stamps
+     * \param block The block index
+     * \param &timestamps Receives one time stamp per scan (usecs)
+     */
+    void SickPLSArchiveReader::_decodeTimestamps(const unsigned int block,
+                                                 std::vector<uint64_t>& timestamps) noexcept(false) {
+
+        const sick_pls_archive_block_header_t* const header = _blocks[block];
+        const uint8_t* data = (const uint8_t*) header + sick_pls_archive_block_header_size(_num_beams);
+        const uint8_t* const end = data + header->timestamps_length;
+
+        timestamps.resize(header->num_scans);
+
+        uint64_t previous = header->t_min;
+        unsigned int row = 0;
+        while (row < header->num_scans) {
+
+            uint64_t zigzag;
+            const uint64_t run = sick_pls_archive_get_run(data, end, zigzag);
+            if (run > header->num_scans - row) {
+                throw SickIOException("SickPLSArchiveReader::_decodeTimestamps: Corrupt column!");
+            }
+
+            const uint64_t difference = (zigzag >> 1) ^ (0 - (zigzag & 1));
+            for (uint64_t j = 0; j < run; j++) {
+                previous += difference;
+                timestamps[row++] = previous;
+            }
+
+        }
+
+        if (data != end) {
+            throw SickIOException("SickPLSArchiveReader::_decodeTimestamps: Trailing bytes!");
+        }
+
+        _num_columns_decoded++;
+
+    }
+
+    /**
+     * \brief Decodes one beam's column of a block
+     * \param block The block index
+     * \param beam The beam index
+     * \param *values Destination for the first scan's value
+     * \param stride Distance between consecutive scans' values (words)
+     */
+    void SickPLSArchiveReader::_decodeColumn(const unsigned int block, const unsigned int beam,
+                                             uint16_t* const values, const size_t stride) noexcept(false) {
+
+        const sick_pls_archive_block_header_t* const header = _blocks[block];
+        const size_t header_size = sick_pls_archive_block_header_size(_num_beams);
+        const size_t data_length = header->block_size - header_size;
+        const auto* const offsets = (const uint32_t*) ((const uint8_t*) (header + 1) +
+                                                       2 * _num_beams * sizeof(uint16_t));
+
+        if (offsets[beam] > offsets[beam + 1] || offsets[beam + 1] > data_length ||
+            offsets[beam] < header->timestamps_length) {
+            throw SickIOException("SickPLSArchiveReader::_decodeColumn: Corrupt column offsets!");
+        }
+
+        const uint8_t* const base = (const uint8_t*) header + header_size;
+        const uint8_t* data = base + offsets[beam];
+        const uint8_t* const end = base + offsets[beam + 1];
+
+        uint16_t previous = 0;
+        unsigned int row = 0;
+        while (row < header->num_scans) {
+
+            uint64_t zigzag;
+            const uint64_t run = sick_pls_archive_get_run(data, end, zigzag);
+            if (run > header->num_scans - row) {
+                throw SickIOException("SickPLSArchiveReader::_decodeColumn: Corrupt column!");
+            }
+
+            const auto difference = (uint16_t) ((zigzag >> 1) ^ (0 - (zigzag & 1)));
+            for (uint64_t j = 0; j < run; j++) {
+                previous = (uint16_t) (previous + difference);
+                values[row++ * stride] = previous;
+            }
+
+        }
+
+        if (data != end) {
+            throw SickIOException("SickPLSArchiveReader::_decodeColumn: Trailing bytes!");
+        }
+
+        _num_columns_decoded++;
+
+    }
+
+} /* namespace sickpls */
@@ -0,0 +1,271 @@
+/*!
+ * \file SickPLSArchive.hh
+ * \brief Defines a columnar archive for long recordings of
+ *        Sick PLS scans.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_ARCHIVE_HH
+#define SICK_PLS_ARCHIVE_HH
+
+/* Definition dependencies */
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SickPLS.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define SICK_PLS_ARCHIVE_MAGIC                                      (0x41504B53U)  ///< "SKPA"
+#define SICK_PLS_ARCHIVE_BLOCK_MAGIC                                (0x4B4C4253U)  ///< "SBLK"
+#define SICK_PLS_ARCHIVE_VERSION                                             (1)  ///< Bumped whenever the layout changes
+#define DEFAULT_SICK_PLS_ARCHIVE_SCANS_PER_BLOCK                           (256)  ///< Scans per block
+#define SICK_PLS_ARCHIVE_MAX_SCANS_PER_BLOCK                             (65536)  ///< Largest block allowed
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \struct sick_pls_archive_header_tag
+     * \brief The header at the start of an archive file.
+     */
+    /*!
+     * \typedef sick_pls_archive_header_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_archive_header_tag {
+        uint32_t magic;                                                            ///< SICK_PLS_ARCHIVE_MAGIC
+        uint16_t version;                                                          ///< SICK_PLS_ARCHIVE_VERSION
+        uint16_t num_beams;                                                        ///< Values per scan (fixed per archive)
+        uint32_t scans_per_block;                                                  ///< Scans per full block
+        uint32_t reserved;                                                         ///< Zero
+    } sick_pls_archive_header_t;
+
+    /*!
+     * \struct sick_pls_archive_block_header_tag
+     * \brief The fixed part of a block header. It is followed by the per-beam
+     *        minimum and maximum (uint16_t[num_beams] each), the column
+     *        offsets (uint32_t[num_beams + 1], relative to the end of the
+     *        header), the time stamp column and the beam columns.
+     */
+    /*!
+     * \typedef sick_pls_archive_block_header_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_archive_block_header_tag {
+        uint32_t magic;                                                            ///< SICK_PLS_ARCHIVE_BLOCK_MAGIC
+        uint32_t num_scans;                                                        ///< Scans in the block
+        uint64_t block_size;                                                       ///< Size of the whole block (bytes)
+        uint64_t t_min;                                                            ///< Earliest time stamp (usecs)
+        uint64_t t_max;                                                            ///< Latest time stamp (usecs)
+        uint32_t timestamps_length;                                                ///< Size of the time stamp column (bytes)
+        uint32_t reserved;                                                         ///< Zero
+    } sick_pls_archive_block_header_t;
+
+    /*!
+     * \struct sick_pls_archive_match_tag
+     * \brief A scan selected by a query.
+     */
+    /*!
+     * \typedef sick_pls_archive_match_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_archive_match_tag {
+        uint64_t timestamp_usec;                                                   ///< The scan's time stamp
+        uint32_t block;                                                            ///< Block holding the scan
+        uint32_t row;                                                              ///< The scan's position in the block
+        uint16_t value;                                                            ///< The queried beam's value
+    } sick_pls_archive_match_t;
+
+    /*!
+     * \brief Records scans into a columnar archive
+     *
+     * Scans are buffered into blocks. A full block is written column-wise:
+     * for each beam, the scans' values are replaced by their difference to
+     * the previous scan, and runs of equal differences are collapsed. A
+     * fixed-mount unit sees the same scene scan after scan, so most columns
+     * shrink to a handful of runs. Each block header carries the block's time
+     * span and every beam's minimum and maximum so readers can skip blocks
+     * without decoding them.
+     *
+     * Each column is a sequence of LEB128 varints. A token holds the zigzag
+     * difference shifted left by 4, with the run length minus one (capped
+     * at 15) in the low bits. A capped run is followed by a varint holding
+     * the remainder of the run.
+     */
+    class SickPLSArchiveWriter {
+
+    public:
+
+        /** Constructs a writer for the given file */
+        SickPLSArchiveWriter(const std::string& path, unsigned int num_beams,
+                             unsigned int scans_per_block = DEFAULT_SICK_PLS_ARCHIVE_SCANS_PER_BLOCK);
+
+        /** Creates (truncates) the archive */
+        void Create() noexcept(false);
+
+        /** Appends a decoded scan */
+        void Append(const uint16_t* values, unsigned int num_values, uint64_t timestamp_usec) noexcept(false);
+
+        /** Appends a scan as returned by SickPLS::GetSickScan */
+        void Append(const unsigned int* values, unsigned int num_values, uint64_t timestamp_usec) noexcept(false);
+
+        /** Writes out the buffered scans as a (possibly short) block (dropping them if that fails) */
+        void Flush() noexcept(false);
+
+        /** Flushes and closes the archive */
+        void Close() noexcept(false);
+
+        /** Gets the number of blocks written */
+        [[nodiscard]] uint64_t GetNumBlocks() const { return _num_blocks; }
+
+        /** Gets the number of bytes written */
+        [[nodiscard]] uint64_t GetNumBytes() const { return _num_bytes; }
+
+        /** A standard destructor */
+        ~SickPLSArchiveWriter();
+
+    private:
+
+        /** The archive's path */
+        std::string _path;
+
+        /** Values per scan */
+        unsigned int _num_beams;
+
+        /** Scans per full block */
+        unsigned int _scans_per_block;
+
+        /** The open file (-1 => closed) */
+        int _fd;
+
+        /** Buffered scans (row-major) and their time stamps */
+        std::vector<uint16_t> _rows;
+        std::vector<uint64_t> _timestamps;
+        unsigned int _num_rows;
+
+        /** The block being encoded */
+        std::vector<uint8_t> _block;
+
+        /** Totals */
+        uint64_t _num_blocks;
+        uint64_t _num_bytes;
+
+        /** Encodes the buffered scans as a block and writes it out */
+        void _writeBlock() noexcept(false);
+
+        /** Encodes one beam's column */
+        void _encodeColumn(unsigned int beam);
+
+        /** Writes a buffer out */
+        void _write(const void* buffer, size_t length) noexcept(false);
+
+    };
+
+    /*!
+     * \brief Reads and queries a columnar archive
+     *
+     * The file is mapped read-only. Open() only walks the fixed block headers;
+     * statistics and columns are touched when a query reaches them, so a
+     * query over a narrow time window of a week-long archive reads only the
+     * blocks it needs. A block truncated by a crash ends the archive.
+     */
+    class SickPLSArchiveReader {
+
+    public:
+
+        /** Constructs a reader for the given file */
+        explicit SickPLSArchiveReader(const std::string& path);
+
+        /** Maps the archive and indexes its blocks */
+        void Open() noexcept(false);
+
+        /** Unmaps the archive */
+        void Close() noexcept(false);
+
+        /** Gets the number of values per scan */
+        [[nodiscard]] unsigned int GetNumBeams() const { return _num_beams; }
+
+        /** Gets the number of blocks */
+        [[nodiscard]] unsigned int GetNumBlocks() const { return (unsigned int) _blocks.size(); }
+
+        /** Gets the number of scans */
+        [[nodiscard]] uint64_t GetNumScans() const { return _num_scans; }
+
+        /** Gets the time span of the archive */
+        void GetTimeSpan(uint64_t& t_min, uint64_t& t_max) const noexcept(false);
+
+        /** Gets the number of scans in a block */
+        [[nodiscard]] unsigned int GetBlockNumScans(unsigned int block) const noexcept(false);
+
+        /** Gets the time span of a block */
+        void GetBlockTimeSpan(unsigned int block, uint64_t& t_min, uint64_t& t_max) const noexcept(false);
+
+        /** Decodes a block's time stamps */
+        void ReadTimestamps(unsigned int block, std::vector<uint64_t>& timestamps) noexcept(false);
+
+        /** Selects the scans in [t_start,t_end] whose beam value lies in [min_value,max_value] */
+        unsigned int Select(unsigned int beam, uint16_t min_value, uint16_t max_value, uint64_t t_start,
+                            uint64_t t_end, std::vector<sick_pls_archive_match_t>& matches) noexcept(false);
+
+        /** Decodes a whole scan */
+        void ReadScan(unsigned int block, unsigned int row, uint16_t* values, unsigned int& num_values,
+                      uint64_t* timestamp_usec = nullptr) noexcept(false);
+
+        /** Gets the number of columns decoded so far */
+        [[nodiscard]] uint64_t GetNumColumnsDecoded() const { return _num_columns_decoded; }
+
+        /** A standard destructor */
+        ~SickPLSArchiveReader();
+
+    private:
+
+        /** The archive's path */
+        std::string _path;
+
+        /** The mapping */
+        const uint8_t* _mapping;
+        size_t _mapping_size;
+
+        /** Values per scan */
+        unsigned int _num_beams;
+
+        /** Block headers in file order */
+        std::vector<const sick_pls_archive_block_header_t*> _blocks;
+
+        /** Total scans */
+        uint64_t _num_scans;
+
+        /** The most recently decoded block (row-major), for ReadScan */
+        int64_t _cached_block;
+        std::vector<uint16_t> _cached_rows;
+        std::vector<uint64_t> _cached_timestamps;
+
+        /** Decoding work done */
+        uint64_t _num_columns_decoded;
+
+        /** Scratch column and time stamps */
+        std::vector<uint16_t> _column;
+        std::vector<uint64_t> _timestamps;
+
+        /** Decodes a block's time stamps */
+        void _decodeTimestamps(unsigned int block, std::vector<uint64_t>& timestamps) noexcept(false);
+
+        /** Decodes one beam's column of a block */
+        void _decodeColumn(unsigned int block, unsigned int beam, uint16_t* values, size_t stride) noexcept(false);
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_ARCHIVE_HH */
@@ -0,0 +1,302 @@
+/*!
+ * \file SickPLSBackgroundModel.cc
+ * \brief Implements a per-beam background model and change detector
+ *        for fixed-mount Sick PLS monitoring.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <cmath>
+#include <cstring>
+
+#include "SickPLSBackgroundModel.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Constructs an (empty) background model
+     * \param num_beams The number of beams per scan
+     */
+    SickPLSBackgroundModel::SickPLSBackgroundModel(const unsigned int num_beams) noexcept(false) :
+            _num_beams(num_beams),
+            _learning_scans(DEFAULT_SICK_PLS_BACKGROUND_LEARNING_SCANS),
+            _adaptation_rate(DEFAULT_SICK_PLS_BACKGROUND_ADAPTATION_RATE),
+            _num_sigmas(DEFAULT_SICK_PLS_BACKGROUND_NUM_SIGMAS),
+            _min_deviation(DEFAULT_SICK_PLS_BACKGROUND_MIN_DEVIATION),
+            _min_cluster_beams(DEFAULT_SICK_PLS_BACKGROUND_MIN_CLUSTER_BEAMS),
+            _max_cluster_gap(DEFAULT_SICK_PLS_BACKGROUND_MAX_CLUSTER_GAP),
+            _num_learned(0), _mean(), _variance(), _count(), _deviating() {
+
+        /* A sanity check */
+        if (num_beams == 0 || num_beams > SickPLS::SICK_MAX_NUM_MEASUREMENTS) {
+            throw SickConfigException("SickPLSBackgroundModel::SickPLSBackgroundModel: Invalid number of beams!");
+        }
+
+    }
+
+    /**
+     * \brief Sets the learning parameters
+     * \param learning_scans Number of scans averaged before detection starts
+     * \param adaptation_rate Blend factor applied to matching beams afterwards (0 => frozen)
+     *
+     * NOTE: Changing the learning period restarts learning.
+     */
+    void SickPLSBackgroundModel::SetLearningParameters(const unsigned int learning_scans,
+                                                       const double adaptation_rate) noexcept(false) {
+
+        /* A sanity check */
+        if (learning_scans == 0 || adaptation_rate < 0 || adaptation_rate >= 1) {
+            throw SickConfigException("SickPLSBackgroundModel::SetLearningParameters: Invalid parameters!");
+        }
+
+        if (learning_scans != _learning_scans) {
+            _learning_scans = learning_scans;
+            Reset();
+        }
+        _adaptation_rate = adaptation_rate;
+
+    }
+
+    /**
+     * \brief Sets the deviation thresholds
+     * \param num_sigmas A beam deviates if it is this many standard deviations from its mean...
+     * \param min_deviation ...and at least this far from it (cm)
+     */
+    void SickPLSBackgroundModel::SetDetectionParameters(const double num_sigmas,
+                                                        const unsigned int min_deviation) noexcept(false) {
+
+        /* A sanity check */
+        if (num_sigmas <= 0) {
+            throw SickConfigException("SickPLSBackgroundModel::SetDetectionParameters: Invalid parameters!");
+        }
+
+        _num_sigmas = num_sigmas;
+        _min_deviation = min_deviation;
+
+    }
+
+    /**
+     * \brief Sets how deviating beams are grouped into events
+     * \param min_cluster_beams Clusters with fewer deviating beams are dropped
+     * \param max_cluster_gap Max run of matching beams bridged inside a cluster
+     */
+    void SickPLSBackgroundModel::SetClusterParameters(const unsigned int min_cluster_beams,
+                                                      const unsigned int max_cluster_gap) {
+        _min_cluster_beams = min_cluster_beams;
+        _max_cluster_gap = max_cluster_gap;
+    }
+
+    /**
+     * \brief Feeds a scan to the model
+     * \param *ranges The range values (cm, 0 => no measurement)
+     * \param num_ranges The number of range values
+     * \param *events Destination array of change events (ordered by beam)
+     * \param max_events Capacity of the destination array
+     * \return The number of events written (always 0 while learning)
+     */
+    unsigned int SickPLSBackgroundModel::Update(const uint16_t* const ranges, const unsigned int num_ranges,
+                                                sick_pls_change_event_t* const events,
+                                                const unsigned int max_events) noexcept(false) {
+
+        /* Ensure the scan matches the model */
+        if (num_ranges != _num_beams) {
+            throw SickConfigException("SickPLSBackgroundModel::Update: Scan size does not match the model!");
+        }
+
+        if (!IsLearned()) {
+            _learn(ranges, num_ranges);
+            _num_learned++;
+            memset(_deviating, 0, num_ranges);
+            return 0;
+        }
+
+        _detect(ranges, num_ranges);
+
+        return _cluster(ranges, num_ranges, events, max_events);
+    }
+
+    /**
+     * \brief Forgets the background and starts learning again
+     */
+    void SickPLSBackgroundModel::Reset() {
+
+        _num_learned = 0;
+        memset(_mean, 0, sizeof(_mean));
+        memset(_variance, 0, sizeof(_variance));
+        memset(_count, 0, sizeof(_count));
+        memset(_deviating, 0, sizeof(_deviating));
+
+    }
+
+    /**
+     * \brief Gets the background range of a beam
+     * \param beam The beam index
+     * \return The mean range (cm, 0 if the beam never returned)
+     */
+    double SickPLSBackgroundModel::GetMean(const unsigned int beam) const noexcept(false) {
+
+        /* A sanity check */
+        if (beam >= _num_beams) {
+            throw SickConfigException("SickPLSBackgroundModel::GetMean: Invalid beam!");
+        }
+
+        return _mean[beam];
+    }
+
+    /**
+     * \brief Gets the standard deviation of a beam
+     * \param beam The beam index
+     * \return The standard deviation (cm)
+     */
+    double SickPLSBackgroundModel::GetStdDev(const unsigned int beam) const noexcept(false) {
+
+        /* A sanity check */
+        if (beam >= _num_beams) {
+            throw SickConfigException("SickPLSBackgroundModel::GetStdDev: Invalid beam!");
+        }
+
+        return sqrt(_variance[beam]);
+    }
+
+    /**
+     * \brief Folds a scan into the per-beam statistics (Welford's algorithm)
+     */
+    void SickPLSBackgroundModel::_learn(const uint16_t* const ranges, const unsigned int num_ranges) {
+
+        for (unsigned int i = 0; i < num_ranges; i++) {
+
+            if (ranges[i] == 0) {
+                continue;
+            }
+
+            /* _variance holds the running M2 until learning completes */
+            const double delta = ranges[i] - _mean[i];
+            _count[i]++;
+            _mean[i] += (float) (delta / _count[i]);
+            _variance[i] += (float) (delta * (ranges[i] - _mean[i]));
+
+        }
+
+        /* Turn M2 into the (population) variance */
+        if (_num_learned + 1 == _learning_scans) {
+            for (unsigned int i = 0; i < num_ranges; i++) {
+                if (_count[i] > 0) {
+                    _variance[i] /= (float) _count[i];
+                }
+            }
+        }
+
+    }
+
+    /**
+     * \brief Flags the beams deviating from the background and adapts the others
+     */
+    void SickPLSBackgroundModel::_detect(const uint16_t* const ranges, const unsigned int num_ranges) {
+
+        const auto alpha = (float) _adaptation_rate;
+        const auto num_sigmas_sq = (float) (_num_sigmas * _num_sigmas);
+        const auto min_deviation_sq = (float) _min_deviation * (float) _min_deviation;
+
+        for (unsigned int i = 0; i < num_ranges; i++) {
+
+            /* No measurement, no evidence either way */
+            if (ranges[i] == 0) {
+                _deviating[i] = 0;
+                continue;
+            }
+
+            /* A return where the empty scene had none is always a change */
+            if (_count[i] == 0) {
+                _deviating[i] = 1;
+                continue;
+            }
+
+            const float delta = (float) ranges[i] - _mean[i];
+            const float delta_sq = delta * delta;
+            const bool deviating = delta_sq > num_sigmas_sq * _variance[i] && delta_sq > min_deviation_sq;
+            _deviating[i] = deviating;
+
+            /* Let the background drift (exponential forgetting) */
+            if (!deviating) {
+                _mean[i] += alpha * delta;
+                _variance[i] = (1.0f - alpha) * (_variance[i] + alpha * delta_sq);
+            }
+
+        }
+
+    }
+
+    /**
+     * \brief Groups the flagged beams into events
+     */
+    unsigned int SickPLSBackgroundModel::_cluster(const uint16_t* const ranges, const unsigned int num_ranges,
+                                                  sick_pls_change_event_t* const events,
+                                                  const unsigned int max_events) const {
+
+        unsigned int num_events = 0;
+
+        bool open = false;
+        unsigned int last_index = 0;
+        sick_pls_change_event_t curr = {};
+
+        for (unsigned int i = 0; i <= num_ranges; i++) {
+
+            /* The sentinel i == num_ranges closes the last cluster */
+            const bool last = (i == num_ranges);
+            if (!last && !_deviating[i]) {
+                continue;
+            }
+
+            /* Close off the open cluster if the gap is too wide */
+            if (open && (last || i - last_index > _max_cluster_gap + 1)) {
+                if (curr.num_beams >= _min_cluster_beams && num_events < max_events) {
+                    curr.end_index = (uint16_t) last_index;
+                    events[num_events++] = curr;
+                }
+                open = false;
+            }
+
+            if (last) {
+                break;
+            }
+
+            /* Start a new cluster */
+            if (!open) {
+                open = true;
+                curr.start_index = (uint16_t) i;
+                curr.num_beams = 0;
+                curr.min_range = 0xFFFF;
+                curr.max_deviation = 0;
+            }
+
+            /* Beams that never returned during learning are treated as lying at the max encodable range */
+            const float deviation = (float) ranges[i] - ((_count[i] > 0) ? _mean[i] : 8191.0f);
+            if (fabsf(deviation) > fabsf(curr.max_deviation)) {
+                curr.max_deviation = deviation;
+            }
+            if (ranges[i] < curr.min_range) {
+                curr.min_range = ranges[i];
+            }
+            curr.num_beams++;
+            last_index = i;
+
+        }
+
+        return num_events;
+    }
+
+} /* namespace sickpls */
@@ -0,0 +1,141 @@
+/*!
+ * \file SickPLSBackgroundModel.hh
+ * \brief Defines a per-beam background model and change detector
+ *        for fixed-mount Sick PLS monitoring.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_BACKGROUND_MODEL_HH
+#define SICK_PLS_BACKGROUND_MODEL_HH
+
+/* Definition dependencies */
+#include <cstdint>
+
+#include "SickPLS.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define DEFAULT_SICK_PLS_BACKGROUND_LEARNING_SCANS                          (50)  ///< Scans averaged before detection starts
+#define DEFAULT_SICK_PLS_BACKGROUND_ADAPTATION_RATE                      (0.002)  ///< Blend factor for beams matching the background
+#define DEFAULT_SICK_PLS_BACKGROUND_NUM_SIGMAS                             (4.0)  ///< Deviation threshold in standard deviations
+#define DEFAULT_SICK_PLS_BACKGROUND_MIN_DEVIATION                           (10)  ///< Deviations below this are never reported (cm)
+#define DEFAULT_SICK_PLS_BACKGROUND_MIN_CLUSTER_BEAMS                        (2)  ///< Smaller clusters are treated as noise
+#define DEFAULT_SICK_PLS_BACKGROUND_MAX_CLUSTER_GAP                          (1)  ///< Max run of matching beams bridged inside a cluster
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \struct sick_pls_change_event_tag
+     * \brief A structure describing a cluster of neighbouring beams
+     *        that deviate from the learned background.
+     */
+    /*!
+     * \typedef sick_pls_change_event_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_change_event_tag {
+        uint16_t start_index;                                                      ///< First deviating beam
+        uint16_t end_index;                                                        ///< Last deviating beam (inclusive)
+        uint16_t num_beams;                                                        ///< Number of deviating beams in the cluster
+        uint16_t min_range;                                                        ///< Closest range among the deviating beams (cm)
+        float max_deviation;                                                       ///< Largest signed deviation from the background (cm, < 0 => closer)
+    } sick_pls_change_event_t;
+
+    /*!
+     * \brief Learns the empty scene and reports what differs from it
+     *
+     * Each beam keeps a running mean and variance of its range. The first
+     * scans are averaged exactly (Welford); afterwards beams that match the
+     * background keep adapting with an exponential forgetting factor so that
+     * slow drift (temperature, lighting) is absorbed, while deviating beams
+     * leave the model untouched. Deviating beams are grouped into clusters,
+     * so a consumer handles a handful of events per scan rather than every
+     * range value.
+     */
+    class SickPLSBackgroundModel {
+
+    public:
+
+        /** Constructs a model for scans of the given size */
+        explicit SickPLSBackgroundModel(unsigned int num_beams = 361) noexcept(false);
+
+        /** Sets the learning period (scans) and the post-learning adaptation rate */
+        void SetLearningParameters(unsigned int learning_scans, double adaptation_rate) noexcept(false);
+
+        /** Sets the deviation thresholds (sigmas, cm) */
+        void SetDetectionParameters(double num_sigmas, unsigned int min_deviation) noexcept(false);
+
+        /** Sets how deviating beams are grouped into events */
+        void SetClusterParameters(unsigned int min_cluster_beams, unsigned int max_cluster_gap);
+
+        /** Feeds a scan: learns while learning, otherwise reports deviations */
+        unsigned int Update(const uint16_t* ranges, unsigned int num_ranges,
+                            sick_pls_change_event_t* events, unsigned int max_events) noexcept(false);
+
+        /** Forgets the background and starts learning again */
+        void Reset();
+
+        /** Indicates whether the learning period is complete */
+        [[nodiscard]] bool IsLearned() const { return _num_learned >= _learning_scans; }
+
+        /** Gets the number of beams modelled */
+        [[nodiscard]] unsigned int GetNumBeams() const { return _num_beams; }
+
+        /** Gets the background range of a beam (cm) */
+        [[nodiscard]] double GetMean(unsigned int beam) const noexcept(false);
+
+        /** Gets the standard deviation of a beam (cm) */
+        [[nodiscard]] double GetStdDev(unsigned int beam) const noexcept(false);
+
+        /** Gets the deviation mask computed by the last Update (1 => deviating) */
+        [[nodiscard]] const uint8_t* GetDeviationMask() const { return _deviating; }
+
+    private:
+
+        /** Number of beams modelled */
+        unsigned int _num_beams;
+
+        /** Tunables */
+        unsigned int _learning_scans;
+        double _adaptation_rate;
+        double _num_sigmas;
+        unsigned int _min_deviation;
+        unsigned int _min_cluster_beams;
+        unsigned int _max_cluster_gap;
+
+        /** Number of scans learned so far */
+        unsigned int _num_learned;
+
+        /** Per-beam statistics (cm, cm^2) and sample counts */
+        float _mean[SickPLS::SICK_MAX_NUM_MEASUREMENTS];
+        float _variance[SickPLS::SICK_MAX_NUM_MEASUREMENTS];
+        uint32_t _count[SickPLS::SICK_MAX_NUM_MEASUREMENTS];
+
+        /** Deviation of the last scan */
+        uint8_t _deviating[SickPLS::SICK_MAX_NUM_MEASUREMENTS];
+
+        /** Folds a scan into the statistics (learning phase) */
+        void _learn(const uint16_t* ranges, unsigned int num_ranges);
+
+        /** Flags deviating beams and adapts the rest */
+        void _detect(const uint16_t* ranges, unsigned int num_ranges);
+
+        /** Groups flagged beams into events */
+        unsigned int _cluster(const uint16_t* ranges, unsigned int num_ranges,
+                              sick_pls_change_event_t* events, unsigned int max_events) const;
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_BACKGROUND_MODEL_HH */
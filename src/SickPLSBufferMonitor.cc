@@ -24,6 +24,7 @@
 #include "SickPLSBufferMonitor.hh"
 #include "SickPLSMessage.hh"
 #include "SickPLSUtility.hh"
+#include "SickProbes.hh"
 #include "SickException.hh"
 
 /* Associate the namespace */
@@ -55,13 +56,16 @@ namespace sickpls {
 
             /* Read until we get a valid message header */
             unsigned int bytes_searched = 0;
+            uint64_t first_byte_nsec = 0, byte_nsec = 0;
             while (search_buffer[0] != 0x02 || search_buffer[1] != DEFAULT_SICK_PLS_HOST_ADDRESS) {
 
                 /* Slide the search window */
                 search_buffer[0] = search_buffer[1];
+                first_byte_nsec = byte_nsec;
 
                 /* Attempt to read in another byte */
                 _readBytes(&search_buffer[1], 1, DEFAULT_SICK_PLS_SICK_BYTE_TIMEOUT);
+                byte_nsec = sick_message_clock_nsec();
 
 
                 /* Header should be no more than max message length + header length bytes away */
@@ -80,6 +84,8 @@ namespace sickpls {
 
             }
 
+            const uint64_t header_nsec = byte_nsec;
+
             /* Read until we receive the payload length or we timeout */
             _readBytes(payload_length_buffer, 2, DEFAULT_SICK_PLS_SICK_BYTE_TIMEOUT);
 
@@ -105,11 +111,33 @@ namespace sickpls {
                 /* Build a frame and compute the crc */
                 sick_message.BuildMessage(DEFAULT_SICK_PLS_HOST_ADDRESS, payload_buffer, payload_length);
 
+                /* Account for the line time (STX, address, length, payload, CRC) */
+                const uint64_t frame_end_nsec = sick_message_clock_nsec();
+                _num_bytes_received.fetch_add(payload_length + 6, std::memory_order_relaxed);
+                if (_last_frame_end_nsec != 0 && first_byte_nsec > _last_frame_end_nsec) {
+                    _idle_nsec.fetch_add(first_byte_nsec - _last_frame_end_nsec, std::memory_order_relaxed);
+                }
+                _last_frame_end_nsec = frame_end_nsec;
+
                 /* See if the checksums match */
                 if (sick_message.GetChecksum() != checksum) {
+                    if (SICK_PROBE_ENABLED(crc_failure)) {
+                        SICK_PROBE(crc_failure, payload_length, checksum, sick_message.GetChecksum(),
+                                   sick_message_clock_nsec());
+                    }
+                    _num_checksum_errors.fetch_add(1, std::memory_order_relaxed);
                     throw SickBadChecksumException("SickPLS::GetNextMessageFromDataStream: CRC16 failed!");
                 }
 
+                /* Stamp the frame (the STX byte counts as its first byte) */
+                sick_message.SetStageTimestamp(SICK_MESSAGE_STAGE_FIRST_BYTE, first_byte_nsec);
+                sick_message.SetStageTimestamp(SICK_MESSAGE_STAGE_HEADER_FOUND, header_nsec);
+                sick_message.SetStageTimestamp(SICK_MESSAGE_STAGE_CRC_VERIFIED, sick_message_clock_nsec());
+                if (SICK_PROBE_ENABLED(frame_received)) {
+                    SICK_PROBE(frame_received, payload_length, sick_message.GetCommandCode(), first_byte_nsec,
+                               sick_message.GetStageTimestamp(SICK_MESSAGE_STAGE_CRC_VERIFIED));
+                }
+
             }
 
         }
@@ -136,6 +164,25 @@ namespace sickpls {
 
     }
 
+    /**
+     * \brief Indicates whether a message is a streamed scan rather than a reply
+     * \param &sick_message The message to classify
+     * \return True for the measured value telegrams the monitor modes stream
+     */
+    bool SickPLSBufferMonitor::IsStreamMessage(const SickPLSMessage& sick_message) const {
+
+        switch (sick_message.GetCommandCode()) {
+            case 0xB0: // Measured values
+            case 0xB6: // Mean measured values
+            case 0xB7: // Measured value subrange
+            case 0xBF: // Mean measured value subrange
+                return true;
+            default:
+                return false;
+        }
+
+    }
+
     /**
      * \brief A standard destructor
      */
@@ -42,9 +42,27 @@ namespace sickpls {
         /** A method for extracting a single message from the stream */
         void GetNextMessageFromDataStream(SickPLSMessage& sick_message) noexcept(false) override;
 
+        /** Indicates whether a message is a streamed scan rather than a reply */
+        bool IsStreamMessage(const SickPLSMessage& sick_message) const override;
+
+        /** Gets the number of bytes in the frames read so far (bad CRCs included) */
+        [[nodiscard]] uint64_t GetNumBytesReceived() const { return _num_bytes_received.load(std::memory_order_relaxed); }
+
+        /** Gets the total time between the end of one frame and the first byte of the next (nsecs) */
+        [[nodiscard]] uint64_t GetIdleTime() const { return _idle_nsec.load(std::memory_order_relaxed); }
+
         /** A standard destructor */
         ~SickPLSBufferMonitor();
 
+    private:
+
+        /** Line counters (only ever written by the monitor thread) */
+        std::atomic<uint64_t> _num_bytes_received{0};
+        std::atomic<uint64_t> _idle_nsec{0};
+
+        /** When the last frame ended (0 => none yet) */
+        uint64_t _last_frame_end_nsec{0};
+
     };
 
 } /* namespace sickpls */
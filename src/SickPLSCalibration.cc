@@ -0,0 +1,400 @@
+/*!
+ * \file SickPLSCalibration.cc
+ * \brief Implements a class for estimating the relative mounting pose of
+ *        two Sick PLS units with overlapping views.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "SickPLSCalibration.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \struct sick_pls_calibration_pool_tag
+     * \brief What the pool's threads share.
+     */
+    /*!
+     * \typedef sick_pls_calibration_pool_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_calibration_pool_tag {
+        const SickPLSCartesianConverter* reference_converter;                      ///< Reference geometry
+        const SickPLSCartesianConverter* sensor_converter;                         ///< Sensor geometry (identity pose)
+        void* tasks;                                                               ///< The task vector
+        size_t num_tasks;                                                          ///< Its length
+        std::atomic<size_t> next_task;                                             ///< Next task to claim
+    } sick_pls_calibration_pool_t;
+
+    /**
+     * \brief Constructs a calibrator
+     * \param &reference The reference sensor's geometry and mounting pose
+     * \param &sensor The calibrated sensor's geometry (its mounting pose is ignored)
+     */
+    SickPLSCalibrator::SickPLSCalibrator(const SickPLSCartesianConverter& reference,
+                                         const SickPLSCartesianConverter& sensor) :
+            _reference_converter(reference), _sensor_converter(sensor), _guess_x(0), _guess_y(0), _guess_theta(0),
+            _search_headings(true), _coarse_dist(DEFAULT_SICK_PLS_CALIBRATION_COARSE_DIST),
+            _fine_dist(DEFAULT_SICK_PLS_ICP_MAX_CORRESPONDENCE_DIST) {
+
+        /* Sensor points are expressed in its own frame */
+        _sensor_converter.SetMountingPose(0, 0, 0);
+
+    }
+
+    /**
+     * \brief Sets the pose the seed search starts from
+     * \param x Translation along x (m)
+     * \param y Translation along y (m)
+     * \param theta Rotation (rad)
+     * \param search_headings If true, headings all around the circle are tried as well
+     */
+    void SickPLSCalibrator::SetInitialGuess(const double x, const double y, const double theta,
+                                            const bool search_headings) {
+        _guess_x = x;
+        _guess_y = y;
+        _guess_theta = theta;
+        _search_headings = search_headings;
+    }
+
+    /**
+     * \brief Sets the correspondence gates
+     * \param coarse_dist Gate while searching seeds (m)
+     * \param fine_dist Gate while refining each pair (m)
+     */
+    void SickPLSCalibrator::SetCorrespondenceDistances(const double coarse_dist,
+                                                       const double fine_dist) noexcept(false) {
+
+        if (coarse_dist <= 0 || fine_dist <= 0) {
+            throw SickConfigException("SickPLSCalibrator::SetCorrespondenceDistances: Distances must be positive!");
+        }
+
+        _coarse_dist = coarse_dist;
+        _fine_dist = fine_dist;
+
+    }
+
+    /**
+     * \brief Adds a pair of simultaneous scans as returned by SickPLS::GetSickScan
+     * \param *reference_ranges The reference sensor's range values (cm)
+     * \param num_reference_ranges The number of reference range values
+     * \param *sensor_ranges The calibrated sensor's range values (cm)
+     * \param num_sensor_ranges The number of sensor range values
+     */
+    void SickPLSCalibrator::AddScans(const unsigned int* const reference_ranges, const unsigned int num_reference_ranges,
+                                     const unsigned int* const sensor_ranges,
+                                     const unsigned int num_sensor_ranges) noexcept(false) {
+        _addScans(reference_ranges, num_reference_ranges, sensor_ranges, num_sensor_ranges);
+    }
+
+    /**
+     * \brief Adds a pair of simultaneous decoded scans
+     * \param *reference_ranges The reference sensor's range values (cm)
+     * \param num_reference_ranges The number of reference range values
+     * \param *sensor_ranges The calibrated sensor's range values (cm)
+     * \param num_sensor_ranges The number of sensor range values
+     */
+    void SickPLSCalibrator::AddScans(const uint16_t* const reference_ranges, const unsigned int num_reference_ranges,
+                                     const uint16_t* const sensor_ranges,
+                                     const unsigned int num_sensor_ranges) noexcept(false) {
+        _addScans(reference_ranges, num_reference_ranges, sensor_ranges, num_sensor_ranges);
+    }
+
+    /**
+     * \brief Discards the batch
+     */
+    void SickPLSCalibrator::Clear() {
+        _reference_ranges.clear();
+        _sensor_ranges.clear();
+    }
+
+    /**
+     * \brief Estimates the sensor's mounting pose from the batch
+     * \param &result The estimate
+     * \param num_threads Threads to align with (0 => one per core)
+     */
+    void SickPLSCalibrator::Solve(sick_pls_calibration_result_t& result, const unsigned int num_threads) noexcept(false) {
+
+        if (_reference_ranges.empty()) {
+            throw SickConfigException("SickPLSCalibrator::Solve: No scans have been added!");
+        }
+
+        result = {};
+        result.num_pairs = GetNumPairs();
+
+        /* Seed search on the (noise free) median scans */
+        std::vector<uint16_t> reference_median, sensor_median;
+        _medianScan(_reference_ranges, reference_median);
+        _medianScan(_sensor_ranges, sensor_median);
+
+        std::vector<sick_pls_calibration_task_t> tasks;
+        const auto num_seeds = _search_headings ?
+                               (unsigned int) std::lround(360.0 / DEFAULT_SICK_PLS_CALIBRATION_SEED_STEP) : 1;
+        for (unsigned int i = 0; i < num_seeds; i++) {
+            const double theta = remainder(_guess_theta + 2.0 * M_PI * i / num_seeds, 2.0 * M_PI);
+            tasks.push_back({&reference_median, &sensor_median, _guess_x, _guess_y, theta, _coarse_dist, {}, false});
+        }
+        _runTasks(tasks, num_threads);
+
+        /* The seed that pairs up the most points (ties => the tighter fit) wins */
+        const sick_pls_calibration_task_t* best = nullptr;
+        for (const auto& task: tasks) {
+            if (!task.matched || !task.result.converged) {
+                continue;
+            }
+            if (!best || task.result.num_correspondences > 1.05 * best->result.num_correspondences ||
+                (task.result.num_correspondences >= 0.95 * best->result.num_correspondences &&
+                 task.result.rms_error < best->result.rms_error)) {
+                best = &task;
+            }
+        }
+
+        if (!best) {
+            return;
+        }
+
+        const double coarse_x = best->result.x, coarse_y = best->result.y, coarse_theta = best->result.theta;
+
+        /* Refine every pair from there */
+        tasks.clear();
+        for (unsigned int i = 0; i < result.num_pairs; i++) {
+            tasks.push_back({&_reference_ranges[i], &_sensor_ranges[i], coarse_x, coarse_y, coarse_theta, _fine_dist,
+                             {}, false});
+        }
+        _runTasks(tasks, num_threads);
+
+        std::vector<double> xs, ys, thetas;
+        for (const auto& task: tasks) {
+            if (task.matched && task.result.converged) {
+                xs.push_back(task.result.x);
+                ys.push_back(task.result.y);
+                thetas.push_back(remainder(task.result.theta - coarse_theta, 2.0 * M_PI));
+            }
+        }
+
+        result.num_converged = (unsigned int) xs.size();
+        if (xs.empty()) {
+            return;
+        }
+
+        /* Screen against the median (sigma ~ 1.4826 * MAD, floored to stay sane on identical estimates) */
+        const auto median_of = [](std::vector<double> values) {
+            const size_t mid = values.size() / 2;
+            std::nth_element(values.begin(), values.begin() + (long) mid, values.end());
+            return values[mid];
+        };
+        const auto robust_sigma = [&median_of](const std::vector<double>& values, const double median,
+                                               const double floor) {
+            std::vector<double> deviations(values.size());
+            for (size_t i = 0; i < values.size(); i++) {
+                deviations[i] = std::fabs(values[i] - median);
+            }
+            return std::max(floor, 1.4826 * median_of(deviations));
+        };
+
+        const double median_x = median_of(xs), median_y = median_of(ys), median_theta = median_of(thetas);
+        const double gate_x = DEFAULT_SICK_PLS_CALIBRATION_OUTLIER_THRESHOLD * robust_sigma(xs, median_x, 1e-3);
+        const double gate_y = DEFAULT_SICK_PLS_CALIBRATION_OUTLIER_THRESHOLD * robust_sigma(ys, median_y, 1e-3);
+        const double gate_theta =
+                DEFAULT_SICK_PLS_CALIBRATION_OUTLIER_THRESHOLD * robust_sigma(thetas, median_theta, 1e-3);
+
+        double sum[3] = {0, 0, 0}, sum_sq[3] = {0, 0, 0}, sum_rms = 0;
+        for (size_t i = 0, j = 0; i < tasks.size(); i++) {
+
+            if (!tasks[i].matched || !tasks[i].result.converged) {
+                continue;
+            }
+
+            const double x = xs[j], y = ys[j], theta = thetas[j];
+            j++;
+            if (std::fabs(x - median_x) > gate_x || std::fabs(y - median_y) > gate_y ||
+                std::fabs(theta - median_theta) > gate_theta) {
+                continue;
+            }
+
+            sum[0] += x;
+            sum[1] += y;
+            sum[2] += theta;
+            sum_sq[0] += x * x;
+            sum_sq[1] += y * y;
+            sum_sq[2] += theta * theta;
+            sum_rms += tasks[i].result.rms_error;
+            result.num_inliers++;
+
+        }
+
+        const double n = result.num_inliers;
+        const auto spread = [n](const double s, const double s_sq) {
+            return std::sqrt(std::max(0.0, s_sq / n - (s / n) * (s / n)));
+        };
+
+        result.x = sum[0] / n;
+        result.y = sum[1] / n;
+        result.theta = remainder(coarse_theta + sum[2] / n, 2.0 * M_PI);
+        result.std_x = spread(sum[0], sum_sq[0]);
+        result.std_y = spread(sum[1], sum_sq[1]);
+        result.std_theta = spread(sum[2], sum_sq[2]);
+        result.rms_error = sum_rms / n;
+        result.converged = true;
+
+    }
+
+    /**
+     * \brief Adds a pair to the batch
+     */
+    template<class RANGE_TYPE>
+    void SickPLSCalibrator::_addScans(const RANGE_TYPE* const reference_ranges, const unsigned int num_reference_ranges,
+                                      const RANGE_TYPE* const sensor_ranges,
+                                      const unsigned int num_sensor_ranges) noexcept(false) {
+
+        if (GetNumPairs() == SICK_PLS_CALIBRATION_MAX_PAIRS) {
+            throw SickConfigException("SickPLSCalibrator::AddScans: The batch is full!");
+        }
+
+        if (num_reference_ranges > _reference_converter.GetNumBeams() ||
+            num_sensor_ranges > std::min(_sensor_converter.GetNumBeams(), _reference_converter.GetNumBeams())) {
+            throw SickConfigException("SickPLSCalibrator::AddScans: Scan is larger than its geometry!");
+        }
+
+        _reference_ranges.emplace_back(reference_ranges, reference_ranges + num_reference_ranges);
+        _sensor_ranges.emplace_back(sensor_ranges, sensor_ranges + num_sensor_ranges);
+
+    }
+
+    /**
+     * \brief Runs alignments over a pool of threads
+     * \param &tasks The alignments (results are written back)
+     * \param num_threads Pool size (0 => one per core)
+     */
+    void SickPLSCalibrator::_runTasks(std::vector<sick_pls_calibration_task_t>& tasks,
+                                      unsigned int num_threads) noexcept(false) {
+
+        if (num_threads == 0) {
+            const long num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+            num_threads = (num_cores > 0) ? (unsigned int) num_cores : 1;
+        }
+        num_threads = std::max(1u, std::min(num_threads, (unsigned int) tasks.size()));
+
+        sick_pls_calibration_pool_t pool;
+        pool.reference_converter = &_reference_converter;
+        pool.sensor_converter = &_sensor_converter;
+        pool.tasks = &tasks;
+        pool.num_tasks = tasks.size();
+        pool.next_task.store(0, std::memory_order_relaxed);
+
+        /* The calling thread takes part as well */
+        std::vector<pthread_t> thread_ids;
+        for (unsigned int i = 1; i < num_threads; i++) {
+            pthread_t thread_id;
+            if (pthread_create(&thread_id, nullptr, _taskThread, &pool) != 0) {
+                break;
+            }
+            thread_ids.push_back(thread_id);
+        }
+
+        _taskThread(&pool);
+
+        for (const auto thread_id: thread_ids) {
+            if (pthread_join(thread_id, nullptr) != 0) {
+                throw SickThreadException("SickPLSCalibrator::_runTasks: pthread_join() failed!");
+            }
+        }
+
+    }
+
+    /**
+     * \brief Claims and runs alignments until none are left
+     * \param *thread_args The pool (sick_pls_calibration_pool_t)
+     */
+    void* SickPLSCalibrator::_taskThread(void* const thread_args) {
+
+        auto& pool = *(sick_pls_calibration_pool_t*) thread_args;
+        auto& tasks = *(std::vector<sick_pls_calibration_task_t>*) pool.tasks;
+
+        /* Matchers and scans are large, so keep them off the stack */
+        std::unique_ptr<SickPLSScanMatcher> matcher(new SickPLSScanMatcher(*pool.reference_converter));
+        std::unique_ptr<sick_pls_cartesian_scan_t> reference_scan(new sick_pls_cartesian_scan_t);
+        std::unique_ptr<sick_pls_cartesian_scan_t> sensor_scan(new sick_pls_cartesian_scan_t);
+
+        size_t i;
+        while ((i = pool.next_task.fetch_add(1, std::memory_order_relaxed)) < pool.num_tasks) {
+
+            sick_pls_calibration_task_t& task = tasks[i];
+
+            try {
+
+                pool.reference_converter->Convert(task.reference_ranges->data(),
+                                                  (unsigned int) task.reference_ranges->size(), *reference_scan);
+                const unsigned int num_valid =
+                        pool.sensor_converter->Convert(task.sensor_ranges->data(),
+                                                       (unsigned int) task.sensor_ranges->size(), *sensor_scan);
+
+                /* Demand a real overlap, not a few stray pairs */
+                matcher->SetSearchParameters(DEFAULT_SICK_PLS_ICP_MAX_ITERATIONS, DEFAULT_SICK_PLS_ICP_SEARCH_WINDOW,
+                                             task.max_correspondence_dist);
+                matcher->SetMinCorrespondences(
+                        std::max((unsigned int) DEFAULT_SICK_PLS_ICP_MIN_CORRESPONDENCES,
+                                 (unsigned int) (DEFAULT_SICK_PLS_CALIBRATION_MIN_OVERLAP * num_valid)));
+                matcher->SetReference(*reference_scan);
+
+                task.matched = matcher->Match(*sensor_scan, task.guess_x, task.guess_y, task.guess_theta,
+                                              task.result);
+
+            }
+
+            catch (SickException&) {
+                task.matched = false;
+            }
+
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * \brief Builds the per-beam median of a set of scans
+     * \param &scans The scans (the shortest sets the median's length)
+     * \param &median The median scan
+     */
+    void SickPLSCalibrator::_medianScan(const std::vector<std::vector<uint16_t>>& scans,
+                                        std::vector<uint16_t>& median) {
+
+        size_t num_beams = scans[0].size();
+        for (const auto& scan: scans) {
+            num_beams = std::min(num_beams, scan.size());
+        }
+
+        median.resize(num_beams);
+        std::vector<uint16_t> column(scans.size());
+        for (size_t i = 0; i < num_beams; i++) {
+            for (size_t j = 0; j < scans.size(); j++) {
+                column[j] = scans[j][i];
+            }
+            std::nth_element(column.begin(), column.begin() + (long) (column.size() / 2), column.end());
+            median[i] = column[column.size() / 2];
+        }
+
+    }
+
+} /* namespace sickpls */
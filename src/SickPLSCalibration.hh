@@ -0,0 +1,148 @@
+/*!
+ * \file SickPLSCalibration.hh
+ * \brief Defines a class for estimating the relative mounting pose of
+ *        two Sick PLS units with overlapping views.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_CALIBRATION_HH
+#define SICK_PLS_CALIBRATION_HH
+
+/* Definition dependencies */
+#include <cstdint>
+#include <vector>
+
+#include "SickPLSScanMatcher.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define SICK_PLS_CALIBRATION_MAX_PAIRS                                    (4096)  ///< Scan pairs a batch may hold
+#define DEFAULT_SICK_PLS_CALIBRATION_SEED_STEP                            (15.0)  ///< Spacing of the initial headings tried (deg)
+#define DEFAULT_SICK_PLS_CALIBRATION_COARSE_DIST                          (1.50)  ///< Correspondence gate while searching seeds (m)
+#define DEFAULT_SICK_PLS_CALIBRATION_MIN_OVERLAP                          (0.10)  ///< Share of the sensor's returns that must pair up
+#define DEFAULT_SICK_PLS_CALIBRATION_OUTLIER_THRESHOLD                     (3.0)  ///< Inliers lie within this many robust sigmas of the median
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \struct sick_pls_calibration_result_tag
+     * \brief A structure holding an estimated mounting pose. The pose is
+     *        that of the sensor in the reference converter's output frame,
+     *        i.e. what to pass to the sensor converter's SetMountingPose.
+     */
+    /*!
+     * \typedef sick_pls_calibration_result_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_calibration_result_tag {
+        double x;                                                                  ///< Translation along x (m)
+        double y;                                                                  ///< Translation along y (m)
+        double theta;                                                              ///< Rotation (rad)
+        double std_x;                                                              ///< Spread of the inlier estimates along x (m)
+        double std_y;                                                              ///< Spread of the inlier estimates along y (m)
+        double std_theta;                                                          ///< Spread of the inlier estimates in heading (rad)
+        double rms_error;                                                          ///< Mean point-to-line residual of the inliers (m)
+        unsigned int num_pairs;                                                    ///< Scan pairs in the batch
+        unsigned int num_converged;                                                ///< Pairs whose alignment converged
+        unsigned int num_inliers;                                                  ///< Pairs the estimate is averaged over
+        bool converged;                                                            ///< True if an estimate was found
+    } sick_pls_calibration_result_t;
+
+    /*!
+     * \brief Estimates where one PLS is mounted relative to another from a
+     *        batch of simultaneous scans of a static scene
+     *
+     * Solve() first aligns the per-beam median scans of the batch, trying
+     * headings all around the circle (or only the given guess) with a wide
+     * correspondence gate, and keeps the best fit. Every pair is then
+     * aligned on its own from that estimate, the results are screened
+     * against their median (median absolute deviation) and the inliers
+     * are averaged. Both stages spread their alignments over a pool of
+     * threads, each with its own SickPLSScanMatcher.
+     */
+    class SickPLSCalibrator {
+
+    public:
+
+        /** Constructs a calibrator for the given reference and sensor geometries */
+        SickPLSCalibrator(const SickPLSCartesianConverter& reference, const SickPLSCartesianConverter& sensor);
+
+        /** Sets the pose the seed search starts from (the heading is only kept if no search is made) */
+        void SetInitialGuess(double x, double y, double theta, bool search_headings = true);
+
+        /** Sets the correspondence gates (coarse seed search, per-pair refinement) (m) */
+        void SetCorrespondenceDistances(double coarse_dist, double fine_dist) noexcept(false);
+
+        /** Adds a pair of simultaneous scans as returned by SickPLS::GetSickScan */
+        void AddScans(const unsigned int* reference_ranges, unsigned int num_reference_ranges,
+                      const unsigned int* sensor_ranges, unsigned int num_sensor_ranges) noexcept(false);
+
+        /** Adds a pair of simultaneous decoded scans */
+        void AddScans(const uint16_t* reference_ranges, unsigned int num_reference_ranges,
+                      const uint16_t* sensor_ranges, unsigned int num_sensor_ranges) noexcept(false);
+
+        /** Gets the number of scan pairs in the batch */
+        [[nodiscard]] unsigned int GetNumPairs() const { return (unsigned int) _reference_ranges.size(); }
+
+        /** Discards the batch */
+        void Clear();
+
+        /** Estimates the sensor's mounting pose (num_threads = 0 => one per core) */
+        void Solve(sick_pls_calibration_result_t& result, unsigned int num_threads = 0) noexcept(false);
+
+    private:
+
+        /** An alignment for the thread pool */
+        typedef struct sick_pls_calibration_task_tag {
+            const std::vector<uint16_t>* reference_ranges;                         ///< Reference scan
+            const std::vector<uint16_t>* sensor_ranges;                            ///< Sensor scan
+            double guess_x, guess_y, guess_theta;                                  ///< Starting pose
+            double max_correspondence_dist;                                        ///< Correspondence gate (m)
+            sick_pls_match_result_t result;                                        ///< Outcome
+            bool matched;                                                          ///< True if the matcher produced an estimate
+        } sick_pls_calibration_task_t;
+
+        /** Geometries (the sensor's with its pose cleared) */
+        SickPLSCartesianConverter _reference_converter;
+        SickPLSCartesianConverter _sensor_converter;
+
+        /** Seed search */
+        double _guess_x, _guess_y, _guess_theta;
+        bool _search_headings;
+
+        /** Correspondence gates (m) */
+        double _coarse_dist, _fine_dist;
+
+        /** The batch */
+        std::vector<std::vector<uint16_t>> _reference_ranges;
+        std::vector<std::vector<uint16_t>> _sensor_ranges;
+
+        /** Adds a pair */
+        template<class RANGE_TYPE>
+        void _addScans(const RANGE_TYPE* reference_ranges, unsigned int num_reference_ranges,
+                       const RANGE_TYPE* sensor_ranges, unsigned int num_sensor_ranges) noexcept(false);
+
+        /** Runs the given alignments over a pool of threads */
+        void _runTasks(std::vector<sick_pls_calibration_task_t>& tasks, unsigned int num_threads) noexcept(false);
+
+        /** Entry point for the pool's threads */
+        static void* _taskThread(void* thread_args);
+
+        /** Builds the per-beam median of a set of scans */
+        static void _medianScan(const std::vector<std::vector<uint16_t>>& scans, std::vector<uint16_t>& median);
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_CALIBRATION_HH */
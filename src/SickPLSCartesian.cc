@@ -0,0 +1,331 @@
+/*!
+ * \file SickPLSCartesian.cc
+ * \brief Implements a class for converting Sick PLS range
+ *        scans into Cartesian coordinates.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <cmath>
+#include <cstring>
+
+#include "SickPLSCartesian.hh"
+#include "SickPLSSimd.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Constructs a converter for the given scan geometry
+     * \param scan_angle The scan angle (FOV) of the device (deg)
+     * \param scan_resolution The angular resolution of the device (deg)
+     * \param first_beam Index of the first beam delivered in each scan (e.g. start of a subrange)
+     * \param num_beams Number of beams delivered in each scan (Default: 0 => up to the end of the FOV)
+     */
+    SickPLSCartesianConverter::SickPLSCartesianConverter(const double scan_angle,
+                                                         const double scan_resolution,
+                                                         const unsigned int first_beam,
+                                                         const unsigned int num_beams) noexcept(false) :
+            _first_beam(0), _num_beams(0), _start_angle(0), _resolution(0),
+            _pose_x(0), _pose_y(0), _pose_theta(0),
+            _min_valid_range(DEFAULT_SICK_PLS_MIN_VALID_RANGE),
+            _max_valid_range(DEFAULT_SICK_PLS_MAX_VALID_RANGE) {
+
+        /* Tabulate the beam angles */
+        _buildTables(scan_angle, scan_resolution, first_beam, num_beams);
+
+    }
+
+    /**
+     * \brief Constructs a converter using the geometry of an initialized device
+     * \param &sick_pls An initialized Sick PLS
+     * \param first_beam Index of the first beam delivered in each scan (e.g. start of a subrange)
+     * \param num_beams Number of beams delivered in each scan (Default: 0 => up to the end of the FOV)
+     */
+    SickPLSCartesianConverter::SickPLSCartesianConverter(const SickPLS& sick_pls,
+                                                         const unsigned int first_beam,
+                                                         const unsigned int num_beams) noexcept(false) :
+            SickPLSCartesianConverter(sick_pls.GetSickScanAngle(), sick_pls.GetSickScanResolution(),
+                                      first_beam, num_beams) {}
+
+    /**
+     * \brief Sets the pose of the sensor in the output frame
+     * \param x Sensor x position (m)
+     * \param y Sensor y position (m)
+     * \param theta Sensor heading (rad)
+     */
+    void SickPLSCartesianConverter::SetMountingPose(const double x, const double y, const double theta) {
+
+        _pose_x = x;
+        _pose_y = y;
+        _pose_theta = theta;
+
+        /* Fold the rotation into the tables */
+        _buildPoseTables();
+
+    }
+
+    /**
+     * \brief Sets the window of range values considered valid
+     * \param min_range Smallest valid range (cm)
+     * \param max_range Ranges at or above this value are flagged invalid (cm)
+     */
+    void SickPLSCartesianConverter::SetValidRange(const unsigned int min_range,
+                                                  const unsigned int max_range) noexcept(false) {
+
+        /* A sanity check */
+        if (min_range >= max_range) {
+            throw SickConfigException("SickPLSCartesianConverter::SetValidRange: Empty range window!");
+        }
+
+        _min_valid_range = min_range;
+        _max_valid_range = max_range;
+
+    }
+
+    /**
+     * \brief Converts a decoded scan into Cartesian coordinates
+     * \param *ranges The range values (cm)
+     * \param num_ranges The number of range values
+     * \param &cartesian_scan The destination scan
+     * \return The number of valid points
+     */
+    unsigned int SickPLSCartesianConverter::Convert(const uint16_t* const ranges, const unsigned int num_ranges,
+                                                    sick_pls_cartesian_scan_t& cartesian_scan) const noexcept(false) {
+
+        /* Ensure the scan matches the tables */
+        if (num_ranges > _num_beams) {
+            throw SickConfigException("SickPLSCartesianConverter::Convert: Scan is larger than the angle tables!");
+        }
+
+        cartesian_scan.num_points = num_ranges;
+        if (sick_pls_cpu_has_avx2()) {
+            cartesian_scan.num_valid = _convertAVX2(ranges, num_ranges, cartesian_scan);
+        } else {
+            cartesian_scan.num_valid = _convertScalar(ranges, 0, num_ranges, cartesian_scan);
+        }
+
+        return cartesian_scan.num_valid;
+    }
+
+    /**
+     * \brief Converts a scan as returned by SickPLS::GetSickScan into Cartesian coordinates
+     * \param *ranges The range values (cm)
+     * \param num_ranges The number of range values
+     * \param &cartesian_scan The destination scan
+     * \return The number of valid points
+     */
+    unsigned int SickPLSCartesianConverter::Convert(const unsigned int* const ranges, const unsigned int num_ranges,
+                                                    sick_pls_cartesian_scan_t& cartesian_scan) const noexcept(false) {
+
+        /* Ensure the scan matches the tables */
+        if (num_ranges > _num_beams) {
+            throw SickConfigException("SickPLSCartesianConverter::Convert: Scan is larger than the angle tables!");
+        }
+
+        cartesian_scan.num_points = num_ranges;
+        if (sick_pls_cpu_has_avx2()) {
+            cartesian_scan.num_valid = _convertAVX2(ranges, num_ranges, cartesian_scan);
+        } else {
+            cartesian_scan.num_valid = _convertScalar(ranges, 0, num_ranges, cartesian_scan);
+        }
+
+        return cartesian_scan.num_valid;
+    }
+
+    /**
+     * \brief Builds the sensor frame angle tables
+     */
+    void SickPLSCartesianConverter::_buildTables(const double scan_angle, const double scan_resolution,
+                                                 const unsigned int first_beam,
+                                                 const unsigned int num_beams) noexcept(false) {
+
+        /* Make sure the geometry makes sense */
+        if (scan_angle <= 0 || scan_resolution <= 0) {
+            throw SickConfigException("SickPLSCartesianConverter::_buildTables: Invalid scan geometry!");
+        }
+
+        /* Number of beams across the whole FOV */
+        auto fov_beams = (unsigned int) (std::lround(scan_angle / scan_resolution) + 1);
+        if (fov_beams > SICK_PLS_CARTESIAN_MAX_POINTS || first_beam >= fov_beams) {
+            throw SickConfigException("SickPLSCartesianConverter::_buildTables: Invalid beam range!");
+        }
+
+        _first_beam = first_beam;
+        _num_beams = (num_beams == 0) ? fov_beams - first_beam : num_beams;
+        if (_first_beam + _num_beams > fov_beams) {
+            throw SickConfigException("SickPLSCartesianConverter::_buildTables: Subrange exceeds the FOV!");
+        }
+
+        /* Beam 0 lies at -FOV/2 (i.e. to the right of the sensor) */
+        _resolution = scan_resolution * M_PI / 180.0;
+        _start_angle = -0.5 * scan_angle * M_PI / 180.0 + _first_beam * _resolution;
+
+        /* Tabulate the unit bearings (zero padded out to the SIMD width) */
+        memset(_cos_table, 0, sizeof(_cos_table));
+        memset(_sin_table, 0, sizeof(_sin_table));
+        for (unsigned int i = 0; i < _num_beams; i++) {
+            _cos_table[i] = (float) cos(GetBeamAngle(i));
+            _sin_table[i] = (float) sin(GetBeamAngle(i));
+        }
+
+        /* And the pose dependent versions */
+        _buildPoseTables();
+
+    }
+
+    /**
+     * \brief Rebuilds the tables with the mounting rotation and unit scale folded in
+     */
+    void SickPLSCartesianConverter::_buildPoseTables() {
+
+        memset(_x_table, 0, sizeof(_x_table));
+        memset(_y_table, 0, sizeof(_y_table));
+        for (unsigned int i = 0; i < _num_beams; i++) {
+            const double angle = GetBeamAngle(i) + _pose_theta;
+            _x_table[i] = (float) (0.01 * cos(angle));
+            _y_table[i] = (float) (0.01 * sin(angle));
+        }
+
+    }
+
+    /**
+     * \brief Converts beams [begin,end) one at a time
+     * \return The number of valid beams in the interval
+     */
+    template<class RANGE_TYPE>
+    unsigned int SickPLSCartesianConverter::_convertScalar(const RANGE_TYPE* const ranges,
+                                                           const unsigned int begin, const unsigned int end,
+                                                           sick_pls_cartesian_scan_t& cartesian_scan) const {
+
+        const auto pose_x = (float) _pose_x;
+        const auto pose_y = (float) _pose_y;
+
+        unsigned int num_valid = 0;
+        for (unsigned int i = begin; i < end; i++) {
+            const auto range = (unsigned int) ranges[i];
+            const bool valid = (range >= _min_valid_range) && (range < _max_valid_range);
+            cartesian_scan.x[i] = (float) range * _x_table[i] + pose_x;
+            cartesian_scan.y[i] = (float) range * _y_table[i] + pose_y;
+            cartesian_scan.valid[i] = valid;
+            num_valid += valid;
+        }
+
+        return num_valid;
+    }
+
+#ifdef SICK_PLS_HAVE_X86_SIMD
+
+    /**
+     * \brief Computes x/y and the validity mask for eight beams
+     * \return The number of valid beams among the eight
+     */
+    SICK_PLS_TARGET_AVX2 static inline unsigned int
+    sick_pls_convert8_avx2(const __m256i range_i, const float* const x_table, const float* const y_table,
+                           const __m256 pose_x, const __m256 pose_y, const __m256i min_range, const __m256i max_range,
+                           float* const x, float* const y, uint8_t* const valid) {
+
+        /* min_range <= r < max_range  <=>  r > min_range - 1 && max_range > r */
+        const __m256i mask_i = _mm256_and_si256(_mm256_cmpgt_epi32(range_i, min_range),
+                                                _mm256_cmpgt_epi32(max_range, range_i));
+
+        const __m256 range_f = _mm256_cvtepi32_ps(range_i);
+        _mm256_storeu_ps(x, _mm256_fmadd_ps(range_f, _mm256_load_ps(x_table), pose_x));
+        _mm256_storeu_ps(y, _mm256_fmadd_ps(range_f, _mm256_load_ps(y_table), pose_y));
+
+        /* Expand the lane mask into one byte per beam */
+        const auto bits = (unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(mask_i));
+        uint64_t bytes = 0;
+        for (unsigned int j = 0; j < 8; j++) {
+            bytes |= (uint64_t) ((bits >> j) & 1) << (8 * j);
+        }
+        memcpy(valid, &bytes, 8);
+
+        return (unsigned int) __builtin_popcount(bits);
+    }
+
+    /**
+     * \brief Converts 16-bit ranges eight beams at a time
+     */
+    SICK_PLS_TARGET_AVX2 unsigned int
+    SickPLSCartesianConverter::_convertAVX2(const uint16_t* const ranges, const unsigned int num_ranges,
+                                            sick_pls_cartesian_scan_t& cartesian_scan) const {
+
+        const __m256 pose_x = _mm256_set1_ps((float) _pose_x);
+        const __m256 pose_y = _mm256_set1_ps((float) _pose_y);
+        const __m256i min_range = _mm256_set1_epi32((int) _min_valid_range - 1);
+        const __m256i max_range = _mm256_set1_epi32((int) _max_valid_range);
+
+        unsigned int i = 0, num_valid = 0;
+        for (; i + 8 <= num_ranges; i += 8) {
+            const __m256i range_i = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*) &ranges[i]));
+            num_valid += sick_pls_convert8_avx2(range_i, &_x_table[i], &_y_table[i], pose_x, pose_y,
+                                                min_range, max_range,
+                                                &cartesian_scan.x[i], &cartesian_scan.y[i], &cartesian_scan.valid[i]);
+        }
+
+        /* Finish off the tail */
+        return num_valid + _convertScalar(ranges, i, num_ranges, cartesian_scan);
+    }
+
+    /**
+     * \brief Converts 32-bit ranges eight beams at a time
+     */
+    SICK_PLS_TARGET_AVX2 unsigned int
+    SickPLSCartesianConverter::_convertAVX2(const unsigned int* const ranges, const unsigned int num_ranges,
+                                            sick_pls_cartesian_scan_t& cartesian_scan) const {
+
+        const __m256 pose_x = _mm256_set1_ps((float) _pose_x);
+        const __m256 pose_y = _mm256_set1_ps((float) _pose_y);
+        const __m256i min_range = _mm256_set1_epi32((int) _min_valid_range - 1);
+        const __m256i max_range = _mm256_set1_epi32((int) _max_valid_range);
+
+        /* Ranges are at most 13 bits, so clamping keeps the signed compares honest */
+        const __m256i range_clamp = _mm256_set1_epi32(0xFFFF);
+
+        unsigned int i = 0, num_valid = 0;
+        for (; i + 8 <= num_ranges; i += 8) {
+            const __m256i range_i = _mm256_min_epu32(_mm256_loadu_si256((const __m256i*) &ranges[i]), range_clamp);
+            num_valid += sick_pls_convert8_avx2(range_i, &_x_table[i], &_y_table[i], pose_x, pose_y,
+                                                min_range, max_range,
+                                                &cartesian_scan.x[i], &cartesian_scan.y[i], &cartesian_scan.valid[i]);
+        }
+
+        /* Finish off the tail */
+        return num_valid + _convertScalar(ranges, i, num_ranges, cartesian_scan);
+    }
+
+#else
+
+    /**
+     * \brief Fallback for architectures without the AVX2 kernels
+     */
+    unsigned int SickPLSCartesianConverter::_convertAVX2(const uint16_t* const ranges, const unsigned int num_ranges,
+                                                         sick_pls_cartesian_scan_t& cartesian_scan) const {
+        return _convertScalar(ranges, 0, num_ranges, cartesian_scan);
+    }
+
+    /**
+     * \brief Fallback for architectures without the AVX2 kernels
+     */
+    unsigned int SickPLSCartesianConverter::_convertAVX2(const unsigned int* const ranges, const unsigned int num_ranges,
+                                                         sick_pls_cartesian_scan_t& cartesian_scan) const {
+        return _convertScalar(ranges, 0, num_ranges, cartesian_scan);
+    }
+
+#endif
+
+} /* namespace sickpls */
@@ -0,0 +1,169 @@
+/*!
+ * \file SickPLSCartesian.hh
+ * \brief Defines a class for converting Sick PLS range
+ *        scans into Cartesian coordinates.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_CARTESIAN_HH
+#define SICK_PLS_CARTESIAN_HH
+
+/* Definition dependencies */
+#include <cstdint>
+
+#include "SickPLS.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define SICK_PLS_CARTESIAN_MAX_POINTS                                      (728)  ///< SICK_MAX_NUM_MEASUREMENTS rounded up to a multiple of 8
+#define DEFAULT_SICK_PLS_MIN_VALID_RANGE                                     (1)  ///< Smallest range value treated as a valid return (cm)
+#define DEFAULT_SICK_PLS_MAX_VALID_RANGE                                  (5000)  ///< Range values at or beyond this are "no return" (cm)
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \struct sick_pls_cartesian_scan_tag
+     * \brief A structure holding a scan in Cartesian (SoA) form.
+     *        Coordinates are in meters; valid[i] is 1 if beam i
+     *        produced a usable return and 0 otherwise.
+     */
+    /*!
+     * \typedef sick_pls_cartesian_scan_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_cartesian_scan_tag {
+        unsigned int num_points;                                                   ///< Number of beams converted
+        unsigned int num_valid;                                                    ///< Number of beams flagged valid
+        alignas(32) float x[SICK_PLS_CARTESIAN_MAX_POINTS];                       ///< x coordinates (m)
+        alignas(32) float y[SICK_PLS_CARTESIAN_MAX_POINTS];                       ///< y coordinates (m)
+        alignas(32) uint8_t valid[SICK_PLS_CARTESIAN_MAX_POINTS];                 ///< Validity mask (one byte per beam)
+    } sick_pls_cartesian_scan_t;
+
+    /*!
+     * \brief Converts polar range scans into Cartesian coordinates
+     *
+     * The sin/cos of every beam are tabulated once (with the mounting pose
+     * folded in), so a conversion is a single FMA pass over the ranges.
+     *
+     * Frame convention: x points straight ahead of the sensor, y to its left,
+     * and beam 0 of a full 180 degree scan lies along -y (angle -90 deg).
+     */
+    class SickPLSCartesianConverter {
+
+    public:
+
+        /** Constructs a converter for the given scan geometry */
+        explicit SickPLSCartesianConverter(double scan_angle = 180.0,
+                                           double scan_resolution = 0.5,
+                                           unsigned int first_beam = 0,
+                                           unsigned int num_beams = 0) noexcept(false);
+
+        /** Constructs a converter using the geometry reported by an initialized device */
+        explicit SickPLSCartesianConverter(const SickPLS& sick_pls,
+                                           unsigned int first_beam = 0,
+                                           unsigned int num_beams = 0) noexcept(false);
+
+        /** Sets the sensor pose in the output frame (m, m, rad) */
+        void SetMountingPose(double x, double y, double theta);
+
+        /** Sets the range window (cm) outside of which beams are flagged invalid */
+        void SetValidRange(unsigned int min_range, unsigned int max_range) noexcept(false);
+
+        /** Converts a decoded scan */
+        unsigned int Convert(const uint16_t* ranges, unsigned int num_ranges,
+                             sick_pls_cartesian_scan_t& cartesian_scan) const noexcept(false);
+
+        /** Converts a scan as returned by SickPLS::GetSickScan */
+        unsigned int Convert(const unsigned int* ranges, unsigned int num_ranges,
+                             sick_pls_cartesian_scan_t& cartesian_scan) const noexcept(false);
+
+        /** Gets the number of beams covered by the angle tables */
+        [[nodiscard]] unsigned int GetNumBeams() const { return _num_beams; }
+
+        /** Gets the index of the first tabulated beam */
+        [[nodiscard]] unsigned int GetFirstBeam() const { return _first_beam; }
+
+        /** Gets the angular resolution (rad) */
+        [[nodiscard]] double GetResolution() const { return _resolution; }
+
+        /** Gets the bearing of the given (table relative) beam in the sensor frame (rad) */
+        [[nodiscard]] double GetBeamAngle(unsigned int beam) const { return _start_angle + beam * _resolution; }
+
+        /** Gets the beam cosine table (sensor frame, unit length) */
+        [[nodiscard]] const float* GetCosTable() const { return _cos_table; }
+
+        /** Gets the beam sine table (sensor frame, unit length) */
+        [[nodiscard]] const float* GetSinTable() const { return _sin_table; }
+
+        /** Gets the sensor pose in the output frame (m, m, rad) */
+        void GetMountingPose(double& x, double& y, double& theta) const { x = _pose_x; y = _pose_y; theta = _pose_theta; }
+
+        /** Gets the minimum valid range (cm) */
+        [[nodiscard]] unsigned int GetMinValidRange() const { return _min_valid_range; }
+
+        /** Gets the maximum valid range (cm, exclusive) */
+        [[nodiscard]] unsigned int GetMaxValidRange() const { return _max_valid_range; }
+
+    private:
+
+        /** Index of the first beam tabulated */
+        unsigned int _first_beam;
+
+        /** Number of beams tabulated */
+        unsigned int _num_beams;
+
+        /** Bearing of the first tabulated beam (rad) */
+        double _start_angle;
+
+        /** Angular step between beams (rad) */
+        double _resolution;
+
+        /** Mounting pose */
+        double _pose_x, _pose_y, _pose_theta;
+
+        /** Valid range window (cm) */
+        unsigned int _min_valid_range, _max_valid_range;
+
+        /** Unit bearing vectors in the sensor frame */
+        alignas(32) float _cos_table[SICK_PLS_CARTESIAN_MAX_POINTS];
+        alignas(32) float _sin_table[SICK_PLS_CARTESIAN_MAX_POINTS];
+
+        /** Bearing vectors with the mounting rotation and cm->m scale folded in */
+        alignas(32) float _x_table[SICK_PLS_CARTESIAN_MAX_POINTS];
+        alignas(32) float _y_table[SICK_PLS_CARTESIAN_MAX_POINTS];
+
+        /** Builds the angle tables */
+        void _buildTables(double scan_angle, double scan_resolution,
+                          unsigned int first_beam, unsigned int num_beams) noexcept(false);
+
+        /** Refreshes the pose-dependent tables */
+        void _buildPoseTables();
+
+        /** Scalar conversion of beams [begin,end) */
+        template<class RANGE_TYPE>
+        unsigned int _convertScalar(const RANGE_TYPE* ranges, unsigned int begin, unsigned int end,
+                                    sick_pls_cartesian_scan_t& cartesian_scan) const;
+
+        /** AVX2/FMA conversion of 16-bit ranges */
+        unsigned int _convertAVX2(const uint16_t* ranges, unsigned int num_ranges,
+                                  sick_pls_cartesian_scan_t& cartesian_scan) const;
+
+        /** AVX2/FMA conversion of 32-bit ranges */
+        unsigned int _convertAVX2(const unsigned int* ranges, unsigned int num_ranges,
+                                  sick_pls_cartesian_scan_t& cartesian_scan) const;
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_CARTESIAN_HH */
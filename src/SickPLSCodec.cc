@@ -0,0 +1,686 @@
+/*!
+ * \file SickPLSCodec.cc
+ * \brief Implements a compact codec for storing and shipping
+ *        Sick PLS scans.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <cstring>
+
+#include "SickPLSCodec.hh"
+#include "SickPLSSimd.hh"
+#include "SickException.hh"
+
+/*
+ * NOTE: SSE2 is part of the x86-64 baseline, so the 8-lane kernels below
+ *       need neither a target attribute nor a runtime check. Defining
+ *       SICK_PLS_CODEC_DISABLE_SIMD builds the scalar kernels instead
+ *       (codeccheck compares the two).
+ */
+#if defined(SICK_PLS_HAVE_X86_SIMD) && defined(__SSE2__) && !defined(SICK_PLS_CODEC_DISABLE_SIMD)
+#define SICK_PLS_CODEC_SSE2 1
+#endif
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Gets an upper bound on the encoded size of a scan
+     * \param num_values Number of measurements
+     * \return The largest number of bytes Encode() can write
+     */
+    size_t SickPLSScanCodec::GetMaxEncodedSize(const unsigned int num_values) {
+
+        const unsigned int num_deltas = (num_values > 0) ? num_values - 1 : 0;
+        const unsigned int num_tail = num_deltas % SICK_PLS_CODEC_BLOCK_SIZE;
+
+        /* A block never costs more than its values packed at full width */
+        return SICK_PLS_CODEC_HEADER_SIZE +
+               (num_deltas / SICK_PLS_CODEC_BLOCK_SIZE) * (2 + SICK_PLS_CODEC_BLOCK_SIZE * 2) +
+               ((num_tail > 0) ? 2 + num_tail * 2 : 0) +
+               (3 * num_values + 7) / 8;
+    }
+
+    /**
+     * \brief Encodes measurement words
+     * \param *values Measurement words (13-bit range | 3 flag bits << 13)
+     * \param num_values Number of measurements (at most SickPLS::SICK_MAX_NUM_MEASUREMENTS)
+     * \param *encoded Destination buffer (at least GetMaxEncodedSize(num_values) bytes)
+     * \return The encoded size (bytes)
+     */
+    size_t SickPLSScanCodec::Encode(const uint16_t* const values, const unsigned int num_values,
+                                    uint8_t* const encoded) noexcept(false) {
+
+        /* Ensure the scan fits */
+        if (num_values > SickPLS::SICK_MAX_NUM_MEASUREMENTS) {
+            throw SickConfigException("SickPLSScanCodec::Encode: Too many values!");
+        }
+
+        /* Are there any flags to store? */
+        const bool any_flags = _anyFlags(values, num_values);
+
+        /* Header */
+        const uint16_t first_range = (num_values > 0) ? values[0] & SICK_PLS_CODEC_RANGE_MASK : 0;
+        encoded[0] = SICK_PLS_CODEC_MAGIC & 0xFF;
+        encoded[1] = SICK_PLS_CODEC_MAGIC >> 8;
+        encoded[2] = num_values & 0xFF;
+        encoded[3] = num_values >> 8;
+        encoded[4] = first_range & 0xFF;
+        encoded[5] = first_range >> 8;
+        encoded[6] = any_flags ? SICK_PLS_CODEC_FLAGS_PACKED : SICK_PLS_CODEC_FLAGS_NONE;
+        encoded[7] = 0;
+
+        size_t length = SICK_PLS_CODEC_HEADER_SIZE;
+
+        if (num_values == 0) {
+            return length;
+        }
+
+        /* Ranges */
+        uint16_t deltas[SickPLS::SICK_MAX_NUM_MEASUREMENTS];
+        const unsigned int num_deltas = num_values - 1;
+        _computeDeltas(values, num_values, deltas);
+
+        for (unsigned int i = 0; i < num_deltas; i += SICK_PLS_CODEC_BLOCK_SIZE) {
+            const unsigned int count = (num_deltas - i < SICK_PLS_CODEC_BLOCK_SIZE) ? num_deltas - i : SICK_PLS_CODEC_BLOCK_SIZE;
+            length += _encodeBlock(&deltas[i], count, &encoded[length]);
+        }
+
+        /* Flags */
+        if (any_flags) {
+
+            const size_t flags_length = (3 * num_values + 7) / 8;
+            memset(&encoded[length], 0, flags_length);
+
+            for (unsigned int i = 0; i < num_values; i++) {
+                const unsigned int bit = 3 * i;
+                const unsigned int flags = (unsigned int) (values[i] >> SICK_PLS_CODEC_FLAGS_SHIFT) << (bit % 8);
+                encoded[length + bit / 8] |= (uint8_t) flags;
+                if (bit % 8 > 5) {
+                    encoded[length + bit / 8 + 1] |= (uint8_t) (flags >> 8);
+                }
+            }
+
+            length += flags_length;
+
+        }
+
+        return length;
+    }
+
+    /**
+     * \brief Encodes a scan as returned by SickPLS::GetSickScan
+     * \param *values Range values (cm)
+     * \param num_values Number of values (at most SickPLS::SICK_MAX_NUM_MEASUREMENTS)
+     * \param *encoded Destination buffer (at least GetMaxEncodedSize(num_values) bytes)
+     * \return The encoded size (bytes)
+     */
+    size_t SickPLSScanCodec::Encode(const unsigned int* const values, const unsigned int num_values,
+                                    uint8_t* const encoded) noexcept(false) {
+
+        /* Ensure the scan fits */
+        if (num_values > SickPLS::SICK_MAX_NUM_MEASUREMENTS) {
+            throw SickConfigException("SickPLSScanCodec::Encode: Too many values!");
+        }
+
+        uint16_t words[SickPLS::SICK_MAX_NUM_MEASUREMENTS];
+        for (unsigned int i = 0; i < num_values; i++) {
+            words[i] = (uint16_t) values[i];
+        }
+
+        return Encode(words, num_values, encoded);
+    }
+
+    /**
+     * \brief Decodes measurement words
+     * \param *encoded The encoded scan
+     * \param encoded_length Its size (bytes)
+     * \param *values Destination buffer (SickPLS::SICK_MAX_NUM_MEASUREMENTS words)
+     * \param &num_values The number of measurements decoded
+     */
+    void SickPLSScanCodec::Decode(const uint8_t* const encoded, const size_t encoded_length,
+                                  uint16_t* const values, unsigned int& num_values) noexcept(false) {
+
+        /* Header */
+        if (encoded_length < SICK_PLS_CODEC_HEADER_SIZE ||
+            (encoded[0] | encoded[1] << 8) != SICK_PLS_CODEC_MAGIC) {
+            throw SickIOException("SickPLSScanCodec::Decode: Not an encoded scan!");
+        }
+
+        const unsigned int count = encoded[2] | encoded[3] << 8;
+        const uint16_t first_range = (uint16_t) (encoded[4] | encoded[5] << 8);
+        const uint8_t flags_encoding = encoded[6];
+
+        if (count > SickPLS::SICK_MAX_NUM_MEASUREMENTS || flags_encoding > SICK_PLS_CODEC_FLAGS_PACKED) {
+            throw SickIOException("SickPLSScanCodec::Decode: Corrupt header!");
+        }
+
+        size_t length = SICK_PLS_CODEC_HEADER_SIZE;
+
+        if (count > 0) {
+
+            /* Ranges */
+            uint16_t deltas[SickPLS::SICK_MAX_NUM_MEASUREMENTS];
+            const unsigned int num_deltas = count - 1;
+
+            for (unsigned int i = 0; i < num_deltas; i += SICK_PLS_CODEC_BLOCK_SIZE) {
+                const unsigned int block = (num_deltas - i < SICK_PLS_CODEC_BLOCK_SIZE) ? num_deltas - i : SICK_PLS_CODEC_BLOCK_SIZE;
+                length += _decodeBlock(&encoded[length], encoded_length - length, block, &deltas[i]);
+            }
+
+            _restoreRanges(first_range, deltas, num_deltas, values);
+
+            /* Flags */
+            if (flags_encoding == SICK_PLS_CODEC_FLAGS_PACKED) {
+
+                const size_t flags_length = (3 * count + 7) / 8;
+                if (encoded_length - length < flags_length) {
+                    throw SickIOException("SickPLSScanCodec::Decode: Truncated flags!");
+                }
+
+                const uint8_t* const flags = &encoded[length];
+                for (unsigned int i = 0; i < count; i++) {
+                    const unsigned int bit = 3 * i;
+                    unsigned int bits = flags[bit / 8] >> (bit % 8);
+                    if (bit % 8 > 5) {
+                        bits |= flags[bit / 8 + 1] << (8 - bit % 8);
+                    }
+                    values[i] |= (uint16_t) ((bits & 0x7) << SICK_PLS_CODEC_FLAGS_SHIFT);
+                }
+
+                length += flags_length;
+
+            }
+
+        }
+
+        if (length != encoded_length) {
+            throw SickIOException("SickPLSScanCodec::Decode: Trailing bytes!");
+        }
+
+        num_values = count;
+    }
+
+    /**
+     * \brief Decodes ranges in the SickPLS::GetSickScan format
+     * \param *encoded The encoded scan
+     * \param encoded_length Its size (bytes)
+     * \param *values Destination buffer (SickPLS::SICK_MAX_NUM_MEASUREMENTS values)
+     * \param &num_values The number of values decoded
+     */
+    void SickPLSScanCodec::Decode(const uint8_t* const encoded, const size_t encoded_length,
+                                  unsigned int* const values, unsigned int& num_values) noexcept(false) {
+
+        uint16_t words[SickPLS::SICK_MAX_NUM_MEASUREMENTS];
+        Decode(encoded, encoded_length, words, num_values);
+
+        for (unsigned int i = 0; i < num_values; i++) {
+            values[i] = words[i] & SICK_PLS_CODEC_RANGE_MASK;
+        }
+
+    }
+
+    /**
+     * \brief Checks whether any measurement has a flag bit set
+     * \param *values Measurement words
+     * \param num_values Number of measurements
+     * \return True if any flag bit is set
+     */
+    bool SickPLSScanCodec::_anyFlags(const uint16_t* const values, const unsigned int num_values) {
+
+        unsigned int any_bits = 0;
+        unsigned int i = 0;
+
+#ifdef SICK_PLS_CODEC_SSE2
+        __m128i any_bits_vector = _mm_setzero_si128();
+        for (; i + 8 <= num_values; i += 8) {
+            any_bits_vector = _mm_or_si128(any_bits_vector, _mm_loadu_si128((const __m128i*) &values[i]));
+        }
+        any_bits_vector = _mm_srli_epi16(any_bits_vector, SICK_PLS_CODEC_FLAGS_SHIFT);
+        any_bits = 0xFFFF ^ (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi16(any_bits_vector, _mm_setzero_si128()));
+#endif
+
+        for (; i < num_values; i++) {
+            any_bits |= values[i] >> SICK_PLS_CODEC_FLAGS_SHIFT;
+        }
+
+        return any_bits != 0;
+    }
+
+    /**
+     * \brief Computes zigzag deltas between neighbouring ranges
+     * \param *values Measurement words
+     * \param num_values Number of measurements (> 0)
+     * \param *deltas num_values - 1 zigzag deltas
+     */
+    void SickPLSScanCodec::_computeDeltas(const uint16_t* const values, const unsigned int num_values,
+                                          uint16_t* const deltas) {
+
+        const unsigned int num_deltas = num_values - 1;
+        unsigned int i = 0;
+
+#ifdef SICK_PLS_CODEC_SSE2
+        const __m128i mask = _mm_set1_epi16(SICK_PLS_CODEC_RANGE_MASK);
+        for (; i + 8 <= num_deltas; i += 8) {
+            const __m128i next = _mm_and_si128(_mm_loadu_si128((const __m128i*) &values[i + 1]), mask);
+            const __m128i prev = _mm_and_si128(_mm_loadu_si128((const __m128i*) &values[i]), mask);
+            const __m128i delta = _mm_sub_epi16(next, prev);
+            _mm_storeu_si128((__m128i*) &deltas[i],
+                             _mm_xor_si128(_mm_slli_epi16(delta, 1), _mm_srai_epi16(delta, 15)));
+        }
+#endif
+
+        for (; i < num_deltas; i++) {
+            const int delta = (int) (values[i + 1] & SICK_PLS_CODEC_RANGE_MASK) - (int) (values[i] & SICK_PLS_CODEC_RANGE_MASK);
+            deltas[i] = (uint16_t) ((delta << 1) ^ (delta >> 31));
+        }
+
+    }
+
+    /**
+     * \brief Undoes _computeDeltas (prefix sum of the decoded deltas)
+     * \param first_range Range of the first beam
+     * \param *deltas The zigzag deltas
+     * \param num_deltas Number of deltas
+     * \param *values num_deltas + 1 ranges
+     */
+    void SickPLSScanCodec::_restoreRanges(const uint16_t first_range, const uint16_t* const deltas,
+                                          const unsigned int num_deltas, uint16_t* const values) {
+
+        values[0] = first_range;
+        unsigned int i = 0;
+
+#ifdef SICK_PLS_CODEC_SSE2
+        const __m128i one = _mm_set1_epi16(1);
+        __m128i carry = _mm_set1_epi16((short) first_range);
+        for (; i + 8 <= num_deltas; i += 8) {
+
+            /* Unzigzag */
+            const __m128i zigzag = _mm_loadu_si128((const __m128i*) &deltas[i]);
+            __m128i sum = _mm_xor_si128(_mm_srli_epi16(zigzag, 1),
+                                        _mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(zigzag, one)));
+
+            /* In-register prefix sum, then add the running range */
+            sum = _mm_add_epi16(sum, _mm_slli_si128(sum, 2));
+            sum = _mm_add_epi16(sum, _mm_slli_si128(sum, 4));
+            sum = _mm_add_epi16(sum, _mm_slli_si128(sum, 8));
+            sum = _mm_add_epi16(sum, carry);
+            _mm_storeu_si128((__m128i*) &values[i + 1], sum);
+
+            /* Broadcast the last lane */
+            carry = _mm_shufflehi_epi16(sum, 0xFF);
+            carry = _mm_unpackhi_epi64(carry, carry);
+
+        }
+#endif
+
+        for (; i < num_deltas; i++) {
+            const unsigned int zigzag = deltas[i];
+            values[i + 1] = (uint16_t) (values[i] + ((zigzag >> 1) ^ (0u - (zigzag & 1))));
+        }
+
+    }
+
+    /**
+     * \brief Encodes a run of deltas
+     * \param *deltas The zigzag deltas
+     * \param num_deltas Number of deltas (a full block or the tail)
+     * \param *encoded Destination
+     * \return The bytes written
+     */
+    size_t SickPLSScanCodec::_encodeBlock(const uint16_t* const deltas, const unsigned int num_deltas,
+                                          uint8_t* const encoded) {
+
+        const bool full = (num_deltas == SICK_PLS_CODEC_BLOCK_SIZE);
+
+        /* The widest value bounds the width */
+        unsigned int any_bits = 0;
+        unsigned int first = 0;
+#ifdef SICK_PLS_CODEC_SSE2
+        __m128i any_bits_vector = _mm_setzero_si128();
+        for (; first + 8 <= num_deltas; first += 8) {
+            any_bits_vector = _mm_or_si128(any_bits_vector, _mm_loadu_si128((const __m128i*) &deltas[first]));
+        }
+        any_bits_vector = _mm_or_si128(any_bits_vector, _mm_srli_si128(any_bits_vector, 8));
+        any_bits_vector = _mm_or_si128(any_bits_vector, _mm_srli_si128(any_bits_vector, 4));
+        any_bits_vector = _mm_or_si128(any_bits_vector, _mm_srli_si128(any_bits_vector, 2));
+        any_bits = (unsigned int) _mm_cvtsi128_si32(any_bits_vector) & 0xFFFF;
+#endif
+        for (; first < num_deltas; first++) {
+            any_bits |= deltas[first];
+        }
+
+        const unsigned int max_width = any_bits ? 32 - __builtin_clz(any_bits) : 0;
+
+        /* Narrow it while packed bytes + 3 bytes per exception keep shrinking */
+        unsigned int width = max_width;
+        unsigned int num_exceptions = 0;
+        size_t best_size = full ? 16 * max_width : (num_deltas * max_width + 7) / 8;
+
+        for (unsigned int w = max_width; w-- > 0;) {
+
+            const unsigned int num_above = _countAbove(deltas, num_deltas, (uint16_t) ((1u << w) - 1));
+
+            /* Narrower widths only add exceptions */
+            if (3 * num_above >= best_size) {
+                break;
+            }
+
+            const size_t size = (full ? 16 * w : (num_deltas * w + 7) / 8) + 3 * num_above;
+            if (size < best_size) {
+                best_size = size;
+                width = w;
+                num_exceptions = num_above;
+            }
+
+        }
+
+        encoded[0] = (uint8_t) width;
+        encoded[1] = (uint8_t) num_exceptions;
+        size_t length = 2;
+
+        /* Low bits */
+        if (full) {
+            _packBlock(deltas, width, &encoded[length]);
+            length += 16 * width;
+        } else {
+
+            const unsigned int mask = (1u << width) - 1;
+            const size_t packed_length = (num_deltas * width + 7) / 8;
+
+            uint32_t buffer = 0;
+            unsigned int num_bits = 0;
+            size_t j = length;
+            for (unsigned int i = 0; i < num_deltas; i++) {
+                buffer |= (deltas[i] & mask) << num_bits;
+                num_bits += width;
+                while (num_bits >= 8) {
+                    encoded[j++] = (uint8_t) buffer;
+                    buffer >>= 8;
+                    num_bits -= 8;
+                }
+            }
+            if (num_bits > 0) {
+                encoded[j] = (uint8_t) buffer;
+            }
+
+            length += packed_length;
+
+        }
+
+        /* Exceptions */
+        if (num_exceptions > 0) {
+
+            uint8_t* const positions = &encoded[length];
+            uint8_t* const high_bits = &encoded[length + num_exceptions];
+            unsigned int k = 0;
+            unsigned int j = 0;
+
+#ifdef SICK_PLS_CODEC_SSE2
+            /* Skip rows without exceptions */
+            const __m128i bound = _mm_set1_epi16((short) ((1u << width) - 1));
+            for (; j + 8 <= num_deltas; j += 8) {
+                unsigned int above = (unsigned int) _mm_movemask_epi8(
+                        _mm_cmpgt_epi16(_mm_loadu_si128((const __m128i*) &deltas[j]), bound));
+                while (above) {
+                    positions[k++] = (uint8_t) (j + __builtin_ctz(above) / 2);
+                    above &= above - 1;
+                    above &= above - 1;
+                }
+            }
+#endif
+
+            for (; j < num_deltas; j++) {
+                if (deltas[j] >> width) {
+                    positions[k++] = (uint8_t) j;
+                }
+            }
+
+            for (k = 0; k < num_exceptions; k++) {
+                const unsigned int high = deltas[positions[k]] >> width;
+                high_bits[2 * k] = (uint8_t) high;
+                high_bits[2 * k + 1] = (uint8_t) (high >> 8);
+            }
+
+            length += 3 * num_exceptions;
+
+        }
+
+        return length;
+    }
+
+    /**
+     * \brief Decodes a run of deltas
+     * \param *encoded The encoded block
+     * \param encoded_length Bytes available
+     * \param num_deltas Number of deltas (a full block or the tail)
+     * \param *deltas Destination
+     * \return The bytes consumed
+     */
+    size_t SickPLSScanCodec::_decodeBlock(const uint8_t* const encoded, const size_t encoded_length,
+                                          const unsigned int num_deltas, uint16_t* const deltas) noexcept(false) {
+
+        const bool full = (num_deltas == SICK_PLS_CODEC_BLOCK_SIZE);
+
+        if (encoded_length < 2) {
+            throw SickIOException("SickPLSScanCodec::_decodeBlock: Truncated block!");
+        }
+
+        const unsigned int width = encoded[0];
+        const unsigned int num_exceptions = encoded[1];
+        const size_t packed_length = full ? 16 * width : (num_deltas * width + 7) / 8;
+
+        if (width > 16 || num_exceptions > num_deltas || (num_exceptions > 0 && width == 16)) {
+            throw SickIOException("SickPLSScanCodec::_decodeBlock: Corrupt block!");
+        }
+
+        if (encoded_length < 2 + packed_length + 3 * num_exceptions) {
+            throw SickIOException("SickPLSScanCodec::_decodeBlock: Truncated block!");
+        }
+
+        /* Low bits */
+        if (full) {
+            _unpackBlock(&encoded[2], width, deltas);
+        } else {
+
+            const unsigned int mask = (1u << width) - 1;
+
+            uint32_t buffer = 0;
+            unsigned int num_bits = 0;
+            size_t j = 2;
+            for (unsigned int i = 0; i < num_deltas; i++) {
+                while (num_bits < width) {
+                    buffer |= (uint32_t) encoded[j++] << num_bits;
+                    num_bits += 8;
+                }
+                deltas[i] = (uint16_t) (buffer & mask);
+                buffer >>= width;
+                num_bits -= width;
+            }
+
+        }
+
+        /* Patch in the exceptions */
+        const uint8_t* const positions = &encoded[2 + packed_length];
+        const uint8_t* const high_bits = positions + num_exceptions;
+        for (unsigned int k = 0; k < num_exceptions; k++) {
+            if (positions[k] >= num_deltas) {
+                throw SickIOException("SickPLSScanCodec::_decodeBlock: Corrupt exception!");
+            }
+            deltas[positions[k]] |= (uint16_t) ((high_bits[2 * k] | high_bits[2 * k + 1] << 8) << width);
+        }
+
+        return 2 + packed_length + 3 * num_exceptions;
+    }
+
+    /**
+     * \brief Counts the values that do not fit below a bound
+     * \param *deltas The zigzag deltas (at most 0x7FFF, as produced from 13-bit ranges)
+     * \param num_deltas Number of deltas
+     * \param bound Largest value that fits
+     * \return The number of values greater than bound
+     */
+    unsigned int SickPLSScanCodec::_countAbove(const uint16_t* const deltas, const unsigned int num_deltas,
+                                               const uint16_t bound) {
+
+        unsigned int num_above = 0;
+        unsigned int i = 0;
+
+#ifdef SICK_PLS_CODEC_SSE2
+        const __m128i bound_vector = _mm_set1_epi16((short) bound);
+        __m128i count = _mm_setzero_si128();
+        for (; i + 8 <= num_deltas; i += 8) {
+            const __m128i above = _mm_cmpgt_epi16(_mm_loadu_si128((const __m128i*) &deltas[i]), bound_vector);
+            count = _mm_sub_epi16(count, above);
+        }
+        count = _mm_madd_epi16(count, _mm_set1_epi16(1));
+        count = _mm_add_epi32(count, _mm_srli_si128(count, 8));
+        count = _mm_add_epi32(count, _mm_srli_si128(count, 4));
+        num_above = (unsigned int) _mm_cvtsi128_si32(count);
+#endif
+
+        for (; i < num_deltas; i++) {
+            num_above += (deltas[i] > bound);
+        }
+
+        return num_above;
+    }
+
+    /**
+     * \brief Vertically packs a full block of width-bit values
+     * \param *deltas SICK_PLS_CODEC_BLOCK_SIZE values
+     * \param width Bits kept per value (higher bits are dropped)
+     * \param *packed 16 * width bytes
+     *
+     * Value i goes to 16-bit lane i % 8; each lane fills its 16-bit words
+     * from the least significant bit up, spilling into the next word.
+     */
+    void SickPLSScanCodec::_packBlock(const uint16_t* const deltas, const unsigned int width, uint8_t* const packed) {
+
+        if (width == 0) {
+            return;
+        }
+
+#ifdef SICK_PLS_CODEC_SSE2
+
+        const __m128i mask = _mm_set1_epi16((short) ((1u << width) - 1));
+        auto* out = (__m128i*) packed;
+
+        __m128i word = _mm_setzero_si128();
+        unsigned int num_bits = 0;
+        for (unsigned int row = 0; row < SICK_PLS_CODEC_BLOCK_SIZE / SICK_PLS_CODEC_LANES; row++) {
+            const __m128i value = _mm_and_si128(_mm_loadu_si128((const __m128i*) &deltas[row * SICK_PLS_CODEC_LANES]), mask);
+            word = _mm_or_si128(word, _mm_sll_epi16(value, _mm_cvtsi32_si128((int) num_bits)));
+            num_bits += width;
+            if (num_bits >= 16) {
+                _mm_storeu_si128(out++, word);
+                num_bits -= 16;
+                word = num_bits ? _mm_srl_epi16(value, _mm_cvtsi32_si128((int) (width - num_bits))) : _mm_setzero_si128();
+            }
+        }
+
+#else
+
+        const unsigned int mask = (1u << width) - 1;
+        uint8_t* out = packed;
+
+        uint16_t word[SICK_PLS_CODEC_LANES] = {0};
+        unsigned int num_bits = 0;
+        for (unsigned int row = 0; row < SICK_PLS_CODEC_BLOCK_SIZE / SICK_PLS_CODEC_LANES; row++) {
+            const unsigned int next_bits = num_bits + width;
+            for (unsigned int lane = 0; lane < SICK_PLS_CODEC_LANES; lane++) {
+                const unsigned int value = deltas[row * SICK_PLS_CODEC_LANES + lane] & mask;
+                word[lane] |= (uint16_t) (value << num_bits);
+                if (next_bits >= 16) {
+                    out[2 * lane] = (uint8_t) word[lane];
+                    out[2 * lane + 1] = (uint8_t) (word[lane] >> 8);
+                    word[lane] = (next_bits > 16) ? (uint16_t) (value >> (width - (next_bits - 16))) : 0;
+                }
+            }
+            if (next_bits >= 16) {
+                out += 2 * SICK_PLS_CODEC_LANES;
+            }
+            num_bits = next_bits % 16;
+        }
+
+#endif
+
+    }
+
+    /**
+     * \brief Undoes _packBlock
+     * \param *packed 16 * width bytes
+     * \param width Bits per value
+     * \param *deltas SICK_PLS_CODEC_BLOCK_SIZE values
+     */
+    void SickPLSScanCodec::_unpackBlock(const uint8_t* const packed, const unsigned int width, uint16_t* const deltas) {
+
+        if (width == 0) {
+            memset(deltas, 0, SICK_PLS_CODEC_BLOCK_SIZE * sizeof(uint16_t));
+            return;
+        }
+
+        const unsigned int num_rows = SICK_PLS_CODEC_BLOCK_SIZE / SICK_PLS_CODEC_LANES;
+
+#ifdef SICK_PLS_CODEC_SSE2
+
+        const __m128i mask = _mm_set1_epi16((short) ((1u << width) - 1));
+        const auto* in = (const __m128i*) packed;
+
+        __m128i word = _mm_loadu_si128(in++);
+        unsigned int num_bits = 0;
+        for (unsigned int row = 0; row < num_rows; row++) {
+            __m128i value = _mm_srl_epi16(word, _mm_cvtsi32_si128((int) num_bits));
+            num_bits += width;
+            if (num_bits > 16) {
+                word = _mm_loadu_si128(in++);
+                num_bits -= 16;
+                value = _mm_or_si128(value, _mm_sll_epi16(word, _mm_cvtsi32_si128((int) (width - num_bits))));
+            } else if (num_bits == 16 && row + 1 < num_rows) {
+                word = _mm_loadu_si128(in++);
+                num_bits = 0;
+            }
+            _mm_storeu_si128((__m128i*) &deltas[row * SICK_PLS_CODEC_LANES], _mm_and_si128(value, mask));
+        }
+
+#else
+
+        const unsigned int mask = (1u << width) - 1;
+        const uint8_t* in = packed;
+
+        unsigned int num_bits = 0;
+        for (unsigned int row = 0; row < num_rows; row++) {
+            const unsigned int next_bits = num_bits + width;
+            for (unsigned int lane = 0; lane < SICK_PLS_CODEC_LANES; lane++) {
+                unsigned int value = (unsigned int) (in[2 * lane] | in[2 * lane + 1] << 8) >> num_bits;
+                if (next_bits > 16) {
+                    const unsigned int next = in[2 * SICK_PLS_CODEC_LANES + 2 * lane] |
+                                              in[2 * SICK_PLS_CODEC_LANES + 2 * lane + 1] << 8;
+                    value |= next << (width - (next_bits - 16));
+                }
+                deltas[row * SICK_PLS_CODEC_LANES + lane] = (uint16_t) (value & mask);
+            }
+            if (next_bits >= 16) {
+                in += 2 * SICK_PLS_CODEC_LANES;
+            }
+            num_bits = next_bits % 16;
+        }
+
+#endif
+
+    }
+
+} /* namespace sickpls */
@@ -0,0 +1,323 @@
+/*!
+ * \file SickPLSCollision.cc
+ * \brief Implements a footprint collision and time-to-collision
+ *        checker for velocity commands against Sick PLS scans.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <cmath>
+#include <limits>
+
+#include "SickPLSCollision.hh"
+#include "SickPLSSimd.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief A standard constructor (no footprint, no points)
+     */
+    SickPLSCollisionChecker::SickPLSCollisionChecker() :
+            _num_edges(0), _edge_nx(), _edge_ny(), _edge_d(), _footprint_radius(0),
+            _horizon(DEFAULT_SICK_PLS_COLLISION_HORIZON), _time_step(DEFAULT_SICK_PLS_COLLISION_TIME_STEP),
+            _max_speed(0), _num_points(0), _x(), _y() {}
+
+    /**
+     * \brief Sets the footprint polygon
+     * \param *x Vertex x coordinates (robot frame, m)
+     * \param *y Vertex y coordinates (robot frame, m)
+     * \param num_vertices Number of vertices (3 to SICK_PLS_COLLISION_MAX_VERTICES, either winding)
+     */
+    void SickPLSCollisionChecker::SetFootprint(const double* const x, const double* const y,
+                                               const unsigned int num_vertices) noexcept(false) {
+
+        /* A sanity check */
+        if (num_vertices < 3 || num_vertices > SICK_PLS_COLLISION_MAX_VERTICES) {
+            throw SickConfigException("SickPLSCollisionChecker::SetFootprint: Invalid number of vertices!");
+        }
+
+        /* Signed area gives the winding */
+        double area = 0;
+        for (unsigned int i = 0; i < num_vertices; i++) {
+            const unsigned int j = (i + 1 == num_vertices) ? 0 : i + 1;
+            area += x[i] * y[j] - x[j] * y[i];
+        }
+        if (fabs(area) < 1e-9) {
+            throw SickConfigException("SickPLSCollisionChecker::SetFootprint: Degenerate footprint!");
+        }
+        const double winding = (area > 0) ? 1.0 : -1.0;
+
+        _footprint_radius = 0;
+        for (unsigned int i = 0; i < num_vertices; i++) {
+
+            const unsigned int j = (i + 1 == num_vertices) ? 0 : i + 1;
+            const unsigned int k = (j + 1 == num_vertices) ? 0 : j + 1;
+
+            /* Every turn must go the same way */
+            const double turn = (x[j] - x[i]) * (y[k] - y[j]) - (y[j] - y[i]) * (x[k] - x[j]);
+            if (turn * winding < 0) {
+                throw SickConfigException("SickPLSCollisionChecker::SetFootprint: Footprint is not convex!");
+            }
+
+            /* Outward normal of edge i -> j */
+            const double ex = x[j] - x[i], ey = y[j] - y[i];
+            const double length = hypot(ex, ey);
+            if (length < 1e-9) {
+                throw SickConfigException("SickPLSCollisionChecker::SetFootprint: Repeated vertex!");
+            }
+            const double nx = winding * ey / length, ny = -winding * ex / length;
+
+            _edge_nx[i] = (float) nx;
+            _edge_ny[i] = (float) ny;
+            _edge_d[i] = (float) (nx * x[i] + ny * y[i]);
+
+            _footprint_radius = fmax(_footprint_radius, hypot(x[i], y[i]));
+
+        }
+
+        _num_edges = num_vertices;
+
+    }
+
+    /**
+     * \brief Sets the look-ahead horizon
+     * \param horizon Look-ahead time (s)
+     * \param time_step Sampling step along each trajectory (s)
+     */
+    void SickPLSCollisionChecker::SetHorizon(const double horizon, const double time_step) noexcept(false) {
+
+        /* A sanity check */
+        if (horizon <= 0 || time_step <= 0 || time_step > horizon) {
+            throw SickConfigException("SickPLSCollisionChecker::SetHorizon: Invalid parameters!");
+        }
+
+        _horizon = horizon;
+        _time_step = time_step;
+
+    }
+
+    /**
+     * \brief Loads the obstacle points of a scan
+     * \param &cartesian_scan The scan (robot frame)
+     * \param max_speed Largest |v| of the commands to be evaluated (m/s)
+     */
+    void SickPLSCollisionChecker::SetScan(const sick_pls_cartesian_scan_t& cartesian_scan,
+                                          const double max_speed) noexcept(false) {
+
+        /* A sanity check */
+        if (cartesian_scan.num_points > SICK_PLS_CARTESIAN_MAX_POINTS || !std::isfinite(max_speed)) {
+            throw SickConfigException("SickPLSCollisionChecker::SetScan: Invalid scan!");
+        }
+
+        /* Anything beyond this cannot be reached within the horizon */
+        _max_speed = fabs(max_speed);
+        const double reach = _max_speed * _horizon + _footprint_radius;
+        const auto reach_sq = (float) (reach * reach);
+
+        _num_points = 0;
+        for (unsigned int i = 0; i < cartesian_scan.num_points; i++) {
+            const float x = cartesian_scan.x[i], y = cartesian_scan.y[i];
+            if (cartesian_scan.valid[i] && x * x + y * y <= reach_sq) {
+                _x[_num_points] = x;
+                _y[_num_points] = y;
+                _num_points++;
+            }
+        }
+
+        /* Pad out to the SIMD width with points that are never inside */
+        for (unsigned int i = _num_points; i < ((_num_points + 7) & ~7u); i++) {
+            _x[i] = _y[i] = 1e6f;
+        }
+
+    }
+
+    /**
+     * \brief Computes the time-to-collision of a batch of commands
+     * \param *v Forward speeds (m/s)
+     * \param *omega Turn rates (rad/s, positive => left)
+     * \param num_commands Number of commands
+     * \param *time_to_collision Destination (s; 0 if already in collision, infinity if clear within the horizon)
+     *
+     * NOTE: Points beyond the reach of SetScan's max_speed were dropped, so
+     *       a faster command could pass through them unseen and is refused.
+     */
+    void SickPLSCollisionChecker::Evaluate(const double* const v, const double* const omega,
+                                           const unsigned int num_commands,
+                                           double* const time_to_collision) const noexcept(false) {
+
+        /* Ensure there is a footprint */
+        if (_num_edges == 0) {
+            throw SickConfigException("SickPLSCollisionChecker::Evaluate: No footprint!");
+        }
+
+        /* Ensure every command stays within the reach the points were kept for */
+        for (unsigned int i = 0; i < num_commands; i++) {
+            if (!(fabs(v[i]) <= _max_speed)) {
+                throw SickConfigException("SickPLSCollisionChecker::Evaluate: Speed exceeds the one given to SetScan!");
+            }
+        }
+
+        const bool use_avx2 = sick_pls_cpu_has_avx2();
+        for (unsigned int i = 0; i < num_commands; i++) {
+            time_to_collision[i] = _timeToCollision(v[i], omega[i], use_avx2);
+        }
+
+    }
+
+    /**
+     * \brief Rolls out one command and finds its first collision
+     */
+    double SickPLSCollisionChecker::_timeToCollision(const double v, const double omega, const bool use_avx2) const {
+
+        if (_num_points == 0) {
+            return std::numeric_limits<double>::infinity();
+        }
+
+        double x, y, theta;
+        double t_clear = 0;
+        if (_collides(0, 0, 0, use_avx2)) {
+            return 0;
+        }
+
+        const auto num_steps = (unsigned int) ceil(_horizon / _time_step - 1e-9);
+        for (unsigned int step = 1; step <= num_steps; step++) {
+
+            const double t = fmin(step * _time_step, _horizon);
+            _poseAt(v, omega, t, x, y, theta);
+            if (!_collides(x, y, theta, use_avx2)) {
+                t_clear = t;
+                continue;
+            }
+
+            /* Narrow down the contact between the last clear sample and this one */
+            double t_hit = t;
+            for (unsigned int i = 0; i < DEFAULT_SICK_PLS_COLLISION_REFINE_STEPS; i++) {
+                const double t_mid = 0.5 * (t_clear + t_hit);
+                _poseAt(v, omega, t_mid, x, y, theta);
+                if (_collides(x, y, theta, use_avx2)) {
+                    t_hit = t_mid;
+                } else {
+                    t_clear = t_mid;
+                }
+            }
+
+            return t_clear;
+        }
+
+        return std::numeric_limits<double>::infinity();
+    }
+
+    /**
+     * \brief Gets the pose reached after following (v, omega) for time t
+     */
+    void SickPLSCollisionChecker::_poseAt(const double v, const double omega, const double t,
+                                          double& x, double& y, double& theta) {
+
+        theta = omega * t;
+        if (fabs(omega) < 1e-6) {
+            x = v * t;
+            y = 0;
+        } else {
+            const double radius = v / omega;
+            x = radius * sin(theta);
+            y = radius * (1.0 - cos(theta));
+        }
+
+    }
+
+    /**
+     * \brief Tests whether any point lies inside the footprint placed at (x, y, theta)
+     */
+    bool SickPLSCollisionChecker::_collides(const double x, const double y, const double theta,
+                                            const bool use_avx2) const {
+
+        /* Points are moved into the future robot frame: q = R(-theta) * (p - t) */
+        const auto c = (float) cos(theta), s = (float) sin(theta);
+        return use_avx2 ? _collidesAVX2(c, s, (float) x, (float) y) : _collidesScalar(c, s, (float) x, (float) y);
+    }
+
+    /**
+     * \brief Scalar footprint test
+     */
+    bool SickPLSCollisionChecker::_collidesScalar(const float c, const float s, const float x, const float y) const {
+
+        for (unsigned int i = 0; i < _num_points; i++) {
+
+            const float dx = _x[i] - x, dy = _y[i] - y;
+            const float qx = c * dx + s * dy;
+            const float qy = c * dy - s * dx;
+
+            bool inside = true;
+            for (unsigned int e = 0; e < _num_edges && inside; e++) {
+                inside = _edge_nx[e] * qx + _edge_ny[e] * qy <= _edge_d[e];
+            }
+            if (inside) {
+                return true;
+            }
+
+        }
+
+        return false;
+    }
+
+#ifdef SICK_PLS_HAVE_X86_SIMD
+
+    /**
+     * \brief Footprint test eight points at a time
+     */
+    SICK_PLS_TARGET_AVX2 bool SickPLSCollisionChecker::_collidesAVX2(const float c, const float s,
+                                                                     const float x, const float y) const {
+
+        const __m256 cos_v = _mm256_set1_ps(c), sin_v = _mm256_set1_ps(s);
+        const __m256 x_v = _mm256_set1_ps(x), y_v = _mm256_set1_ps(y);
+
+        for (unsigned int i = 0; i < _num_points; i += 8) {
+
+            const __m256 dx = _mm256_sub_ps(_mm256_load_ps(&_x[i]), x_v);
+            const __m256 dy = _mm256_sub_ps(_mm256_load_ps(&_y[i]), y_v);
+            const __m256 qx = _mm256_fmadd_ps(cos_v, dx, _mm256_mul_ps(sin_v, dy));
+            const __m256 qy = _mm256_fmsub_ps(cos_v, dy, _mm256_mul_ps(sin_v, dx));
+
+            /* A lane is outside if any half-plane rejects it */
+            __m256 outside = _mm256_setzero_ps();
+            for (unsigned int e = 0; e < _num_edges; e++) {
+                const __m256 dist = _mm256_fmadd_ps(_mm256_set1_ps(_edge_nx[e]), qx,
+                                                    _mm256_mul_ps(_mm256_set1_ps(_edge_ny[e]), qy));
+                outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist, _mm256_set1_ps(_edge_d[e]), _CMP_GT_OQ));
+            }
+
+            if (_mm256_movemask_ps(outside) != 0xFF) {
+                return true;
+            }
+
+        }
+
+        return false;
+    }
+
+#else
+
+    /**
+     * \brief Fallback for architectures without the AVX2 kernels
+     */
+    bool SickPLSCollisionChecker::_collidesAVX2(const float c, const float s, const float x, const float y) const {
+        return _collidesScalar(c, s, x, y);
+    }
+
+#endif
+
+} /* namespace sickpls */
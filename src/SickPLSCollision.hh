@@ -0,0 +1,126 @@
+/*!
+ * \file SickPLSCollision.hh
+ * \brief Defines a footprint collision and time-to-collision
+ *        checker for velocity commands against Sick PLS scans.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_COLLISION_HH
+#define SICK_PLS_COLLISION_HH
+
+/* Definition dependencies */
+#include <cstdint>
+
+#include "SickPLSCartesian.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define SICK_PLS_COLLISION_MAX_VERTICES                                     (16)  ///< Upper bound on the footprint's size
+#define DEFAULT_SICK_PLS_COLLISION_HORIZON                                 (3.0)  ///< Look-ahead time (s)
+#define DEFAULT_SICK_PLS_COLLISION_TIME_STEP                               (0.1)  ///< Trajectory sampling step (s)
+#define DEFAULT_SICK_PLS_COLLISION_REFINE_STEPS                              (4)  ///< Bisection steps refining the first colliding sample
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \brief Computes time-to-collision of a footprint under (v, omega) commands
+     *
+     * The footprint is a convex polygon in the robot frame (the output frame
+     * of the SickPLSCartesianConverter, i.e. with the mounting pose folded in).
+     * Each candidate command is rolled out as a constant-curvature arc sampled
+     * every time step; at each sample the scan points are moved into the
+     * robot's future frame and tested against the footprint's edge
+     * half-planes, eight points at a time. The first colliding sample is then
+     * refined by bisection.
+     *
+     * The vector lanes run across scan points rather than across the
+     * batch of commands: each command stops at its own first collision and
+     * follows its own arc, so lanes holding different commands would sit
+     * idle or need per-lane pose updates, whereas every sample of every
+     * command tests all the kept points against all the edges. The batch
+     * is evaluated one command at a time.
+     *
+     * SetScan() keeps only the points the footprint could possibly reach
+     * within the horizon at the given speed, so most of a scan is discarded
+     * before any candidate is evaluated. Evaluate() therefore rejects any
+     * command faster than that speed.
+     */
+    class SickPLSCollisionChecker {
+
+    public:
+
+        /** A standard constructor */
+        SickPLSCollisionChecker();
+
+        /** Sets the convex footprint polygon (robot frame, m) */
+        void SetFootprint(const double* x, const double* y, unsigned int num_vertices) noexcept(false);
+
+        /** Sets the look-ahead horizon and sampling step (s) */
+        void SetHorizon(double horizon, double time_step) noexcept(false);
+
+        /** Gets the look-ahead horizon (s) */
+        [[nodiscard]] double GetHorizon() const { return _horizon; }
+
+        /** Loads the obstacle points of a scan (robot frame) reachable at up to max_speed (m/s) */
+        void SetScan(const sick_pls_cartesian_scan_t& cartesian_scan, double max_speed) noexcept(false);
+
+        /** Gets the number of points kept from the last scan */
+        [[nodiscard]] unsigned int GetNumPoints() const { return _num_points; }
+
+        /** Computes the time-to-collision of a batch of (v, omega) commands (m/s, rad/s; |v| <= SetScan's max_speed) */
+        void Evaluate(const double* v, const double* omega, unsigned int num_commands,
+                      double* time_to_collision) const noexcept(false);
+
+    private:
+
+        /** Footprint half-planes: nx * x + ny * y <= d inside */
+        unsigned int _num_edges;
+        float _edge_nx[SICK_PLS_COLLISION_MAX_VERTICES];
+        float _edge_ny[SICK_PLS_COLLISION_MAX_VERTICES];
+        float _edge_d[SICK_PLS_COLLISION_MAX_VERTICES];
+
+        /** Distance of the farthest footprint vertex from the robot origin (m) */
+        double _footprint_radius;
+
+        /** Sampling parameters */
+        double _horizon;
+        double _time_step;
+
+        /** The speed SetScan() trimmed the points for (m/s) */
+        double _max_speed;
+
+        /** Obstacle points (padded to a multiple of 8 with far away points) */
+        unsigned int _num_points;
+        alignas(32) float _x[SICK_PLS_CARTESIAN_MAX_POINTS + 8];
+        alignas(32) float _y[SICK_PLS_CARTESIAN_MAX_POINTS + 8];
+
+        /** Computes the time-to-collision of one command */
+        [[nodiscard]] double _timeToCollision(double v, double omega, bool use_avx2) const;
+
+        /** Gets the pose reached after time t */
+        static void _poseAt(double v, double omega, double t, double& x, double& y, double& theta);
+
+        /** Tests whether any point lies inside the footprint placed at the given pose */
+        [[nodiscard]] bool _collides(double x, double y, double theta, bool use_avx2) const;
+
+        /** Scalar footprint test */
+        [[nodiscard]] bool _collidesScalar(float c, float s, float x, float y) const;
+
+        /** AVX2 footprint test */
+        [[nodiscard]] bool _collidesAVX2(float c, float s, float x, float y) const;
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_COLLISION_HH */
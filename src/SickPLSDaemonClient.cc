@@ -0,0 +1,320 @@
+/*!
+ * \file SickPLSDaemonClient.cc
+ * \brief Implements a client for sickplsd, the daemon that owns a
+ *        Sick PLS and shares it between processes.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "SickPLSDaemonClient.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Gets the time left until a deadline
+     * \param deadline_nsec The deadline (sick_message_clock_nsec time)
+     * \return Time left (usecs, 0 once it has passed)
+     */
+    static unsigned int sick_pls_daemon_remaining_usec(const uint64_t deadline_nsec) {
+        const uint64_t now_nsec = sick_message_clock_nsec();
+        return (now_nsec < deadline_nsec) ? (unsigned int) ((deadline_nsec - now_nsec + 999) / 1000) : 0;
+    }
+
+    /**
+     * \brief Constructs a (disconnected) client
+     * \param &socket_path The daemon's listening socket
+     */
+    SickPLSDaemonClient::SickPLSDaemonClient(const std::string& socket_path) :
+            _socket_path(socket_path), _socket_fd(-1), _next_request_id(1),
+            _notice_pending(false), _notice_scan_index(0), _packet() {}
+
+    /**
+     * \brief Connects to the daemon
+     */
+    void SickPLSDaemonClient::Connect() noexcept(false) {
+
+        if (_socket_fd >= 0) {
+            return;
+        }
+
+        struct sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (_socket_path.size() >= sizeof(address.sun_path)) {
+            throw SickConfigException("SickPLSDaemonClient::Connect: Socket path is too long!");
+        }
+        strncpy(address.sun_path, _socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+        if ((_socket_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0)) < 0) {
+            throw SickIOException("SickPLSDaemonClient::Connect: socket() failed!");
+        }
+
+        if (connect(_socket_fd, (const struct sockaddr*) &address, sizeof(address)) < 0) {
+            close(_socket_fd);
+            _socket_fd = -1;
+            throw SickIOException("SickPLSDaemonClient::Connect: connect() failed (is sickplsd running?)");
+        }
+
+        _notice_pending = false;
+
+    }
+
+    /**
+     * \brief Disconnects from the daemon
+     */
+    void SickPLSDaemonClient::Disconnect() {
+
+        if (_socket_fd >= 0) {
+            close(_socket_fd);
+            _socket_fd = -1;
+        }
+
+    }
+
+    /**
+     * \brief Gets the name of the daemon's shared-memory scan ring
+     */
+    std::string SickPLSDaemonClient::GetShmName() noexcept(false) {
+
+        const sick_pls_daemon_reply_t& reply = _transact(SICK_PLS_DAEMON_CMD_GET_INFO);
+
+        return std::string(reply.shm_name, strnlen(reply.shm_name, SICK_PLS_DAEMON_SHM_NAME_LENGTH));
+    }
+
+    /**
+     * \brief Gets the device's current operating mode (as tracked by the daemon)
+     */
+    sick_pls_operating_mode_t SickPLSDaemonClient::GetSickOperatingMode() noexcept(false) {
+        return (sick_pls_operating_mode_t) _transact(SICK_PLS_DAEMON_CMD_GET_INFO).value;
+    }
+
+    /**
+     * \brief Queries the device status
+     *
+     * NOTE: Clients asking at the same time share a single device transaction.
+     */
+    SickPLS::sick_pls_status_t SickPLSDaemonClient::GetSickStatus() noexcept(false) {
+        return (SickPLS::sick_pls_status_t) _transact(SICK_PLS_DAEMON_CMD_GET_STATUS).value;
+    }
+
+    /**
+     * \brief Switches the device's operating mode
+     * \param sick_operating_mode See SickPLS::SetSickOperatingMode
+     *
+     * NOTE: The daemon only streams scans while the device is in
+     *       SICK_OP_MODE_MONITOR_STREAM_VALUES.
+     */
+    void SickPLSDaemonClient::SetSickOperatingMode(const sick_pls_operating_mode_t sick_operating_mode) noexcept(false) {
+        _transact(SICK_PLS_DAEMON_CMD_SET_MODE, sick_operating_mode);
+    }
+
+    /**
+     * \brief Resets the device
+     */
+    void SickPLSDaemonClient::ResetSick() noexcept(false) {
+        _transact(SICK_PLS_DAEMON_CMD_RESET);
+    }
+
+    /**
+     * \brief Gets the latest scan received by the daemon
+     * \param *ranges Destination buffer (SickPLS::SICK_MAX_NUM_MEASUREMENTS values)
+     * \param &num_ranges The number of range values
+     * \param *scan_index The scan's index in the ring (Default: NULL => Not wanted)
+     * \param *timestamp_usec The scan's receive time (Default: NULL => Not wanted)
+     */
+    void SickPLSDaemonClient::GetSickScan(uint16_t* const ranges, unsigned int& num_ranges,
+                                          uint64_t* const scan_index, uint64_t* const timestamp_usec) noexcept(false) {
+
+        const sick_pls_daemon_reply_t& reply = _transact(SICK_PLS_DAEMON_CMD_GET_SCAN);
+
+        num_ranges = reply.num_ranges;
+        memcpy(ranges, &_packet[sizeof(sick_pls_daemon_reply_t)], num_ranges * sizeof(uint16_t));
+
+        if (scan_index) {
+            *scan_index = reply.scan_index;
+        }
+
+        if (timestamp_usec) {
+            *timestamp_usec = reply.timestamp_usec;
+        }
+
+    }
+
+    /**
+     * \brief Starts receiving scan notices
+     */
+    void SickPLSDaemonClient::Subscribe() noexcept(false) {
+        _transact(SICK_PLS_DAEMON_CMD_SUBSCRIBE);
+    }
+
+    /**
+     * \brief Stops receiving scan notices
+     */
+    void SickPLSDaemonClient::Unsubscribe() noexcept(false) {
+        _transact(SICK_PLS_DAEMON_CMD_UNSUBSCRIBE);
+        _notice_pending = false;
+    }
+
+    /**
+     * \brief Waits for the next scan notice
+     * \param &scan_index Index of the announced scan in the shared-memory ring
+     * \param timeout_usec Max time to wait (usecs)
+     * \return True if a notice arrived, false on timeout
+     */
+    bool SickPLSDaemonClient::WaitForScanNotice(uint64_t& scan_index, const unsigned int timeout_usec) noexcept(false) {
+
+        /* One may have arrived while waiting for a reply */
+        if (_notice_pending) {
+            _notice_pending = false;
+            scan_index = _notice_scan_index;
+            return true;
+        }
+
+        /* Stale replies don't extend the wait */
+        const uint64_t deadline_nsec = sick_message_clock_nsec() + (uint64_t) timeout_usec * 1000;
+
+        for (;;) {
+
+            if (_recvPacket(sick_pls_daemon_remaining_usec(deadline_nsec)) == 0) {
+                return false;
+            }
+
+            const auto* const reply = (const sick_pls_daemon_reply_t*) _packet;
+            if (reply->command == SICK_PLS_DAEMON_NOTIFY_SCAN) {
+                scan_index = reply->scan_index;
+                return true;
+            }
+
+            /* Anything else is a stale reply */
+
+        }
+
+    }
+
+    /**
+     * \brief A standard destructor
+     */
+    SickPLSDaemonClient::~SickPLSDaemonClient() {
+        Disconnect();
+    }
+
+    /**
+     * \brief Sends a request and waits for the matching reply
+     * \param command The command
+     * \param argument The command's argument
+     * \return The reply (valid until the next call)
+     */
+    const sick_pls_daemon_reply_t& SickPLSDaemonClient::_transact(const sick_pls_daemon_command_t command,
+                                                                  const uint32_t argument) noexcept(false) {
+
+        /* Ensure we are connected */
+        if (_socket_fd < 0) {
+            throw SickConfigException("SickPLSDaemonClient::_transact: Not connected!");
+        }
+
+        const sick_pls_daemon_request_t request = {SICK_PLS_DAEMON_MAGIC, (uint32_t) command,
+                                                   _next_request_id++, argument};
+        if (send(_socket_fd, &request, sizeof(request), MSG_NOSIGNAL) != (ssize_t) sizeof(request)) {
+            throw SickIOException("SickPLSDaemonClient::_transact: send() failed!");
+        }
+
+        /* Scan notices (one every scan) and stale replies don't extend the wait */
+        const uint64_t deadline_nsec = sick_message_clock_nsec() + (uint64_t) DEFAULT_SICK_PLS_DAEMON_REPLY_TIMEOUT * 1000;
+
+        for (;;) {
+
+            if (_recvPacket(sick_pls_daemon_remaining_usec(deadline_nsec)) == 0) {
+                throw SickTimeoutException("SickPLSDaemonClient::_transact: No reply from sickplsd!");
+            }
+
+            const auto* const reply = (const sick_pls_daemon_reply_t*) _packet;
+
+            /* Hold on to scan notices for WaitForScanNotice */
+            if (reply->command == SICK_PLS_DAEMON_NOTIFY_SCAN) {
+                _notice_pending = true;
+                _notice_scan_index = reply->scan_index;
+                continue;
+            }
+
+            if (reply->request_id != request.request_id) {
+                continue;
+            }
+
+            switch (reply->result) {
+                case SICK_PLS_DAEMON_OK:
+                    return *reply;
+                case SICK_PLS_DAEMON_ERROR_TIMEOUT:
+                    throw SickTimeoutException("SickPLSDaemonClient::_transact: The device did not answer!");
+                case SICK_PLS_DAEMON_ERROR_NO_SCAN:
+                    throw SickIOException("SickPLSDaemonClient::_transact: No scan available yet!");
+                case SICK_PLS_DAEMON_ERROR_BAD_REQUEST:
+                    throw SickConfigException("SickPLSDaemonClient::_transact: Request rejected!");
+                default:
+                    throw SickIOException("SickPLSDaemonClient::_transact: The device reported an error!");
+            }
+
+        }
+
+    }
+
+    /**
+     * \brief Receives one packet into _packet
+     * \param timeout_usec Max time to wait (usecs)
+     * \return The packet length (0 on timeout)
+     *
+     * NOTE: The timeout is rounded up to poll()'s whole msecs, so a short
+     *       (but nonzero) one still waits.
+     */
+    size_t SickPLSDaemonClient::_recvPacket(const unsigned int timeout_usec) noexcept(false) {
+
+        struct pollfd poll_fd = {_socket_fd, POLLIN, 0};
+
+        int num_ready;
+        do {
+            num_ready = poll(&poll_fd, 1, (int) (((uint64_t) timeout_usec + 999) / 1000));
+        } while (num_ready < 0 && errno == EINTR);
+
+        if (num_ready < 0) {
+            throw SickIOException("SickPLSDaemonClient::_recvPacket: poll() failed!");
+        }
+
+        if (num_ready == 0) {
+            return 0;
+        }
+
+        const ssize_t length = recv(_socket_fd, _packet, sizeof(_packet), 0);
+        if (length <= 0) {
+            Disconnect();
+            throw SickIOException("SickPLSDaemonClient::_recvPacket: Connection to sickplsd lost!");
+        }
+
+        const auto* const reply = (const sick_pls_daemon_reply_t*) _packet;
+        if ((size_t) length < sizeof(sick_pls_daemon_reply_t) || reply->magic != SICK_PLS_DAEMON_MAGIC ||
+            (size_t) length < sizeof(sick_pls_daemon_reply_t) + reply->num_ranges * sizeof(uint16_t) * (reply->command == SICK_PLS_DAEMON_CMD_GET_SCAN)) {
+            throw SickIOException("SickPLSDaemonClient::_recvPacket: Malformed packet!");
+        }
+
+        return (size_t) length;
+    }
+
+} /* namespace sickpls */
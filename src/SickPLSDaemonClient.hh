@@ -0,0 +1,117 @@
+/*!
+ * \file SickPLSDaemonClient.hh
+ * \brief Defines a client for sickplsd, the daemon that owns a
+ *        Sick PLS and shares it between processes.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_DAEMON_CLIENT_HH
+#define SICK_PLS_DAEMON_CLIENT_HH
+
+/* Definition dependencies */
+#include <cstdint>
+#include <string>
+
+#include "SickPLS.hh"
+#include "SickPLSDaemonProtocol.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define DEFAULT_SICK_PLS_DAEMON_REPLY_TIMEOUT                (unsigned int)(70e6)  ///< Max wait for a reply (usecs; a reset can take a minute)
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \brief Talks to sickplsd over its Unix domain socket
+     *
+     * Commands are forwarded to the daemon, which serializes them onto the
+     * device. Scans can be fetched inline with GetSickScan(), or a client can
+     * Subscribe() and wait for scan notices, then read the payload from the
+     * daemon's shared-memory ring (see GetShmName() and SickPLSScanSubscriber).
+     *
+     * A client is meant to be used by one thread at a time.
+     */
+    class SickPLSDaemonClient {
+
+    public:
+
+        /** Constructs a client for the daemon listening on the given socket */
+        explicit SickPLSDaemonClient(const std::string& socket_path = DEFAULT_SICK_PLS_DAEMON_SOCKET_PATH);
+
+        /** Connects to the daemon */
+        void Connect() noexcept(false);
+
+        /** Disconnects from the daemon */
+        void Disconnect();
+
+        /** Gets the name of the daemon's shared-memory scan ring */
+        std::string GetShmName() noexcept(false);
+
+        /** Gets the device's current operating mode */
+        sick_pls_operating_mode_t GetSickOperatingMode() noexcept(false);
+
+        /** Queries the device status */
+        SickPLS::sick_pls_status_t GetSickStatus() noexcept(false);
+
+        /** Switches the device's operating mode */
+        void SetSickOperatingMode(sick_pls_operating_mode_t sick_operating_mode) noexcept(false);
+
+        /** Resets the device */
+        void ResetSick() noexcept(false);
+
+        /** Gets the latest scan (inline over the socket) */
+        void GetSickScan(uint16_t* ranges, unsigned int& num_ranges, uint64_t* scan_index = nullptr,
+                         uint64_t* timestamp_usec = nullptr) noexcept(false);
+
+        /** Starts receiving scan notices */
+        void Subscribe() noexcept(false);
+
+        /** Stops receiving scan notices */
+        void Unsubscribe() noexcept(false);
+
+        /** Waits for the next scan notice (returns false on timeout) */
+        bool WaitForScanNotice(uint64_t& scan_index, unsigned int timeout_usec) noexcept(false);
+
+        /** A standard destructor */
+        ~SickPLSDaemonClient();
+
+    private:
+
+        /** The daemon's socket */
+        std::string _socket_path;
+
+        /** Connected socket (-1 => not connected) */
+        int _socket_fd;
+
+        /** Id of the next request */
+        uint32_t _next_request_id;
+
+        /** A scan notice received while waiting for a reply */
+        bool _notice_pending;
+        uint64_t _notice_scan_index;
+
+        /** Receive buffer (a reply plus an inline scan) */
+        uint8_t _packet[SICK_PLS_DAEMON_MAX_PACKET_SIZE];
+
+        /** Sends a request and waits for its reply (left in _packet) */
+        const sick_pls_daemon_reply_t& _transact(sick_pls_daemon_command_t command,
+                                                 uint32_t argument = 0) noexcept(false);
+
+        /** Receives one packet (returns its length, 0 on timeout) */
+        size_t _recvPacket(unsigned int timeout_usec) noexcept(false);
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_DAEMON_CLIENT_HH */
@@ -0,0 +1,100 @@
+/*!
+ * \file SickPLSDaemonProtocol.hh
+ * \brief Defines the wire format spoken between sickplsd and
+ *        its clients over a Unix domain (SOCK_SEQPACKET) socket.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_DAEMON_PROTOCOL_HH
+#define SICK_PLS_DAEMON_PROTOCOL_HH
+
+/* Definition dependencies */
+#include <cstdint>
+
+#include "SickPLS.hh"
+
+/* Macro definitions */
+#define DEFAULT_SICK_PLS_DAEMON_SOCKET_PATH                 "/tmp/sickplsd.sock"  ///< Default listening socket
+#define SICK_PLS_DAEMON_MAGIC                                       (0x53504C44U)  ///< "SPLD"
+#define SICK_PLS_DAEMON_SHM_NAME_LENGTH                                     (64)  ///< Room for the scan ring's name
+#define SICK_PLS_DAEMON_MAX_PACKET_SIZE   (sizeof(sickpls::sick_pls_daemon_reply_t) + \
+                                           sickpls::SickPLS::SICK_MAX_NUM_MEASUREMENTS * sizeof(uint16_t))  ///< Largest packet on the socket
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \enum sick_pls_daemon_command_t
+     * \brief Requests understood by sickplsd (and the unsolicited scan notice).
+     */
+    enum sick_pls_daemon_command_t {
+        SICK_PLS_DAEMON_CMD_GET_INFO = 0x01,                                       ///< Returns the scan ring name and the operating mode
+        SICK_PLS_DAEMON_CMD_GET_STATUS = 0x02,                                     ///< Queries the device (identical concurrent queries share one transaction)
+        SICK_PLS_DAEMON_CMD_SET_MODE = 0x03,                                       ///< Switches the operating mode (argument: sick_pls_operating_mode_t)
+        SICK_PLS_DAEMON_CMD_RESET = 0x04,                                          ///< Resets the device
+        SICK_PLS_DAEMON_CMD_GET_SCAN = 0x05,                                       ///< Returns the latest scan inline (ranges follow the reply)
+        SICK_PLS_DAEMON_CMD_SUBSCRIBE = 0x06,                                      ///< Starts scan notices for this client
+        SICK_PLS_DAEMON_CMD_UNSUBSCRIBE = 0x07,                                    ///< Stops scan notices for this client
+        SICK_PLS_DAEMON_NOTIFY_SCAN = 0x80                                         ///< Unsolicited: a scan was published to the ring
+    };
+
+    /*!
+     * \enum sick_pls_daemon_result_t
+     * \brief Result codes carried in replies.
+     */
+    enum sick_pls_daemon_result_t {
+        SICK_PLS_DAEMON_OK = 0,                                                    ///< Success
+        SICK_PLS_DAEMON_ERROR_BAD_REQUEST = -1,                                    ///< Malformed or unknown request
+        SICK_PLS_DAEMON_ERROR_DEVICE = -2,                                         ///< The device rejected the command
+        SICK_PLS_DAEMON_ERROR_TIMEOUT = -3,                                        ///< The device did not answer
+        SICK_PLS_DAEMON_ERROR_NO_SCAN = -4                                         ///< No scan has been received yet
+    };
+
+    /*!
+     * \struct sick_pls_daemon_request_tag
+     * \brief A client request (one packet).
+     */
+    /*!
+     * \typedef sick_pls_daemon_request_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_daemon_request_tag {
+        uint32_t magic;                                                            ///< SICK_PLS_DAEMON_MAGIC
+        uint32_t command;                                                          ///< A sick_pls_daemon_command_t
+        uint32_t request_id;                                                       ///< Echoed back in the reply
+        uint32_t argument;                                                         ///< Command specific argument
+    } sick_pls_daemon_request_t;
+
+    /*!
+     * \struct sick_pls_daemon_reply_tag
+     * \brief A reply or scan notice (one packet). GET_SCAN replies are
+     *        followed by num_ranges uint16_t ranges in the same packet.
+     */
+    /*!
+     * \typedef sick_pls_daemon_reply_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_daemon_reply_tag {
+        uint32_t magic;                                                            ///< SICK_PLS_DAEMON_MAGIC
+        uint32_t command;                                                          ///< The command answered (or SICK_PLS_DAEMON_NOTIFY_SCAN)
+        uint32_t request_id;                                                       ///< The request answered (0 for notices)
+        int32_t result;                                                            ///< A sick_pls_daemon_result_t
+        uint32_t value;                                                            ///< Command specific value (status, mode, ...)
+        uint32_t num_ranges;                                                       ///< Number of ranges in the scan referred to
+        uint64_t scan_index;                                                       ///< Index of the scan in the shared-memory ring
+        uint64_t timestamp_usec;                                                   ///< Receive time of that scan (usecs since the epoch)
+        char shm_name[SICK_PLS_DAEMON_SHM_NAME_LENGTH];                            ///< Scan ring name (GET_INFO)
+    } sick_pls_daemon_reply_t;
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_DAEMON_PROTOCOL_HH */
@@ -0,0 +1,507 @@
+/*!
+ * \file SickPLSDiscovery.cc
+ * \brief Implements a class for finding Sick PLS units among the host's
+ *        serial devices.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <poll.h>
+#include <pthread.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#ifdef HAVE_LINUX_SERIAL_H
+#include <linux/serial.h>
+#endif
+
+#include "SickPLSDiscovery.hh"
+#include "SickPLSLinkAnalyzer.hh"
+#include "SickPLSUtility.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \struct sick_pls_discovery_job_tag
+     * \brief A probe thread's work.
+     */
+    /*!
+     * \typedef sick_pls_discovery_job_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_discovery_job_tag {
+        const SickPLSDiscovery* discovery;                                         ///< The prober
+        sick_pls_discovery_result_t* result;                                       ///< Where the findings go
+    } sick_pls_discovery_job_t;
+
+    /**
+     * \brief Constructs a prober
+     * \param send_queries If false, devices are only listened to (finds streaming units only)
+     * \param sniff_timeout Least listening time per baud (usecs)
+     * \param reply_timeout Time to wait for a query's reply (usecs)
+     *
+     * NOTE: The bauds are tried in the order 9600 (the PLS's power-on rate),
+     *       38400, 500K and 19200.
+     */
+    SickPLSDiscovery::SickPLSDiscovery(const bool send_queries, const unsigned int sniff_timeout,
+                                       const unsigned int reply_timeout) :
+            _send_queries(send_queries), _sniff_timeout(sniff_timeout), _reply_timeout(reply_timeout),
+            _bauds({SickPLS::SICK_BAUD_9600, SickPLS::SICK_BAUD_38400, SickPLS::SICK_BAUD_500K,
+                    SickPLS::SICK_BAUD_19200}) {}
+
+    /**
+     * \brief Sets the bauds tried
+     * \param &bauds The bauds, most likely first
+     */
+    void SickPLSDiscovery::SetBauds(const std::vector<sick_pls_baud_t>& bauds) noexcept(false) {
+
+        if (bauds.empty() || std::count(bauds.begin(), bauds.end(), SickPLS::SICK_BAUD_UNKNOWN) > 0) {
+            throw SickConfigException("SickPLSDiscovery::SetBauds: Invalid baud list!");
+        }
+
+        _bauds = bauds;
+
+    }
+
+    /**
+     * \brief Lists the host's USB and on-board serial devices
+     * \param &device_paths The candidates (/dev/ttyUSB*, /dev/ttyACM*, /dev/ttyS*)
+     */
+    void SickPLSDiscovery::ListCandidates(std::vector<std::string>& device_paths) {
+
+        device_paths.clear();
+
+        const char* patterns[3] = {"/dev/ttyUSB*", "/dev/ttyACM*", "/dev/ttyS*"};
+        for (const auto pattern: patterns) {
+            glob_t matches;
+            if (glob(pattern, 0, nullptr, &matches) == 0) {
+                for (size_t i = 0; i < matches.gl_pathc; i++) {
+                    device_paths.emplace_back(matches.gl_pathv[i]);
+                }
+            }
+            globfree(&matches);
+        }
+
+    }
+
+    /**
+     * \brief Probes devices concurrently
+     * \param &device_paths The devices
+     * \param &results One result per device, in the same order
+     */
+    void SickPLSDiscovery::Probe(const std::vector<std::string>& device_paths,
+                                 std::vector<sick_pls_discovery_result_t>& results) const noexcept(false) {
+
+        results.assign(device_paths.size(), {});
+        std::vector<sick_pls_discovery_job_t> jobs(device_paths.size());
+        std::vector<pthread_t> thread_ids(device_paths.size());
+        std::vector<bool> started(device_paths.size(), false);
+
+        for (size_t i = 0; i < device_paths.size(); i++) {
+
+            results[i].device_path = device_paths[i];
+            results[i].baud = SickPLS::SICK_BAUD_UNKNOWN;
+            results[i].operating_mode = SickPLS::SICK_OP_MODE_UNKNOWN;
+            jobs[i] = {this, &results[i]};
+
+            /* Should we run out of threads, the device is probed in line instead */
+            started[i] = (pthread_create(&thread_ids[i], nullptr, _probeThread, &jobs[i]) == 0);
+            if (!started[i]) {
+                _probe(results[i]);
+            }
+
+        }
+
+        for (size_t i = 0; i < device_paths.size(); i++) {
+            if (started[i] && pthread_join(thread_ids[i], nullptr) != 0) {
+                throw SickThreadException("SickPLSDiscovery::Probe: pthread_join() failed!");
+            }
+        }
+
+    }
+
+    /**
+     * \brief Probes every candidate
+     * \param &devices Device path => findings, for every PLS found
+     */
+    void SickPLSDiscovery::Discover(std::map<std::string, sick_pls_discovery_result_t>& devices) const noexcept(false) {
+
+        std::vector<std::string> device_paths;
+        ListCandidates(device_paths);
+
+        std::vector<sick_pls_discovery_result_t> results;
+        Probe(device_paths, results);
+
+        devices.clear();
+        for (const auto& result: results) {
+            if (result.baud != SickPLS::SICK_BAUD_UNKNOWN) {
+                devices[result.device_path] = result;
+            }
+        }
+
+    }
+
+    /**
+     * \brief Gets a device's stable name
+     * \param &device_path The device
+     * \return The SICK_PLS_DISCOVERY_BY_ID_PATH link resolving to it ("" => none)
+     *
+     * NOTE: These names carry the adapter's vendor, model and serial number,
+     *       so they survive reboots and replugging.
+     */
+    std::string SickPLSDiscovery::GetIdentity(const std::string& device_path) {
+
+        char device_real[PATH_MAX];
+        if (!realpath(device_path.c_str(), device_real)) {
+            return "";
+        }
+
+        std::string identity;
+        DIR* dir = opendir(SICK_PLS_DISCOVERY_BY_ID_PATH);
+        if (!dir) {
+            return "";
+        }
+
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            const std::string link_path = std::string(SICK_PLS_DISCOVERY_BY_ID_PATH) + "/" + entry->d_name;
+            char link_real[PATH_MAX];
+            if (entry->d_name[0] != '.' && realpath(link_path.c_str(), link_real) && strcmp(link_real, device_real) == 0) {
+                identity = link_path;
+                break;
+            }
+        }
+
+        closedir(dir);
+        return identity;
+    }
+
+    /**
+     * \brief Probes one device
+     * \param &result Its findings (device_path is set by the caller)
+     */
+    void SickPLSDiscovery::_probe(sick_pls_discovery_result_t& result) const {
+
+        const uint64_t start_nsec = sick_message_clock_nsec();
+        result.identity = GetIdentity(result.device_path);
+
+        /* Don't wait on a modem's carrier while opening */
+        const int fd = open(result.device_path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (fd < 0) {
+            result.error = std::string("open() failed: ") + strerror(errno);
+            result.probe_time = (double) (sick_message_clock_nsec() - start_nsec) / 1e9;
+            return;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+
+#ifdef HAVE_LINUX_SERIAL_H
+        /* Skip on-board ports without a UART behind them */
+        struct serial_struct serial = {};
+        if (ioctl(fd, TIOCGSERIAL, &serial) == 0 && serial.type == PORT_UNKNOWN) {
+            close(fd);
+            result.error = "No UART";
+            result.probe_time = (double) (sick_message_clock_nsec() - start_nsec) / 1e9;
+            return;
+        }
+#endif
+
+        uint8_t payload_buffer[1] = {0x32};
+        const SickPLSMessage query(DEFAULT_SICK_PLS_SICK_ADDRESS, payload_buffer, 1);
+        SickPLSMessage reply;
+
+        bool custom_divisor = false;
+        for (const auto baud: _bauds) {
+
+            if (!_setTerminalBaud(fd, baud)) {
+                continue;
+            }
+            custom_divisor = (baud == SickPLS::SICK_BAUD_500K);
+
+            /* A streaming unit speaks first */
+            if (_readTelegram(fd, _getSniffTimeout(baud), 0, reply)) {
+                result.baud = baud;
+                result.streaming = true;
+                result.operating_mode = _replyCodeToMode(reply.GetCommandCode());
+                break;
+            }
+
+            /* Otherwise ask for its errors */
+            if (_send_queries && _writeTelegram(fd, query) && _readTelegram(fd, _reply_timeout, 0xB2, reply)) {
+                result.baud = baud;
+                result.num_errors = (reply.GetPayloadLength() - 2) / 2;
+                break;
+            }
+
+        }
+
+#ifdef HAVE_LINUX_SERIAL_H
+        /* Don't leave a 500K divisor behind on a port without a PLS */
+        if (custom_divisor && result.baud == SickPLS::SICK_BAUD_UNKNOWN) {
+            _setTerminalBaud(fd, SickPLS::SICK_BAUD_9600);
+        }
+#else
+        (void) custom_divisor;
+#endif
+
+        close(fd);
+        result.probe_time = (double) (sick_message_clock_nsec() - start_nsec) / 1e9;
+
+    }
+
+    /**
+     * \brief Gets how long to listen for a streaming PLS at the given baud
+     * \param baud The baud
+     * \return The sniff timeout or, if longer, the time taken by
+     *         SICK_PLS_DISCOVERY_SNIFF_TELEGRAMS of the longest scan telegrams (usecs)
+     *
+     * NOTE: Listening may begin just after a telegram's first byte, in
+     *       which case the first whole telegram ends nearly two telegram
+     *       times later.
+     */
+    unsigned int SickPLSDiscovery::_getSniffTimeout(const sick_pls_baud_t baud) const {
+
+        const uint64_t baud_rate = SickPLSLinkAnalyzer::SickBaudToInt(baud);
+        if (baud_rate == 0) {
+            return _sniff_timeout;
+        }
+
+        /* The longest scan telegram: a full scan of means with the subrange fields */
+        const uint64_t telegram_length =
+                SickPLSLinkAnalyzer::GetScanLength(SickPLS::SICK_OP_MODE_MONITOR_STREAM_MEAN_VALUES_SUBRANGE,
+                                                   SICK_PLS_LINK_FULL_SCAN_VALUES);
+
+        const uint64_t num_bits = SICK_PLS_DISCOVERY_SNIFF_TELEGRAMS * telegram_length * DEFAULT_SICK_PLS_BITS_PER_BYTE;
+        const uint64_t sniff_usecs = (num_bits * 1000000 + baud_rate - 1) / baud_rate;
+
+        return std::max<unsigned int>(_sniff_timeout, (unsigned int) sniff_usecs);
+    }
+
+    /**
+     * \brief Sets up the terminal (raw, 8E1) for the given baud
+     * \param fd The terminal
+     * \param baud The baud
+     * \return False if the host cannot run the terminal at that baud
+     *
+     * NOTE: As in SickPLS::_setTerminalBaud, 500K runs at B38400 with a
+     *       custom divisor (FTDI adapters).
+     */
+    bool SickPLSDiscovery::_setTerminalBaud(const int fd, const sick_pls_baud_t baud) {
+
+#ifdef HAVE_LINUX_SERIAL_H
+        struct serial_struct serial = {};
+        if (ioctl(fd, TIOCGSERIAL, &serial) == 0) {
+            if (baud == SickPLS::SICK_BAUD_500K) {
+                serial.flags |= ASYNC_SPD_CUST;
+                serial.custom_divisor = 48;
+            } else {
+                serial.flags &= ~ASYNC_SPD_CUST;
+                serial.custom_divisor = 0;
+            }
+            if (ioctl(fd, TIOCSSERIAL, &serial) < 0 && baud == SickPLS::SICK_BAUD_500K) {
+                return false;
+            }
+        } else if (baud == SickPLS::SICK_BAUD_500K) {
+            return false;
+        }
+#else
+        if (baud == SickPLS::SICK_BAUD_500K) {
+            return false;
+        }
+#endif
+
+        struct termios term = {};
+        if (tcgetattr(fd, &term) < 0) {
+            return false;
+        }
+
+        cfmakeraw(&term);
+        term.c_iflag |= INPCK;
+        term.c_iflag &= ~IXOFF;
+        term.c_cflag |= PARENB | CLOCAL | CREAD;
+
+        speed_t speed;
+        switch (baud) {
+            case SickPLS::SICK_BAUD_9600:
+                speed = B9600;
+                break;
+            case SickPLS::SICK_BAUD_19200:
+                speed = B19200;
+                break;
+            default:
+                speed = B38400;
+                break;
+        }
+        cfsetispeed(&term, speed);
+        cfsetospeed(&term, speed);
+
+        if (tcsetattr(fd, TCSAFLUSH, &term) < 0) {
+            return false;
+        }
+
+        /* Drop whatever arrived at the old baud */
+        tcflush(fd, TCIOFLUSH);
+        return true;
+    }
+
+    /**
+     * \brief Reads until a well-formed telegram arrives or the time is up
+     * \param fd The terminal
+     * \param timeout How long to read (usecs)
+     * \param reply_code The command code wanted (0 => any)
+     * \param &message The telegram
+     * \return True if one arrived
+     */
+    bool SickPLSDiscovery::_readTelegram(const int fd, const unsigned int timeout, const uint8_t reply_code,
+                                         SickPLSMessage& message) {
+
+        const unsigned int header_length = SickPLSMessage::MESSAGE_HEADER_LENGTH;
+        const unsigned int trailer_length = SickPLSMessage::MESSAGE_TRAILER_LENGTH;
+
+        uint8_t buffer[2 * SickPLSMessage::MESSAGE_MAX_LENGTH];
+        unsigned int num_bytes = 0;
+        const uint64_t deadline_nsec = sick_message_clock_nsec() + (uint64_t) timeout * 1000;
+
+        for (;;) {
+
+            /* Look for STX and the host address, then check the CRC */
+            unsigned int i = 0;
+            while (i + header_length <= num_bytes) {
+
+                if (buffer[i] != 0x02 || buffer[i + 1] != DEFAULT_SICK_PLS_HOST_ADDRESS) {
+                    i++;
+                    continue;
+                }
+
+                uint16_t payload_length;
+                memcpy(&payload_length, &buffer[i + 2], 2);
+                payload_length = sick_pls_to_host_byte_order(payload_length);
+                if (payload_length == 0 || payload_length > SickPLSMessage::MESSAGE_PAYLOAD_MAX_LENGTH) {
+                    i++;
+                    continue;
+                }
+
+                /* Not all here yet */
+                if (i + header_length + payload_length + trailer_length > num_bytes) {
+                    break;
+                }
+
+                uint16_t checksum;
+                memcpy(&checksum, &buffer[i + header_length + payload_length], 2);
+                checksum = sick_pls_to_host_byte_order(checksum);
+
+                message.BuildMessage(DEFAULT_SICK_PLS_HOST_ADDRESS, &buffer[i + header_length], payload_length);
+                if (message.GetChecksum() == checksum &&
+                    (reply_code == 0 || message.GetCommandCode() == reply_code)) {
+                    return true;
+                }
+
+                i++;
+
+            }
+
+            /* Keep the unparsed tail */
+            memmove(buffer, &buffer[i], num_bytes - i);
+            num_bytes -= i;
+            if (num_bytes == sizeof(buffer)) {
+                memmove(buffer, &buffer[1], --num_bytes);
+            }
+
+            const uint64_t now_nsec = sick_message_clock_nsec();
+            if (now_nsec >= deadline_nsec) {
+                return false;
+            }
+
+            struct pollfd poll_fd = {fd, POLLIN, 0};
+            const int wait_msec = (int) ((deadline_nsec - now_nsec + 999999) / 1000000);
+            if (poll(&poll_fd, 1, wait_msec) <= 0 || !(poll_fd.revents & POLLIN)) {
+                continue;
+            }
+
+            const ssize_t num_read = read(fd, &buffer[num_bytes], sizeof(buffer) - num_bytes);
+            if (num_read <= 0) {
+                return false;
+            }
+            num_bytes += (unsigned int) num_read;
+
+        }
+
+    }
+
+    /**
+     * \brief Sends a telegram with the PLS's inter-byte spacing
+     * \param fd The terminal
+     * \param &message The telegram
+     * \return True if it was written
+     */
+    bool SickPLSDiscovery::_writeTelegram(const int fd, const SickPLSMessage& message) {
+
+        uint8_t message_buffer[SickPLSMessage::MESSAGE_MAX_LENGTH];
+        message.GetMessage(message_buffer);
+
+        for (unsigned int i = 0; i < message.GetMessageLength(); i++) {
+            if (write(fd, &message_buffer[i], 1) != 1) {
+                return false;
+            }
+            usleep(DEFAULT_SICK_PLS_BYTE_INTERVAL);
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Maps a streamed reply code to the mode that produces it
+     * \param reply_code The command code of a streamed telegram
+     * \return The mode (SICK_OP_MODE_UNKNOWN if ambiguous)
+     */
+    sick_pls_operating_mode_t SickPLSDiscovery::_replyCodeToMode(const uint8_t reply_code) {
+
+        switch (reply_code) {
+            case 0xB0:
+                return SickPLS::SICK_OP_MODE_MONITOR_STREAM_VALUES;
+            case 0xB6:
+                return SickPLS::SICK_OP_MODE_MONITOR_STREAM_MEAN_VALUES;
+            case 0xB7:
+                return SickPLS::SICK_OP_MODE_MONITOR_STREAM_VALUES_SUBRANGE;
+            case 0xBF:
+                return SickPLS::SICK_OP_MODE_MONITOR_STREAM_MEAN_VALUES_SUBRANGE;
+            default:
+                return SickPLS::SICK_OP_MODE_UNKNOWN;
+        }
+
+    }
+
+    /**
+     * \brief Runs one probe
+     * \param *thread_args The job (sick_pls_discovery_job_t)
+     */
+    void* SickPLSDiscovery::_probeThread(void* const thread_args) {
+
+        const auto& job = *(sick_pls_discovery_job_t*) thread_args;
+        job.discovery->_probe(*job.result);
+        return nullptr;
+    }
+
+} /* namespace sickpls */
@@ -0,0 +1,130 @@
+/*!
+ * \file SickPLSDiscovery.hh
+ * \brief Defines a class for finding Sick PLS units among the host's
+ *        serial devices.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_DISCOVERY_HH
+#define SICK_PLS_DISCOVERY_HH
+
+/* Definition dependencies */
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SickPLS.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define DEFAULT_SICK_PLS_DISCOVERY_SNIFF_TIMEOUT                 (unsigned int)(60e3)  ///< Listen for a streaming PLS at least this long per baud (usecs)
+#define SICK_PLS_DISCOVERY_SNIFF_TELEGRAMS                                    (2)  ///< ...and for this many longest scan telegram times
+#define DEFAULT_SICK_PLS_DISCOVERY_REPLY_TIMEOUT                (unsigned int)(120e3)  ///< Wait this long for the reply to a query (usecs)
+#define SICK_PLS_DISCOVERY_BY_ID_PATH                          "/dev/serial/by-id"  ///< udev's stable names for serial adapters
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \struct sick_pls_discovery_result_tag
+     * \brief What probing a serial device found.
+     */
+    /*!
+     * \typedef sick_pls_discovery_result_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_discovery_result_tag {
+        std::string device_path;                                                   ///< The device probed
+        std::string identity;                                                      ///< Its stable name under SICK_PLS_DISCOVERY_BY_ID_PATH ("" => none)
+        sick_pls_baud_t baud;                                                      ///< Baud the PLS answered at (SICK_BAUD_UNKNOWN => no PLS)
+        bool streaming;                                                            ///< True if the PLS was found streaming scans
+        sick_pls_operating_mode_t operating_mode;                                  ///< Streaming mode (SICK_OP_MODE_UNKNOWN unless streaming)
+        unsigned int num_errors;                                                   ///< Errors reported in reply to the query (0 if not queried)
+        double probe_time;                                                         ///< Time spent on the device (secs)
+        std::string error;                                                         ///< Why the device could not be probed ("" => it was)
+    } sick_pls_discovery_result_t;
+
+    /*!
+     * \brief Probes serial devices for a Sick PLS, all at once
+     *
+     * Each candidate gets its own thread. At every baud the thread first
+     * listens for a valid telegram and otherwise sends the 0x32 error query
+     * and waits for its 0xB2 reply. A streaming PLS sends back to back
+     * telegrams of up to about 740 bytes, which take about 850 ms at 9600
+     * and 210 ms at 38400, and listening may begin mid-telegram, so each baud
+     * is listened to for SICK_PLS_DISCOVERY_SNIFF_TELEGRAMS such telegram
+     * times (or the sniff timeout, if longer). Unlike SickPLS::Initialize,
+     * no buffer monitor is started; all devices are probed at once, so a
+     * whole bus is enumerated in about as long as one port takes (about
+     * 3.5 secs with the default bauds). The devices are left closed; their
+     * modes are not changed.
+     */
+    class SickPLSDiscovery {
+
+    public:
+
+        /** Constructs a prober (send_queries = false => only listen) */
+        explicit SickPLSDiscovery(bool send_queries = true,
+                                  unsigned int sniff_timeout = DEFAULT_SICK_PLS_DISCOVERY_SNIFF_TIMEOUT,
+                                  unsigned int reply_timeout = DEFAULT_SICK_PLS_DISCOVERY_REPLY_TIMEOUT);
+
+        /** Sets the bauds tried, in order */
+        void SetBauds(const std::vector<sick_pls_baud_t>& bauds) noexcept(false);
+
+        /** Lists the host's USB and on-board serial devices */
+        static void ListCandidates(std::vector<std::string>& device_paths);
+
+        /** Probes the given devices concurrently */
+        void Probe(const std::vector<std::string>& device_paths,
+                   std::vector<sick_pls_discovery_result_t>& results) const noexcept(false);
+
+        /** Probes every candidate and maps the path of each PLS found to what was found */
+        void Discover(std::map<std::string, sick_pls_discovery_result_t>& devices) const noexcept(false);
+
+        /** Gets a device's stable name under SICK_PLS_DISCOVERY_BY_ID_PATH ("" => none) */
+        static std::string GetIdentity(const std::string& device_path);
+
+    private:
+
+        /** Probe settings */
+        bool _send_queries;
+        unsigned int _sniff_timeout;
+        unsigned int _reply_timeout;
+        std::vector<sick_pls_baud_t> _bauds;
+
+        /** Probes one device */
+        void _probe(sick_pls_discovery_result_t& result) const;
+
+        /** Gets how long to listen for a streaming PLS at the given baud (usecs) */
+        [[nodiscard]] unsigned int _getSniffTimeout(sick_pls_baud_t baud) const;
+
+        /** Sets up the terminal for the given baud (returns false if the host cannot do it) */
+        static bool _setTerminalBaud(int fd, sick_pls_baud_t baud);
+
+        /** Reads until a well-formed telegram (with the given reply code, 0 => any) arrives or the time is up */
+        static bool _readTelegram(int fd, unsigned int timeout, uint8_t reply_code, SickPLSMessage& message);
+
+        /** Sends a telegram with the PLS's inter-byte spacing */
+        static bool _writeTelegram(int fd, const SickPLSMessage& message);
+
+        /** Maps a streamed reply code to the mode that produces it */
+        static sick_pls_operating_mode_t _replyCodeToMode(uint8_t reply_code);
+
+        /** Entry point for the probe threads */
+        static void* _probeThread(void* thread_args);
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_DISCOVERY_HH */
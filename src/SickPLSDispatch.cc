@@ -0,0 +1,524 @@
+/*!
+ * \file SickPLSDispatch.cc
+ * \brief Implements a class for handing each scan to several consumers,
+ *        each with its own delivery policy.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+
+#include "SickPLSDispatch.hh"
+#include "SickLogger.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Constructs a dispatcher
+     * \param pool_size Released scans kept for reuse (more are freed)
+     */
+    SickPLSScanDispatcher::SickPLSScanDispatcher(const unsigned int pool_size) :
+            _subscribers(), _registry_mutex(), _pool_size(pool_size), _pool_mutex(), _num_published(0),
+            _sick_pls(nullptr), _receive_thread_id(0), _receiving(false) {
+
+        if (pthread_mutex_init(&_registry_mutex, nullptr) != 0 || pthread_mutex_init(&_pool_mutex, nullptr) != 0) {
+            throw SickThreadException("SickPLSScanDispatcher::SickPLSScanDispatcher: pthread_mutex_init() failed!");
+        }
+
+        _pool.reserve(_pool_size);
+
+    }
+
+    /**
+     * \brief Adds a consumer
+     * \param policy How scans the consumer has not taken yet are handled
+     * \param capacity Unread scans kept by a SICK_PLS_DELIVERY_DROP_OLDEST consumer
+     * \return The consumer's handle (for Receive, GetStats and Unsubscribe)
+     */
+    unsigned int SickPLSScanDispatcher::Subscribe(const sick_pls_delivery_policy_t policy,
+                                                  const unsigned int capacity) noexcept(false) {
+
+        if (policy != SICK_PLS_DELIVERY_LOSSLESS && policy != SICK_PLS_DELIVERY_DROP_OLDEST &&
+            policy != SICK_PLS_DELIVERY_LATEST) {
+            throw SickConfigException("SickPLSScanDispatcher::Subscribe: Unsupported delivery policy!");
+        }
+
+        if (policy == SICK_PLS_DELIVERY_DROP_OLDEST && capacity == 0) {
+            throw SickConfigException("SickPLSScanDispatcher::Subscribe: Capacity must be positive!");
+        }
+
+        auto* subscriber = new sick_pls_dispatch_subscriber_t();
+        subscriber->policy = policy;
+        subscriber->capacity = capacity;
+
+        /* Waits time out against the monotonic clock */
+        pthread_condattr_t cond_attr;
+        pthread_condattr_init(&cond_attr);
+        pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+        const bool initialized = (pthread_mutex_init(&subscriber->mutex, nullptr) == 0 &&
+                                  pthread_cond_init(&subscriber->cond, &cond_attr) == 0);
+        pthread_condattr_destroy(&cond_attr);
+        if (!initialized) {
+            delete subscriber;
+            throw SickThreadException("SickPLSScanDispatcher::Subscribe: pthread_cond_init() failed!");
+        }
+
+        /* Claim a free handle */
+        pthread_mutex_lock(&_registry_mutex);
+        unsigned int handle = 0;
+        while (handle < SICK_PLS_DISPATCH_MAX_SUBSCRIBERS && _subscribers[handle] != nullptr) {
+            handle++;
+        }
+        if (handle < SICK_PLS_DISPATCH_MAX_SUBSCRIBERS) {
+            _subscribers[handle] = subscriber;
+        }
+        pthread_mutex_unlock(&_registry_mutex);
+
+        if (handle == SICK_PLS_DISPATCH_MAX_SUBSCRIBERS) {
+            pthread_cond_destroy(&subscriber->cond);
+            pthread_mutex_destroy(&subscriber->mutex);
+            delete subscriber;
+            throw SickConfigException("SickPLSScanDispatcher::Subscribe: Too many subscribers!");
+        }
+
+        return handle;
+    }
+
+    /**
+     * \brief Removes a consumer
+     * \param subscriber The consumer's handle
+     *
+     * NOTE: No thread may be receiving on the handle.
+     */
+    void SickPLSScanDispatcher::Unsubscribe(const unsigned int subscriber) noexcept(false) {
+
+        if (subscriber >= SICK_PLS_DISPATCH_MAX_SUBSCRIBERS) {
+            throw SickConfigException("SickPLSScanDispatcher::Unsubscribe: Invalid subscriber!");
+        }
+
+        /* Once out of the registry, Publish no longer sees it */
+        pthread_mutex_lock(&_registry_mutex);
+        sick_pls_dispatch_subscriber_t* const removed = _subscribers[subscriber];
+        _subscribers[subscriber] = nullptr;
+        pthread_mutex_unlock(&_registry_mutex);
+
+        if (removed == nullptr) {
+            throw SickConfigException("SickPLSScanDispatcher::Unsubscribe: Invalid subscriber!");
+        }
+
+        /* Hand back whatever it never read */
+        for (sick_pls_dispatch_scan_t* const scan: removed->queue) {
+            _unref(scan);
+        }
+        _unref(removed->latest.exchange(nullptr));
+
+        pthread_cond_destroy(&removed->cond);
+        pthread_mutex_destroy(&removed->mutex);
+        delete removed;
+
+    }
+
+    /**
+     * \brief Publishes a decoded scan
+     * \param *values The range/reflectivity values
+     * \param num_values The number of values
+     * \param timestamp_usec The scan's time stamp (handed through to consumers)
+     */
+    void SickPLSScanDispatcher::Publish(const uint16_t* const values, const unsigned int num_values,
+                                        const uint64_t timestamp_usec) noexcept(false) {
+        _publish(values, num_values, timestamp_usec);
+    }
+
+    /**
+     * \brief Publishes a scan as returned by SickPLS::GetSickScan
+     * \param *values The range/reflectivity values
+     * \param num_values The number of values
+     * \param timestamp_usec The scan's time stamp (handed through to consumers)
+     */
+    void SickPLSScanDispatcher::Publish(const unsigned int* const values, const unsigned int num_values,
+                                        const uint64_t timestamp_usec) noexcept(false) {
+        _publish(values, num_values, timestamp_usec);
+    }
+
+    /**
+     * \brief Takes the consumer's next scan
+     * \param subscriber The consumer's handle
+     * \param *&scan Set to the scan (hand it back with Release once read)
+     * \param timeout_value The time to wait for a scan (usecs, 0 => don't wait)
+     * \return True if a scan was taken, false if none arrived in time
+     *
+     * NOTE: Lossless and drop-oldest consumers get their scans oldest
+     *       first; a latest consumer gets the newest scan it has not seen.
+     */
+    bool SickPLSScanDispatcher::Receive(const unsigned int subscriber, const sick_pls_dispatch_scan_t*& scan,
+                                        const unsigned int timeout_value) noexcept(false) {
+
+        sick_pls_dispatch_subscriber_t* const consumer = _getSubscriber(subscriber);
+
+        if (pthread_mutex_lock(&consumer->mutex) != 0) {
+            throw SickThreadException("SickPLSScanDispatcher::Receive: pthread_mutex_lock() failed!");
+        }
+
+        sick_pls_dispatch_scan_t* taken = _take(consumer);
+        if (taken == nullptr && timeout_value > 0) {
+
+            struct timespec deadline{};
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_sec += timeout_value / 1000000;
+            deadline.tv_nsec += (long) (timeout_value % 1000000) * 1000;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+
+            /* Announce the wait before looking again, so a latest delivery cannot slip by unsignalled */
+            consumer->waiting.store(true);
+            while ((taken = _take(consumer)) == nullptr) {
+                if (pthread_cond_timedwait(&consumer->cond, &consumer->mutex, &deadline) == ETIMEDOUT) {
+                    taken = _take(consumer);
+                    break;
+                }
+            }
+            consumer->waiting.store(false);
+
+        }
+
+        pthread_mutex_unlock(&consumer->mutex);
+
+        if (taken == nullptr) {
+            return false;
+        }
+
+        consumer->num_received.fetch_add(1, std::memory_order_relaxed);
+        scan = taken;
+        return true;
+    }
+
+    /**
+     * \brief Hands a received scan back
+     * \param *scan The scan (nullptr is ignored)
+     */
+    void SickPLSScanDispatcher::Release(const sick_pls_dispatch_scan_t* const scan) {
+        _unref(const_cast<sick_pls_dispatch_scan_t*>(scan));
+    }
+
+    /**
+     * \brief Gets the delivery totals of a consumer
+     * \param subscriber The consumer's handle
+     * \param &stats The totals since it subscribed
+     */
+    void SickPLSScanDispatcher::GetStats(const unsigned int subscriber,
+                                         sick_pls_dispatch_stats_t& stats) const noexcept(false) {
+
+        sick_pls_dispatch_subscriber_t* const consumer = _getSubscriber(subscriber);
+
+        stats.num_offered = consumer->num_offered.load(std::memory_order_relaxed);
+        stats.num_received = consumer->num_received.load(std::memory_order_relaxed);
+        stats.num_dropped = consumer->num_dropped.load(std::memory_order_relaxed);
+        stats.max_pending = consumer->max_pending.load(std::memory_order_relaxed);
+
+        if (consumer->policy == SICK_PLS_DELIVERY_LATEST) {
+            stats.num_pending = (consumer->latest.load() != nullptr) ? 1 : 0;
+        } else {
+            pthread_mutex_lock(&consumer->mutex);
+            stats.num_pending = (unsigned int) consumer->queue.size();
+            pthread_mutex_unlock(&consumer->mutex);
+        }
+
+    }
+
+    /**
+     * \brief Starts a thread publishing every scan of the given device
+     * \param &sick_pls An initialized device (or replay)
+     *
+     * NOTE: Other threads may still configure the device meanwhile;
+     *       GetSickScan puts it back into streaming mode on its own.
+     */
+    void SickPLSScanDispatcher::Start(SickPLS& sick_pls) noexcept(false) {
+
+        if (_receiving.load()) {
+            throw SickThreadException("SickPLSScanDispatcher::Start: Already receiving!");
+        }
+
+        _sick_pls = &sick_pls;
+        _receiving.store(true);
+
+        if (pthread_create(&_receive_thread_id, nullptr, _receiveThread, this) != 0) {
+            _receiving.store(false);
+            throw SickThreadException("SickPLSScanDispatcher::Start: pthread_create() failed!");
+        }
+
+    }
+
+    /**
+     * \brief Stops the receive thread (returns once its scan in flight is published)
+     */
+    void SickPLSScanDispatcher::Stop() noexcept(false) {
+
+        if (!_receiving.exchange(false)) {
+            return;
+        }
+
+        if (pthread_join(_receive_thread_id, nullptr) != 0) {
+            throw SickThreadException("SickPLSScanDispatcher::Stop: pthread_join() failed!");
+        }
+
+    }
+
+    /**
+     * \brief Stops receiving and frees every scan
+     */
+    SickPLSScanDispatcher::~SickPLSScanDispatcher() {
+
+        try {
+            Stop();
+        }
+
+        catch (SickThreadException& sick_thread_exception) {
+            SICK_LOG_ERROR(sick_thread_exception.what());
+        }
+
+        for (unsigned int i = 0; i < SICK_PLS_DISPATCH_MAX_SUBSCRIBERS; i++) {
+            if (_subscribers[i] != nullptr) {
+                Unsubscribe(i);
+            }
+        }
+
+        for (sick_pls_dispatch_scan_t* const scan: _pool) {
+            delete scan;
+        }
+
+        pthread_mutex_destroy(&_pool_mutex);
+        pthread_mutex_destroy(&_registry_mutex);
+
+    }
+
+    /**
+     * \brief Publishes a scan
+     * \param *values The range/reflectivity values
+     * \param num_values The number of values
+     * \param timestamp_usec The scan's time stamp
+     */
+    template<class VALUE_TYPE>
+    void SickPLSScanDispatcher::_publish(const VALUE_TYPE* const values, const unsigned int num_values,
+                                         const uint64_t timestamp_usec) noexcept(false) {
+
+        if (num_values > SickPLS::SICK_MAX_NUM_MEASUREMENTS) {
+            throw SickConfigException("SickPLSScanDispatcher::Publish: Too many values!");
+        }
+
+        /* The one and only copy of the scan */
+        sick_pls_dispatch_scan_t* const scan = _allocate();
+        scan->sequence = _num_published.fetch_add(1, std::memory_order_relaxed);
+        scan->timestamp_usec = timestamp_usec;
+        scan->num_values = num_values;
+        for (unsigned int i = 0; i < num_values; i++) {
+            scan->values[i] = (uint16_t) values[i];
+        }
+
+        /* Hold a reference of our own until every consumer has one */
+        scan->num_refs.store(1, std::memory_order_relaxed);
+
+        pthread_mutex_lock(&_registry_mutex);
+        for (sick_pls_dispatch_subscriber_t* const subscriber: _subscribers) {
+            if (subscriber != nullptr) {
+                scan->num_refs.fetch_add(1, std::memory_order_relaxed);
+                _deliver(subscriber, scan);
+            }
+        }
+        pthread_mutex_unlock(&_registry_mutex);
+
+        _unref(scan);
+
+    }
+
+    /**
+     * \brief Hands a scan to one consumer (the consumer's reference is already counted)
+     * \param *subscriber The consumer
+     * \param *scan The scan
+     */
+    void SickPLSScanDispatcher::_deliver(sick_pls_dispatch_subscriber_t* const subscriber,
+                                         sick_pls_dispatch_scan_t* const scan) {
+
+        sick_pls_dispatch_scan_t* dropped = nullptr;
+        unsigned int num_pending = 1;
+
+        subscriber->num_offered.fetch_add(1, std::memory_order_relaxed);
+
+        if (subscriber->policy == SICK_PLS_DELIVERY_LATEST) {
+
+            /* Conflate: swap in the new scan, no lock unless the consumer is waiting */
+            dropped = subscriber->latest.exchange(scan);
+            if (subscriber->waiting.load()) {
+                pthread_mutex_lock(&subscriber->mutex);
+                pthread_cond_signal(&subscriber->cond);
+                pthread_mutex_unlock(&subscriber->mutex);
+            }
+
+        } else {
+
+            pthread_mutex_lock(&subscriber->mutex);
+            if (subscriber->policy == SICK_PLS_DELIVERY_DROP_OLDEST &&
+                subscriber->queue.size() >= subscriber->capacity) {
+                dropped = subscriber->queue.front();
+                subscriber->queue.pop_front();
+            }
+            subscriber->queue.push_back(scan);
+            num_pending = (unsigned int) subscriber->queue.size();
+            if (subscriber->waiting.load(std::memory_order_relaxed)) {
+                pthread_cond_signal(&subscriber->cond);
+            }
+            pthread_mutex_unlock(&subscriber->mutex);
+
+        }
+
+        if (dropped != nullptr) {
+            subscriber->num_dropped.fetch_add(1, std::memory_order_relaxed);
+            _unref(dropped);
+        }
+
+        unsigned int max_pending = subscriber->max_pending.load(std::memory_order_relaxed);
+        while (num_pending > max_pending &&
+               !subscriber->max_pending.compare_exchange_weak(max_pending, num_pending, std::memory_order_relaxed));
+
+    }
+
+    /**
+     * \brief Takes a consumer's next scan without waiting (the consumer's mutex must be held)
+     * \param *subscriber The consumer
+     * \return The scan, or nullptr if none is pending
+     */
+    sick_pls_dispatch_scan_t* SickPLSScanDispatcher::_take(sick_pls_dispatch_subscriber_t* const subscriber) {
+
+        if (subscriber->policy == SICK_PLS_DELIVERY_LATEST) {
+            return subscriber->latest.exchange(nullptr);
+        }
+
+        if (subscriber->queue.empty()) {
+            return nullptr;
+        }
+
+        sick_pls_dispatch_scan_t* const scan = subscriber->queue.front();
+        subscriber->queue.pop_front();
+        return scan;
+    }
+
+    /**
+     * \brief Gets a checked consumer
+     * \param subscriber The consumer's handle
+     * \return The consumer
+     */
+    SickPLSScanDispatcher::sick_pls_dispatch_subscriber_t*
+    SickPLSScanDispatcher::_getSubscriber(const unsigned int subscriber) const noexcept(false) {
+
+        sick_pls_dispatch_subscriber_t* consumer = nullptr;
+
+        if (subscriber < SICK_PLS_DISPATCH_MAX_SUBSCRIBERS) {
+            pthread_mutex_lock(const_cast<pthread_mutex_t*>(&_registry_mutex));
+            consumer = _subscribers[subscriber];
+            pthread_mutex_unlock(const_cast<pthread_mutex_t*>(&_registry_mutex));
+        }
+
+        if (consumer == nullptr) {
+            throw SickConfigException("SickPLSScanDispatcher::_getSubscriber: Invalid subscriber!");
+        }
+
+        return consumer;
+    }
+
+    /**
+     * \brief Gets a scan buffer, reusing a released one if there is any
+     * \return The buffer
+     */
+    sick_pls_dispatch_scan_t* SickPLSScanDispatcher::_allocate() {
+
+        sick_pls_dispatch_scan_t* scan = nullptr;
+
+        pthread_mutex_lock(&_pool_mutex);
+        if (!_pool.empty()) {
+            scan = _pool.back();
+            _pool.pop_back();
+        }
+        pthread_mutex_unlock(&_pool_mutex);
+
+        return (scan != nullptr) ? scan : new sick_pls_dispatch_scan_t();
+    }
+
+    /**
+     * \brief Drops a reference to a scan
+     * \param *scan The scan (nullptr is ignored)
+     */
+    void SickPLSScanDispatcher::_unref(sick_pls_dispatch_scan_t* const scan) {
+
+        if (scan == nullptr || scan->num_refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+
+        /* Nobody holds it any longer */
+        pthread_mutex_lock(&_pool_mutex);
+        const bool pooled = (_pool.size() < _pool_size);
+        if (pooled) {
+            _pool.push_back(scan);
+        }
+        pthread_mutex_unlock(&_pool_mutex);
+
+        if (!pooled) {
+            delete scan;
+        }
+
+    }
+
+    /**
+     * \brief The receive thread
+     * \param *thread_args The dispatcher
+     */
+    void* SickPLSScanDispatcher::_receiveThread(void* const thread_args) {
+
+        auto* const dispatcher = (SickPLSScanDispatcher*) thread_args;
+
+        unsigned int values[SickPLS::SICK_MAX_NUM_MEASUREMENTS] = {0};
+        unsigned int num_values = 0;
+        uint64_t timestamp_usec = 0;
+
+        while (dispatcher->_receiving.load()) {
+
+            try {
+
+                dispatcher->_sick_pls->GetSickScan(values, num_values, timestamp_usec);
+                dispatcher->_publish(values, num_values, timestamp_usec);
+
+            }
+
+                /* The stream stalled (e.g. during a mode change), so keep listening */
+            catch (SickTimeoutException& sick_timeout_exception) {
+                SICK_LOG_WARNING(sick_timeout_exception.what());
+            }
+
+                /* Don't spin on a device that cannot deliver */
+            catch (SickException& sick_exception) {
+                SICK_LOG_ERROR(sick_exception.what());
+                usleep(DEFAULT_SICK_PLS_DISPATCH_RETRY_INTERVAL);
+            }
+
+        }
+
+        return nullptr;
+    }
+
+} /* namespace sickpls */
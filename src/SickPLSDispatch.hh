@@ -0,0 +1,200 @@
+/*!
+ * \file SickPLSDispatch.hh
+ * \brief Defines a class for handing each scan to several consumers, each
+ *        with its own delivery policy.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_DISPATCH_HH
+#define SICK_PLS_DISPATCH_HH
+
+/* Definition dependencies */
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <pthread.h>
+
+#include "SickPLS.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define SICK_PLS_DISPATCH_MAX_SUBSCRIBERS                                   (16)  ///< Consumers a dispatcher serves
+#define DEFAULT_SICK_PLS_DISPATCH_RING_CAPACITY                             (25)  ///< One second of scans at 25 Hz
+#define DEFAULT_SICK_PLS_DISPATCH_POOL_SIZE                                 (64)  ///< Released scans kept for reuse
+#define DEFAULT_SICK_PLS_DISPATCH_RETRY_INTERVAL              (unsigned int)(1e5)  ///< Receive thread pause after a failed GetSickScan (usecs)
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \enum sick_pls_delivery_policy_t
+     * \brief How a consumer's undelivered scans are handled
+     */
+    enum sick_pls_delivery_policy_t {
+        SICK_PLS_DELIVERY_LOSSLESS,                                                ///< Queue every scan (the queue is unbounded)
+        SICK_PLS_DELIVERY_DROP_OLDEST,                                             ///< Keep the newest scans of a bounded ring
+        SICK_PLS_DELIVERY_LATEST                                                   ///< Keep only the newest scan
+    };
+
+    /*!
+     * \struct sick_pls_dispatch_scan_tag
+     * \brief A published scan. It is shared by every consumer it is
+     *        delivered to and must be handed back to the dispatcher
+     *        (SickPLSScanDispatcher::Release) once read.
+     */
+    /*!
+     * \typedef sick_pls_dispatch_scan_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_dispatch_scan_tag {
+        uint64_t sequence;                                                         ///< Publication index (from 0)
+        uint64_t timestamp_usec;                                                   ///< Time stamp given to Publish
+        unsigned int num_values;                                                   ///< Number of values
+        uint16_t values[SickPLS::SICK_MAX_NUM_MEASUREMENTS];                       ///< Range/reflectivity values
+        std::atomic<unsigned int> num_refs;                                        ///< Outstanding references (dispatcher use only)
+    } sick_pls_dispatch_scan_t;
+
+    /*!
+     * \struct sick_pls_dispatch_stats_tag
+     * \brief Running totals of one consumer's deliveries.
+     */
+    /*!
+     * \typedef sick_pls_dispatch_stats_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_dispatch_stats_tag {
+        uint64_t num_offered;                                                      ///< Scans published while subscribed
+        uint64_t num_received;                                                     ///< Scans taken by the consumer
+        uint64_t num_dropped;                                                      ///< Scans discarded unread (ring overflow or conflation)
+        unsigned int num_pending;                                                  ///< Scans waiting to be taken
+        unsigned int max_pending;                                                  ///< Most scans ever waiting at once
+    } sick_pls_dispatch_stats_t;
+
+    /*!
+     * \brief Fans scans out to consumers that each pick a delivery policy
+     *
+     * Publish() copies a scan once into a reference counted buffer and
+     * hands that same buffer to every subscriber. A lossless subscriber
+     * queues it, a drop-oldest subscriber pushes it onto a bounded ring
+     * (discarding the oldest unread scan when full) and a latest
+     * subscriber swaps it into a single slot with an atomic exchange,
+     * discarding whatever unread scan was there. The publisher only ever
+     * holds a subscriber's lock for a pointer push (and not at all for a
+     * latest subscriber nobody is waiting on), so however slow a consumer
+     * is, the publishing thread is never held up by it.
+     *
+     * Start() runs a receive thread that publishes every scan of a SickPLS.
+     */
+    class SickPLSScanDispatcher {
+
+    public:
+
+        /** Constructs a dispatcher keeping up to pool_size released scans for reuse */
+        explicit SickPLSScanDispatcher(unsigned int pool_size = DEFAULT_SICK_PLS_DISPATCH_POOL_SIZE);
+
+        /** Adds a consumer and returns its handle (capacity is only used by SICK_PLS_DELIVERY_DROP_OLDEST) */
+        unsigned int Subscribe(sick_pls_delivery_policy_t policy,
+                               unsigned int capacity = DEFAULT_SICK_PLS_DISPATCH_RING_CAPACITY) noexcept(false);
+
+        /** Removes a consumer and releases its unread scans (it must not be receiving) */
+        void Unsubscribe(unsigned int subscriber) noexcept(false);
+
+        /** Publishes a decoded scan */
+        void Publish(const uint16_t* values, unsigned int num_values, uint64_t timestamp_usec) noexcept(false);
+
+        /** Publishes a scan as returned by SickPLS::GetSickScan */
+        void Publish(const unsigned int* values, unsigned int num_values, uint64_t timestamp_usec) noexcept(false);
+
+        /** Takes the consumer's next scan, waiting up to timeout_value usecs (0 => don't wait) */
+        bool Receive(unsigned int subscriber, const sick_pls_dispatch_scan_t*& scan,
+                     unsigned int timeout_value = 0) noexcept(false);
+
+        /** Hands a received scan back */
+        void Release(const sick_pls_dispatch_scan_t* scan);
+
+        /** Gets the delivery totals of a consumer */
+        void GetStats(unsigned int subscriber, sick_pls_dispatch_stats_t& stats) const noexcept(false);
+
+        /** Gets the number of scans published */
+        [[nodiscard]] uint64_t GetNumPublished() const { return _num_published.load(std::memory_order_relaxed); }
+
+        /** Starts a thread publishing every scan of the given (initialized) device */
+        void Start(SickPLS& sick_pls) noexcept(false);
+
+        /** Stops the receive thread */
+        void Stop() noexcept(false);
+
+        /** A standard destructor */
+        ~SickPLSScanDispatcher();
+
+    private:
+
+        /** A consumer */
+        typedef struct sick_pls_dispatch_subscriber_tag {
+            sick_pls_delivery_policy_t policy;                                     ///< Delivery policy
+            unsigned int capacity;                                                 ///< Ring capacity (drop-oldest only)
+            pthread_mutex_t mutex;                                                 ///< Guards the queue and the wait
+            pthread_cond_t cond;                                                   ///< Signalled when a scan is delivered
+            std::deque<sick_pls_dispatch_scan_t*> queue;                           ///< Unread scans (lossless and drop-oldest)
+            alignas(64) std::atomic<sick_pls_dispatch_scan_t*> latest;             ///< Unread scan (latest only)
+            std::atomic<bool> waiting;                                             ///< True while the consumer is (about to be) waiting
+            std::atomic<uint64_t> num_offered;                                     ///< Scans published while subscribed
+            std::atomic<uint64_t> num_received;                                    ///< Scans taken
+            std::atomic<uint64_t> num_dropped;                                     ///< Scans discarded unread
+            std::atomic<unsigned int> max_pending;                                 ///< Most scans ever waiting at once
+        } sick_pls_dispatch_subscriber_t;
+
+        /** The consumers (guarded by the registry mutex) */
+        sick_pls_dispatch_subscriber_t* _subscribers[SICK_PLS_DISPATCH_MAX_SUBSCRIBERS];
+        pthread_mutex_t _registry_mutex;
+
+        /** Released scans kept for reuse */
+        std::vector<sick_pls_dispatch_scan_t*> _pool;
+        unsigned int _pool_size;
+        pthread_mutex_t _pool_mutex;
+
+        /** Scans published so far */
+        std::atomic<uint64_t> _num_published;
+
+        /** The receive thread */
+        SickPLS* _sick_pls;
+        pthread_t _receive_thread_id;
+        std::atomic<bool> _receiving;
+
+        /** Publishes a scan */
+        template<class VALUE_TYPE>
+        void _publish(const VALUE_TYPE* values, unsigned int num_values, uint64_t timestamp_usec) noexcept(false);
+
+        /** Hands a scan to one consumer */
+        void _deliver(sick_pls_dispatch_subscriber_t* subscriber, sick_pls_dispatch_scan_t* scan);
+
+        /** Takes a consumer's next scan without waiting */
+        sick_pls_dispatch_scan_t* _take(sick_pls_dispatch_subscriber_t* subscriber);
+
+        /** Gets a checked consumer */
+        sick_pls_dispatch_subscriber_t* _getSubscriber(unsigned int subscriber) const noexcept(false);
+
+        /** Gets a scan buffer from the pool */
+        sick_pls_dispatch_scan_t* _allocate();
+
+        /** Drops a reference to a scan, returning it to the pool with the last */
+        void _unref(sick_pls_dispatch_scan_t* scan);
+
+        /** Entry point for the receive thread */
+        static void* _receiveThread(void* thread_args);
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_DISPATCH_HH */
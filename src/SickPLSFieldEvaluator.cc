@@ -0,0 +1,250 @@
+/*!
+ * \file SickPLSFieldEvaluator.cc
+ * \brief Implements a host-side evaluator checking Sick PLS scans
+ *        against polygonal protective/warning zones.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
+#include "SickPLSFieldEvaluator.hh"
+#include "SickPLSSimd.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Constructs an evaluator without any zones
+     * \param &converter Describes the scan geometry (must outlive the evaluator)
+     */
+    SickPLSFieldEvaluator::SickPLSFieldEvaluator(const SickPLSCartesianConverter& converter) :
+            _converter(converter), _num_zones(0), _min_beams(), _near(), _far() {}
+
+    /**
+     * \brief Compiles a zone polygon into per-beam range intervals
+     * \param *x Vertex x coordinates (sensor frame, m)
+     * \param *y Vertex y coordinates (sensor frame, m)
+     * \param num_vertices Number of vertices (3 to SICK_PLS_FIELD_MAX_VERTICES)
+     * \param min_beams Number of beams that must hit inside the zone to violate it
+     * \return The index of the zone (its bit in the result mask)
+     */
+    unsigned int SickPLSFieldEvaluator::AddZone(const double* const x, const double* const y,
+                                                const unsigned int num_vertices,
+                                                const unsigned int min_beams) noexcept(false) {
+
+        /* A sanity check */
+        if (num_vertices < 3 || num_vertices > SICK_PLS_FIELD_MAX_VERTICES || min_beams == 0) {
+            throw SickConfigException("SickPLSFieldEvaluator::AddZone: Invalid polygon!");
+        }
+
+        /* Make sure there is room */
+        if (_num_zones >= SICK_PLS_FIELD_MAX_ZONES) {
+            throw SickConfigException("SickPLSFieldEvaluator::AddZone: Too many zones!");
+        }
+
+        const unsigned int zone = _num_zones;
+        const float* const cos_table = _converter.GetCosTable();
+        const float* const sin_table = _converter.GetSinTable();
+
+        for (unsigned int i = 0; i < _converter.GetNumBeams(); i++) {
+
+            const double dx = cos_table[i], dy = sin_table[i];
+
+            /* Distances along the beam at which it crosses the polygon's edges */
+            double crossings[SICK_PLS_FIELD_MAX_VERTICES];
+            unsigned int num_crossings = 0;
+            for (unsigned int j = 0; j < num_vertices; j++) {
+
+                const unsigned int k = (j + 1 == num_vertices) ? 0 : j + 1;
+                const double ex = x[k] - x[j], ey = y[k] - y[j];
+                const double denom = dx * ey - dy * ex;
+                if (fabs(denom) < 1e-12) {
+                    continue;
+                }
+
+                /* Beam: t * d, edge: v[j] + u * e (half open so that shared vertices count once) */
+                const double t = (x[j] * ey - y[j] * ex) / denom;
+                const double u = (x[j] * dy - y[j] * dx) / denom;
+                if (t > 0 && u >= 0 && u < 1) {
+                    crossings[num_crossings++] = t;
+                }
+
+            }
+            std::sort(crossings, crossings + num_crossings);
+
+            /* An odd number of crossings means the sensor itself is inside */
+            double near, far;
+            if (num_crossings % 2 == 1) {
+                near = 0;
+                far = crossings[0];
+            } else if (num_crossings >= 2) {
+                near = crossings[0];
+                far = crossings[1];
+            } else {
+                _near[zone][i] = 0xFFFF;
+                _far[zone][i] = 0;
+                continue;
+            }
+
+            /* Round inwards to whole cm (a zero range is not a return) */
+            near = std::max(ceil(near * 100.0), 1.0);
+            far = std::min(floor(far * 100.0), 65535.0);
+            _near[zone][i] = (uint16_t) near;
+            _far[zone][i] = (uint16_t) far;
+
+        }
+
+        _min_beams[zone] = min_beams;
+
+        return _num_zones++;
+    }
+
+    /**
+     * \brief Gets the compiled interval of a beam in a zone
+     * \param zone The zone index
+     * \param beam The beam index
+     * \param &near Closest range inside the zone (cm)
+     * \param &far Farthest range inside the zone (cm)
+     */
+    void SickPLSFieldEvaluator::GetZoneInterval(const unsigned int zone, const unsigned int beam,
+                                                uint16_t& near, uint16_t& far) const noexcept(false) {
+
+        /* A sanity check */
+        if (zone >= _num_zones || beam >= _converter.GetNumBeams()) {
+            throw SickConfigException("SickPLSFieldEvaluator::GetZoneInterval: Invalid zone or beam!");
+        }
+
+        near = _near[zone][beam];
+        far = _far[zone][beam];
+
+    }
+
+    /**
+     * \brief Checks a scan against every zone
+     * \param *ranges The range values (cm)
+     * \param num_ranges The number of range values
+     * \param &result The per-zone beam masks, violated zones and evaluation time
+     * \return The violated zone mask (also stored in the result)
+     */
+    uint32_t SickPLSFieldEvaluator::Evaluate(const uint16_t* const ranges, const unsigned int num_ranges,
+                                             sick_pls_field_result_t& result) const noexcept(false) {
+
+        /* Ensure the scan matches the tables */
+        if (num_ranges > _converter.GetNumBeams()) {
+            throw SickConfigException("SickPLSFieldEvaluator::Evaluate: Scan is larger than the angle tables!");
+        }
+
+        struct timespec start_time, end_time;
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+        const bool use_avx2 = sick_pls_cpu_has_avx2();
+
+        result.zone_mask = 0;
+        for (unsigned int zone = 0; zone < _num_zones; zone++) {
+
+            uint32_t* const beam_mask = result.beam_mask[zone];
+            memset(beam_mask, 0, sizeof(result.beam_mask[zone]));
+
+            const unsigned int begin = use_avx2 ? _evaluateAVX2(zone, ranges, num_ranges, beam_mask) : 0;
+            _evaluateScalar(zone, ranges, begin, num_ranges, beam_mask);
+
+            unsigned int num_inside = 0;
+            for (unsigned int word = 0; word < (num_ranges + 31) / 32; word++) {
+                num_inside += (unsigned int) __builtin_popcount(beam_mask[word]);
+            }
+
+            result.num_beams_inside[zone] = (uint16_t) num_inside;
+            if (num_inside >= _min_beams[zone]) {
+                result.zone_mask |= 1u << zone;
+            }
+
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &end_time);
+        result.evaluation_time = (uint32_t) ((end_time.tv_sec - start_time.tv_sec) * 1000000000L +
+                                             (end_time.tv_nsec - start_time.tv_nsec));
+
+        return result.zone_mask;
+    }
+
+    /**
+     * \brief Evaluates beams [begin,end) of a zone one at a time
+     */
+    void SickPLSFieldEvaluator::_evaluateScalar(const unsigned int zone, const uint16_t* const ranges,
+                                                const unsigned int begin, const unsigned int end,
+                                                uint32_t* const beam_mask) const {
+
+        for (unsigned int i = begin; i < end; i++) {
+            if (ranges[i] >= _near[zone][i] && ranges[i] <= _far[zone][i]) {
+                beam_mask[i / 32] |= 1u << (i % 32);
+            }
+        }
+
+    }
+
+#ifdef SICK_PLS_HAVE_X86_SIMD
+
+    /**
+     * \brief Evaluates a zone 32 beams at a time
+     * \return The first beam left for the scalar tail
+     */
+    SICK_PLS_TARGET_AVX2 unsigned int
+    SickPLSFieldEvaluator::_evaluateAVX2(const unsigned int zone, const uint16_t* const ranges,
+                                         const unsigned int num_ranges, uint32_t* const beam_mask) const {
+
+        const uint16_t* const near = _near[zone];
+        const uint16_t* const far = _far[zone];
+
+        unsigned int i = 0;
+        for (; i + 32 <= num_ranges; i += 32) {
+
+            const __m256i range_lo = _mm256_loadu_si256((const __m256i*) &ranges[i]);
+            const __m256i range_hi = _mm256_loadu_si256((const __m256i*) &ranges[i + 16]);
+
+            /* near <= r <= far  <=>  max(r, near) == r && min(r, far) == r (unsigned) */
+            const __m256i inside_lo = _mm256_and_si256(
+                    _mm256_cmpeq_epi16(_mm256_max_epu16(range_lo, _mm256_loadu_si256((const __m256i*) &near[i])), range_lo),
+                    _mm256_cmpeq_epi16(_mm256_min_epu16(range_lo, _mm256_loadu_si256((const __m256i*) &far[i])), range_lo));
+            const __m256i inside_hi = _mm256_and_si256(
+                    _mm256_cmpeq_epi16(_mm256_max_epu16(range_hi, _mm256_loadu_si256((const __m256i*) &near[i + 16])), range_hi),
+                    _mm256_cmpeq_epi16(_mm256_min_epu16(range_hi, _mm256_loadu_si256((const __m256i*) &far[i + 16])), range_hi));
+
+            /* Narrow to one byte per beam (packs interleaves the 128-bit lanes, so undo that) */
+            const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(inside_lo, inside_hi), 0xD8);
+            beam_mask[i / 32] = (uint32_t) _mm256_movemask_epi8(packed);
+
+        }
+
+        return i;
+    }
+
+#else
+
+    /**
+     * \brief Fallback for architectures without the AVX2 kernels
+     */
+    unsigned int SickPLSFieldEvaluator::_evaluateAVX2(const unsigned int zone, const uint16_t* const ranges,
+                                                      const unsigned int num_ranges, uint32_t* const beam_mask) const {
+        return 0;
+    }
+
+#endif
+
+} /* namespace sickpls */
@@ -0,0 +1,118 @@
+/*!
+ * \file SickPLSFieldEvaluator.hh
+ * \brief Defines a host-side evaluator checking Sick PLS scans
+ *        against polygonal protective/warning zones.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_FIELD_EVALUATOR_HH
+#define SICK_PLS_FIELD_EVALUATOR_HH
+
+/* Definition dependencies */
+#include <cstdint>
+
+#include "SickPLSCartesian.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define SICK_PLS_FIELD_MAX_ZONES                                            (32)  ///< One bit per zone in the result mask
+#define SICK_PLS_FIELD_MAX_VERTICES                                         (64)  ///< Upper bound on a zone polygon's size
+#define SICK_PLS_FIELD_MASK_WORDS          ((SICK_PLS_CARTESIAN_MAX_POINTS + 31) / 32)  ///< 32-bit words in a per-zone beam mask
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \struct sick_pls_field_result_tag
+     * \brief A structure holding the outcome of a field evaluation.
+     *        Bit k of zone_mask is set if zone k was violated, and
+     *        bit (i % 32) of beam_mask[k][i / 32] is set if beam i
+     *        hit something inside zone k.
+     */
+    /*!
+     * \typedef sick_pls_field_result_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_field_result_tag {
+        uint32_t zone_mask;                                                        ///< Violated zones (one bit per zone)
+        uint16_t num_beams_inside[SICK_PLS_FIELD_MAX_ZONES];                       ///< Number of beams hitting inside each zone
+        uint32_t beam_mask[SICK_PLS_FIELD_MAX_ZONES][SICK_PLS_FIELD_MASK_WORDS];   ///< Beams hitting inside each zone
+        uint32_t evaluation_time;                                                  ///< Time spent evaluating the scan (nsecs)
+    } sick_pls_field_result_t;
+
+    /*!
+     * \brief Checks scans against polygonal zones given in sensor coordinates
+     *
+     * Since the beams have a fixed angular layout, each zone polygon is
+     * compiled once into a per-beam range interval [near, far] (cm): beam i
+     * hits inside the zone iff near[i] <= r[i] <= far[i]. Evaluating a scan
+     * against K zones is then a vectorized compare over the 16-bit ranges
+     * producing one bit per beam, cheap enough to run right after
+     * SickPLS::GetSickScan on the receiving thread.
+     *
+     * The interval is the first stretch of each beam inside the polygon, so
+     * zones should be star-shaped as seen from the sensor (as the PLS's own
+     * fields are); parts of a zone hidden behind an earlier part along the
+     * same beam are ignored.
+     */
+    class SickPLSFieldEvaluator {
+
+    public:
+
+        /** Constructs an evaluator for scans produced with the given geometry */
+        explicit SickPLSFieldEvaluator(const SickPLSCartesianConverter& converter);
+
+        /** Compiles a zone polygon (sensor frame, m) and returns its index */
+        unsigned int AddZone(const double* x, const double* y, unsigned int num_vertices,
+                             unsigned int min_beams = 1) noexcept(false);
+
+        /** Removes every zone */
+        void ClearZones() { _num_zones = 0; }
+
+        /** Gets the number of zones */
+        [[nodiscard]] unsigned int GetNumZones() const { return _num_zones; }
+
+        /** Gets the compiled interval of a beam in a zone (cm, near > far => the beam misses the zone) */
+        void GetZoneInterval(unsigned int zone, unsigned int beam, uint16_t& near, uint16_t& far) const noexcept(false);
+
+        /** Checks a scan against every zone and returns the violated zone mask */
+        uint32_t Evaluate(const uint16_t* ranges, unsigned int num_ranges,
+                          sick_pls_field_result_t& result) const noexcept(false);
+
+    private:
+
+        /** The scan geometry */
+        const SickPLSCartesianConverter& _converter;
+
+        /** Number of zones compiled */
+        unsigned int _num_zones;
+
+        /** Number of beams hitting a zone before it counts as violated */
+        unsigned int _min_beams[SICK_PLS_FIELD_MAX_ZONES];
+
+        /** Per-zone, per-beam interval bounds (cm, inclusive) */
+        alignas(32) uint16_t _near[SICK_PLS_FIELD_MAX_ZONES][SICK_PLS_CARTESIAN_MAX_POINTS];
+        alignas(32) uint16_t _far[SICK_PLS_FIELD_MAX_ZONES][SICK_PLS_CARTESIAN_MAX_POINTS];
+
+        /** Scalar evaluation of beams [begin,end) of a zone */
+        void _evaluateScalar(unsigned int zone, const uint16_t* ranges, unsigned int begin, unsigned int end,
+                             uint32_t* beam_mask) const;
+
+        /** AVX2 evaluation of a zone (returns the first beam left for the scalar tail) */
+        unsigned int _evaluateAVX2(unsigned int zone, const uint16_t* ranges, unsigned int num_ranges,
+                                   uint32_t* beam_mask) const;
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_FIELD_EVALUATOR_HH */
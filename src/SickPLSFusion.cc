@@ -0,0 +1,277 @@
+/*!
+ * \file SickPLSFusion.cc
+ * \brief Implements a class for fusing time-synchronized scans from
+ *        several Sick PLS units into a single 360 degree scan.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <algorithm>
+#include <cmath>
+
+#include "SickPLSFusion.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Constructs a fusion stage
+     * \param resolution Output bin width (deg, must divide 360)
+     * \param max_skew_usec Largest time stamp difference within a set (usecs)
+     */
+    SickPLSFusion::SickPLSFusion(const double resolution, const uint64_t max_skew_usec) noexcept(false) :
+            _num_bins(0), _bin_width(0), _max_skew_usec(max_skew_usec), _num_sensors(0), _last_fused_usec(0),
+            _num_fused(0) {
+
+        /* The bins must tile the circle */
+        const long num_bins = (resolution > 0) ? std::lround(360.0 / resolution) : 0;
+        if (num_bins < 1 || num_bins > SICK_PLS_FUSION_MAX_BINS || std::fabs(num_bins * resolution - 360.0) > 1e-6) {
+            throw SickConfigException("SickPLSFusion::SickPLSFusion: Resolution must divide 360 deg into at most "
+                                      "SICK_PLS_FUSION_MAX_BINS bins!");
+        }
+
+        _num_bins = (unsigned int) num_bins;
+        _bin_width = 2 * M_PI / _num_bins;
+
+    }
+
+    /**
+     * \brief Adds a sensor
+     * \param &converter The sensor's scan geometry, with its mounting pose in the output frame
+     * \param time_offset_usec Added to the sensor's time stamps (usecs)
+     * \return The sensor's index (for Push)
+     *
+     * NOTE: Sensors must all be added before the first Push.
+     */
+    unsigned int SickPLSFusion::AddSensor(const SickPLSCartesianConverter& converter,
+                                          const int64_t time_offset_usec) noexcept(false) {
+
+        if (_num_sensors == SICK_PLS_FUSION_MAX_SENSORS) {
+            throw SickConfigException("SickPLSFusion::AddSensor: Too many sensors!");
+        }
+
+        for (unsigned int i = 0; i < _num_sensors; i++) {
+            if (_sensors[i]->num_pushed.load(std::memory_order_relaxed) > 0) {
+                throw SickConfigException("SickPLSFusion::AddSensor: Scans have already been pushed!");
+            }
+        }
+
+        _sensors[_num_sensors].reset(new sick_pls_fusion_sensor_t{converter, time_offset_usec});
+        return _num_sensors++;
+    }
+
+    /**
+     * \brief Adds a decoded scan
+     * \param sensor The sensor index (from AddSensor)
+     * \param *ranges The range values (cm)
+     * \param num_ranges The number of range values
+     * \param timestamp_usec When the scan was taken (usecs)
+     * \param &fused_scan Filled in when this scan completed a set (untouched otherwise)
+     * \return True if fused_scan was filled in
+     */
+    bool SickPLSFusion::Push(const unsigned int sensor, const uint16_t* const ranges, const unsigned int num_ranges,
+                             const uint64_t timestamp_usec, sick_pls_fused_scan_t& fused_scan) noexcept(false) {
+        return _push(sensor, ranges, num_ranges, timestamp_usec, fused_scan);
+    }
+
+    /**
+     * \brief Adds a scan as returned by SickPLS::GetSickScan
+     * \param sensor The sensor index (from AddSensor)
+     * \param *ranges The range values (cm)
+     * \param num_ranges The number of range values
+     * \param timestamp_usec When the scan was taken (usecs)
+     * \param &fused_scan Filled in when this scan completed a set (untouched otherwise)
+     * \return True if fused_scan was filled in
+     */
+    bool SickPLSFusion::Push(const unsigned int sensor, const unsigned int* const ranges, const unsigned int num_ranges,
+                             const uint64_t timestamp_usec, sick_pls_fused_scan_t& fused_scan) noexcept(false) {
+        return _push(sensor, ranges, num_ranges, timestamp_usec, fused_scan);
+    }
+
+    /**
+     * \brief Writes a scan into its sensor's ring and tries to complete a set
+     */
+    template<class RANGE_TYPE>
+    bool SickPLSFusion::_push(const unsigned int sensor, const RANGE_TYPE* const ranges, const unsigned int num_ranges,
+                              const uint64_t timestamp_usec, sick_pls_fused_scan_t& fused_scan) noexcept(false) {
+
+        if (sensor >= _num_sensors) {
+            throw SickConfigException("SickPLSFusion::Push: Invalid sensor!");
+        }
+
+        sick_pls_fusion_sensor_t& curr_sensor = *_sensors[sensor];
+        if (num_ranges > curr_sensor.converter.GetNumBeams()) {
+            throw SickConfigException("SickPLSFusion::Push: Scan is larger than the sensor's geometry!");
+        }
+
+        const auto offset_usec = (int64_t) timestamp_usec + curr_sensor.time_offset_usec;
+        const uint64_t curr_usec = (offset_usec > 0) ? (uint64_t) offset_usec : 0;
+
+        /* Only this sensor's thread writes its ring */
+        const uint64_t index = curr_sensor.num_pushed.load(std::memory_order_relaxed);
+        sick_pls_fusion_slot_t& slot = curr_sensor.slots[index & (SICK_PLS_FUSION_HISTORY - 1)];
+
+        const uint64_t sequence = slot.sequence.load(std::memory_order_relaxed) + 2;
+        slot.sequence.store(sequence - 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.timestamp_usec = curr_usec;
+        slot.num_ranges = num_ranges;
+        for (unsigned int i = 0; i < num_ranges; i++) {
+            slot.ranges[i] = (uint16_t) ranges[i];
+        }
+
+        slot.sequence.store(sequence, std::memory_order_release);
+        curr_sensor.num_pushed.store(index + 1, std::memory_order_release);
+
+        /* Try to complete a set around this scan (binned aside until it is claimed) */
+        sick_pls_fused_scan_t curr_fused_scan;
+        for (unsigned int attempt = 0; attempt < SICK_PLS_FUSION_MAX_RETRIES; attempt++) {
+
+            uint64_t last_usec = _last_fused_usec.load(std::memory_order_acquire);
+            if (curr_usec <= last_usec) {
+                return false;
+            }
+
+            sick_pls_fusion_pick_t picks[SICK_PLS_FUSION_MAX_SENSORS];
+            picks[sensor] = {&slot, sequence, curr_usec};
+
+            uint64_t latest_usec = curr_usec;
+            for (unsigned int i = 0; i < _num_sensors; i++) {
+                if (i != sensor) {
+                    if (!_pick(i, curr_usec, last_usec, picks[i])) {
+                        return false;
+                    }
+                    latest_usec = std::max(latest_usec, picks[i].timestamp_usec);
+                }
+            }
+
+            /* Claim the set only once it has been binned intact */
+            if (_fuse(picks, curr_fused_scan) &&
+                _last_fused_usec.compare_exchange_strong(last_usec, latest_usec, std::memory_order_acq_rel)) {
+                _num_fused.fetch_add(1, std::memory_order_relaxed);
+                fused_scan = curr_fused_scan;
+                return true;
+            }
+
+        }
+
+        return false;
+    }
+
+    /**
+     * \brief Finds the scan of a sensor closest to the given time stamp
+     * \param sensor The sensor index
+     * \param timestamp_usec The time stamp to match (usecs)
+     * \param last_usec Only scans after this are eligible (usecs)
+     * \param &pick The chosen scan
+     * \return True if a scan within the maximum skew was found
+     */
+    bool SickPLSFusion::_pick(const unsigned int sensor, const uint64_t timestamp_usec, const uint64_t last_usec,
+                              sick_pls_fusion_pick_t& pick) const {
+
+        const sick_pls_fusion_sensor_t& curr_sensor = *_sensors[sensor];
+        const uint64_t num_pushed = curr_sensor.num_pushed.load(std::memory_order_acquire);
+
+        uint64_t best_skew_usec = UINT64_MAX;
+        const uint64_t num_candidates = std::min<uint64_t>(num_pushed, SICK_PLS_FUSION_HISTORY);
+        for (uint64_t i = 0; i < num_candidates; i++) {
+
+            const sick_pls_fusion_slot_t& slot =
+                    curr_sensor.slots[(num_pushed - 1 - i) & (SICK_PLS_FUSION_HISTORY - 1)];
+
+            /* Read the time stamp under the seqlock */
+            const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence & 1) {
+                continue;
+            }
+            const uint64_t slot_usec = slot.timestamp_usec;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence || slot_usec <= last_usec) {
+                continue;
+            }
+
+            const uint64_t skew_usec = (slot_usec > timestamp_usec) ? slot_usec - timestamp_usec :
+                                       timestamp_usec - slot_usec;
+            if (skew_usec <= _max_skew_usec && skew_usec < best_skew_usec) {
+                pick = {&slot, sequence, slot_usec};
+                best_skew_usec = skew_usec;
+            }
+
+        }
+
+        return best_skew_usec != UINT64_MAX;
+    }
+
+    /**
+     * \brief Bins a set into a fused scan (nearest return per bin)
+     * \param *picks One scan per sensor
+     * \param &fused_scan The destination scan
+     * \return False if a scan was overwritten while being read
+     */
+    bool SickPLSFusion::_fuse(const sick_pls_fusion_pick_t* const picks, sick_pls_fused_scan_t& fused_scan) const {
+
+        std::fill(fused_scan.ranges, fused_scan.ranges + _num_bins, (uint16_t) SICK_PLS_FUSION_NO_RETURN);
+        fused_scan.num_points = 0;
+
+        uint64_t earliest_usec = UINT64_MAX, latest_usec = 0;
+        sick_pls_cartesian_scan_t cartesian_scan;
+        for (unsigned int i = 0; i < _num_sensors; i++) {
+
+            const sick_pls_fusion_slot_t& slot = *picks[i].slot;
+            _sensors[i]->converter.Convert(slot.ranges, std::min(slot.num_ranges, _sensors[i]->converter.GetNumBeams()),
+                                           cartesian_scan);
+
+            /* Discard the set if the scan changed underneath us */
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != picks[i].sequence) {
+                return false;
+            }
+
+            for (unsigned int j = 0; j < cartesian_scan.num_points; j++) {
+
+                if (!cartesian_scan.valid[j]) {
+                    continue;
+                }
+
+                const float x = cartesian_scan.x[j], y = cartesian_scan.y[j];
+                const auto range = (unsigned int) std::lround(std::sqrt(x * x + y * y) * 100.0f);
+                auto bin = (unsigned int) ((std::atan2(y, x) + M_PI) / _bin_width);
+                bin = std::min(bin, _num_bins - 1);
+
+                if (range < fused_scan.ranges[bin]) {
+                    fused_scan.ranges[bin] = (uint16_t) range;
+                }
+                fused_scan.num_points++;
+
+            }
+
+            fused_scan.sensor_timestamps_usec[i] = picks[i].timestamp_usec;
+            earliest_usec = std::min(earliest_usec, picks[i].timestamp_usec);
+            latest_usec = std::max(latest_usec, picks[i].timestamp_usec);
+
+        }
+
+        fused_scan.timestamp_usec = latest_usec;
+        fused_scan.skew_usec = latest_usec - earliest_usec;
+        fused_scan.num_sensors = _num_sensors;
+        fused_scan.num_bins = _num_bins;
+        fused_scan.resolution = 360.0 / _num_bins;
+
+        return true;
+    }
+
+} /* namespace sickpls */
@@ -0,0 +1,167 @@
+/*!
+ * \file SickPLSFusion.hh
+ * \brief Defines a class for fusing time-synchronized scans from
+ *        several Sick PLS units into a single 360 degree scan.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_FUSION_HH
+#define SICK_PLS_FUSION_HH
+
+/* Definition dependencies */
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+
+#include "SickPLSCartesian.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define SICK_PLS_FUSION_MAX_SENSORS                                          (8)  ///< Sensors a fusion stage accepts
+#define SICK_PLS_FUSION_MAX_BINS                                          (1440)  ///< 360 deg at 0.25 deg
+#define SICK_PLS_FUSION_HISTORY                                              (4)  ///< Scans kept per sensor for pairing (power of two)
+#define SICK_PLS_FUSION_MAX_RETRIES                                          (8)  ///< Pairing attempts per Push before giving up
+#define SICK_PLS_FUSION_NO_RETURN                                       (0xFFFF)  ///< Reported for bins without a valid return
+#define DEFAULT_SICK_PLS_FUSION_RESOLUTION                                 (0.5)  ///< Output resolution (deg)
+#define DEFAULT_SICK_PLS_FUSION_MAX_SKEW                                 (20000)  ///< Half of the PLS's 40 ms scan period (usecs)
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \struct sick_pls_fused_scan_tag
+     * \brief A structure holding a fused scan. Bin i covers bearings
+     *        [-180 + i * resolution, -180 + (i + 1) * resolution) deg in
+     *        the output frame, so the scan is sorted by angle.
+     */
+    /*!
+     * \typedef sick_pls_fused_scan_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_fused_scan_tag {
+        uint64_t timestamp_usec;                                                   ///< Latest input time stamp (offsets applied)
+        uint64_t skew_usec;                                                        ///< Latest minus earliest input time stamp
+        unsigned int num_sensors;                                                  ///< Number of inputs
+        uint64_t sensor_timestamps_usec[SICK_PLS_FUSION_MAX_SENSORS];              ///< Time stamp of each input (offsets applied)
+        unsigned int num_points;                                                   ///< Valid returns binned
+        unsigned int num_bins;                                                     ///< Number of bins
+        double resolution;                                                         ///< Bin width (deg)
+        uint16_t ranges[SICK_PLS_FUSION_MAX_BINS];                                 ///< Nearest return per bin (cm)
+    } sick_pls_fused_scan_t;
+
+    /*!
+     * \brief Pairs scans from several sensors by time stamp and merges them
+     *        into one angularly sorted scan around a common origin
+     *
+     * Each sensor's extrinsics are its converter's mounting pose (the
+     * converter also supplies the scan geometry and valid range window).
+     * Every sensor's reading thread calls Push() with its own scans. The
+     * scans go into per-sensor seqlocked rings, and whichever Push()
+     * completes a set (one scan per sensor, all within the maximum skew)
+     * fuses it on the spot, so a fused scan is out as soon as the later
+     * input has been converted. A set is claimed with one compare-and-swap
+     * on the latest fused time stamp, which also keeps every scan from
+     * being used twice; no Push() ever takes a lock or waits on another.
+     *
+     * Time stamps must come from one clock, e.g. those of the timestamped
+     * SickPLS::GetSickScan; per-sensor offsets absorb fixed differences.
+     */
+    class SickPLSFusion {
+
+    public:
+
+        /** Constructs a fusion stage with the given output resolution (deg) and maximum skew (usecs) */
+        explicit SickPLSFusion(double resolution = DEFAULT_SICK_PLS_FUSION_RESOLUTION,
+                               uint64_t max_skew_usec = DEFAULT_SICK_PLS_FUSION_MAX_SKEW) noexcept(false);
+
+        /** Adds a sensor (before any Push) and returns its index */
+        unsigned int AddSensor(const SickPLSCartesianConverter& converter,
+                               int64_t time_offset_usec = 0) noexcept(false);
+
+        /** Adds a decoded scan, returning true if it completed a fused scan */
+        bool Push(unsigned int sensor, const uint16_t* ranges, unsigned int num_ranges, uint64_t timestamp_usec,
+                  sick_pls_fused_scan_t& fused_scan) noexcept(false);
+
+        /** Adds a scan as returned by SickPLS::GetSickScan, returning true if it completed a fused scan */
+        bool Push(unsigned int sensor, const unsigned int* ranges, unsigned int num_ranges, uint64_t timestamp_usec,
+                  sick_pls_fused_scan_t& fused_scan) noexcept(false);
+
+        /** Gets the number of sensors */
+        [[nodiscard]] unsigned int GetNumSensors() const { return _num_sensors; }
+
+        /** Gets the number of bins in a fused scan */
+        [[nodiscard]] unsigned int GetNumBins() const { return _num_bins; }
+
+        /** Gets the number of fused scans produced */
+        [[nodiscard]] uint64_t GetNumFused() const { return _num_fused.load(std::memory_order_relaxed); }
+
+        /** Gets the bearing of the center of the given bin in the output frame (rad) */
+        [[nodiscard]] double GetBinAngle(unsigned int bin) const { return -M_PI + (bin + 0.5) * _bin_width; }
+
+    private:
+
+        /** A pairing slot: the sequence is odd while the scan is written */
+        typedef struct sick_pls_fusion_slot_tag {
+            std::atomic<uint64_t> sequence;                                        ///< Seqlock counter
+            uint64_t timestamp_usec;                                               ///< Time stamp (offset applied)
+            unsigned int num_ranges;                                               ///< Number of range values
+            uint16_t ranges[SickPLS::SICK_MAX_NUM_MEASUREMENTS];                   ///< Range values (cm)
+        } sick_pls_fusion_slot_t;
+
+        /** A sensor and its recent scans */
+        typedef struct sick_pls_fusion_sensor_tag {
+            SickPLSCartesianConverter converter;                                   ///< Geometry and extrinsics
+            int64_t time_offset_usec;                                              ///< Added to every time stamp
+            alignas(64) std::atomic<uint64_t> num_pushed{0};                       ///< Scans written so far
+            sick_pls_fusion_slot_t slots[SICK_PLS_FUSION_HISTORY]{};               ///< The ring
+        } sick_pls_fusion_sensor_t;
+
+        /** A scan chosen for a set */
+        typedef struct sick_pls_fusion_pick_tag {
+            const sick_pls_fusion_slot_t* slot;                                    ///< Where it lives
+            uint64_t sequence;                                                     ///< Its sequence when chosen
+            uint64_t timestamp_usec;                                               ///< Its time stamp
+        } sick_pls_fusion_pick_t;
+
+        /** Output geometry */
+        unsigned int _num_bins;
+        double _bin_width;
+
+        /** Largest time stamp difference within a set (usecs) */
+        uint64_t _max_skew_usec;
+
+        /** The sensors */
+        std::unique_ptr<sick_pls_fusion_sensor_t> _sensors[SICK_PLS_FUSION_MAX_SENSORS];
+        unsigned int _num_sensors;
+
+        /** Latest time stamp of the last fused set (no scan at or before it is used again) */
+        alignas(64) std::atomic<uint64_t> _last_fused_usec;
+        std::atomic<uint64_t> _num_fused;
+
+        /** Writes a scan into its sensor's ring and tries to complete a set */
+        template<class RANGE_TYPE>
+        bool _push(unsigned int sensor, const RANGE_TYPE* ranges, unsigned int num_ranges, uint64_t timestamp_usec,
+                   sick_pls_fused_scan_t& fused_scan) noexcept(false);
+
+        /** Finds the scan of a sensor closest to the given time stamp and newer than last_usec */
+        bool _pick(unsigned int sensor, uint64_t timestamp_usec, uint64_t last_usec,
+                   sick_pls_fusion_pick_t& pick) const;
+
+        /** Bins a set (returns false if a scan was overwritten meanwhile) */
+        bool _fuse(const sick_pls_fusion_pick_t* picks, sick_pls_fused_scan_t& fused_scan) const;
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_FUSION_HH */
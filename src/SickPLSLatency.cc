@@ -0,0 +1,228 @@
+/*!
+ * \file SickPLSLatency.cc
+ * \brief Implements per-stage latency histograms for the Sick PLS
+ *        receive pipeline.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <algorithm>
+#include <cstring>
+
+#include "SickPLSLatency.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief The stages bounding each interval
+     */
+    static const sick_message_stage_t sick_pls_latency_bounds[SICK_PLS_LATENCY_NUM_INTERVALS][2] = {
+            {SICK_MESSAGE_STAGE_FIRST_BYTE,   SICK_MESSAGE_STAGE_HEADER_FOUND},
+            {SICK_MESSAGE_STAGE_HEADER_FOUND, SICK_MESSAGE_STAGE_CRC_VERIFIED},
+            {SICK_MESSAGE_STAGE_CRC_VERIFIED, SICK_MESSAGE_STAGE_ENQUEUED},
+            {SICK_MESSAGE_STAGE_ENQUEUED,     SICK_MESSAGE_STAGE_DEQUEUED},
+            {SICK_MESSAGE_STAGE_DEQUEUED,     SICK_MESSAGE_STAGE_DECODED},
+            {SICK_MESSAGE_STAGE_FIRST_BYTE,   SICK_MESSAGE_STAGE_DECODED}
+    };
+
+    /**
+     * \brief A standard constructor
+     */
+    SickPLSLatencyHistogram::SickPLSLatencyHistogram() : _sum(0), _max(0) {
+        for (auto& count: _counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * \brief Records a sample
+     * \param value The sample (nsecs)
+     */
+    void SickPLSLatencyHistogram::Record(const uint64_t value) {
+
+        _counts[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t max = _max.load(std::memory_order_relaxed);
+        while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+
+    }
+
+    /**
+     * \brief Summarizes the recorded samples
+     * \param &summary The summary (nsecs); percentiles are bucket upper bounds
+     */
+    void SickPLSLatencyHistogram::GetSummary(sick_pls_latency_summary_t& summary) const {
+
+        memset(&summary, 0, sizeof(summary));
+
+        /* Copy the buckets once so the percentiles agree with each other */
+        uint64_t counts[SICK_PLS_LATENCY_NUM_BUCKETS];
+        for (unsigned int i = 0; i < SICK_PLS_LATENCY_NUM_BUCKETS; i++) {
+            counts[i] = _counts[i].load(std::memory_order_relaxed);
+            summary.count += counts[i];
+        }
+
+        if (summary.count == 0) {
+            return;
+        }
+
+        summary.sum = _sum.load(std::memory_order_relaxed);
+        summary.mean = summary.sum / summary.count;
+        summary.max = _max.load(std::memory_order_relaxed);
+
+        /* Ranks of the percentiles (rounded up, at least 1) */
+        const uint64_t ranks[4] = {(summary.count * 500 + 999) / 1000,
+                                   (summary.count * 900 + 999) / 1000,
+                                   (summary.count * 990 + 999) / 1000,
+                                   (summary.count * 999 + 999) / 1000};
+        uint64_t* const percentiles[4] = {&summary.p50, &summary.p90, &summary.p99, &summary.p999};
+
+        uint64_t seen = 0;
+        unsigned int next = 0;
+        for (unsigned int i = 0; i < SICK_PLS_LATENCY_NUM_BUCKETS && next < 4; i++) {
+            seen += counts[i];
+            while (next < 4 && seen >= ranks[next]) {
+                *percentiles[next++] = std::min(GetBucketUpperBound(i), summary.max);
+            }
+        }
+
+        /* Fold the fine buckets into the coarse ones (a fine bucket counts once its lower bound is in range) */
+        seen = 0;
+        unsigned int bound = 0;
+        for (unsigned int i = 0; i < SICK_PLS_LATENCY_NUM_BUCKETS && bound < SICK_PLS_LATENCY_NUM_EXPORT_BUCKETS; i++) {
+            const uint64_t lower_bound = (i == 0) ? 0 : GetBucketUpperBound(i - 1) + 1;
+            while (bound < SICK_PLS_LATENCY_NUM_EXPORT_BUCKETS && lower_bound > GetExportBound(bound)) {
+                summary.buckets[bound++] = seen;
+            }
+            seen += counts[i];
+        }
+
+    }
+
+    /**
+     * \brief Discards all samples
+     */
+    void SickPLSLatencyHistogram::Reset() {
+
+        for (auto& count: _counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        _sum.store(0, std::memory_order_relaxed);
+        _max.store(0, std::memory_order_relaxed);
+
+    }
+
+    /**
+     * \brief Gets the bucket a value falls in
+     * \param value The value (nsecs)
+     * \return The bucket index
+     */
+    unsigned int SickPLSLatencyHistogram::GetBucketIndex(const uint64_t value) {
+
+        if (value < SICK_PLS_LATENCY_SUB_BUCKETS) {
+            return (unsigned int) value;
+        }
+
+        const unsigned int magnitude = 63 - __builtin_clzll(value);
+        if (magnitude >= SICK_PLS_LATENCY_MAX_MAGNITUDE) {
+            return SICK_PLS_LATENCY_NUM_BUCKETS - 1;
+        }
+
+        /* The top six bits pick the sub-bucket (the leading one is implied) */
+        const unsigned int shift = magnitude - 5;
+        return SICK_PLS_LATENCY_SUB_BUCKETS + (magnitude - 6) * (SICK_PLS_LATENCY_SUB_BUCKETS / 2) +
+               (unsigned int) (value >> shift) - SICK_PLS_LATENCY_SUB_BUCKETS / 2;
+    }
+
+    /**
+     * \brief Gets one of the coarse export bounds
+     * \param index The bound's index (below SICK_PLS_LATENCY_NUM_EXPORT_BUCKETS)
+     * \return The bound (nsecs)
+     */
+    uint64_t SickPLSLatencyHistogram::GetExportBound(const unsigned int index) {
+
+        /*
+         * 1-2.5-5 steps from 10 us to 1 s, which spans one byte time to a stalled stream.
+         * These do not fall on fine bucket edges; the fine bucket spanning a bound is
+         * counted at that bound, so le=X holds every sample <= X plus at most one fine
+         * bucket (~3%) of samples just above X, never fewer.
+         */
+        static const uint64_t bounds[SICK_PLS_LATENCY_NUM_EXPORT_BUCKETS] = {
+                10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000,
+                5000000, 10000000, 25000000, 50000000, 100000000, 250000000, 500000000, 1000000000
+        };
+
+        return bounds[index];
+    }
+
+    /**
+     * \brief Gets the largest value that falls in a bucket
+     * \param index The bucket index
+     * \return The bucket's upper bound (nsecs)
+     */
+    uint64_t SickPLSLatencyHistogram::GetBucketUpperBound(const unsigned int index) {
+
+        if (index < SICK_PLS_LATENCY_SUB_BUCKETS) {
+            return index;
+        }
+
+        if (index >= SICK_PLS_LATENCY_NUM_BUCKETS - 1) {
+            return UINT64_MAX;
+        }
+
+        const unsigned int offset = index - SICK_PLS_LATENCY_SUB_BUCKETS;
+        const unsigned int shift = offset / (SICK_PLS_LATENCY_SUB_BUCKETS / 2) + 1;
+        const uint64_t sub_bucket = offset % (SICK_PLS_LATENCY_SUB_BUCKETS / 2) + SICK_PLS_LATENCY_SUB_BUCKETS / 2;
+        return ((sub_bucket + 1) << shift) - 1;
+    }
+
+    /**
+     * \brief Records the intervals between the stages a message has passed
+     * \param *stage_timestamps SICK_MESSAGE_NUM_STAGES time stamps (nsecs, 0 => stage not recorded)
+     */
+    void SickPLSLatencyRecorder::Record(const uint64_t* const stage_timestamps) {
+
+        for (unsigned int i = 0; i < SICK_PLS_LATENCY_NUM_INTERVALS; i++) {
+            const uint64_t begin = stage_timestamps[sick_pls_latency_bounds[i][0]];
+            const uint64_t end = stage_timestamps[sick_pls_latency_bounds[i][1]];
+            if (begin != 0 && end >= begin) {
+                _histograms[i].Record(end - begin);
+            }
+        }
+
+    }
+
+    /**
+     * \brief Summarizes every interval
+     * \param &snapshot The summaries
+     */
+    void SickPLSLatencyRecorder::GetSnapshot(sick_pls_latency_snapshot_t& snapshot) const {
+        for (unsigned int i = 0; i < SICK_PLS_LATENCY_NUM_INTERVALS; i++) {
+            _histograms[i].GetSummary(snapshot.intervals[i]);
+        }
+    }
+
+    /**
+     * \brief Discards all samples
+     */
+    void SickPLSLatencyRecorder::Reset() {
+        for (auto& histogram: _histograms) {
+            histogram.Reset();
+        }
+    }
+
+} /* namespace sickpls */
@@ -0,0 +1,152 @@
+/*!
+ * \file SickPLSLatency.hh
+ * \brief Defines per-stage latency histograms for the Sick PLS
+ *        receive pipeline.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_LATENCY_HH
+#define SICK_PLS_LATENCY_HH
+
+/* Definition dependencies */
+#include <atomic>
+#include <cstdint>
+
+#include "SickMessage.hh"
+
+/* Macro definitions */
+#define SICK_PLS_LATENCY_SUB_BUCKETS                                        (64)  ///< Buckets per power of two (~3% precision)
+#define SICK_PLS_LATENCY_MAX_MAGNITUDE                                      (40)  ///< Largest tracked value is 2^40 nsecs (~18 min)
+#define SICK_PLS_LATENCY_NUM_BUCKETS   (SICK_PLS_LATENCY_SUB_BUCKETS + \
+        (SICK_PLS_LATENCY_MAX_MAGNITUDE - 6) * (SICK_PLS_LATENCY_SUB_BUCKETS / 2))  ///< Buckets per histogram (6 = log2 of the sub-buckets)
+#define SICK_PLS_LATENCY_NUM_EXPORT_BUCKETS                                 (16)  ///< Fixed coarse bounds, 10 us to 1 s (see GetExportBound)
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \enum sick_pls_latency_interval_t
+     * \brief The intervals between receive pipeline stages that are tracked.
+     */
+    enum sick_pls_latency_interval_t {
+        SICK_PLS_LATENCY_HEADER = 0,                                               ///< First byte -> header found
+        SICK_PLS_LATENCY_FRAME,                                                    ///< Header found -> CRC verified
+        SICK_PLS_LATENCY_HANDOFF,                                                  ///< CRC verified -> enqueued in the monitor
+        SICK_PLS_LATENCY_QUEUED,                                                   ///< Enqueued -> dequeued by GetNextMessageFromMonitor
+        SICK_PLS_LATENCY_DECODE,                                                   ///< Dequeued -> decoded
+        SICK_PLS_LATENCY_TOTAL,                                                    ///< First byte -> decoded
+        SICK_PLS_LATENCY_NUM_INTERVALS                                             ///< Number of intervals
+    };
+
+    /*!
+     * \struct sick_pls_latency_summary_tag
+     * \brief Summary statistics of one interval (nsecs).
+     */
+    /*!
+     * \typedef sick_pls_latency_summary_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_latency_summary_tag {
+        uint64_t count;                                                            ///< Samples recorded
+        uint64_t sum;                                                              ///< Sum of the samples
+        uint64_t mean;                                                             ///< Mean
+        uint64_t p50;                                                              ///< Median
+        uint64_t p90;                                                              ///< 90th percentile
+        uint64_t p99;                                                              ///< 99th percentile
+        uint64_t p999;                                                             ///< 99.9th percentile
+        uint64_t max;                                                              ///< Largest sample
+        uint64_t buckets[SICK_PLS_LATENCY_NUM_EXPORT_BUCKETS];                     ///< Samples at or below each export bound (cumulative, see GetExportBound)
+    } sick_pls_latency_summary_t;
+
+    /*!
+     * \struct sick_pls_latency_snapshot_tag
+     * \brief Summary statistics of every interval.
+     */
+    /*!
+     * \typedef sick_pls_latency_snapshot_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_latency_snapshot_tag {
+        sick_pls_latency_summary_t intervals[SICK_PLS_LATENCY_NUM_INTERVALS];     ///< Indexed by sick_pls_latency_interval_t
+    } sick_pls_latency_snapshot_t;
+
+    /*!
+     * \brief A fixed-size log-linear latency histogram
+     *
+     * Values below SICK_PLS_LATENCY_SUB_BUCKETS nsecs get a bucket each;
+     * every power of two above that is split into SICK_PLS_LATENCY_SUB_BUCKETS / 2
+     * buckets, as in HdrHistogram. Values beyond 2^SICK_PLS_LATENCY_MAX_MAGNITUDE
+     * land in the last bucket. Record() is a handful of relaxed atomic
+     * adds, so any thread may record while another takes a summary.
+     */
+    class SickPLSLatencyHistogram {
+
+    public:
+
+        /** A standard constructor */
+        SickPLSLatencyHistogram();
+
+        /** Records a sample (nsecs) */
+        void Record(uint64_t value);
+
+        /** Summarizes the recorded samples */
+        void GetSummary(sick_pls_latency_summary_t& summary) const;
+
+        /** Discards all samples (samples recorded concurrently may survive) */
+        void Reset();
+
+        /** Gets the bucket a value falls in */
+        static unsigned int GetBucketIndex(uint64_t value);
+
+        /** Gets the largest value that falls in a bucket */
+        static uint64_t GetBucketUpperBound(unsigned int index);
+
+        /** Gets one of the coarse bounds the summary's cumulative buckets are counted at (nsecs) */
+        static uint64_t GetExportBound(unsigned int index);
+
+    private:
+
+        /** Bucket counts */
+        std::atomic<uint64_t> _counts[SICK_PLS_LATENCY_NUM_BUCKETS];
+
+        /** Sum and maximum of the samples */
+        std::atomic<uint64_t> _sum;
+        std::atomic<uint64_t> _max;
+
+    };
+
+    /*!
+     * \brief Per-interval latency histograms fed from message stage time stamps
+     */
+    class SickPLSLatencyRecorder {
+
+    public:
+
+        /** Records the intervals between the stages a message has passed */
+        void Record(const uint64_t* stage_timestamps);
+
+        /** Summarizes every interval */
+        void GetSnapshot(sick_pls_latency_snapshot_t& snapshot) const;
+
+        /** Discards all samples */
+        void Reset();
+
+    private:
+
+        /** One histogram per interval */
+        SickPLSLatencyHistogram _histograms[SICK_PLS_LATENCY_NUM_INTERVALS];
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_LATENCY_HH */
@@ -0,0 +1,340 @@
+/*!
+ * \file SickPLSLineExtractor.cc
+ * \brief Implements a class for extracting line features from
+ *        Cartesian Sick PLS scans (split-and-merge).
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <cmath>
+
+#include "SickPLSLineExtractor.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief A standard constructor
+     */
+    SickPLSLineExtractor::SickPLSLineExtractor() :
+            _split_threshold(DEFAULT_SICK_PLS_LINE_SPLIT_THRESHOLD),
+            _max_point_gap(DEFAULT_SICK_PLS_LINE_MAX_POINT_GAP),
+            _merge_angle(DEFAULT_SICK_PLS_LINE_MERGE_ANGLE * M_PI / 180.0),
+            _merge_distance(DEFAULT_SICK_PLS_LINE_MERGE_DISTANCE),
+            _min_points(DEFAULT_SICK_PLS_LINE_MIN_POINTS),
+            _min_length(DEFAULT_SICK_PLS_LINE_MIN_LENGTH),
+            _max_splits(DEFAULT_SICK_PLS_LINE_MAX_SPLITS),
+            _num_points(0), _x(), _y(), _beam(), _stack(), _spans(), _moments() {}
+
+    /**
+     * \brief Sets the split parameters
+     * \param split_threshold Max distance of a point from the chord before the span is split (m)
+     * \param max_point_gap Max distance between neighbouring points on the same line (m)
+     */
+    void SickPLSLineExtractor::SetSplitParameters(const double split_threshold,
+                                                  const double max_point_gap) noexcept(false) {
+
+        /* A sanity check */
+        if (split_threshold <= 0 || max_point_gap <= 0) {
+            throw SickConfigException("SickPLSLineExtractor::SetSplitParameters: Invalid parameters!");
+        }
+
+        _split_threshold = split_threshold;
+        _max_point_gap = max_point_gap;
+
+    }
+
+    /**
+     * \brief Sets the collinearity tolerances used when merging neighbouring lines
+     * \param merge_angle Max difference between the line normals (deg)
+     * \param merge_distance Max difference between the line distances (m)
+     */
+    void SickPLSLineExtractor::SetMergeParameters(const double merge_angle,
+                                                  const double merge_distance) noexcept(false) {
+
+        /* A sanity check */
+        if (merge_angle < 0 || merge_distance < 0) {
+            throw SickConfigException("SickPLSLineExtractor::SetMergeParameters: Invalid parameters!");
+        }
+
+        _merge_angle = merge_angle * M_PI / 180.0;
+        _merge_distance = merge_distance;
+
+    }
+
+    /**
+     * \brief Sets the support a line needs in order to be reported
+     * \param min_points Minimum number of supporting points (>= 2)
+     * \param min_length Minimum line length (m)
+     */
+    void SickPLSLineExtractor::SetMinimumSupport(const unsigned int min_points,
+                                                 const double min_length) noexcept(false) {
+
+        /* A sanity check */
+        if (min_points < 2 || min_length < 0) {
+            throw SickConfigException("SickPLSLineExtractor::SetMinimumSupport: Invalid parameters!");
+        }
+
+        _min_points = min_points;
+        _min_length = min_length;
+
+    }
+
+    /**
+     * \brief Extracts line features from a Cartesian scan
+     * \param &cartesian_scan The scan (see SickPLSCartesianConverter)
+     * \param *lines Destination array of lines (ordered by beam index)
+     * \param max_lines Capacity of the destination array
+     * \return The number of lines written
+     */
+    unsigned int SickPLSLineExtractor::Extract(const sick_pls_cartesian_scan_t& cartesian_scan,
+                                               sick_pls_line_t* const lines,
+                                               const unsigned int max_lines) noexcept(false) {
+
+        /* A sanity check */
+        if (cartesian_scan.num_points > SICK_PLS_CARTESIAN_MAX_POINTS) {
+            throw SickConfigException("SickPLSLineExtractor::Extract: Invalid scan!");
+        }
+
+        /* Compact the valid points */
+        _num_points = 0;
+        for (unsigned int i = 0; i < cartesian_scan.num_points; i++) {
+            if (cartesian_scan.valid[i]) {
+                _x[_num_points] = cartesian_scan.x[i];
+                _y[_num_points] = cartesian_scan.y[i];
+                _beam[_num_points] = (uint16_t) i;
+                _num_points++;
+            }
+        }
+
+        /* Split */
+        const unsigned int num_spans = _split();
+        if (num_spans == 0) {
+            return 0;
+        }
+
+        /* Fit each span */
+        for (unsigned int i = 0; i < num_spans; i++) {
+            _accumulate(_spans[i], _moments[i]);
+        }
+
+        /* Merge collinear neighbours (in place) */
+        unsigned int num_merged = 0;
+        for (unsigned int i = 1; i < num_spans; i++) {
+
+            sick_pls_line_span_t& curr = _spans[num_merged];
+            sick_pls_line_moments_t& curr_moments = _moments[num_merged];
+            const sick_pls_line_span_t& next = _spans[i];
+            const sick_pls_line_moments_t& next_moments = _moments[i];
+
+            bool merge = false;
+
+            /* Only consider spans that were split apart (i.e. adjacent and close) */
+            if (next.first == curr.last + 1 &&
+                hypot(_x[next.first] - _x[curr.last], _y[next.first] - _y[curr.last]) <= _max_point_gap) {
+
+                double rho_a, alpha_a, rms_a, rho_b, alpha_b, rms_b;
+                _fit(curr_moments, rho_a, alpha_a, rms_a);
+                _fit(next_moments, rho_b, alpha_b, rms_b);
+
+                const double angle_diff = fabs(remainder(alpha_a - alpha_b, 2.0 * M_PI));
+                if (angle_diff <= _merge_angle && fabs(rho_a - rho_b) <= _merge_distance) {
+
+                    /* Make sure the union still is a line */
+                    sick_pls_line_moments_t merged = {curr_moments.n + next_moments.n,
+                                                      curr_moments.sx + next_moments.sx,
+                                                      curr_moments.sy + next_moments.sy,
+                                                      curr_moments.sxx + next_moments.sxx,
+                                                      curr_moments.syy + next_moments.syy,
+                                                      curr_moments.sxy + next_moments.sxy};
+                    double rho, alpha, rms;
+                    _fit(merged, rho, alpha, rms);
+                    if (rms <= _split_threshold) {
+                        curr.last = next.last;
+                        curr_moments = merged;
+                        merge = true;
+                    }
+
+                }
+
+            }
+
+            if (!merge) {
+                num_merged++;
+                _spans[num_merged] = next;
+                _moments[num_merged] = next_moments;
+            }
+
+        }
+        num_merged++;
+
+        /* Emit the lines with enough support */
+        unsigned int num_lines = 0;
+        for (unsigned int i = 0; i < num_merged && num_lines < max_lines; i++) {
+            if (_moments[i].n >= _min_points) {
+                _buildLine(_spans[i], _moments[i], lines[num_lines]);
+                if (lines[num_lines].length >= _min_length) {
+                    num_lines++;
+                }
+            }
+        }
+
+        return num_lines;
+    }
+
+    /**
+     * \brief Splits the compacted points into (ordered) spans
+     * \return The number of spans
+     */
+    unsigned int SickPLSLineExtractor::_split() {
+
+        unsigned int num_spans = 0, stack_size = 0, num_splits = 0;
+
+        if (_num_points == 0) {
+            return 0;
+        }
+
+        /* Seed the stack with the runs of neighbouring points (last run on the bottom) */
+        unsigned int run_end = _num_points - 1;
+        for (unsigned int i = _num_points - 1; i > 0; i--) {
+            if (hypot(_x[i] - _x[i - 1], _y[i] - _y[i - 1]) > _max_point_gap) {
+                _stack[stack_size++] = {(uint16_t) i, (uint16_t) run_end};
+                run_end = i - 1;
+            }
+        }
+        _stack[stack_size++] = {0, (uint16_t) run_end};
+
+        /* Pop spans off in beam order, splitting them until they are straight or the budget runs out */
+        while (stack_size > 0) {
+
+            const sick_pls_line_span_t span = _stack[--stack_size];
+
+            /* Too short to split, or out of budget */
+            if (span.last - span.first < 2 || num_splits >= _max_splits) {
+                _spans[num_spans++] = span;
+                continue;
+            }
+
+            /* Find the point farthest from the chord */
+            const double ax = _x[span.first], ay = _y[span.first];
+            const double dx = _x[span.last] - ax, dy = _y[span.last] - ay;
+            const double chord = hypot(dx, dy);
+
+            unsigned int split_index = span.first;
+            double max_dist = 0;
+            for (unsigned int i = span.first + 1; i < span.last; i++) {
+                const double dist = (chord > 1e-6) ? fabs(dx * (_y[i] - ay) - dy * (_x[i] - ax)) / chord
+                                                   : hypot(_x[i] - ax, _y[i] - ay);
+                if (dist > max_dist) {
+                    max_dist = dist;
+                    split_index = i;
+                }
+            }
+
+            /* Straight enough */
+            if (max_dist <= _split_threshold) {
+                _spans[num_spans++] = span;
+                continue;
+            }
+
+            /* Split at the corner (the corner point goes left); push the right half first */
+            num_splits++;
+            _stack[stack_size++] = {(uint16_t) (split_index + 1), span.last};
+            _stack[stack_size++] = {span.first, (uint16_t) split_index};
+
+        }
+
+        return num_spans;
+    }
+
+    /**
+     * \brief Computes the moments of the points in a span
+     */
+    void SickPLSLineExtractor::_accumulate(const sick_pls_line_span_t& span,
+                                           sick_pls_line_moments_t& moments) const {
+
+        moments = {0, 0, 0, 0, 0, 0};
+        for (unsigned int i = span.first; i <= span.last; i++) {
+            const double x = _x[i], y = _y[i];
+            moments.n += 1;
+            moments.sx += x;
+            moments.sy += y;
+            moments.sxx += x * x;
+            moments.syy += y * y;
+            moments.sxy += x * y;
+        }
+
+    }
+
+    /**
+     * \brief Total least squares line fit from moments
+     * \param &moments The point moments
+     * \param &rho Distance of the line from the origin (m)
+     * \param &alpha Direction of the line normal (rad)
+     * \param &rms_error RMS orthogonal residual (m)
+     */
+    void SickPLSLineExtractor::_fit(const sick_pls_line_moments_t& moments,
+                                    double& rho, double& alpha, double& rms_error) {
+
+        const double mx = moments.sx / moments.n;
+        const double my = moments.sy / moments.n;
+        const double cxx = moments.sxx / moments.n - mx * mx;
+        const double cyy = moments.syy / moments.n - my * my;
+        const double cxy = moments.sxy / moments.n - mx * my;
+
+        /* The normal is the minor axis of the scatter */
+        alpha = 0.5 * atan2(-2.0 * cxy, cyy - cxx);
+        rho = mx * cos(alpha) + my * sin(alpha);
+        if (rho < 0) {
+            rho = -rho;
+            alpha = remainder(alpha + M_PI, 2.0 * M_PI);
+        }
+
+        const double c = cos(alpha), s = sin(alpha);
+        const double variance = cxx * c * c + cyy * s * s + 2.0 * cxy * c * s;
+        rms_error = (variance > 0) ? sqrt(variance) : 0;
+
+    }
+
+    /**
+     * \brief Builds the output description of a span
+     */
+    void SickPLSLineExtractor::_buildLine(const sick_pls_line_span_t& span, const sick_pls_line_moments_t& moments,
+                                          sick_pls_line_t& line) const {
+
+        double rho, alpha, rms_error;
+        _fit(moments, rho, alpha, rms_error);
+
+        /* Project the extreme points onto the line */
+        const double c = cos(alpha), s = sin(alpha);
+        const double d1 = _x[span.first] * c + _y[span.first] * s - rho;
+        const double d2 = _x[span.last] * c + _y[span.last] * s - rho;
+
+        line.rho = (float) rho;
+        line.alpha = (float) alpha;
+        line.x1 = (float) (_x[span.first] - d1 * c);
+        line.y1 = (float) (_y[span.first] - d1 * s);
+        line.x2 = (float) (_x[span.last] - d2 * c);
+        line.y2 = (float) (_y[span.last] - d2 * s);
+        line.length = (float) hypot(line.x2 - line.x1, line.y2 - line.y1);
+        line.rms_error = (float) rms_error;
+        line.start_index = _beam[span.first];
+        line.end_index = _beam[span.last];
+        line.num_points = (uint16_t) moments.n;
+
+    }
+
+} /* namespace sickpls */
@@ -0,0 +1,148 @@
+/*!
+ * \file SickPLSLineExtractor.hh
+ * \brief Defines a class for extracting line features from
+ *        Cartesian Sick PLS scans (split-and-merge).
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_LINE_EXTRACTOR_HH
+#define SICK_PLS_LINE_EXTRACTOR_HH
+
+/* Definition dependencies */
+#include <cstdint>
+
+#include "SickPLSCartesian.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define DEFAULT_SICK_PLS_LINE_SPLIT_THRESHOLD                             (0.05)  ///< Max point-to-chord distance before a split (m)
+#define DEFAULT_SICK_PLS_LINE_MAX_POINT_GAP                               (0.30)  ///< Max distance between neighbouring points on a line (m)
+#define DEFAULT_SICK_PLS_LINE_MERGE_ANGLE                                  (3.0)  ///< Max normal angle difference for merging (deg)
+#define DEFAULT_SICK_PLS_LINE_MERGE_DISTANCE                              (0.05)  ///< Max normal distance difference for merging (m)
+#define DEFAULT_SICK_PLS_LINE_MIN_POINTS                                     (5)  ///< Lines supported by fewer points are discarded
+#define DEFAULT_SICK_PLS_LINE_MIN_LENGTH                                  (0.20)  ///< Lines shorter than this are discarded (m)
+#define DEFAULT_SICK_PLS_LINE_MAX_SPLITS                                    (96)  ///< Per-scan split budget (bounds the worst case)
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \struct sick_pls_line_tag
+     * \brief A structure describing a line feature. The infinite line
+     *        is x*cos(alpha) + y*sin(alpha) = rho (rho >= 0) and the
+     *        endpoints are the extreme points projected onto it.
+     */
+    /*!
+     * \typedef sick_pls_line_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_line_tag {
+        float rho;                                                                 ///< Distance of the line from the origin (m)
+        float alpha;                                                               ///< Direction of the line normal (rad)
+        float x1, y1;                                                              ///< First endpoint (m)
+        float x2, y2;                                                              ///< Second endpoint (m)
+        float length;                                                              ///< Distance between the endpoints (m)
+        float rms_error;                                                           ///< RMS orthogonal residual of the supporting points (m)
+        uint16_t start_index;                                                      ///< First supporting beam
+        uint16_t end_index;                                                        ///< Last supporting beam (inclusive)
+        uint16_t num_points;                                                       ///< Number of supporting points
+    } sick_pls_line_t;
+
+    /*!
+     * \brief Extracts line segments from Cartesian scans
+     *
+     * Valid points are grouped into runs of neighbouring points, recursively
+     * split at the point farthest from the chord, refined by total least
+     * squares and finally merged with collinear neighbours. All working
+     * storage is preallocated and the number of splits per scan is capped,
+     * so the worst-case cost is O(max_splits * beams).
+     */
+    class SickPLSLineExtractor {
+
+    public:
+
+        /** A standard constructor */
+        SickPLSLineExtractor();
+
+        /** Sets the split threshold and max gap between neighbouring points (m) */
+        void SetSplitParameters(double split_threshold, double max_point_gap) noexcept(false);
+
+        /** Sets the collinearity tolerances used when merging (deg, m) */
+        void SetMergeParameters(double merge_angle, double merge_distance) noexcept(false);
+
+        /** Sets the minimum support (points, m) a line must have to be reported */
+        void SetMinimumSupport(unsigned int min_points, double min_length) noexcept(false);
+
+        /** Sets the per-scan split budget */
+        void SetMaxSplits(unsigned int max_splits) { _max_splits = max_splits; }
+
+        /** Extracts lines from a Cartesian scan */
+        unsigned int Extract(const sick_pls_cartesian_scan_t& cartesian_scan,
+                             sick_pls_line_t* lines, unsigned int max_lines) noexcept(false);
+
+    private:
+
+        /*!
+         * \struct sick_pls_line_moments_tag
+         * \brief Running sums used to fit (and merge) lines in O(1)
+         */
+        typedef struct sick_pls_line_moments_tag {
+            double n, sx, sy, sxx, syy, sxy;
+        } sick_pls_line_moments_t;
+
+        /*!
+         * \struct sick_pls_line_span_tag
+         * \brief A run of compacted point indices [first,last]
+         */
+        typedef struct sick_pls_line_span_tag {
+            uint16_t first;
+            uint16_t last;
+        } sick_pls_line_span_t;
+
+        /** Tunables */
+        double _split_threshold;
+        double _max_point_gap;
+        double _merge_angle;
+        double _merge_distance;
+        unsigned int _min_points;
+        double _min_length;
+        unsigned int _max_splits;
+
+        /** Compacted valid points (x, y, beam index) */
+        unsigned int _num_points;
+        float _x[SICK_PLS_CARTESIAN_MAX_POINTS];
+        float _y[SICK_PLS_CARTESIAN_MAX_POINTS];
+        uint16_t _beam[SICK_PLS_CARTESIAN_MAX_POINTS];
+
+        /** Split work stack and the resulting (ordered) spans */
+        sick_pls_line_span_t _stack[SICK_PLS_CARTESIAN_MAX_POINTS];
+        sick_pls_line_span_t _spans[SICK_PLS_CARTESIAN_MAX_POINTS];
+        sick_pls_line_moments_t _moments[SICK_PLS_CARTESIAN_MAX_POINTS];
+
+        /** Splits the compacted points into spans */
+        unsigned int _split();
+
+        /** Computes the moments of a span */
+        void _accumulate(const sick_pls_line_span_t& span, sick_pls_line_moments_t& moments) const;
+
+        /** Fits a line to a set of moments */
+        static void _fit(const sick_pls_line_moments_t& moments, double& rho, double& alpha, double& rms_error);
+
+        /** Builds the output line for a span */
+        void _buildLine(const sick_pls_line_span_t& span, const sick_pls_line_moments_t& moments,
+                        sick_pls_line_t& line) const;
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_LINE_EXTRACTOR_HH */
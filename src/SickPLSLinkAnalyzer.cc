@@ -0,0 +1,287 @@
+/*!
+ * \file SickPLSLinkAnalyzer.cc
+ * \brief Implements a serial link utilization and throughput analyzer
+ *        for the Sick PLS.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "SickPLSLinkAnalyzer.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Constructs an analyzer (the first Sample() opens the first window)
+     * \param &sick_pls The driver to watch (must outlive the analyzer)
+     */
+    SickPLSLinkAnalyzer::SickPLSLinkAnalyzer(const SickPLS& sick_pls) :
+            _sick_pls(sick_pls), _sample_nsec(0), _has_sample(false), _has_report(false) {}
+
+    /**
+     * \brief Closes the current window and opens the next one
+     */
+    void SickPLSLinkAnalyzer::Sample() {
+
+        SickPLS::sick_pls_counters_t counters;
+        _sick_pls.GetSickCounters(counters);
+        const uint64_t now_nsec = sick_message_clock_nsec();
+
+        if (_has_sample && now_nsec > _sample_nsec) {
+
+            sick_pls_link_report_t& report = _report;
+            report.interval = (double) (now_nsec - _sample_nsec) / 1e9;
+            report.baud_rate = SickBaudToInt(_sick_pls.GetSickSessionBaud());
+            report.bits_per_byte = _sick_pls.GetSickBitsPerByte();
+
+            try {
+                report.operating_mode = _sick_pls.GetSickOperatingMode();
+            }
+            catch (SickConfigException&) {
+                report.operating_mode = SickPLS::SICK_OP_MODE_UNKNOWN;
+            }
+
+            const auto num_scans = (double) (counters.sick_scans - _counters.sick_scans);
+            const auto num_frames = (double) (counters.sick_messages_received - _counters.sick_messages_received);
+            const auto num_bytes = (double) (counters.sick_bytes_received - _counters.sick_bytes_received);
+            const auto idle_secs = (double) (counters.sick_idle_nsec - _counters.sick_idle_nsec) / 1e9;
+
+            report.scan_rate = num_scans / report.interval;
+            report.frame_rate = num_frames / report.interval;
+            report.byte_rate = num_bytes / report.interval;
+            report.mean_frame_length = (num_frames > 0) ? num_bytes / num_frames : 0;
+            report.checksum_error_rate =
+                    (double) (counters.sick_checksum_errors - _counters.sick_checksum_errors) / report.interval;
+            report.overwrite_rate =
+                    (double) (counters.sick_messages_overwritten - _counters.sick_messages_overwritten) /
+                    report.interval;
+
+            report.line_capacity = (report.bits_per_byte > 0) ? (double) report.baud_rate / report.bits_per_byte : 0;
+            report.utilization = (report.line_capacity > 0) ? report.byte_rate / report.line_capacity : 0;
+            report.idle_fraction = std::min(1.0, idle_secs / report.interval);
+            report.mean_idle_gap = (num_frames > 1) ? idle_secs / (num_frames - 1) : 0;
+
+            /* Judge the mode by the frames it actually produced (a full scan until there are some) */
+            unsigned int num_values = SICK_PLS_LINK_FULL_SCAN_VALUES;
+            if (report.mean_frame_length > 0) {
+                const double payload = report.mean_frame_length - (GetScanLength(report.operating_mode, 0));
+                num_values = (unsigned int) std::max(0.0, payload / 2);
+            }
+            report.max_scan_rate = (report.baud_rate > 0) ?
+                                   GetMaxScanRate(report.baud_rate, report.bits_per_byte, report.operating_mode,
+                                                  num_values) : 0;
+            report.headroom = (report.max_scan_rate > 0) ? 1 - report.scan_rate / report.max_scan_rate : 0;
+
+            _has_report = true;
+
+        }
+
+        _counters = counters;
+        _sample_nsec = now_nsec;
+        _has_sample = true;
+
+    }
+
+    /**
+     * \brief Gets the report for the last closed window
+     * \param &report The report
+     */
+    void SickPLSLinkAnalyzer::GetReport(sick_pls_link_report_t& report) const noexcept(false) {
+
+        if (!_has_report) {
+            throw SickConfigException("SickPLSLinkAnalyzer::GetReport: Sample() has not been called twice yet!");
+        }
+
+        report = _report;
+
+    }
+
+    /**
+     * \brief Formats a report for humans
+     * \param &report The report
+     * \return A multi-line summary
+     */
+    std::string SickPLSLinkAnalyzer::ReportToString(const sick_pls_link_report_t& report) {
+
+        std::stringstream str_stream;
+        str_stream << std::fixed << std::setprecision(2);
+        str_stream << "\tLink: " << report.baud_rate << " baud, " << report.bits_per_byte << " bits/byte ("
+                   << report.line_capacity << " bytes/s), "
+                   << SickPLS::SickOperatingModeToString(report.operating_mode) << std::endl;
+        str_stream << "\tScans: " << report.scan_rate << "/s of " << report.max_scan_rate << "/s possible (headroom "
+                   << report.headroom * 100 << "%)" << std::endl;
+        str_stream << "\tFrames: " << report.frame_rate << "/s, " << report.mean_frame_length << " bytes each, "
+                   << report.byte_rate << " bytes/s (" << report.utilization * 100 << "% of the line)" << std::endl;
+        str_stream << "\tIdle: " << report.idle_fraction * 100 << "% of the time, "
+                   << report.mean_idle_gap * 1e3 << " ms between frames" << std::endl;
+        str_stream << "\tLost: " << report.checksum_error_rate << " bad CRCs/s, " << report.overwrite_rate
+                   << " unread frames/s" << std::endl;
+
+        return str_stream.str();
+    }
+
+    /**
+     * \brief Gets the bytes the device sends for one scan
+     * \param operating_mode The operating mode
+     * \param num_values Values per scan
+     * \return Frame length (bytes)
+     *
+     * NOTE: Every reply carries the frame overhead, a command byte, a value
+     *       count, the values and a status byte; mean and subrange replies
+     *       add their sample count and index fields.
+     */
+    unsigned int SickPLSLinkAnalyzer::GetScanLength(const sick_pls_operating_mode_t operating_mode,
+                                                   const unsigned int num_values) {
+
+        unsigned int payload_length = 1 + 2 + 2 * num_values + 1;
+
+        switch (operating_mode) {
+            case SickPLS::SICK_OP_MODE_MONITOR_STREAM_MEAN_VALUES:
+                payload_length += 1;
+                break;
+            case SickPLS::SICK_OP_MODE_MONITOR_STREAM_VALUES_SUBRANGE:
+                payload_length += 4;
+                break;
+            case SickPLS::SICK_OP_MODE_MONITOR_STREAM_MEAN_VALUES_SUBRANGE:
+                payload_length += 5;
+                break;
+            default:
+                break;
+        }
+
+        return SICK_PLS_LINK_FRAME_OVERHEAD + payload_length;
+    }
+
+    /**
+     * \brief Gets the best scan rate a configuration allows
+     * \param baud_rate Line rate (bits/sec)
+     * \param bits_per_byte Start, data, parity and stop bits
+     * \param operating_mode The operating mode
+     * \param num_values Values per scan
+     * \param num_mean_samples Scans averaged per value (mean modes)
+     * \return Scans/sec
+     */
+    double SickPLSLinkAnalyzer::GetMaxScanRate(const unsigned int baud_rate, const unsigned int bits_per_byte,
+                                               const sick_pls_operating_mode_t operating_mode,
+                                               const unsigned int num_values, const unsigned int num_mean_samples) {
+
+        double device_rate = SICK_PLS_LINK_DEVICE_SCAN_RATE;
+        if (operating_mode == SickPLS::SICK_OP_MODE_MONITOR_STREAM_MEAN_VALUES ||
+            operating_mode == SickPLS::SICK_OP_MODE_MONITOR_STREAM_MEAN_VALUES_SUBRANGE) {
+            device_rate /= std::max(1u, num_mean_samples);
+        }
+
+        /* A polled scan also waits for its request to go out */
+        unsigned int num_bytes = GetScanLength(operating_mode, num_values);
+        if (operating_mode == SickPLS::SICK_OP_MODE_MONITOR_REQUEST_VALUES) {
+            num_bytes += SICK_PLS_LINK_REQUEST_LENGTH;
+        }
+
+        const double line_rate = (double) baud_rate / ((double) bits_per_byte * num_bytes);
+
+        return std::min(device_rate, line_rate);
+    }
+
+    /**
+     * \brief Lists configurations that reach a target scan rate
+     * \param target_scan_rate Scans/sec wanted
+     * \param bits_per_byte Start, data, parity and stop bits
+     * \param &options Per baud rate: full streaming, polling, and averaging if
+     *                 they reach the target, otherwise the widest subrange that does
+     */
+    void SickPLSLinkAnalyzer::Plan(const double target_scan_rate, const unsigned int bits_per_byte,
+                                   std::vector<sick_pls_link_option_t>& options) {
+
+        options.clear();
+
+        const sick_pls_baud_t bauds[4] = {SickPLS::SICK_BAUD_9600, SickPLS::SICK_BAUD_19200,
+                                          SickPLS::SICK_BAUD_38400, SickPLS::SICK_BAUD_500K};
+
+        for (const auto baud: bauds) {
+
+            const unsigned int baud_rate = SickBaudToInt(baud);
+            const auto add_option = [&](const sick_pls_operating_mode_t mode, const unsigned int num_values,
+                                        const unsigned int num_mean_samples) {
+                const double max_scan_rate = GetMaxScanRate(baud_rate, bits_per_byte, mode, num_values,
+                                                            num_mean_samples);
+                const double utilization = target_scan_rate * GetScanLength(mode, num_values) * bits_per_byte /
+                                           baud_rate;
+                options.push_back({baud, mode, num_values, num_mean_samples, max_scan_rate, utilization});
+            };
+
+            const sick_pls_operating_mode_t stream = SickPLS::SICK_OP_MODE_MONITOR_STREAM_VALUES;
+            if (GetMaxScanRate(baud_rate, bits_per_byte, stream, SICK_PLS_LINK_FULL_SCAN_VALUES) >= target_scan_rate) {
+
+                add_option(stream, SICK_PLS_LINK_FULL_SCAN_VALUES, 1);
+
+                const sick_pls_operating_mode_t request = SickPLS::SICK_OP_MODE_MONITOR_REQUEST_VALUES;
+                if (GetMaxScanRate(baud_rate, bits_per_byte, request, SICK_PLS_LINK_FULL_SCAN_VALUES) >=
+                    target_scan_rate) {
+                    add_option(request, SICK_PLS_LINK_FULL_SCAN_VALUES, 1);
+                }
+
+                /* Spare mirror revolutions can go into averaging */
+                const auto num_mean_samples = (unsigned int) (SICK_PLS_LINK_DEVICE_SCAN_RATE / target_scan_rate);
+                if (num_mean_samples >= 2) {
+                    add_option(SickPLS::SICK_OP_MODE_MONITOR_STREAM_MEAN_VALUES, SICK_PLS_LINK_FULL_SCAN_VALUES,
+                               num_mean_samples);
+                }
+
+                continue;
+
+            }
+
+            /* Otherwise narrow the field of view until the frames fit */
+            const sick_pls_operating_mode_t subrange = SickPLS::SICK_OP_MODE_MONITOR_STREAM_VALUES_SUBRANGE;
+            if (target_scan_rate <= SICK_PLS_LINK_DEVICE_SCAN_RATE) {
+                const double max_bytes = (double) baud_rate / (bits_per_byte * target_scan_rate);
+                const double max_values = (max_bytes - GetScanLength(subrange, 0)) / 2;
+                if (max_values >= 1) {
+                    add_option(subrange, (unsigned int) std::min<double>(max_values, SICK_PLS_LINK_FULL_SCAN_VALUES),
+                               1);
+                }
+            }
+
+        }
+
+    }
+
+    /**
+     * \brief Converts a session baud to bits/sec
+     * \param baud The session baud
+     * \return Bits/sec (0 => unknown)
+     */
+    unsigned int SickPLSLinkAnalyzer::SickBaudToInt(const sick_pls_baud_t baud) {
+
+        switch (baud) {
+            case SickPLS::SICK_BAUD_9600:
+                return 9600;
+            case SickPLS::SICK_BAUD_19200:
+                return 19200;
+            case SickPLS::SICK_BAUD_38400:
+                return 38400;
+            case SickPLS::SICK_BAUD_500K:
+                return 500000;
+            default:
+                return 0;
+        }
+
+    }
+
+} /* namespace sickpls */
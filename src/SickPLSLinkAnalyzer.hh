@@ -0,0 +1,144 @@
+/*!
+ * \file SickPLSLinkAnalyzer.hh
+ * \brief Defines a serial link utilization and throughput analyzer
+ *        for the Sick PLS.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_LINK_ANALYZER_HH
+#define SICK_PLS_LINK_ANALYZER_HH
+
+/* Definition dependencies */
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SickPLS.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define SICK_PLS_LINK_DEVICE_SCAN_RATE                                     (25.0)  ///< Scans per second of the PLS mirror (40 ms per revolution)
+#define SICK_PLS_LINK_FULL_SCAN_VALUES                                      (361)  ///< Values in a 180 deg scan at 0.5 deg
+#define SICK_PLS_LINK_FRAME_OVERHEAD                                          (6)  ///< STX, address, length (2) and CRC (2)
+#define SICK_PLS_LINK_REQUEST_LENGTH                                          (8)  ///< A request for measured values (0x30 0x01)
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \struct sick_pls_link_report_tag
+     * \brief What the link achieved over one sampling window and what it could achieve.
+     */
+    /*!
+     * \typedef sick_pls_link_report_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_link_report_tag {
+        double interval;                                                           ///< Length of the window (secs)
+        unsigned int baud_rate;                                                    ///< Line rate (bits/sec)
+        unsigned int bits_per_byte;                                                ///< Start, data, parity and stop bits
+        sick_pls_operating_mode_t operating_mode;                                  ///< Mode during the window
+        double scan_rate;                                                          ///< Scans returned (scans/sec)
+        double frame_rate;                                                         ///< Frames received (frames/sec)
+        double byte_rate;                                                          ///< Bytes received (bytes/sec)
+        double mean_frame_length;                                                  ///< Bytes per frame (0 => no frames)
+        double line_capacity;                                                      ///< Bytes the line can carry (bytes/sec)
+        double utilization;                                                        ///< byte_rate / line_capacity
+        double max_scan_rate;                                                      ///< Best scan rate for this mode and frame length (scans/sec)
+        double headroom;                                                           ///< 1 - scan_rate / max_scan_rate
+        double idle_fraction;                                                      ///< Share of the window between frames
+        double mean_idle_gap;                                                      ///< Mean time between frames (secs)
+        double checksum_error_rate;                                                ///< Frames dropped for a bad CRC (frames/sec)
+        double overwrite_rate;                                                     ///< Frames replaced before being read (frames/sec)
+    } sick_pls_link_report_t;
+
+    /*!
+     * \struct sick_pls_link_option_tag
+     * \brief A configuration that reaches a target scan rate.
+     */
+    /*!
+     * \typedef sick_pls_link_option_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_link_option_tag {
+        sick_pls_baud_t baud;                                                      ///< Session baud
+        sick_pls_operating_mode_t operating_mode;                                  ///< Mode to run in
+        unsigned int num_values;                                                   ///< Values per scan (subranges: the largest that fits)
+        unsigned int num_mean_samples;                                             ///< Scans averaged per value (mean modes, else 1)
+        double max_scan_rate;                                                      ///< Scans/sec it can deliver
+        double utilization;                                                        ///< Line utilization at the target rate
+    } sick_pls_link_option_t;
+
+    /*!
+     * \brief Compares the scan and byte rates a SickPLS achieves with what its
+     *        baud rate and operating mode allow
+     *
+     * Call Sample() periodically (e.g. once a second), alongside the thread
+     * reading scans; each call closes a window and GetReport() describes the
+     * last one. The analyzer itself is not thread safe. The model
+     * counts every byte of a frame at the terminal's bits per byte and caps
+     * the scan rate at the PLS's mirror rate. It ignores the device's own
+     * reply latency, so max_scan_rate is an upper bound.
+     */
+    class SickPLSLinkAnalyzer {
+
+    public:
+
+        /** Constructs an analyzer for the given driver */
+        explicit SickPLSLinkAnalyzer(const SickPLS& sick_pls);
+
+        /** Closes the current window */
+        void Sample();
+
+        /** Indicates whether a window has been closed yet */
+        [[nodiscard]] bool HasReport() const { return _has_report; }
+
+        /** Gets the report for the last window */
+        void GetReport(sick_pls_link_report_t& report) const noexcept(false);
+
+        /** Formats a report for humans */
+        static std::string ReportToString(const sick_pls_link_report_t& report);
+
+        /** Gets the bytes on the line for one scan */
+        static unsigned int GetScanLength(sick_pls_operating_mode_t operating_mode, unsigned int num_values);
+
+        /** Gets the best scan rate a configuration allows */
+        static double GetMaxScanRate(unsigned int baud_rate, unsigned int bits_per_byte,
+                                     sick_pls_operating_mode_t operating_mode, unsigned int num_values,
+                                     unsigned int num_mean_samples = 1);
+
+        /** Lists configurations that reach a target scan rate */
+        static void Plan(double target_scan_rate, unsigned int bits_per_byte,
+                         std::vector<sick_pls_link_option_t>& options);
+
+        /** Converts a session baud to bits/sec */
+        static unsigned int SickBaudToInt(sick_pls_baud_t baud);
+
+    private:
+
+        /** The driver */
+        const SickPLS& _sick_pls;
+
+        /** Counters at the start of the current window */
+        SickPLS::sick_pls_counters_t _counters{};
+        uint64_t _sample_nsec;
+        bool _has_sample;
+
+        /** The last closed window */
+        sick_pls_link_report_t _report{};
+        bool _has_report;
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_LINK_ANALYZER_HH */
@@ -0,0 +1,567 @@
+/*!
+ * \file SickPLSMetrics.cc
+ * \brief Implements a metrics registry for Sick PLS drivers and a
+ *        small HTTP endpoint serving it in Prometheus text format.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "SickPLSMetrics.hh"
+#include "SickLogger.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Names of the latency intervals (indexed by sick_pls_latency_interval_t)
+     */
+    static const char* const sick_pls_metrics_interval_names[SICK_PLS_LATENCY_NUM_INTERVALS] = {
+            "header", "frame", "handoff", "queued", "decode", "total"
+    };
+
+    /**
+     * \brief Appends one sample line
+     * \param &text The text to append to
+     * \param &name The metric name
+     * \param &labels Preformatted labels (may be empty)
+     * \param &value The formatted value
+     */
+    static void sick_pls_metrics_sample(std::string& text, const std::string& name, const std::string& labels,
+                                        const std::string& value) {
+
+        text += name;
+        if (!labels.empty()) {
+            text += '{';
+            text += labels;
+            text += '}';
+        }
+        text += ' ';
+        text += value;
+        text += '\n';
+
+    }
+
+    /**
+     * \brief Appends the HELP and TYPE lines of a metric
+     */
+    static void sick_pls_metrics_header(std::string& text, const std::string& name, const std::string& help,
+                                        const char* const type) {
+        text += "# HELP " + name + " " + help + "\n";
+        text += "# TYPE " + name + " " + type + "\n";
+    }
+
+    /**
+     * \brief Formats a duration in nsecs as seconds
+     */
+    static std::string sick_pls_metrics_seconds(const uint64_t nsecs) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.9g", (double) nsecs / 1e9);
+        return buffer;
+    }
+
+    /**
+     * \brief Joins two preformatted label lists
+     */
+    static std::string sick_pls_metrics_join(const std::string& labels, const std::string& more) {
+        if (labels.empty()) {
+            return more;
+        }
+        return more.empty() ? labels : labels + "," + more;
+    }
+
+    /**
+     * \brief Appends a histogram's cumulative bucket, sum and count lines
+     * \param &summary The summary holding the buckets (nsecs)
+     *
+     * NOTE: The bounds are fixed (SickPLSLatencyHistogram::GetExportBound),
+     *       so series from any number of devices and hosts can be summed
+     *       before quantiles are taken (histogram_quantile).
+     */
+    static void sick_pls_metrics_histogram(std::string& text, const std::string& name, const std::string& labels,
+                                           const sick_pls_latency_summary_t& summary) {
+
+        for (unsigned int i = 0; i < SICK_PLS_LATENCY_NUM_EXPORT_BUCKETS; i++) {
+            sick_pls_metrics_sample(text, name + "_bucket",
+                                    sick_pls_metrics_join(labels, "le=\"" + sick_pls_metrics_seconds(
+                                            SickPLSLatencyHistogram::GetExportBound(i)) + "\""),
+                                    std::to_string(summary.buckets[i]));
+        }
+        sick_pls_metrics_sample(text, name + "_bucket", sick_pls_metrics_join(labels, "le=\"+Inf\""),
+                                std::to_string(summary.count));
+        sick_pls_metrics_sample(text, name + "_sum", labels, sick_pls_metrics_seconds(summary.sum));
+        sick_pls_metrics_sample(text, name + "_count", labels, std::to_string(summary.count));
+
+    }
+
+    /**
+     * \brief A standard constructor
+     */
+    SickPLSMetricsRegistry::SickPLSMetricsRegistry() noexcept(false) {
+
+        if (pthread_mutex_init(&_registry_mutex, nullptr) != 0) {
+            throw SickThreadException("SickPLSMetricsRegistry::SickPLSMetricsRegistry: pthread_mutex_init() failed!");
+        }
+
+    }
+
+    /**
+     * \brief Gets (creating if needed) a counter
+     * \param &name The metric name (conventionally ending in _total)
+     * \param &help The help text
+     * \param &labels Preformatted labels
+     * \return The counter, valid for the registry's lifetime
+     */
+    SickPLSMetricsCounter& SickPLSMetricsRegistry::GetCounter(const std::string& name, const std::string& help,
+                                                              const std::string& labels) noexcept(false) {
+        return *_getSeries(name, help, labels, SICK_PLS_METRICS_COUNTER).counter;
+    }
+
+    /**
+     * \brief Gets (creating if needed) a latency histogram
+     * \param &name The metric name (conventionally ending in _seconds)
+     * \param &help The help text
+     * \param &labels Preformatted labels
+     * \return The histogram (record nsecs), valid for the registry's lifetime
+     */
+    SickPLSLatencyHistogram& SickPLSMetricsRegistry::GetHistogram(const std::string& name, const std::string& help,
+                                                                  const std::string& labels) noexcept(false) {
+        return *_getSeries(name, help, labels, SICK_PLS_METRICS_HISTOGRAM).histogram;
+    }
+
+    /**
+     * \brief Exports a driver's counters and latencies
+     * \param &sick_pls The driver
+     * \param &device The value of its "device" label
+     */
+    void SickPLSMetricsRegistry::AddSickPLS(const SickPLS& sick_pls, const std::string& device) noexcept(false) {
+
+        pthread_mutex_lock(&_registry_mutex);
+        _devices.push_back({&sick_pls, FormatLabel("device", device)});
+        pthread_mutex_unlock(&_registry_mutex);
+
+    }
+
+    /**
+     * \brief Stops exporting a driver
+     * \param &sick_pls The driver
+     */
+    void SickPLSMetricsRegistry::RemoveSickPLS(const SickPLS& sick_pls) noexcept(false) {
+
+        pthread_mutex_lock(&_registry_mutex);
+        _devices.erase(std::remove_if(_devices.begin(), _devices.end(),
+                                      [&sick_pls](const sick_pls_metrics_device_t& device) {
+                                          return device.sick_pls == &sick_pls;
+                                      }), _devices.end());
+        pthread_mutex_unlock(&_registry_mutex);
+
+    }
+
+    /**
+     * \brief Renders every metric in Prometheus text format (version 0.0.4)
+     * \param &text The rendered metrics
+     */
+    void SickPLSMetricsRegistry::Render(std::string& text) const noexcept(false) {
+
+        text.clear();
+
+        pthread_mutex_lock(&_registry_mutex);
+
+        _renderDevices(text);
+
+        /* Samples of one metric must be contiguous, so group the series by name */
+        std::vector<bool> rendered(_series.size(), false);
+        for (size_t i = 0; i < _series.size(); i++) {
+
+            if (rendered[i]) {
+                continue;
+            }
+
+            const sick_pls_metrics_series_t& first = *_series[i];
+            sick_pls_metrics_header(text, first.name, first.help,
+                                    first.kind == SICK_PLS_METRICS_COUNTER ? "counter" : "histogram");
+
+            for (size_t j = i; j < _series.size(); j++) {
+
+                const sick_pls_metrics_series_t& series = *_series[j];
+                if (rendered[j] || series.name != first.name) {
+                    continue;
+                }
+                rendered[j] = true;
+
+                if (series.kind == SICK_PLS_METRICS_COUNTER) {
+                    sick_pls_metrics_sample(text, series.name, series.labels, std::to_string(series.counter->Get()));
+                } else {
+                    sick_pls_latency_summary_t summary;
+                    series.histogram->GetSummary(summary);
+                    sick_pls_metrics_histogram(text, series.name, series.labels, summary);
+                }
+
+            }
+
+        }
+
+        pthread_mutex_unlock(&_registry_mutex);
+
+    }
+
+    /**
+     * \brief Formats a label pair
+     * \param &name The label name
+     * \param &value The label value (escaped as required)
+     * \return name="value"
+     */
+    std::string SickPLSMetricsRegistry::FormatLabel(const std::string& name, const std::string& value) {
+
+        std::string label = name + "=\"";
+        for (const char c: value) {
+            switch (c) {
+                case '\\':
+                    label += "\\\\";
+                    break;
+                case '"':
+                    label += "\\\"";
+                    break;
+                case '\n':
+                    label += "\\n";
+                    break;
+                default:
+                    label += c;
+            }
+        }
+        label += '"';
+
+        return label;
+    }
+
+    /**
+     * \brief A standard destructor
+     */
+    SickPLSMetricsRegistry::~SickPLSMetricsRegistry() {
+        pthread_mutex_destroy(&_registry_mutex);
+    }
+
+    /**
+     * \brief Finds or creates a series
+     * \return The series (kept at a stable address)
+     */
+    SickPLSMetricsRegistry::sick_pls_metrics_series_t&
+    SickPLSMetricsRegistry::_getSeries(const std::string& name, const std::string& help, const std::string& labels,
+                                       const sick_pls_metrics_kind_t kind) noexcept(false) {
+
+        pthread_mutex_lock(&_registry_mutex);
+
+        for (auto& series: _series) {
+            if (series->name == name && series->labels == labels) {
+                pthread_mutex_unlock(&_registry_mutex);
+                if (series->kind != kind) {
+                    throw SickConfigException("SickPLSMetricsRegistry::_getSeries: " + name + " has another type!");
+                }
+                return *series;
+            }
+        }
+
+        auto series = std::make_unique<sick_pls_metrics_series_t>();
+        series->name = name;
+        series->help = help;
+        series->labels = labels;
+        series->kind = kind;
+        if (kind == SICK_PLS_METRICS_COUNTER) {
+            series->counter = std::make_unique<SickPLSMetricsCounter>();
+        } else {
+            series->histogram = std::make_unique<SickPLSLatencyHistogram>();
+        }
+
+        sick_pls_metrics_series_t& result = *series;
+        _series.push_back(std::move(series));
+
+        pthread_mutex_unlock(&_registry_mutex);
+
+        return result;
+    }
+
+    /**
+     * \brief Renders the exported drivers (the registry mutex is held)
+     * \param &text The text to append to
+     */
+    void SickPLSMetricsRegistry::_renderDevices(std::string& text) const {
+
+        if (_devices.empty()) {
+            return;
+        }
+
+        /* Take every reading up front so each metric's lines agree */
+        std::vector<SickPLS::sick_pls_counters_t> counters(_devices.size());
+        std::vector<sick_pls_latency_snapshot_t> latencies(_devices.size());
+        for (size_t i = 0; i < _devices.size(); i++) {
+            _devices[i].sick_pls->GetSickCounters(counters[i]);
+            _devices[i].sick_pls->GetSickLatencySnapshot(latencies[i]);
+        }
+
+        const struct {
+            const char* name;
+            const char* help;
+            uint64_t SickPLS::sick_pls_counters_t::* field;
+        } counter_metrics[] = {
+                {"sickpls_scans_total", "Scans returned by GetSickScan.",
+                 &SickPLS::sick_pls_counters_t::sick_scans},
+                {"sickpls_messages_total", "Frames received with a valid CRC.",
+                 &SickPLS::sick_pls_counters_t::sick_messages_received},
+                {"sickpls_received_bytes_total", "Bytes of all frames read, bad CRCs included.",
+                 &SickPLS::sick_pls_counters_t::sick_bytes_received},
+                {"sickpls_messages_overwritten_total", "Frames replaced before they were read.",
+                 &SickPLS::sick_pls_counters_t::sick_messages_overwritten},
+                {"sickpls_crc_errors_total", "Frames dropped for a bad CRC.",
+                 &SickPLS::sick_pls_counters_t::sick_checksum_errors},
+                {"sickpls_requests_total", "Requests sent to the device, retries included.",
+                 &SickPLS::sick_pls_counters_t::sick_requests_sent},
+                {"sickpls_request_retries_total", "Requests sent again after a timeout.",
+                 &SickPLS::sick_pls_counters_t::sick_request_retries},
+                {"sickpls_request_failures_total", "Requests unanswered on every try.",
+                 &SickPLS::sick_pls_counters_t::sick_request_failures},
+                {"sickpls_scan_timeouts_total", "GetSickScan calls that timed out waiting on the scan stream.",
+                 &SickPLS::sick_pls_counters_t::sick_scan_timeouts}
+        };
+
+        for (const auto& metric: counter_metrics) {
+            sick_pls_metrics_header(text, metric.name, metric.help, "counter");
+            for (size_t i = 0; i < _devices.size(); i++) {
+                sick_pls_metrics_sample(text, metric.name, _devices[i].labels,
+                                        std::to_string(counters[i].*metric.field));
+            }
+        }
+
+        const std::string latency_name = "sickpls_receive_latency_seconds";
+        sick_pls_metrics_header(text, latency_name, "Time between receive pipeline stages of decoded scans.",
+                                "histogram");
+        for (size_t i = 0; i < _devices.size(); i++) {
+            for (unsigned int j = 0; j < SICK_PLS_LATENCY_NUM_INTERVALS; j++) {
+                sick_pls_metrics_histogram(text, latency_name,
+                                         _devices[i].labels + "," +
+                                         FormatLabel("interval", sick_pls_metrics_interval_names[j]),
+                                         latencies[i].intervals[j]);
+            }
+        }
+
+    }
+
+    /**
+     * \brief Constructs a server (nothing is bound until Start())
+     * \param &registry The registry served
+     * \param port TCP port
+     * \param address IPv4 address to bind
+     */
+    SickPLSMetricsServer::SickPLSMetricsServer(const SickPLSMetricsRegistry& registry, const unsigned int port,
+                                               std::string address) :
+            _registry(registry), _port(port), _address(std::move(address)), _listen_fd(-1),
+            _shutdown_pipe{-1, -1}, _server_thread_id(0), _running(false) {}
+
+    /**
+     * \brief Binds the port and starts the server thread
+     */
+    void SickPLSMetricsServer::Start() noexcept(false) {
+
+        if (_running) {
+            return;
+        }
+
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t) _port);
+        if (inet_pton(AF_INET, _address.c_str(), &addr.sin_addr) != 1) {
+            throw SickConfigException("SickPLSMetricsServer::Start: Invalid address!");
+        }
+
+        if ((_listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0) {
+            throw SickIOException("SickPLSMetricsServer::Start: socket() failed!");
+        }
+
+        const int reuse = 1;
+        setsockopt(_listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        if (bind(_listen_fd, (struct sockaddr*) &addr, sizeof(addr)) < 0 || listen(_listen_fd, 8) < 0) {
+            close(_listen_fd);
+            _listen_fd = -1;
+            throw SickIOException("SickPLSMetricsServer::Start: bind() failed! " + std::string(strerror(errno)));
+        }
+
+        if (pipe2(_shutdown_pipe, O_CLOEXEC | O_NONBLOCK) < 0) {
+            close(_listen_fd);
+            _listen_fd = -1;
+            throw SickIOException("SickPLSMetricsServer::Start: pipe2() failed!");
+        }
+
+        if (pthread_create(&_server_thread_id, nullptr, _serverThread, this) != 0) {
+            close(_shutdown_pipe[0]);
+            close(_shutdown_pipe[1]);
+            close(_listen_fd);
+            _listen_fd = _shutdown_pipe[0] = _shutdown_pipe[1] = -1;
+            throw SickThreadException("SickPLSMetricsServer::Start: pthread_create() failed!");
+        }
+
+        _running = true;
+
+    }
+
+    /**
+     * \brief Stops the server thread and closes the port
+     */
+    void SickPLSMetricsServer::Stop() noexcept(false) {
+
+        if (!_running) {
+            return;
+        }
+
+        const char wake = 0;
+        if (write(_shutdown_pipe[1], &wake, 1) < 0) {
+            SICK_LOG_ERROR("SickPLSMetricsServer::Stop: write() failed!");
+        }
+
+        if (pthread_join(_server_thread_id, nullptr) != 0) {
+            throw SickThreadException("SickPLSMetricsServer::Stop: pthread_join() failed!");
+        }
+
+        close(_shutdown_pipe[0]);
+        close(_shutdown_pipe[1]);
+        close(_listen_fd);
+        _listen_fd = _shutdown_pipe[0] = _shutdown_pipe[1] = -1;
+        _running = false;
+
+    }
+
+    /**
+     * \brief A standard destructor
+     */
+    SickPLSMetricsServer::~SickPLSMetricsServer() {
+
+        try {
+            Stop();
+        }
+
+            /* Catch anything else */
+        catch (...) {
+            SICK_LOG_ERROR("SickPLSMetricsServer::~SickPLSMetricsServer: Unknown exception!");
+        }
+
+    }
+
+    /**
+     * \brief Reads a request and answers it
+     * \param connection_fd The accepted connection
+     */
+    void SickPLSMetricsServer::_serveConnection(const int connection_fd) const {
+
+        /* Don't let a stalled client hold up the next scrape */
+        struct timeval timeout = {};
+        timeout.tv_sec = SICK_PLS_METRICS_REQUEST_TIMEOUT / 1000000;
+        timeout.tv_usec = SICK_PLS_METRICS_REQUEST_TIMEOUT % 1000000;
+        setsockopt(connection_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(connection_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        /* Read up to the end of the request header */
+        std::string request;
+        char buffer[512];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < SICK_PLS_METRICS_MAX_REQUEST_LENGTH) {
+            const ssize_t num_bytes_read = read(connection_fd, buffer, sizeof(buffer));
+            if (num_bytes_read <= 0) {
+                return;
+            }
+            request.append(buffer, (size_t) num_bytes_read);
+        }
+
+        std::string status = "200 OK";
+        std::string body;
+        if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 13, "GET /metrics?") == 0) {
+            try {
+                _registry.Render(body);
+            }
+            catch (...) {
+                status = "500 Internal Server Error";
+                body = "render failed\n";
+            }
+        } else if (request.compare(0, 4, "GET ") == 0) {
+            status = "404 Not Found";
+            body = "try /metrics\n";
+        } else {
+            status = "405 Method Not Allowed";
+        }
+
+        const std::string response = "HTTP/1.1 " + status + "\r\n"
+                                     "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                                     "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                                     "Connection: close\r\n\r\n" + body;
+
+        size_t num_bytes_written = 0;
+        while (num_bytes_written < response.size()) {
+            const ssize_t n = send(connection_fd, response.data() + num_bytes_written,
+                                   response.size() - num_bytes_written, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return;
+            }
+            num_bytes_written += (size_t) n;
+        }
+
+    }
+
+    /**
+     * \brief The server thread
+     * \param *thread_args The server
+     */
+    void* SickPLSMetricsServer::_serverThread(void* thread_args) {
+
+        auto* server = (SickPLSMetricsServer*) thread_args;
+
+        for (;;) {
+
+            struct pollfd fds[2] = {{server->_listen_fd,       POLLIN, 0},
+                                    {server->_shutdown_pipe[0], POLLIN, 0}};
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                SICK_LOG_ERROR("SickPLSMetricsServer::_serverThread: poll() failed!");
+                break;
+            }
+
+            if (fds[1].revents != 0) {
+                break;
+            }
+
+            if (fds[0].revents & POLLIN) {
+                const int connection_fd = accept4(server->_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+                if (connection_fd >= 0) {
+                    server->_serveConnection(connection_fd);
+                    close(connection_fd);
+                }
+            }
+
+        }
+
+        /* Thread is done */
+        return nullptr;
+
+    }
+
+} /* namespace sickpls */
@@ -0,0 +1,207 @@
+/*!
+ * \file SickPLSMetrics.hh
+ * \brief Defines a metrics registry for Sick PLS drivers and a
+ *        small HTTP endpoint serving it in Prometheus text format.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_METRICS_HH
+#define SICK_PLS_METRICS_HH
+
+/* Definition dependencies */
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include "SickPLS.hh"
+#include "SickPLSLatency.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define DEFAULT_SICK_PLS_METRICS_ADDRESS                           "127.0.0.1"  ///< Only serve the local host
+#define DEFAULT_SICK_PLS_METRICS_PORT                                   (9477)  ///< TCP port of the endpoint
+#define SICK_PLS_METRICS_REQUEST_TIMEOUT                       (unsigned int)(1e6)  ///< Time allowed to send a request (usecs)
+#define SICK_PLS_METRICS_MAX_REQUEST_LENGTH                             (4096)  ///< Longest request header accepted (bytes)
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \brief A monotonically increasing count
+     *
+     * Increment() is a single relaxed atomic add.
+     */
+    class SickPLSMetricsCounter {
+
+    public:
+
+        /** Adds to the count */
+        void Increment(const uint64_t amount = 1) { _count.fetch_add(amount, std::memory_order_relaxed); }
+
+        /** Gets the count */
+        [[nodiscard]] uint64_t Get() const { return _count.load(std::memory_order_relaxed); }
+
+    private:
+
+        /** The count */
+        std::atomic<uint64_t> _count{0};
+
+    };
+
+    /*!
+     * \brief A set of named counters, histograms and Sick PLS drivers
+     *        rendered in Prometheus text exposition format
+     *
+     * Counters and histograms are created by the registry and live as long
+     * as it does, so the references handed out may be cached and updated
+     * without touching the registry again. Histograms record nsecs and
+     * are exported as Prometheus histograms in seconds, with cumulative
+     * buckets at fixed coarse bounds so they aggregate across devices. Drivers added with AddSickPLS()
+     * are read only when the registry is rendered; they cost nothing on
+     * their receive path beyond the relaxed counters they keep anyway.
+     *
+     * Labels are given preformatted, e.g. "device=\"/dev/ttyS0\"" (see
+     * FormatLabel()).
+     */
+    class SickPLSMetricsRegistry {
+
+    public:
+
+        /** A standard constructor */
+        SickPLSMetricsRegistry() noexcept(false);
+
+        /** Gets (creating if needed) a counter */
+        SickPLSMetricsCounter& GetCounter(const std::string& name, const std::string& help,
+                                          const std::string& labels = "") noexcept(false);
+
+        /** Gets (creating if needed) a latency histogram (nsecs) */
+        SickPLSLatencyHistogram& GetHistogram(const std::string& name, const std::string& help,
+                                              const std::string& labels = "") noexcept(false);
+
+        /** Exports a driver's counters and latencies under the given device label */
+        void AddSickPLS(const SickPLS& sick_pls, const std::string& device) noexcept(false);
+
+        /** Stops exporting a driver (must precede its destruction) */
+        void RemoveSickPLS(const SickPLS& sick_pls) noexcept(false);
+
+        /** Renders every metric in Prometheus text format */
+        void Render(std::string& text) const noexcept(false);
+
+        /** Formats a label pair, escaping the value */
+        static std::string FormatLabel(const std::string& name, const std::string& value);
+
+        /** A standard destructor */
+        ~SickPLSMetricsRegistry();
+
+    private:
+
+        /** Kinds of registered series */
+        enum sick_pls_metrics_kind_t {
+            SICK_PLS_METRICS_COUNTER,
+            SICK_PLS_METRICS_HISTOGRAM
+        };
+
+        /** A registered series */
+        typedef struct sick_pls_metrics_series_tag {
+            std::string name;                                                      ///< Metric name
+            std::string help;                                                      ///< Help text
+            std::string labels;                                                    ///< Preformatted labels
+            sick_pls_metrics_kind_t kind;                                          ///< Counter or histogram
+            std::unique_ptr<SickPLSMetricsCounter> counter;                        ///< Set for counters
+            std::unique_ptr<SickPLSLatencyHistogram> histogram;                    ///< Set for histograms
+        } sick_pls_metrics_series_t;
+
+        /** An exported driver */
+        typedef struct sick_pls_metrics_device_tag {
+            const SickPLS* sick_pls;                                               ///< The driver
+            std::string labels;                                                    ///< Its device label
+        } sick_pls_metrics_device_t;
+
+        /** Guards the series and drivers (not the values) */
+        mutable pthread_mutex_t _registry_mutex{};
+
+        /** Registered series, in registration order */
+        std::vector<std::unique_ptr<sick_pls_metrics_series_t>> _series;
+
+        /** Exported drivers */
+        std::vector<sick_pls_metrics_device_t> _devices;
+
+        /** Finds or creates a series */
+        sick_pls_metrics_series_t& _getSeries(const std::string& name, const std::string& help,
+                                              const std::string& labels, sick_pls_metrics_kind_t kind) noexcept(false);
+
+        /** Renders the exported drivers */
+        void _renderDevices(std::string& text) const;
+
+    };
+
+    /*!
+     * \brief Serves a registry at http://ADDRESS:PORT/metrics
+     *
+     * A single background thread accepts one connection at a time,
+     * renders the registry and closes the connection, which is all a
+     * Prometheus scraper needs.
+     */
+    class SickPLSMetricsServer {
+
+    public:
+
+        /** Constructs a server for the given registry */
+        explicit SickPLSMetricsServer(const SickPLSMetricsRegistry& registry,
+                                      unsigned int port = DEFAULT_SICK_PLS_METRICS_PORT,
+                                      std::string address = DEFAULT_SICK_PLS_METRICS_ADDRESS);
+
+        /** Binds the port and starts serving */
+        void Start() noexcept(false);
+
+        /** Stops serving and closes the port */
+        void Stop() noexcept(false);
+
+        /** Indicates whether the server is running */
+        [[nodiscard]] bool IsRunning() const { return _running; }
+
+        /** A standard destructor */
+        ~SickPLSMetricsServer();
+
+    private:
+
+        /** The registry served */
+        const SickPLSMetricsRegistry& _registry;
+
+        /** Where to listen */
+        unsigned int _port;
+        std::string _address;
+
+        /** The listening socket */
+        int _listen_fd;
+
+        /** Wakes up the server thread when stopping */
+        int _shutdown_pipe[2];
+
+        /** Server thread */
+        pthread_t _server_thread_id;
+        bool _running;
+
+        /** Answers one connection */
+        void _serveConnection(int connection_fd) const;
+
+        /** Entry point for the server thread */
+        static void* _serverThread(void* thread_args);
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_METRICS_HH */
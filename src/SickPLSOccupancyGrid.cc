@@ -0,0 +1,316 @@
+/*!
+ * \file SickPLSOccupancyGrid.cc
+ * \brief Implements a tiled log-odds occupancy grid built
+ *        incrementally from Sick PLS scans.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "SickPLSOccupancyGrid.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Constructs an (unknown) grid
+     * \param width Extent of the grid along x (m)
+     * \param height Extent of the grid along y (m)
+     * \param resolution Cell size (m)
+     * \param origin_x World x of the grid's lower-left corner (m)
+     * \param origin_y World y of the grid's lower-left corner (m)
+     */
+    SickPLSOccupancyGrid::SickPLSOccupancyGrid(const double width, const double height, const double resolution,
+                                               const double origin_x, const double origin_y) noexcept(false) :
+            _resolution(resolution), _origin_x(origin_x), _origin_y(origin_y),
+            _cells_x(0), _cells_y(0), _tiles_x(0), _tiles_y(0),
+            _log_odds_hit(DEFAULT_SICK_PLS_GRID_LOG_ODDS_HIT), _log_odds_miss(DEFAULT_SICK_PLS_GRID_LOG_ODDS_MISS),
+            _log_odds_min(DEFAULT_SICK_PLS_GRID_LOG_ODDS_MIN), _log_odds_max(DEFAULT_SICK_PLS_GRID_LOG_ODDS_MAX),
+            _no_return_clear_range(0) {
+
+        /* A sanity check */
+        if (width <= 0 || height <= 0 || resolution <= 0) {
+            throw SickConfigException("SickPLSOccupancyGrid::SickPLSOccupancyGrid: Invalid grid geometry!");
+        }
+
+        _cells_x = (unsigned int) ceil(width / resolution);
+        _cells_y = (unsigned int) ceil(height / resolution);
+        _tiles_x = (_cells_x + SICK_PLS_GRID_TILE_MASK) >> SICK_PLS_GRID_TILE_SHIFT;
+        _tiles_y = (_cells_y + SICK_PLS_GRID_TILE_MASK) >> SICK_PLS_GRID_TILE_SHIFT;
+
+        /* Allocate whole tiles */
+        _cells.assign((size_t) _tiles_x * _tiles_y * SICK_PLS_GRID_TILE_CELLS, 0);
+        _dirty_tiles.assign((size_t) _tiles_x * _tiles_y, 0);
+
+    }
+
+    /**
+     * \brief Sets the log-odds update parameters (in 1/32 nat steps)
+     * \param log_odds_hit Increment applied to a beam's endpoint (> 0)
+     * \param log_odds_miss Increment applied to the cells a beam passes through (< 0)
+     * \param log_odds_min Lower clamp (>= -127)
+     * \param log_odds_max Upper clamp (<= 127)
+     */
+    void SickPLSOccupancyGrid::SetUpdateParameters(const int log_odds_hit, const int log_odds_miss,
+                                                   const int log_odds_min, const int log_odds_max) noexcept(false) {
+
+        /* A sanity check */
+        if (log_odds_hit <= 0 || log_odds_miss >= 0 || log_odds_min < -127 || log_odds_max > 127 ||
+            log_odds_min >= log_odds_max) {
+            throw SickConfigException("SickPLSOccupancyGrid::SetUpdateParameters: Invalid parameters!");
+        }
+
+        _log_odds_hit = log_odds_hit;
+        _log_odds_miss = log_odds_miss;
+        _log_odds_min = log_odds_min;
+        _log_odds_max = log_odds_max;
+
+    }
+
+    /**
+     * \brief Integrates a scan into the grid
+     * \param *ranges The range values (cm)
+     * \param num_ranges The number of range values
+     * \param &converter Describes the scan geometry and valid range window
+     * \param sensor_x World x of the sensor (m)
+     * \param sensor_y World y of the sensor (m)
+     * \param sensor_theta World heading of the sensor (rad)
+     *
+     * NOTE: Scans taken while the sensor is outside of the grid are ignored.
+     */
+    void SickPLSOccupancyGrid::Update(const uint16_t* const ranges, const unsigned int num_ranges,
+                                      const SickPLSCartesianConverter& converter,
+                                      const double sensor_x, const double sensor_y,
+                                      const double sensor_theta) noexcept(false) {
+
+        /* Ensure the scan matches the geometry */
+        if (num_ranges > converter.GetNumBeams()) {
+            throw SickConfigException("SickPLSOccupancyGrid::Update: Scan is larger than the converter's tables!");
+        }
+
+        int x0, y0;
+        if (!WorldToCell(sensor_x, sensor_y, x0, y0)) {
+            return;
+        }
+
+        const float* const cos_table = converter.GetCosTable();
+        const float* const sin_table = converter.GetSinTable();
+        const double cos_theta = cos(sensor_theta), sin_theta = sin(sensor_theta);
+        const unsigned int min_range = converter.GetMinValidRange();
+        const unsigned int max_range = converter.GetMaxValidRange();
+
+        /* Beam endpoints in (fractional) cells relative to the sensor: dx = r * (c*cos - s*sin) / res */
+        const double cells_per_cm = 0.01 / _resolution;
+        const double sensor_cell_x = (sensor_x - _origin_x) / _resolution;
+        const double sensor_cell_y = (sensor_y - _origin_y) / _resolution;
+
+        for (unsigned int i = 0; i < num_ranges; i++) {
+
+            double length;
+            bool hit;
+            if (ranges[i] < min_range) {
+                continue;
+            } else if (ranges[i] >= max_range) {
+                if (_no_return_clear_range <= 0) {
+                    continue;
+                }
+                length = _no_return_clear_range * 100.0;
+                hit = false;
+            } else {
+                length = ranges[i];
+                hit = true;
+            }
+
+            const double dir_x = cos_table[i] * cos_theta - sin_table[i] * sin_theta;
+            const double dir_y = cos_table[i] * sin_theta + sin_table[i] * cos_theta;
+            const auto x1 = (int) floor(sensor_cell_x + length * cells_per_cm * dir_x);
+            const auto y1 = (int) floor(sensor_cell_y + length * cells_per_cm * dir_y);
+
+            _traceRay(x0, y0, x1, y1, hit);
+
+        }
+
+    }
+
+    /**
+     * \brief Resets every cell to unknown (log-odds 0)
+     */
+    void SickPLSOccupancyGrid::Clear() {
+
+        memset(_cells.data(), 0, _cells.size());
+        memset(_dirty_tiles.data(), 1, _dirty_tiles.size());
+
+    }
+
+    /**
+     * \brief Converts a world position into cell coordinates
+     * \param x World x (m)
+     * \param y World y (m)
+     * \param &cell_x The cell column
+     * \param &cell_y The cell row
+     * \return True if the position lies within the grid
+     */
+    bool SickPLSOccupancyGrid::WorldToCell(const double x, const double y, int& cell_x, int& cell_y) const {
+
+        cell_x = (int) floor((x - _origin_x) / _resolution);
+        cell_y = (int) floor((y - _origin_y) / _resolution);
+
+        return cell_x >= 0 && cell_y >= 0 && (unsigned int) cell_x < _cells_x && (unsigned int) cell_y < _cells_y;
+    }
+
+    /**
+     * \brief Gets the log-odds of a cell
+     * \param cell_x The cell column
+     * \param cell_y The cell row
+     * \return The log-odds (1/32 nat steps)
+     */
+    int8_t SickPLSOccupancyGrid::GetLogOdds(const unsigned int cell_x, const unsigned int cell_y) const noexcept(false) {
+
+        /* A sanity check */
+        if (cell_x >= _cells_x || cell_y >= _cells_y) {
+            throw SickConfigException("SickPLSOccupancyGrid::GetLogOdds: Cell is outside of the grid!");
+        }
+
+        return _cells[_cellIndex(cell_x, cell_y)];
+    }
+
+    /**
+     * \brief Gets the occupancy probability of a cell
+     * \param cell_x The cell column
+     * \param cell_y The cell row
+     * \return The probability that the cell is occupied
+     */
+    double SickPLSOccupancyGrid::GetProbability(const unsigned int cell_x,
+                                                const unsigned int cell_y) const noexcept(false) {
+        return 1.0 - 1.0 / (1.0 + exp(GetLogOdds(cell_x, cell_y) / 32.0));
+    }
+
+    /**
+     * \brief Copies the grid out in row-major order
+     * \param *log_odds Destination buffer (GetNumCellsX() * GetNumCellsY() values)
+     */
+    void SickPLSOccupancyGrid::CopyRowMajor(int8_t* const log_odds) const {
+
+        for (unsigned int cell_y = 0; cell_y < _cells_y; cell_y++) {
+            for (unsigned int tile_x = 0; tile_x < _tiles_x; tile_x++) {
+
+                /* Copy one tile row at a time */
+                const unsigned int cell_x = tile_x << SICK_PLS_GRID_TILE_SHIFT;
+                const unsigned int count = (cell_x + SICK_PLS_GRID_TILE_SIZE <= _cells_x) ? SICK_PLS_GRID_TILE_SIZE
+                                                                                          : _cells_x - cell_x;
+                memcpy(&log_odds[(size_t) cell_y * _cells_x + cell_x], &_cells[_cellIndex(cell_x, cell_y)], count);
+
+            }
+        }
+
+    }
+
+    /**
+     * \brief Indicates whether a tile was modified since the last ClearDirtyTiles()
+     * \param tile_x The tile column
+     * \param tile_y The tile row
+     */
+    bool SickPLSOccupancyGrid::IsTileDirty(const unsigned int tile_x, const unsigned int tile_y) const {
+        return tile_x < _tiles_x && tile_y < _tiles_y && _dirty_tiles[tile_y * _tiles_x + tile_x];
+    }
+
+    /**
+     * \brief Gets the cells of a tile
+     * \param tile_x The tile column
+     * \param tile_y The tile row
+     * \return Pointer to SICK_PLS_GRID_TILE_CELLS row-major cells (NULL if out of range)
+     */
+    const int8_t* SickPLSOccupancyGrid::GetTile(const unsigned int tile_x, const unsigned int tile_y) const {
+
+        if (tile_x >= _tiles_x || tile_y >= _tiles_y) {
+            return nullptr;
+        }
+
+        return &_cells[(size_t) (tile_y * _tiles_x + tile_x) * SICK_PLS_GRID_TILE_CELLS];
+    }
+
+    /**
+     * \brief Marks every tile as clean
+     */
+    void SickPLSOccupancyGrid::ClearDirtyTiles() {
+        memset(_dirty_tiles.data(), 0, _dirty_tiles.size());
+    }
+
+    /**
+     * \brief Applies a clamped log-odds increment to a cell
+     */
+    void SickPLSOccupancyGrid::_updateCell(const unsigned int cell_x, const unsigned int cell_y, const int delta) {
+
+        int8_t& cell = _cells[_cellIndex(cell_x, cell_y)];
+
+        int value = cell + delta;
+        if (value < _log_odds_min) {
+            value = _log_odds_min;
+        } else if (value > _log_odds_max) {
+            value = _log_odds_max;
+        }
+        cell = (int8_t) value;
+
+        _dirty_tiles[(cell_y >> SICK_PLS_GRID_TILE_SHIFT) * _tiles_x + (cell_x >> SICK_PLS_GRID_TILE_SHIFT)] = 1;
+
+    }
+
+    /**
+     * \brief Traces a beam from (x0,y0) to (x1,y1) using Bresenham's algorithm
+     * \param x0,y0 The sensor cell (inside the grid)
+     * \param x1,y1 The endpoint cell (may lie outside the grid)
+     * \param hit Whether the endpoint is an obstacle (otherwise it is free space too)
+     */
+    void SickPLSOccupancyGrid::_traceRay(int x0, int y0, const int x1, const int y1, const bool hit) {
+
+        const int dx = abs(x1 - x0), sx = (x0 < x1) ? 1 : -1;
+        const int dy = -abs(y1 - y0), sy = (y0 < y1) ? 1 : -1;
+        int error = dx + dy;
+
+        for (;;) {
+
+            /* The ray has left the grid (it started inside, so it never comes back) */
+            if (x0 < 0 || y0 < 0 || (unsigned int) x0 >= _cells_x || (unsigned int) y0 >= _cells_y) {
+                return;
+            }
+
+            if (x0 == x1 && y0 == y1) {
+                break;
+            }
+
+            _updateCell(x0, y0, _log_odds_miss);
+
+            const int error2 = 2 * error;
+            if (error2 >= dy) {
+                error += dy;
+                x0 += sx;
+            }
+            if (error2 <= dx) {
+                error += dx;
+                y0 += sy;
+            }
+
+        }
+
+        /* The endpoint */
+        _updateCell(x0, y0, hit ? _log_odds_hit : _log_odds_miss);
+
+    }
+
+} /* namespace sickpls */
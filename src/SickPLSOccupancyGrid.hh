@@ -0,0 +1,146 @@
+/*!
+ * \file SickPLSOccupancyGrid.hh
+ * \brief Defines a tiled log-odds occupancy grid built
+ *        incrementally from Sick PLS scans.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_OCCUPANCY_GRID_HH
+#define SICK_PLS_OCCUPANCY_GRID_HH
+
+/* Definition dependencies */
+#include <cstdint>
+#include <vector>
+
+#include "SickPLSCartesian.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define SICK_PLS_GRID_TILE_SHIFT                                             (5)  ///< Tiles are 2^5 x 2^5 cells
+#define SICK_PLS_GRID_TILE_SIZE                   (1 << SICK_PLS_GRID_TILE_SHIFT)  ///< Cells along a tile edge
+#define SICK_PLS_GRID_TILE_MASK                     (SICK_PLS_GRID_TILE_SIZE - 1)  ///< Cell offset within a tile
+#define SICK_PLS_GRID_TILE_CELLS  (SICK_PLS_GRID_TILE_SIZE * SICK_PLS_GRID_TILE_SIZE)  ///< Cells per tile (1 KB of int8_t)
+#define DEFAULT_SICK_PLS_GRID_LOG_ODDS_HIT                                  (20)  ///< Log-odds increment for an endpoint (1/32 nats)
+#define DEFAULT_SICK_PLS_GRID_LOG_ODDS_MISS                                 (-6)  ///< Log-odds increment for a traversed cell (1/32 nats)
+#define DEFAULT_SICK_PLS_GRID_LOG_ODDS_MIN                                (-100)  ///< Lower clamp for a cell
+#define DEFAULT_SICK_PLS_GRID_LOG_ODDS_MAX                                 (100)  ///< Upper clamp for a cell
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \brief A log-odds occupancy grid updated by ray casting scans
+     *
+     * Cells hold int8_t log-odds (in 1/32 nat steps) and are stored in
+     * 32 x 32 cell tiles so that a ray touches few cache lines. Each beam
+     * is traced with Bresenham's algorithm, so an update only touches the
+     * cells along the beams; the tiles touched since the last call to
+     * ClearDirtyTiles() are tracked for downstream consumers.
+     *
+     * At the default 5 cm resolution a 40 m x 40 m area is 800 x 800 cells
+     * (625 KB).
+     */
+    class SickPLSOccupancyGrid {
+
+    public:
+
+        /** Constructs a grid covering [origin_x, origin_x + width) x [origin_y, origin_y + height) (m) */
+        SickPLSOccupancyGrid(double width = 40.0, double height = 40.0, double resolution = 0.05,
+                             double origin_x = -20.0, double origin_y = -20.0) noexcept(false);
+
+        /** Sets the log-odds update and clamping parameters */
+        void SetUpdateParameters(int log_odds_hit, int log_odds_miss,
+                                 int log_odds_min, int log_odds_max) noexcept(false);
+
+        /** Sets the free-space length traced for beams without a return (m, 0 => ignore such beams) */
+        void SetNoReturnClearRange(double clear_range) { _no_return_clear_range = clear_range; }
+
+        /** Integrates a decoded scan taken from the given sensor pose (m, m, rad) */
+        void Update(const uint16_t* ranges, unsigned int num_ranges, const SickPLSCartesianConverter& converter,
+                    double sensor_x, double sensor_y, double sensor_theta) noexcept(false);
+
+        /** Resets every cell to unknown */
+        void Clear();
+
+        /** Gets the number of cells along x */
+        [[nodiscard]] unsigned int GetNumCellsX() const { return _cells_x; }
+
+        /** Gets the number of cells along y */
+        [[nodiscard]] unsigned int GetNumCellsY() const { return _cells_y; }
+
+        /** Gets the cell size (m) */
+        [[nodiscard]] double GetResolution() const { return _resolution; }
+
+        /** Converts a world position into cell coordinates */
+        bool WorldToCell(double x, double y, int& cell_x, int& cell_y) const;
+
+        /** Gets the log-odds of a cell */
+        [[nodiscard]] int8_t GetLogOdds(unsigned int cell_x, unsigned int cell_y) const noexcept(false);
+
+        /** Gets the occupancy probability of a cell */
+        [[nodiscard]] double GetProbability(unsigned int cell_x, unsigned int cell_y) const noexcept(false);
+
+        /** Copies the grid out in row-major order (cells_x * cells_y values) */
+        void CopyRowMajor(int8_t* log_odds) const;
+
+        /** Gets the number of tiles along x */
+        [[nodiscard]] unsigned int GetNumTilesX() const { return _tiles_x; }
+
+        /** Gets the number of tiles along y */
+        [[nodiscard]] unsigned int GetNumTilesY() const { return _tiles_y; }
+
+        /** Indicates whether a tile was modified since the last ClearDirtyTiles() */
+        [[nodiscard]] bool IsTileDirty(unsigned int tile_x, unsigned int tile_y) const;
+
+        /** Gets a pointer to the (row-major, 32x32) cells of a tile */
+        [[nodiscard]] const int8_t* GetTile(unsigned int tile_x, unsigned int tile_y) const;
+
+        /** Marks every tile as clean */
+        void ClearDirtyTiles();
+
+    private:
+
+        /** Grid geometry */
+        double _resolution;
+        double _origin_x, _origin_y;
+        unsigned int _cells_x, _cells_y;
+        unsigned int _tiles_x, _tiles_y;
+
+        /** Update parameters */
+        int _log_odds_hit, _log_odds_miss;
+        int _log_odds_min, _log_odds_max;
+        double _no_return_clear_range;
+
+        /** Cells, tile-major */
+        std::vector<int8_t> _cells;
+
+        /** One flag per tile */
+        std::vector<uint8_t> _dirty_tiles;
+
+        /** Gets the storage index of a cell */
+        [[nodiscard]] unsigned int _cellIndex(unsigned int cell_x, unsigned int cell_y) const {
+            const unsigned int tile = (cell_y >> SICK_PLS_GRID_TILE_SHIFT) * _tiles_x + (cell_x >> SICK_PLS_GRID_TILE_SHIFT);
+            return tile * SICK_PLS_GRID_TILE_CELLS +
+                   ((cell_y & SICK_PLS_GRID_TILE_MASK) << SICK_PLS_GRID_TILE_SHIFT) + (cell_x & SICK_PLS_GRID_TILE_MASK);
+        }
+
+        /** Applies an increment to a cell (with clamping) */
+        void _updateCell(unsigned int cell_x, unsigned int cell_y, int delta);
+
+        /** Traces a ray, decrementing traversed cells and (optionally) incrementing the endpoint */
+        void _traceRay(int x0, int y0, int x1, int y1, bool hit);
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_OCCUPANCY_GRID_HH */
@@ -0,0 +1,474 @@
+/*!
+ * \file SickPLSReplay.cc
+ * \brief Implements a replay source that presents a recorded scan
+ *        archive as a Sick PLS.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+
+#include "SickPLSReplay.hh"
+#include "SickLogger.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Reads the monotonic clock (usecs)
+     */
+    static inline uint64_t sick_pls_replay_clock_usec() {
+        struct timespec now = {};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+    }
+
+    /**
+     * \brief Sleeps until the monotonic clock reaches a time
+     * \param due_usec The time (usecs); 0 => return immediately
+     */
+    static void sick_pls_replay_sleep_until(const uint64_t due_usec) {
+
+        if (due_usec == 0) {
+            return;
+        }
+
+        struct timespec deadline = {};
+        deadline.tv_sec = (time_t) (due_usec / 1000000);
+        deadline.tv_nsec = (long) (due_usec % 1000000) * 1000;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {}
+
+    }
+
+    /**
+     * \brief Constructs a replay (nothing is mapped until Initialize())
+     * \param &archive_path The recording
+     * \param speed Replay speed (1.0 => real time, SICK_PLS_REPLAY_MAX_SPEED => unpaced)
+     */
+    SickPLSReplay::SickPLSReplay(const std::string& archive_path, const double speed) :
+            SickPLS(archive_path), _reader(archive_path), _speed(speed), _next_scan(0),
+            _anchored(false), _anchor_timestamp_usec(0), _anchor_clock_usec(0) {}
+
+    /**
+     * \brief Maps the archive and rewinds to its first scan
+     * \param desired_baud_rate Ignored (kept for interface compatibility)
+     */
+    void SickPLSReplay::Initialize(const sick_pls_baud_t desired_baud_rate) noexcept(false) {
+
+        _acquireSickConfig();
+
+        try {
+
+            /* Buffer the desired baud rate so the replay reports it back */
+            _desired_session_baud = desired_baud_rate;
+            _curr_session_baud = desired_baud_rate;
+
+            if (!_sick_initialized) {
+                _setupConnection();
+                _sick_initialized = true;
+            }
+
+            _storeSickOpMode(SICK_OP_MODE_MONITOR_STREAM_VALUES);
+            _seek(0);
+
+        }
+
+            /* Handle any I/O exceptions */
+        catch (SickIOException& sick_io_exception) {
+            SICK_LOG_ERROR(sick_io_exception.what());
+            _releaseSickConfig();
+            throw;
+        }
+
+            /* Let other configuration calls in before passing it on */
+        catch (...) {
+            _releaseSickConfig();
+            throw;
+        }
+
+        _releaseSickConfig();
+
+    }
+
+    /**
+     * \brief Unmaps the archive
+     */
+    void SickPLSReplay::Uninitialize() noexcept(false) {
+
+        _acquireSickConfig();
+
+        try {
+
+            if (_sick_initialized) {
+                _teardownConnection();
+                _storeSickOpMode(SICK_OP_MODE_UNKNOWN);
+                _sick_initialized = false;
+            }
+
+        }
+
+            /* Let other configuration calls in before passing it on */
+        catch (...) {
+            _releaseSickConfig();
+            throw;
+        }
+
+        _releaseSickConfig();
+
+    }
+
+    /**
+     * \brief Gets the next recorded scan
+     * \param *measurement_values Destination buffer (SICK_MAX_NUM_MEASUREMENTS values)
+     * \param &num_measurement_values Number of values stored in measurement_values
+     */
+    void SickPLSReplay::GetSickScan(unsigned int* const measurement_values,
+                                    unsigned int& num_measurement_values) noexcept(false) {
+
+        uint64_t timestamp_usec;
+        GetSickScan(measurement_values, num_measurement_values, timestamp_usec);
+
+    }
+
+    /**
+     * \brief Gets the next recorded scan and its recorded time stamp
+     * \param *measurement_values Destination buffer (SICK_MAX_NUM_MEASUREMENTS values)
+     * \param &num_measurement_values Number of values stored in measurement_values
+     * \param &timestamp_usec The scan's recorded time stamp (usecs)
+     */
+    void SickPLSReplay::GetSickScan(unsigned int* const measurement_values, unsigned int& num_measurement_values,
+                                    uint64_t& timestamp_usec) noexcept(false) {
+
+        uint16_t values[SICK_MAX_NUM_MEASUREMENTS];
+        unsigned int num_values = 0;
+        uint64_t due_usec = 0;
+
+        /* Claim the next scan (the reader's block cache is shared too) */
+        _acquireSickConfig();
+
+        try {
+
+            /* Ensure the replay is initialized */
+            if (!_sick_initialized) {
+                throw SickConfigException("SickPLSReplay::GetSickScan: Replay is not initialized!");
+            }
+
+            /* Like the device, asking for a scan switches to streaming */
+            _storeSickOpMode(SICK_OP_MODE_MONITOR_STREAM_VALUES);
+
+            const uint64_t scan_index = _next_scan.load(std::memory_order_relaxed);
+            if (scan_index >= _reader.GetNumScans()) {
+                throw SickTimeoutException("SickPLSReplay::GetSickScan: End of recording!");
+            }
+
+            const unsigned int block = _findBlock(scan_index);
+            const auto row = (unsigned int) (scan_index - _block_first_scan[block]);
+
+            _reader.ReadScan(block, row, values, num_values, &timestamp_usec);
+            due_usec = _pace(timestamp_usec);
+
+            _next_scan.store(scan_index + 1, std::memory_order_relaxed);
+
+        }
+
+            /* Let other configuration calls in before passing it on */
+        catch (...) {
+            _releaseSickConfig();
+            throw;
+        }
+
+        _releaseSickConfig();
+
+        /* Wait outside the lock so seeks and other consumers are not held up */
+        sick_pls_replay_sleep_until(due_usec);
+
+        for (unsigned int i = 0; i < num_values; i++) {
+            measurement_values[i] = values[i];
+        }
+        num_measurement_values = num_values;
+
+        _num_scans.fetch_add(1, std::memory_order_relaxed);
+
+    }
+
+    /**
+     * \brief Acquire the replay's status
+     * \return SICK_STATUS_OK
+     */
+    SickPLS::sick_pls_status_t SickPLSReplay::GetSickStatus() noexcept(false) {
+
+        /* Ensure the replay is initialized */
+        if (!_sick_initialized) {
+            throw SickConfigException("SickPLSReplay::GetSickStatus: Replay is not initialized!");
+        }
+
+        return SICK_STATUS_OK;
+    }
+
+    /**
+     * \brief Records the requested operating mode
+     * \param sick_operating_mode Installation, diagnostic, monitor (request values) or monitor (stream values)
+     */
+    void SickPLSReplay::SetSickOperatingMode(const sick_pls_operating_mode_t sick_operating_mode) noexcept(false) {
+
+        /* Ensure the replay is initialized */
+        if (!_sick_initialized) {
+            throw SickConfigException("SickPLSReplay::SetSickOperatingMode: Replay is not initialized!");
+        }
+
+        switch (sick_operating_mode) {
+            case SICK_OP_MODE_INSTALLATION:
+            case SICK_OP_MODE_DIAGNOSTIC:
+            case SICK_OP_MODE_MONITOR_REQUEST_VALUES:
+            case SICK_OP_MODE_MONITOR_STREAM_VALUES:
+                break;
+            default:
+                throw SickConfigException("SickPLSReplay::SetSickOperatingMode: Unsupported operating mode!");
+        }
+
+        /* Keep the store ordered against GetSickScan's switch to streaming */
+        _acquireSickConfig();
+        _storeSickOpMode(sick_operating_mode);
+        _releaseSickConfig();
+
+    }
+
+    /**
+     * \brief Rewinds to the first scan
+     */
+    void SickPLSReplay::ResetSick() noexcept(false) {
+
+        /* Ensure the replay is initialized */
+        if (!_sick_initialized) {
+            throw SickConfigException("SickPLSReplay::ResetSick: Replay is not initialized!");
+        }
+
+        Seek(0);
+
+    }
+
+    /**
+     * \brief Sets the replay speed
+     * \param speed 1.0 => real time, N => N times faster, SICK_PLS_REPLAY_MAX_SPEED => unpaced
+     */
+    void SickPLSReplay::SetReplaySpeed(const double speed) noexcept(false) {
+
+        if (!(speed >= 0)) {
+            throw SickConfigException("SickPLSReplay::SetReplaySpeed: Invalid speed!");
+        }
+
+        _acquireSickConfig();
+        _speed.store(speed, std::memory_order_relaxed);
+        _anchored = false;
+        _releaseSickConfig();
+
+    }
+
+    /**
+     * \brief Moves to the given scan
+     * \param scan_index The next scan to return (GetNumScans() => end of recording)
+     */
+    void SickPLSReplay::Seek(const uint64_t scan_index) noexcept(false) {
+
+        _acquireSickConfig();
+
+        try {
+            _seek(scan_index);
+        }
+
+            /* Let other configuration calls in before passing it on */
+        catch (...) {
+            _releaseSickConfig();
+            throw;
+        }
+
+        _releaseSickConfig();
+
+    }
+
+    /**
+     * \brief Moves to the first scan recorded at or after the given time
+     * \param timestamp_usec The time (usecs); past the end => end of recording
+     */
+    void SickPLSReplay::SeekTime(const uint64_t timestamp_usec) noexcept(false) {
+
+        _acquireSickConfig();
+
+        try {
+
+            /* Ensure the replay is initialized */
+            if (!_sick_initialized) {
+                throw SickConfigException("SickPLSReplay::SeekTime: Replay is not initialized!");
+            }
+
+            /* Binary search for the first block that ends at or after the time */
+            unsigned int low = 0;
+            unsigned int high = _reader.GetNumBlocks();
+            while (low < high) {
+                const unsigned int middle = low + (high - low) / 2;
+                uint64_t t_min, t_max;
+                _reader.GetBlockTimeSpan(middle, t_min, t_max);
+                if (t_max < timestamp_usec) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+
+            if (low == _reader.GetNumBlocks()) {
+                _seek(_reader.GetNumScans());
+            } else {
+
+                /* Then for the scan within it */
+                std::vector<uint64_t> timestamps;
+                _reader.ReadTimestamps(low, timestamps);
+                const auto row = (uint64_t) (std::lower_bound(timestamps.begin(), timestamps.end(), timestamp_usec) -
+                                             timestamps.begin());
+
+                _seek(_block_first_scan[low] + row);
+
+            }
+
+        }
+
+            /* Let other configuration calls in before passing it on */
+        catch (...) {
+            _releaseSickConfig();
+            throw;
+        }
+
+        _releaseSickConfig();
+
+    }
+
+    /**
+     * \brief Gets the time span of the recording
+     * \param &t_min Earliest time stamp (usecs)
+     * \param &t_max Latest time stamp (usecs)
+     */
+    void SickPLSReplay::GetTimeSpan(uint64_t& t_min, uint64_t& t_max) const noexcept(false) {
+
+        /* Ensure the replay is initialized */
+        if (!_sick_initialized) {
+            throw SickConfigException("SickPLSReplay::GetTimeSpan: Replay is not initialized!");
+        }
+
+        _reader.GetTimeSpan(t_min, t_max);
+
+    }
+
+    /**
+     * \brief A standard destructor
+     */
+    SickPLSReplay::~SickPLSReplay() {
+
+        try {
+            Uninitialize();
+        }
+
+            /* Catch anything else */
+        catch (...) {
+            SICK_LOG_ERROR("SickPLSReplay::~SickPLSReplay: Unknown exception!");
+        }
+
+    }
+
+    /**
+     * \brief Maps the archive and indexes its blocks
+     */
+    void SickPLSReplay::_setupConnection() noexcept(false) {
+
+        _reader.Open();
+
+        _block_first_scan.resize(_reader.GetNumBlocks() + 1);
+        _block_first_scan[0] = 0;
+        for (unsigned int i = 0; i < _reader.GetNumBlocks(); i++) {
+            _block_first_scan[i + 1] = _block_first_scan[i] + _reader.GetBlockNumScans(i);
+        }
+
+    }
+
+    /**
+     * \brief Unmaps the archive
+     */
+    void SickPLSReplay::_teardownConnection() noexcept(false) {
+        _reader.Close();
+        _block_first_scan.clear();
+    }
+
+    /**
+     * \brief Moves to the given scan
+     * \param scan_index The next scan to return (GetNumScans() => end of recording)
+     */
+    void SickPLSReplay::_seek(const uint64_t scan_index) noexcept(false) {
+
+        /* Ensure the replay is initialized */
+        if (!_sick_initialized) {
+            throw SickConfigException("SickPLSReplay::Seek: Replay is not initialized!");
+        }
+
+        if (scan_index > _reader.GetNumScans()) {
+            throw SickConfigException("SickPLSReplay::Seek: Invalid scan index!");
+        }
+
+        _next_scan.store(scan_index, std::memory_order_relaxed);
+        _anchored = false;
+
+    }
+
+    /**
+     * \brief Gets the monotonic time a recorded time is due at
+     * \param timestamp_usec The scan's recorded time stamp (usecs)
+     * \return The due time (usecs); 0 => play immediately
+     *
+     * The first scan after (re)anchoring is played immediately and sets
+     * the anchor.
+     */
+    uint64_t SickPLSReplay::_pace(const uint64_t timestamp_usec) {
+
+        const double speed = _speed.load(std::memory_order_relaxed);
+        if (speed == SICK_PLS_REPLAY_MAX_SPEED) {
+            return 0;
+        }
+
+        if (!_anchored) {
+            _anchor_timestamp_usec = timestamp_usec;
+            _anchor_clock_usec = sick_pls_replay_clock_usec();
+            _anchored = true;
+            return 0;
+        }
+
+        if (timestamp_usec <= _anchor_timestamp_usec) {
+            return 0;
+        }
+
+        return _anchor_clock_usec + (uint64_t) ((double) (timestamp_usec - _anchor_timestamp_usec) / speed);
+
+    }
+
+    /**
+     * \brief Finds the block holding a scan
+     * \param scan_index The scan (< GetNumScans())
+     * \return The block index
+     */
+    unsigned int SickPLSReplay::_findBlock(const uint64_t scan_index) const {
+        return (unsigned int) (std::upper_bound(_block_first_scan.begin(), _block_first_scan.end(), scan_index) -
+                               _block_first_scan.begin()) - 1;
+    }
+
+} /* namespace sickpls */
@@ -0,0 +1,158 @@
+/*!
+ * \file SickPLSReplay.hh
+ * \brief Defines a replay source that presents a recorded scan
+ *        archive as a Sick PLS.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_REPLAY_HH
+#define SICK_PLS_REPLAY_HH
+
+/* Definition dependencies */
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SickPLS.hh"
+#include "SickPLSArchive.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define SICK_PLS_REPLAY_MAX_SPEED                                          (0.0)  ///< Replay as fast as the consumer reads
+#define DEFAULT_SICK_PLS_REPLAY_SPEED                                      (1.0)  ///< Replay in real time
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \brief Replays a scan archive (see SickPLSArchiveWriter) through the SickPLS API
+     *
+     * Initialize() maps the archive instead of opening a serial line, and
+     * GetSickScan() hands out the recorded scans in order. Consumers written
+     * against SickPLS (including sickplsd) therefore run unchanged against
+     * a recording. At 1x or Nx speed each scan is held back until its
+     * recorded offset from the first scan played, divided by the speed, has
+     * elapsed; at SICK_PLS_REPLAY_MAX_SPEED scans are returned immediately.
+     * Seeking or changing the speed restarts the pacing at the next scan.
+     *
+     * Once the recording is exhausted the replay behaves like a silent
+     * device: GetSickScan() throws a SickTimeoutException and IsFinished()
+     * becomes true.
+     *
+     * Like SickPLS, a replay may be shared between threads (e.g. handed to
+     * a SickPLSScanDispatcher while another thread seeks). Every call that
+     * moves through or reconfigures the recording holds the configuration
+     * lock, so each scan is handed to exactly one GetSickScan() caller. The
+     * pacing wait happens after the lock is released, so a Seek() is not
+     * held up by a long gap in the recording; the scan already claimed is
+     * still returned, as a frame already on the wire would be.
+     *
+     * NOTE: Time stamps within the archive are assumed to be nondecreasing.
+     */
+    class SickPLSReplay : public SickPLS {
+
+    public:
+
+        /** Constructs a replay of the given archive */
+        explicit SickPLSReplay(const std::string& archive_path, double speed = DEFAULT_SICK_PLS_REPLAY_SPEED);
+
+        /** Maps the archive and rewinds to its first scan (the baud rate is ignored) */
+        void Initialize(sick_pls_baud_t desired_baud_rate) noexcept(false) override;
+
+        /** Unmaps the archive */
+        void Uninitialize() noexcept(false) override;
+
+        /** Gets the next recorded scan */
+        void GetSickScan(unsigned int* measurement_values, unsigned int& num_measurement_values) noexcept(false) override;
+
+        /** Gets the next recorded scan and its recorded time stamp */
+        void GetSickScan(unsigned int* measurement_values, unsigned int& num_measurement_values,
+                         uint64_t& timestamp_usec) noexcept(false) override;
+
+        /** A recording is always healthy */
+        sick_pls_status_t GetSickStatus() noexcept(false) override;
+
+        /** Records the requested operating mode */
+        void SetSickOperatingMode(sick_pls_operating_mode_t sick_operating_mode) noexcept(false) override;
+
+        /** Rewinds to the first scan */
+        void ResetSick() noexcept(false) override;
+
+        /** Sets the replay speed (1.0 => real time, SICK_PLS_REPLAY_MAX_SPEED => unpaced) */
+        void SetReplaySpeed(double speed) noexcept(false);
+
+        /** Gets the replay speed */
+        [[nodiscard]] double GetReplaySpeed() const { return _speed.load(std::memory_order_relaxed); }
+
+        /** Moves to the given scan */
+        void Seek(uint64_t scan_index) noexcept(false);
+
+        /** Moves to the first scan recorded at or after the given time */
+        void SeekTime(uint64_t timestamp_usec) noexcept(false);
+
+        /** Gets the index of the next scan to be returned */
+        [[nodiscard]] uint64_t GetScanIndex() const { return _next_scan.load(std::memory_order_relaxed); }
+
+        /** Gets the number of scans in the recording (must not race Initialize/Uninitialize) */
+        [[nodiscard]] uint64_t GetNumScans() const { return _reader.GetNumScans(); }
+
+        /** Gets the time span of the recording (must not race Initialize/Uninitialize) */
+        void GetTimeSpan(uint64_t& t_min, uint64_t& t_max) const noexcept(false);
+
+        /** Indicates whether every scan has been returned */
+        [[nodiscard]] bool IsFinished() const { return GetScanIndex() >= _reader.GetNumScans(); }
+
+        /** A standard destructor */
+        ~SickPLSReplay() override;
+
+    protected:
+
+        /** Maps the archive */
+        void _setupConnection() noexcept(false) override;
+
+        /** Unmaps the archive */
+        void _teardownConnection() noexcept(false) override;
+
+    private:
+
+        /** The recording */
+        SickPLSArchiveReader _reader;
+
+        /** Index of each block's first scan (plus the total) */
+        std::vector<uint64_t> _block_first_scan;
+
+        /** Replay speed (written under the configuration lock) */
+        std::atomic<double> _speed;
+
+        /** The next scan to return (written under the configuration lock) */
+        std::atomic<uint64_t> _next_scan;
+
+        /** Pacing anchor: a recorded time and the monotonic time it was played at */
+        bool _anchored;
+        uint64_t _anchor_timestamp_usec;
+        uint64_t _anchor_clock_usec;
+
+        /** Moves to the given scan (configuration lock held) */
+        void _seek(uint64_t scan_index) noexcept(false);
+
+        /** Gets the monotonic time a recorded time is due at (configuration lock held) */
+        [[nodiscard]] uint64_t _pace(uint64_t timestamp_usec);
+
+        /** Finds the block holding a scan */
+        [[nodiscard]] unsigned int _findBlock(uint64_t scan_index) const;
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_REPLAY_HH */
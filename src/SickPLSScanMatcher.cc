@@ -0,0 +1,352 @@
+/*!
+ * \file SickPLSScanMatcher.cc
+ * \brief Implements a point-to-line ICP scan matcher for estimating
+ *        the motion between consecutive Sick PLS scans.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <cmath>
+
+#include "SickPLSScanMatcher.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Constructs a matcher
+     * \param &converter Describes the scan geometry (must outlive the matcher)
+     */
+    SickPLSScanMatcher::SickPLSScanMatcher(const SickPLSCartesianConverter& converter) :
+            _converter(converter),
+            _max_iterations(DEFAULT_SICK_PLS_ICP_MAX_ITERATIONS),
+            _search_window(DEFAULT_SICK_PLS_ICP_SEARCH_WINDOW),
+            _max_correspondence_dist(DEFAULT_SICK_PLS_ICP_MAX_CORRESPONDENCE_DIST),
+            _min_correspondences(DEFAULT_SICK_PLS_ICP_MIN_CORRESPONDENCES),
+            _translation_epsilon(DEFAULT_SICK_PLS_ICP_TRANSLATION_EPSILON),
+            _rotation_epsilon(DEFAULT_SICK_PLS_ICP_ROTATION_EPSILON),
+            _start_angle(converter.GetBeamAngle(0)), _resolution(converter.GetResolution()),
+            _mount_x(0), _mount_y(0), _mount_cos(1), _mount_sin(0),
+            _has_reference(false), _ref_num_points(0),
+            _ref_x(), _ref_y(), _ref_nx(), _ref_ny(), _ref_valid(),
+            _last_x(0), _last_y(0), _last_theta(0) {}
+
+    /**
+     * \brief Sets the iteration cap and correspondence search parameters
+     * \param max_iterations Iteration cap per match
+     * \param search_window Reference beams searched on either side of the projected bearing
+     * \param max_correspondence_dist Pairs farther apart than this are rejected (m)
+     */
+    void SickPLSScanMatcher::SetSearchParameters(const unsigned int max_iterations, const unsigned int search_window,
+                                                 const double max_correspondence_dist) noexcept(false) {
+
+        /* A sanity check */
+        if (max_iterations == 0 || max_correspondence_dist <= 0) {
+            throw SickConfigException("SickPLSScanMatcher::SetSearchParameters: Invalid parameters!");
+        }
+
+        _max_iterations = max_iterations;
+        _search_window = search_window;
+        _max_correspondence_dist = max_correspondence_dist;
+
+    }
+
+    /**
+     * \brief Sets the convergence thresholds
+     * \param translation_epsilon Stop once a step moves less than this (m)
+     * \param rotation_epsilon ... and turns less than this (rad)
+     */
+    void SickPLSScanMatcher::SetConvergenceThresholds(const double translation_epsilon,
+                                                      const double rotation_epsilon) noexcept(false) {
+
+        /* A sanity check */
+        if (translation_epsilon <= 0 || rotation_epsilon <= 0) {
+            throw SickConfigException("SickPLSScanMatcher::SetConvergenceThresholds: Invalid parameters!");
+        }
+
+        _translation_epsilon = translation_epsilon;
+        _rotation_epsilon = rotation_epsilon;
+
+    }
+
+    /**
+     * \brief Sets the reference scan and estimates its normals
+     * \param &cartesian_scan The scan (see SickPLSCartesianConverter)
+     */
+    void SickPLSScanMatcher::SetReference(const sick_pls_cartesian_scan_t& cartesian_scan) noexcept(false) {
+
+        /* Ensure the scan matches the geometry */
+        if (cartesian_scan.num_points > _converter.GetNumBeams()) {
+            throw SickConfigException("SickPLSScanMatcher::SetReference: Scan is larger than the converter's tables!");
+        }
+
+        /* Pick up the current mounting pose */
+        double mount_theta;
+        _converter.GetMountingPose(_mount_x, _mount_y, mount_theta);
+        _mount_cos = cos(mount_theta);
+        _mount_sin = sin(mount_theta);
+
+        const unsigned int n = cartesian_scan.num_points;
+        const double max_gap_sq = DEFAULT_SICK_PLS_ICP_MAX_NORMAL_GAP * DEFAULT_SICK_PLS_ICP_MAX_NORMAL_GAP;
+
+        for (unsigned int i = 0; i < n; i++) {
+
+            _ref_x[i] = cartesian_scan.x[i];
+            _ref_y[i] = cartesian_scan.y[i];
+            _ref_valid[i] = 0;
+
+            if (!cartesian_scan.valid[i]) {
+                continue;
+            }
+
+            /* Use the neighbours on either side that are close enough to lie on the same surface */
+            unsigned int prev = i, next = i;
+            if (i > 0 && cartesian_scan.valid[i - 1]) {
+                const double dx = cartesian_scan.x[i] - cartesian_scan.x[i - 1];
+                const double dy = cartesian_scan.y[i] - cartesian_scan.y[i - 1];
+                if (dx * dx + dy * dy <= max_gap_sq) {
+                    prev = i - 1;
+                }
+            }
+            if (i + 1 < n && cartesian_scan.valid[i + 1]) {
+                const double dx = cartesian_scan.x[i + 1] - cartesian_scan.x[i];
+                const double dy = cartesian_scan.y[i + 1] - cartesian_scan.y[i];
+                if (dx * dx + dy * dy <= max_gap_sq) {
+                    next = i + 1;
+                }
+            }
+
+            /* An isolated point has no usable normal */
+            const double tx = cartesian_scan.x[next] - cartesian_scan.x[prev];
+            const double ty = cartesian_scan.y[next] - cartesian_scan.y[prev];
+            const double length = hypot(tx, ty);
+            if (prev == next || length < 1e-6) {
+                continue;
+            }
+
+            _ref_nx[i] = (float) (-ty / length);
+            _ref_ny[i] = (float) (tx / length);
+            _ref_valid[i] = 1;
+
+        }
+
+        _ref_num_points = n;
+        _has_reference = true;
+
+    }
+
+    /**
+     * \brief Matches a scan against the reference
+     * \param &cartesian_scan The scan to align
+     * \param guess_x,guess_y,guess_theta Initial guess of the motion (m, m, rad)
+     * \param &result The estimated motion and match statistics
+     * \return True if the estimate converged with enough support
+     */
+    bool SickPLSScanMatcher::Match(const sick_pls_cartesian_scan_t& cartesian_scan,
+                                   const double guess_x, const double guess_y, const double guess_theta,
+                                   sick_pls_match_result_t& result) noexcept(false) {
+
+        /* Ensure we have something to match against */
+        if (!_has_reference) {
+            throw SickConfigException("SickPLSScanMatcher::Match: No reference scan!");
+        }
+
+        /* Ensure the scan matches the geometry */
+        if (cartesian_scan.num_points > _converter.GetNumBeams()) {
+            throw SickConfigException("SickPLSScanMatcher::Match: Scan is larger than the converter's tables!");
+        }
+
+        const double max_dist_sq = _max_correspondence_dist * _max_correspondence_dist;
+        const double inv_resolution = 1.0 / _resolution;
+        const int num_ref = (int) _ref_num_points;
+        const int window = (int) _search_window;
+
+        result.x = guess_x;
+        result.y = guess_y;
+        result.theta = guess_theta;
+        result.rms_error = 0;
+        result.num_correspondences = 0;
+        result.iterations = 0;
+        result.converged = false;
+
+        while (result.iterations < _max_iterations) {
+
+            result.iterations++;
+
+            const double c = cos(result.theta), s = sin(result.theta);
+
+            /* Normal equations (upper triangle of H, and g) */
+            double H[6] = {0, 0, 0, 0, 0, 0};
+            double g[3] = {0, 0, 0};
+            double sum_sq = 0;
+            unsigned int num_pairs = 0;
+
+            for (unsigned int i = 0; i < cartesian_scan.num_points; i++) {
+
+                if (!cartesian_scan.valid[i]) {
+                    continue;
+                }
+
+                /* Transform into the reference frame */
+                const double px = cartesian_scan.x[i], py = cartesian_scan.y[i];
+                const double qx = c * px - s * py + result.x;
+                const double qy = s * px + c * py + result.y;
+
+                /* Project onto the reference sensor's beams */
+                const double sx = _mount_cos * (qx - _mount_x) + _mount_sin * (qy - _mount_y);
+                const double sy = -_mount_sin * (qx - _mount_x) + _mount_cos * (qy - _mount_y);
+                const int beam = (int) lrint((atan2(sy, sx) - _start_angle) * inv_resolution);
+                if (beam + window < 0 || beam - window >= num_ref) {
+                    continue;
+                }
+
+                /* Nearest reference point within the window */
+                const int first = (beam - window < 0) ? 0 : beam - window;
+                const int last = (beam + window >= num_ref) ? num_ref - 1 : beam + window;
+                int best = -1;
+                double best_dist_sq = max_dist_sq;
+                for (int j = first; j <= last; j++) {
+                    if (_ref_valid[j]) {
+                        const double dx = qx - _ref_x[j], dy = qy - _ref_y[j];
+                        const double dist_sq = dx * dx + dy * dy;
+                        if (dist_sq < best_dist_sq) {
+                            best_dist_sq = dist_sq;
+                            best = j;
+                        }
+                    }
+                }
+                if (best < 0) {
+                    continue;
+                }
+
+                /* Linearized point-to-line residual: e + J * [dx dy dtheta] */
+                const double nx = _ref_nx[best], ny = _ref_ny[best];
+                const double e = nx * (qx - _ref_x[best]) + ny * (qy - _ref_y[best]);
+                const double j2 = ny * (qx - result.x) - nx * (qy - result.y);
+
+                H[0] += nx * nx;
+                H[1] += nx * ny;
+                H[2] += nx * j2;
+                H[3] += ny * ny;
+                H[4] += ny * j2;
+                H[5] += j2 * j2;
+                g[0] += nx * e;
+                g[1] += ny * e;
+                g[2] += j2 * e;
+                sum_sq += e * e;
+                num_pairs++;
+
+            }
+
+            result.num_correspondences = num_pairs;
+            result.rms_error = (num_pairs > 0) ? sqrt(sum_sq / num_pairs) : 0;
+
+            /* Too little support (or a degenerate geometry) */
+            double dx[3];
+            if (num_pairs < _min_correspondences || num_pairs < 3 || !_solve3x3(H, g, dx)) {
+                return false;
+            }
+
+            result.x -= dx[0];
+            result.y -= dx[1];
+            result.theta = remainder(result.theta - dx[2], 2.0 * M_PI);
+
+            if (hypot(dx[0], dx[1]) < _translation_epsilon && fabs(dx[2]) < _rotation_epsilon) {
+                result.converged = true;
+                break;
+            }
+
+        }
+
+        return result.converged;
+    }
+
+    /**
+     * \brief Matches a scan against the previous one and makes it the new reference
+     * \param &cartesian_scan The newest scan
+     * \param &result The motion since the previous scan
+     * \return True if the estimate converged (false for the very first scan)
+     *
+     * NOTE: The previous increment is used as the initial guess (constant velocity).
+     */
+    bool SickPLSScanMatcher::Step(const sick_pls_cartesian_scan_t& cartesian_scan,
+                                  sick_pls_match_result_t& result) noexcept(false) {
+
+        bool converged = false;
+
+        if (_has_reference) {
+            converged = Match(cartesian_scan, _last_x, _last_y, _last_theta, result);
+        } else {
+            result = {0, 0, 0, 0, 0, 0, false};
+        }
+
+        /* Only trust converged increments as the next guess */
+        if (converged) {
+            _last_x = result.x;
+            _last_y = result.y;
+            _last_theta = result.theta;
+        } else {
+            _last_x = _last_y = _last_theta = 0;
+        }
+
+        SetReference(cartesian_scan);
+
+        return converged;
+    }
+
+    /**
+     * \brief Solves H * dx = g for symmetric positive definite H (Cholesky)
+     * \param H Upper triangle of H: h00 h01 h02 h11 h12 h22
+     * \param g The right-hand side
+     * \param dx The solution
+     * \return False if H is (nearly) singular
+     */
+    bool SickPLSScanMatcher::_solve3x3(const double H[6], const double g[3], double dx[3]) {
+
+        const double l00_sq = H[0];
+        if (l00_sq <= 1e-9) {
+            return false;
+        }
+        const double l00 = sqrt(l00_sq);
+        const double l10 = H[1] / l00;
+        const double l20 = H[2] / l00;
+
+        const double l11_sq = H[3] - l10 * l10;
+        if (l11_sq <= 1e-9) {
+            return false;
+        }
+        const double l11 = sqrt(l11_sq);
+        const double l21 = (H[4] - l20 * l10) / l11;
+
+        const double l22_sq = H[5] - l20 * l20 - l21 * l21;
+        if (l22_sq <= 1e-9) {
+            return false;
+        }
+        const double l22 = sqrt(l22_sq);
+
+        /* Forward then back substitution */
+        const double z0 = g[0] / l00;
+        const double z1 = (g[1] - l10 * z0) / l11;
+        const double z2 = (g[2] - l20 * z0 - l21 * z1) / l22;
+
+        dx[2] = z2 / l22;
+        dx[1] = (z1 - l21 * dx[2]) / l11;
+        dx[0] = (z0 - l10 * dx[1] - l20 * dx[2]) / l00;
+
+        return true;
+    }
+
+} /* namespace sickpls */
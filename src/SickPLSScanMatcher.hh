@@ -0,0 +1,139 @@
+/*!
+ * \file SickPLSScanMatcher.hh
+ * \brief Defines a point-to-line ICP scan matcher for estimating
+ *        the motion between consecutive Sick PLS scans.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_SCAN_MATCHER_HH
+#define SICK_PLS_SCAN_MATCHER_HH
+
+/* Definition dependencies */
+#include <cstdint>
+
+#include "SickPLSCartesian.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define DEFAULT_SICK_PLS_ICP_MAX_ITERATIONS                                 (30)  ///< Iteration cap per match
+#define DEFAULT_SICK_PLS_ICP_SEARCH_WINDOW                                   (6)  ///< Beams searched on either side of the projected bearing
+#define DEFAULT_SICK_PLS_ICP_MAX_CORRESPONDENCE_DIST                      (0.50)  ///< Pairs farther apart than this are rejected (m)
+#define DEFAULT_SICK_PLS_ICP_MAX_NORMAL_GAP                               (0.20)  ///< Max neighbour distance used to estimate a normal (m)
+#define DEFAULT_SICK_PLS_ICP_MIN_CORRESPONDENCES                            (20)  ///< Fewer pairs than this => no estimate
+#define DEFAULT_SICK_PLS_ICP_TRANSLATION_EPSILON                        (0.0005)  ///< Stop once a step moves less than this (m)
+#define DEFAULT_SICK_PLS_ICP_ROTATION_EPSILON                           (0.0002)  ///< ... and turns less than this (rad)
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \struct sick_pls_match_result_tag
+     * \brief A structure describing the outcome of a scan match. The pose
+     *        is that of the current scan's frame expressed in the
+     *        reference scan's frame (i.e. the incremental motion).
+     */
+    /*!
+     * \typedef sick_pls_match_result_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_match_result_tag {
+        double x;                                                                  ///< Translation along x (m)
+        double y;                                                                  ///< Translation along y (m)
+        double theta;                                                              ///< Rotation (rad)
+        double rms_error;                                                          ///< RMS point-to-line residual of the final pairs (m)
+        unsigned int num_correspondences;                                          ///< Number of pairs used in the final iteration
+        unsigned int iterations;                                                   ///< Number of iterations run
+        bool converged;                                                            ///< True if the estimate converged
+    } sick_pls_match_result_t;
+
+    /*!
+     * \brief Estimates the rigid motion between scans (point-to-line ICP)
+     *
+     * Instead of a k-d tree, correspondences are found projectively: each
+     * transformed point's bearing (relative to the sensor) is mapped to a
+     * beam index and only a small window of reference beams around it is
+     * searched. Each reference point carries a normal estimated from its
+     * neighbours, and every iteration solves the 3x3 normal equations of
+     * the linearized point-to-line error. All storage is preallocated.
+     *
+     * Both scans must come from the given converter (same geometry and
+     * mounting pose); the estimated motion is expressed in its output frame.
+     */
+    class SickPLSScanMatcher {
+
+    public:
+
+        /** Constructs a matcher for scans produced by the given converter */
+        explicit SickPLSScanMatcher(const SickPLSCartesianConverter& converter);
+
+        /** Sets the iteration cap and correspondence search parameters */
+        void SetSearchParameters(unsigned int max_iterations, unsigned int search_window,
+                                 double max_correspondence_dist) noexcept(false);
+
+        /** Sets the convergence thresholds (m, rad) */
+        void SetConvergenceThresholds(double translation_epsilon, double rotation_epsilon) noexcept(false);
+
+        /** Sets the minimum number of pairs needed for an estimate */
+        void SetMinCorrespondences(unsigned int min_correspondences) { _min_correspondences = min_correspondences; }
+
+        /** Sets the scan subsequent scans are matched against */
+        void SetReference(const sick_pls_cartesian_scan_t& cartesian_scan) noexcept(false);
+
+        /** Indicates whether a reference scan has been set */
+        [[nodiscard]] bool HasReference() const { return _has_reference; }
+
+        /** Matches a scan against the reference, starting from the given guess */
+        bool Match(const sick_pls_cartesian_scan_t& cartesian_scan, double guess_x, double guess_y, double guess_theta,
+                   sick_pls_match_result_t& result) noexcept(false);
+
+        /** Matches a scan against the previous one and makes it the new reference (odometry) */
+        bool Step(const sick_pls_cartesian_scan_t& cartesian_scan, sick_pls_match_result_t& result) noexcept(false);
+
+    private:
+
+        /** The scan geometry */
+        const SickPLSCartesianConverter& _converter;
+
+        /** Tunables */
+        unsigned int _max_iterations;
+        unsigned int _search_window;
+        double _max_correspondence_dist;
+        unsigned int _min_correspondences;
+        double _translation_epsilon;
+        double _rotation_epsilon;
+
+        /** Sensor-frame bearing of beam 0 and the beam step (rad) */
+        double _start_angle, _resolution;
+
+        /** Mounting pose of the sensor in the output frame */
+        double _mount_x, _mount_y, _mount_cos, _mount_sin;
+
+        /** Reference points and their normals (indexed by beam) */
+        bool _has_reference;
+        unsigned int _ref_num_points;
+        float _ref_x[SICK_PLS_CARTESIAN_MAX_POINTS];
+        float _ref_y[SICK_PLS_CARTESIAN_MAX_POINTS];
+        float _ref_nx[SICK_PLS_CARTESIAN_MAX_POINTS];
+        float _ref_ny[SICK_PLS_CARTESIAN_MAX_POINTS];
+        uint8_t _ref_valid[SICK_PLS_CARTESIAN_MAX_POINTS];
+
+        /** Last incremental motion (constant velocity guess for Step) */
+        double _last_x, _last_y, _last_theta;
+
+        /** Solves a symmetric 3x3 system */
+        static bool _solve3x3(const double H[6], const double g[3], double dx[3]);
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_SCAN_MATCHER_HH */
@@ -0,0 +1,208 @@
+/*!
+ * \file SickPLSSectorMin.cc
+ * \brief Implements a sparse table answering sector minimum-range
+ *        queries over Sick PLS scans in constant time.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <cmath>
+
+#include "SickPLSSectorMin.hh"
+#include "SickPLSSimd.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Constructs an (empty) table
+     * \param &converter Describes the scan geometry (must outlive the table)
+     */
+    SickPLSSectorMinTable::SickPLSSectorMinTable(const SickPLSCartesianConverter& converter) :
+            _converter(converter), _num_beams(0), _table() {}
+
+    /**
+     * \brief Builds the sparse table over a decoded scan
+     * \param *ranges The range values (cm)
+     * \param num_ranges The number of range values
+     */
+    void SickPLSSectorMinTable::Build(const uint16_t* const ranges, const unsigned int num_ranges) noexcept(false) {
+
+        /* Ensure the scan matches the geometry */
+        if (num_ranges > _converter.GetNumBeams()) {
+            throw SickConfigException("SickPLSSectorMinTable::Build: Scan is larger than the converter's tables!");
+        }
+
+        const unsigned int min_range = _converter.GetMinValidRange();
+        const unsigned int max_range = _converter.GetMaxValidRange();
+
+        /* Level 0: the (masked) ranges themselves, tagged with their beam */
+        for (unsigned int i = 0; i < num_ranges; i++) {
+            const uint32_t range = (ranges[i] >= min_range && ranges[i] < max_range) ? ranges[i]
+                                                                                      : SICK_PLS_SECTOR_MIN_NO_RETURN;
+            _table[0][i] = (range << 16) | i;
+        }
+
+        /* Level k: windows of 2^k beams */
+        for (unsigned int level = 1; level < SICK_PLS_SECTOR_MIN_LEVELS && (1u << level) <= num_ranges; level++) {
+            const unsigned int end = num_ranges + 1 - (1u << level);
+            const unsigned int begin = sick_pls_cpu_has_avx2() ? _buildLevelAVX2(level, end) : 0;
+            _buildLevelScalar(level, begin, end);
+        }
+
+        _num_beams = num_ranges;
+
+    }
+
+    /**
+     * \brief Gets the nearest valid range among a run of beams
+     * \param first_beam The first beam of the sector
+     * \param last_beam The last beam of the sector (inclusive)
+     * \return The range (cm) or SICK_PLS_SECTOR_MIN_NO_RETURN
+     */
+    uint16_t SickPLSSectorMinTable::GetSectorMin(const unsigned int first_beam,
+                                                 const unsigned int last_beam) const noexcept(false) {
+        unsigned int beam;
+        return GetSectorMin(first_beam, last_beam, beam);
+    }
+
+    /**
+     * \brief Gets the nearest valid range, and the beam it came from, among a run of beams
+     * \param first_beam The first beam of the sector
+     * \param last_beam The last beam of the sector (inclusive)
+     * \param &beam The beam holding the minimum
+     * \return The range (cm) or SICK_PLS_SECTOR_MIN_NO_RETURN
+     */
+    uint16_t SickPLSSectorMinTable::GetSectorMin(const unsigned int first_beam, const unsigned int last_beam,
+                                                 unsigned int& beam) const noexcept(false) {
+
+        /* A sanity check */
+        if (first_beam > last_beam || last_beam >= _num_beams) {
+            throw SickConfigException("SickPLSSectorMinTable::GetSectorMin: Invalid sector!");
+        }
+
+        const uint32_t entry = _query(first_beam, last_beam);
+        beam = entry & 0xFFFF;
+
+        return (uint16_t) (entry >> 16);
+    }
+
+    /**
+     * \brief Gets the nearest valid range among the beams within a bearing window
+     * \param min_angle Lower bearing (sensor frame, rad)
+     * \param max_angle Upper bearing (sensor frame, rad)
+     * \return The range (cm) or SICK_PLS_SECTOR_MIN_NO_RETURN if no beam lies in the window
+     */
+    uint16_t SickPLSSectorMinTable::GetSectorMinByAngle(const double min_angle,
+                                                        const double max_angle) const noexcept(false) {
+
+        /* A sanity check */
+        if (min_angle > max_angle) {
+            throw SickConfigException("SickPLSSectorMinTable::GetSectorMinByAngle: Invalid sector!");
+        }
+
+        if (_num_beams == 0) {
+            return SICK_PLS_SECTOR_MIN_NO_RETURN;
+        }
+
+        /* Beams whose bearing falls inside the window (with a little slack for rounding) */
+        const double start_angle = _converter.GetBeamAngle(0);
+        const double resolution = _converter.GetResolution();
+        const double first = ceil((min_angle - start_angle) / resolution - 1e-6);
+        const double last = floor((max_angle - start_angle) / resolution + 1e-6);
+        if (last < 0 || first > _num_beams - 1.0) {
+            return SICK_PLS_SECTOR_MIN_NO_RETURN;
+        }
+
+        const unsigned int first_beam = (first < 0) ? 0 : (unsigned int) first;
+        const unsigned int last_beam = (last > _num_beams - 1.0) ? _num_beams - 1 : (unsigned int) last;
+
+        return (uint16_t) (_query(first_beam, last_beam) >> 16);
+    }
+
+    /**
+     * \brief Writes a min-pooled (decimated) scan
+     * \param factor Number of beams pooled into each output value
+     * \param *pooled Destination array (ranges in cm, SICK_PLS_SECTOR_MIN_NO_RETURN if empty)
+     * \param max_pooled Capacity of the destination array
+     * \return The number of values written (ceil(beams / factor), capped at max_pooled)
+     */
+    unsigned int SickPLSSectorMinTable::Decimate(const unsigned int factor, uint16_t* const pooled,
+                                                 const unsigned int max_pooled) const noexcept(false) {
+
+        /* A sanity check */
+        if (factor == 0) {
+            throw SickConfigException("SickPLSSectorMinTable::Decimate: Invalid factor!");
+        }
+
+        unsigned int num_pooled = 0;
+        for (unsigned int first = 0; first < _num_beams && num_pooled < max_pooled; first += factor) {
+            const unsigned int last = (first + factor > _num_beams) ? _num_beams - 1 : first + factor - 1;
+            pooled[num_pooled++] = (uint16_t) (_query(first, last) >> 16);
+        }
+
+        return num_pooled;
+    }
+
+    /**
+     * \brief Builds entries [begin,end) of a level one at a time
+     */
+    void SickPLSSectorMinTable::_buildLevelScalar(const unsigned int level, const unsigned int begin,
+                                                  const unsigned int end) {
+
+        const uint32_t* const prev = _table[level - 1];
+        const unsigned int half = 1u << (level - 1);
+
+        for (unsigned int i = begin; i < end; i++) {
+            _table[level][i] = (prev[i] < prev[i + half]) ? prev[i] : prev[i + half];
+        }
+
+    }
+
+#ifdef SICK_PLS_HAVE_X86_SIMD
+
+    /**
+     * \brief Builds a level eight entries at a time
+     * \return The first entry left for the scalar tail
+     */
+    SICK_PLS_TARGET_AVX2 unsigned int SickPLSSectorMinTable::_buildLevelAVX2(const unsigned int level,
+                                                                             const unsigned int end) {
+
+        const uint32_t* const prev = _table[level - 1];
+        const unsigned int half = 1u << (level - 1);
+
+        unsigned int i = 0;
+        for (; i + 8 <= end; i += 8) {
+            const __m256i a = _mm256_loadu_si256((const __m256i*) &prev[i]);
+            const __m256i b = _mm256_loadu_si256((const __m256i*) &prev[i + half]);
+            _mm256_storeu_si256((__m256i*) &_table[level][i], _mm256_min_epu32(a, b));
+        }
+
+        return i;
+    }
+
+#else
+
+    /**
+     * \brief Fallback for architectures without the AVX2 kernels
+     */
+    unsigned int SickPLSSectorMinTable::_buildLevelAVX2(const unsigned int level, const unsigned int end) {
+        return 0;
+    }
+
+#endif
+
+} /* namespace sickpls */
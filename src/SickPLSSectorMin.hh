@@ -0,0 +1,99 @@
+/*!
+ * \file SickPLSSectorMin.hh
+ * \brief Defines a sparse table answering sector minimum-range
+ *        queries over Sick PLS scans in constant time.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_SECTOR_MIN_HH
+#define SICK_PLS_SECTOR_MIN_HH
+
+/* Definition dependencies */
+#include <cstdint>
+
+#include "SickPLSCartesian.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define SICK_PLS_SECTOR_MIN_LEVELS                                          (10)  ///< floor(log2(SICK_PLS_CARTESIAN_MAX_POINTS)) + 1
+#define SICK_PLS_SECTOR_MIN_NO_RETURN                                   (0xFFFF)  ///< Reported for sectors without a valid return
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \brief Answers "nearest return in sector [a,b]" in O(1)
+     *
+     * Build() constructs a sparse table over the scan once (O(n log n),
+     * vectorized): level k holds the minimum of every window of 2^k beams.
+     * Any sector is then covered by two overlapping power-of-two windows, so
+     * a query is two loads and a compare regardless of the sector's width.
+     * Entries pack (range << 16 | beam), so the minimum also yields the beam
+     * it came from (ties go to the lower beam).
+     *
+     * Beams outside the converter's valid range window never win a query.
+     */
+    class SickPLSSectorMinTable {
+
+    public:
+
+        /** Constructs a table for scans produced with the given geometry */
+        explicit SickPLSSectorMinTable(const SickPLSCartesianConverter& converter);
+
+        /** Builds the table over a decoded scan */
+        void Build(const uint16_t* ranges, unsigned int num_ranges) noexcept(false);
+
+        /** Gets the number of beams in the current scan */
+        [[nodiscard]] unsigned int GetNumBeams() const { return _num_beams; }
+
+        /** Gets the nearest valid range (cm) among beams [first_beam,last_beam] */
+        [[nodiscard]] uint16_t GetSectorMin(unsigned int first_beam, unsigned int last_beam) const noexcept(false);
+
+        /** Gets the nearest valid range (cm) and its beam among beams [first_beam,last_beam] */
+        uint16_t GetSectorMin(unsigned int first_beam, unsigned int last_beam,
+                              unsigned int& beam) const noexcept(false);
+
+        /** Gets the nearest valid range (cm) among the beams with bearings in [min_angle,max_angle] (sensor frame, rad) */
+        [[nodiscard]] uint16_t GetSectorMinByAngle(double min_angle, double max_angle) const noexcept(false);
+
+        /** Writes a min-pooled scan with one value per group of factor beams */
+        unsigned int Decimate(unsigned int factor, uint16_t* pooled, unsigned int max_pooled) const noexcept(false);
+
+    private:
+
+        /** The scan geometry */
+        const SickPLSCartesianConverter& _converter;
+
+        /** Number of beams in the current scan */
+        unsigned int _num_beams;
+
+        /** Level k, entry i = min(range << 16 | beam) over beams [i, i + 2^k) */
+        alignas(32) uint32_t _table[SICK_PLS_SECTOR_MIN_LEVELS][SICK_PLS_CARTESIAN_MAX_POINTS];
+
+        /** O(1) query over [first,last] (no checks) */
+        [[nodiscard]] uint32_t _query(unsigned int first, unsigned int last) const {
+            const unsigned int level = 31 - __builtin_clz(last - first + 1);
+            const uint32_t a = _table[level][first], b = _table[level][last + 1 - (1u << level)];
+            return (a < b) ? a : b;
+        }
+
+        /** Builds level k from level k - 1 */
+        void _buildLevelScalar(unsigned int level, unsigned int begin, unsigned int end);
+
+        /** AVX2 level builder (returns the first entry left for the scalar tail) */
+        unsigned int _buildLevelAVX2(unsigned int level, unsigned int end);
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_SECTOR_MIN_HH */
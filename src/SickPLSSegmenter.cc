@@ -0,0 +1,181 @@
+/*!
+ * \file SickPLSSegmenter.cc
+ * \brief Implements a class for splitting Sick PLS scans into
+ *        contiguous segments via adaptive breakpoint detection.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <cmath>
+
+#include "SickPLSSegmenter.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Constructs a segmenter
+     * \param &converter Describes the scan geometry (must outlive the segmenter)
+     * \param lambda Worst-case incidence angle of a surface still considered continuous (deg)
+     * \param sigma Range noise standard deviation (cm)
+     */
+    SickPLSSegmenter::SickPLSSegmenter(const SickPLSCartesianConverter& converter,
+                                       const double lambda, const double sigma) noexcept(false) :
+            _converter(converter), _min_points(DEFAULT_SICK_PLS_SEGMENTER_MIN_POINTS),
+            _max_gap(DEFAULT_SICK_PLS_SEGMENTER_MAX_GAP), _three_sigma(0),
+            _ratio_table(), _two_cos_table() {
+
+        SetBreakpointParameters(lambda, sigma);
+
+    }
+
+    /**
+     * \brief Sets the breakpoint detector parameters
+     * \param lambda Worst-case incidence angle of a surface still considered continuous (deg)
+     * \param sigma Range noise standard deviation (cm)
+     */
+    void SickPLSSegmenter::SetBreakpointParameters(const double lambda, const double sigma) noexcept(false) {
+
+        const double dphi = _converter.GetResolution();
+        const double lambda_rad = lambda * M_PI / 180.0;
+
+        /* The threshold is only defined while lambda exceeds the widest bridged gap */
+        if (sigma < 0 || lambda_rad <= (SICK_PLS_SEGMENTER_MAX_GAP + 1) * dphi || lambda >= 90.0) {
+            throw SickConfigException("SickPLSSegmenter::SetBreakpointParameters: Invalid parameters!");
+        }
+
+        _three_sigma = 3.0 * sigma;
+        for (unsigned int k = 1; k <= SICK_PLS_SEGMENTER_MAX_GAP + 1; k++) {
+            _ratio_table[k] = sin(k * dphi) / sin(lambda_rad - k * dphi);
+            _two_cos_table[k] = 2.0 * cos(k * dphi);
+        }
+
+    }
+
+    /**
+     * \brief Sets the maximum run of invalid beams bridged inside a segment
+     * \param max_gap The number of invalid beams (0 to SICK_PLS_SEGMENTER_MAX_GAP)
+     */
+    void SickPLSSegmenter::SetMaxGap(const unsigned int max_gap) noexcept(false) {
+
+        /* A sanity check */
+        if (max_gap > SICK_PLS_SEGMENTER_MAX_GAP) {
+            throw SickConfigException("SickPLSSegmenter::SetMaxGap: Gap is too large!");
+        }
+
+        _max_gap = max_gap;
+
+    }
+
+    /**
+     * \brief Splits a decoded scan into segments
+     * \param *ranges The range values (cm)
+     * \param num_ranges The number of range values
+     * \param *segments Destination array of segment descriptors
+     * \param max_segments Capacity of the destination array
+     * \return The number of segments written (extra segments are dropped)
+     */
+    unsigned int SickPLSSegmenter::Segment(const uint16_t* const ranges, const unsigned int num_ranges,
+                                           sick_pls_segment_t* const segments,
+                                           const unsigned int max_segments) const noexcept(false) {
+
+        /* Ensure the scan matches the geometry */
+        if (num_ranges > _converter.GetNumBeams()) {
+            throw SickConfigException("SickPLSSegmenter::Segment: Scan is larger than the converter's tables!");
+        }
+
+        const float* const cos_table = _converter.GetCosTable();
+        const float* const sin_table = _converter.GetSinTable();
+        const unsigned int min_range = _converter.GetMinValidRange();
+        const unsigned int max_range = _converter.GetMaxValidRange();
+
+        unsigned int num_segments = 0;
+
+        /* The segment being grown */
+        bool open = false;
+        unsigned int prev_index = 0;
+        double prev_range = 0;
+        double sum_x = 0, sum_y = 0;
+        sick_pls_segment_t curr = {};
+
+        for (unsigned int i = 0; i <= num_ranges; i++) {
+
+            /* Skip beams w/o a usable return (the sentinel i == num_ranges closes the last segment) */
+            const bool last = (i == num_ranges);
+            if (!last && (ranges[i] < min_range || ranges[i] >= max_range)) {
+                continue;
+            }
+
+            const double range = last ? 0 : ranges[i];
+
+            /* Does this return continue the open segment? */
+            bool breakpoint = true;
+            if (open && !last) {
+                const unsigned int step = i - prev_index;
+                if (step <= _max_gap + 1) {
+                    const double d_max = prev_range * _ratio_table[step] + _three_sigma;
+                    const double dist_sq = prev_range * prev_range + range * range
+                                           - prev_range * range * _two_cos_table[step];
+                    breakpoint = dist_sq > d_max * d_max;
+                }
+            }
+
+            /* Close off the open segment */
+            if (open && breakpoint) {
+                if (curr.num_points >= _min_points && num_segments < max_segments) {
+                    const double first_x = 0.01 * ranges[curr.start_index] * cos_table[curr.start_index];
+                    const double first_y = 0.01 * ranges[curr.start_index] * sin_table[curr.start_index];
+                    const double last_x = 0.01 * prev_range * cos_table[prev_index];
+                    const double last_y = 0.01 * prev_range * sin_table[prev_index];
+                    curr.end_index = (uint16_t) prev_index;
+                    curr.centroid_x = (float) (0.01 * sum_x / curr.num_points);
+                    curr.centroid_y = (float) (0.01 * sum_y / curr.num_points);
+                    curr.extent = (float) hypot(last_x - first_x, last_y - first_y);
+                    segments[num_segments++] = curr;
+                }
+                open = false;
+            }
+
+            if (last) {
+                break;
+            }
+
+            /* Start a new segment */
+            if (!open) {
+                open = true;
+                curr.start_index = (uint16_t) i;
+                curr.num_points = 0;
+                curr.min_range = 0xFFFF;
+                sum_x = sum_y = 0;
+            }
+
+            /* Accumulate this return */
+            curr.num_points++;
+            if (ranges[i] < curr.min_range) {
+                curr.min_range = ranges[i];
+            }
+            sum_x += range * cos_table[i];
+            sum_y += range * sin_table[i];
+
+            prev_index = i;
+            prev_range = range;
+
+        }
+
+        return num_segments;
+    }
+
+} /* namespace sickpls */
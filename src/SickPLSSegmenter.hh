@@ -0,0 +1,113 @@
+/*!
+ * \file SickPLSSegmenter.hh
+ * \brief Defines a class for splitting Sick PLS scans into
+ *        contiguous segments via adaptive breakpoint detection.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_SEGMENTER_HH
+#define SICK_PLS_SEGMENTER_HH
+
+/* Definition dependencies */
+#include <cstdint>
+
+#include "SickPLSCartesian.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define DEFAULT_SICK_PLS_SEGMENTER_LAMBDA                                 (10.0)  ///< Worst-case incidence angle for the breakpoint threshold (deg)
+#define DEFAULT_SICK_PLS_SEGMENTER_SIGMA                                   (3.0)  ///< Range noise std. deviation (cm)
+#define DEFAULT_SICK_PLS_SEGMENTER_MIN_POINTS                                (3)  ///< Segments with fewer points are discarded
+#define DEFAULT_SICK_PLS_SEGMENTER_MAX_GAP                                   (2)  ///< Max run of invalid beams bridged inside a segment
+#define SICK_PLS_SEGMENTER_MAX_GAP                                           (8)  ///< Upper bound on the bridged gap
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \struct sick_pls_segment_tag
+     * \brief A structure describing one contiguous segment of a scan.
+     *        Indices are relative to the scan passed in, and positions
+     *        are in the sensor frame.
+     */
+    /*!
+     * \typedef sick_pls_segment_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_segment_tag {
+        uint16_t start_index;                                                      ///< Index of the first beam in the segment
+        uint16_t end_index;                                                        ///< Index of the last beam in the segment (inclusive)
+        uint16_t num_points;                                                       ///< Number of valid beams in the segment
+        uint16_t min_range;                                                        ///< Closest range in the segment (cm)
+        float centroid_x;                                                          ///< Mean x of the segment's points (m)
+        float centroid_y;                                                          ///< Mean y of the segment's points (m)
+        float extent;                                                              ///< Distance between the first and last points (m)
+    } sick_pls_segment_t;
+
+    /*!
+     * \brief Splits scans into segments using an adaptive breakpoint detector
+     *
+     * Two consecutive returns r[n-1], r[n] separated by dphi belong to the
+     * same segment if their Euclidean distance is within
+     *
+     *   D_max = r[n-1] * sin(dphi) / sin(lambda - dphi) + 3 * sigma
+     *
+     * (Borges & Aldon). The detector works directly on the decoded ranges,
+     * needs no per-scan heap allocation and makes a single pass over the scan.
+     */
+    class SickPLSSegmenter {
+
+    public:
+
+        /** Constructs a segmenter for scans with the converter's geometry */
+        explicit SickPLSSegmenter(const SickPLSCartesianConverter& converter,
+                                  double lambda = DEFAULT_SICK_PLS_SEGMENTER_LAMBDA,
+                                  double sigma = DEFAULT_SICK_PLS_SEGMENTER_SIGMA) noexcept(false);
+
+        /** Sets the breakpoint parameters (deg, cm) */
+        void SetBreakpointParameters(double lambda, double sigma) noexcept(false);
+
+        /** Sets the minimum number of points a segment must have to be reported */
+        void SetMinPoints(unsigned int min_points) { _min_points = (min_points == 0) ? 1 : min_points; }
+
+        /** Sets the maximum run of invalid beams bridged inside a segment */
+        void SetMaxGap(unsigned int max_gap) noexcept(false);
+
+        /** Segments a decoded scan */
+        unsigned int Segment(const uint16_t* ranges, unsigned int num_ranges,
+                             sick_pls_segment_t* segments, unsigned int max_segments) const noexcept(false);
+
+    private:
+
+        /** The geometry (and valid range window) of the scans */
+        const SickPLSCartesianConverter& _converter;
+
+        /** Minimum number of points per segment */
+        unsigned int _min_points;
+
+        /** Maximum bridged gap (beams) */
+        unsigned int _max_gap;
+
+        /** 3 * sigma (cm) */
+        double _three_sigma;
+
+        /** sin(k*dphi) / sin(lambda - k*dphi) for k = 1..SICK_PLS_SEGMENTER_MAX_GAP+1 */
+        double _ratio_table[SICK_PLS_SEGMENTER_MAX_GAP + 2];
+
+        /** 2 * cos(k*dphi) for k = 1..SICK_PLS_SEGMENTER_MAX_GAP+1 */
+        double _two_cos_table[SICK_PLS_SEGMENTER_MAX_GAP + 2];
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_SEGMENTER_HH */
@@ -0,0 +1,566 @@
+/*!
+ * \file SickPLSSharedMemory.cc
+ * \brief Implements a POSIX shared-memory scan ring for publishing
+ *        Sick PLS scans to any number of local processes.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "SickPLSSharedMemory.hh"
+#include "SickLogger.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Gets the size of a ring's shared-memory object
+     */
+    static inline size_t sick_pls_shm_size(const unsigned int num_slots) {
+        return sizeof(sick_pls_shm_header_t) + (size_t) num_slots * sizeof(sick_pls_shm_slot_t);
+    }
+
+    /**
+     * \brief Constructs a publisher (nothing is mapped until Create())
+     * \param &name The shared-memory object name (e.g. "/sickpls")
+     * \param num_slots Ring size (scans)
+     */
+    SickPLSScanPublisher::SickPLSScanPublisher(const std::string& name, const unsigned int num_slots) :
+            _name(name), _num_slots(num_slots), _mapping(nullptr), _mapping_size(0),
+            _header(nullptr), _slots(nullptr) {}
+
+    /**
+     * \brief Creates the ring, or re-attaches to a compatible one left by a previous publisher
+     *
+     * NOTE: Re-attaching keeps the publication count running, so subscribers
+     *       that outlive a publisher restart simply carry on. An incompatible
+     *       ring is retired and replaced, and its subscribers move over.
+     */
+    void SickPLSScanPublisher::Create() noexcept(false) {
+
+        /* A sanity check */
+        if (_num_slots < 2) {
+            throw SickConfigException("SickPLSScanPublisher::Create: The ring needs at least two slots!");
+        }
+
+        if (_mapping) {
+            throw SickConfigException("SickPLSScanPublisher::Create: Ring is already mapped!");
+        }
+
+        int fd = shm_open(_name.c_str(), O_CREAT | O_RDWR, 0644);
+        if (fd < 0) {
+            throw SickIOException("SickPLSScanPublisher::Create: shm_open() failed!");
+        }
+
+        const size_t size = sick_pls_shm_size(_num_slots);
+
+        struct stat shm_stat = {};
+        if (fstat(fd, &shm_stat) < 0) {
+            close(fd);
+            throw SickIOException("SickPLSScanPublisher::Create: fstat() failed!");
+        }
+
+        /* Re-attach if the existing layout matches */
+        void* mapping = MAP_FAILED;
+        if ((size_t) shm_stat.st_size == size) {
+            mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (mapping == MAP_FAILED) {
+                close(fd);
+                throw SickIOException("SickPLSScanPublisher::Create: mmap() failed!");
+            }
+            auto* const header = (sick_pls_shm_header_t*) mapping;
+            if (header->magic.load(std::memory_order_acquire) == SICK_PLS_SHM_MAGIC &&
+                header->version == SICK_PLS_SHM_VERSION &&
+                header->num_slots == _num_slots &&
+                header->slot_size == sizeof(sick_pls_shm_slot_t)) {
+
+                close(fd);
+                _mapping = mapping;
+                _mapping_size = size;
+                _header = header;
+                _slots = (sick_pls_shm_slot_t*) ((uint8_t*) mapping + sizeof(sick_pls_shm_header_t));
+
+                /* A publisher that died mid-write leaves an odd sequence behind */
+                for (unsigned int i = 0; i < _num_slots; i++) {
+                    const uint64_t sequence = _slots[i].sequence.load(std::memory_order_relaxed);
+                    if (sequence & 1) {
+                        _slots[i].sequence.store(sequence + 1, std::memory_order_release);
+                    }
+                }
+
+                return;
+            }
+        }
+
+        /*
+         * Anything else may already be mapped by subscribers, so it is neither
+         * resized (which could fault their reads) nor reset in place: it is
+         * retired and a new object takes over the name.
+         */
+        uint32_t generation = 0;
+        if (shm_stat.st_size > 0) {
+
+            if (mapping == MAP_FAILED && (size_t) shm_stat.st_size >= sizeof(sick_pls_shm_header_t)) {
+                mapping = mmap(nullptr, sizeof(sick_pls_shm_header_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+
+            if (mapping != MAP_FAILED) {
+                auto* const header = (sick_pls_shm_header_t*) mapping;
+                generation = header->generation.load(std::memory_order_relaxed);
+                _retire(header);
+                munmap(mapping, ((size_t) shm_stat.st_size == size) ? size : sizeof(sick_pls_shm_header_t));
+            }
+
+            close(fd);
+            if (shm_unlink(_name.c_str()) < 0 && errno != ENOENT) {
+                throw SickIOException("SickPLSScanPublisher::Create: shm_unlink() failed!");
+            }
+
+            if ((fd = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644)) < 0) {
+                throw SickIOException("SickPLSScanPublisher::Create: shm_open() failed!");
+            }
+
+        }
+
+        /* A new object, so sizing it cannot disturb anyone */
+        if (ftruncate(fd, (off_t) size) < 0) {
+            close(fd);
+            throw SickIOException("SickPLSScanPublisher::Create: ftruncate() failed!");
+        }
+
+        mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            throw SickIOException("SickPLSScanPublisher::Create: mmap() failed!");
+        }
+
+        _mapping = mapping;
+        _mapping_size = size;
+        _header = (sick_pls_shm_header_t*) mapping;
+        _slots = (sick_pls_shm_slot_t*) ((uint8_t*) mapping + sizeof(sick_pls_shm_header_t));
+
+        /* Fresh ring: readers ignore it until the magic is in place */
+        _header->magic.store(0, std::memory_order_relaxed);
+        _header->version = SICK_PLS_SHM_VERSION;
+        _header->num_slots = _num_slots;
+        _header->slot_size = sizeof(sick_pls_shm_slot_t);
+        _header->generation.store((generation | 1) + 1, std::memory_order_relaxed);
+        _header->num_published.store(0, std::memory_order_relaxed);
+        for (unsigned int i = 0; i < _num_slots; i++) {
+            _slots[i].sequence.store(0, std::memory_order_relaxed);
+            memset(&_slots[i].scan, 0, sizeof(sick_pls_shm_scan_t));
+        }
+        _header->magic.store(SICK_PLS_SHM_MAGIC, std::memory_order_release);
+
+    }
+
+    /**
+     * \brief Unmaps the ring
+     * \param unlink Also retire and remove the shared-memory object (subscribers keep their
+     *        mappings and move over to the next publisher's ring)
+     */
+    void SickPLSScanPublisher::Destroy(const bool unlink) noexcept(false) {
+
+        if (_mapping) {
+            if (unlink) {
+                _retire(_header);
+            }
+            if (munmap(_mapping, _mapping_size) < 0) {
+                throw SickIOException("SickPLSScanPublisher::Destroy: munmap() failed!");
+            }
+            _mapping = nullptr;
+            _header = nullptr;
+            _slots = nullptr;
+        }
+
+        if (unlink && shm_unlink(_name.c_str()) < 0 && errno != ENOENT) {
+            throw SickIOException("SickPLSScanPublisher::Destroy: shm_unlink() failed!");
+        }
+
+    }
+
+    /**
+     * \brief Publishes a decoded scan
+     * \param *ranges The range values (cm)
+     * \param num_ranges The number of range values
+     * \param timestamp_usec Time stamp stored alongside the scan (usecs)
+     */
+    void SickPLSScanPublisher::Publish(const uint16_t* const ranges, const unsigned int num_ranges,
+                                       const uint64_t timestamp_usec) noexcept(false) {
+
+        /* A sanity check */
+        if (num_ranges > SickPLS::SICK_MAX_NUM_MEASUREMENTS) {
+            throw SickConfigException("SickPLSScanPublisher::Publish: Scan is too large!");
+        }
+
+        uint64_t scan_index, sequence;
+        sick_pls_shm_slot_t& slot = _beginWrite(scan_index, sequence);
+
+        slot.scan.scan_index = scan_index;
+        slot.scan.timestamp_usec = timestamp_usec;
+        slot.scan.num_ranges = num_ranges;
+        memcpy(slot.scan.ranges, ranges, num_ranges * sizeof(uint16_t));
+
+        _endWrite(slot, scan_index, sequence);
+
+    }
+
+    /**
+     * \brief Publishes a scan as returned by SickPLS::GetSickScan
+     * \param *ranges The range values (cm)
+     * \param num_ranges The number of range values
+     * \param timestamp_usec Time stamp stored alongside the scan (usecs)
+     */
+    void SickPLSScanPublisher::Publish(const unsigned int* const ranges, const unsigned int num_ranges,
+                                       const uint64_t timestamp_usec) noexcept(false) {
+
+        /* A sanity check */
+        if (num_ranges > SickPLS::SICK_MAX_NUM_MEASUREMENTS) {
+            throw SickConfigException("SickPLSScanPublisher::Publish: Scan is too large!");
+        }
+
+        uint64_t scan_index, sequence;
+        sick_pls_shm_slot_t& slot = _beginWrite(scan_index, sequence);
+
+        slot.scan.scan_index = scan_index;
+        slot.scan.timestamp_usec = timestamp_usec;
+        slot.scan.num_ranges = num_ranges;
+        for (unsigned int i = 0; i < num_ranges; i++) {
+            slot.scan.ranges[i] = (uint16_t) ranges[i];
+        }
+
+        _endWrite(slot, scan_index, sequence);
+
+    }
+
+    /**
+     * \brief Gets the number of scans published into the ring
+     */
+    uint64_t SickPLSScanPublisher::GetNumPublished() const {
+        return _header ? _header->num_published.load(std::memory_order_relaxed) : 0;
+    }
+
+    /**
+     * \brief A standard destructor (leaves the object in place for subscribers)
+     */
+    SickPLSScanPublisher::~SickPLSScanPublisher() {
+
+        try {
+            Destroy(false);
+        }
+
+            /* Catch anything else */
+        catch (...) {
+            SICK_LOG_ERROR("SickPLSScanPublisher::~SickPLSScanPublisher: Unknown exception!");
+        }
+
+    }
+
+    /**
+     * \brief Claims the next slot and marks it as being written
+     */
+    sick_pls_shm_slot_t& SickPLSScanPublisher::_beginWrite(uint64_t& scan_index,
+                                                           uint64_t& sequence) noexcept(false) {
+
+        /* Ensure the ring is mapped */
+        if (!_mapping) {
+            throw SickConfigException("SickPLSScanPublisher::Publish: Ring is not mapped!");
+        }
+
+        /* We are the only writer, so relaxed loads of our own state suffice */
+        scan_index = _header->num_published.load(std::memory_order_relaxed);
+        sick_pls_shm_slot_t& slot = _slots[scan_index % _num_slots];
+
+        sequence = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        return slot;
+    }
+
+    /**
+     * \brief Marks a slot as complete and advances the published count
+     */
+    void SickPLSScanPublisher::_endWrite(sick_pls_shm_slot_t& slot, const uint64_t scan_index,
+                                         const uint64_t sequence) {
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        _header->num_published.store(scan_index + 1, std::memory_order_release);
+    }
+
+    /**
+     * \brief Marks a ring as replaced
+     * \param *header The ring's header
+     *
+     * NOTE: The generation is bumped to an odd value, which no live ring has,
+     *       so subscribers notice; the cleared magic tells them to look for
+     *       a new object under the name.
+     */
+    void SickPLSScanPublisher::_retire(sick_pls_shm_header_t* const header) {
+        header->magic.store(0, std::memory_order_relaxed);
+        header->generation.store(header->generation.load(std::memory_order_relaxed) | 1, std::memory_order_release);
+    }
+
+    /**
+     * \brief Constructs a subscriber (nothing is mapped until Open())
+     * \param &name The shared-memory object name (e.g. "/sickpls")
+     */
+    SickPLSScanSubscriber::SickPLSScanSubscriber(const std::string& name) :
+            _name(name), _mapping(nullptr), _mapping_size(0), _header(nullptr), _slots(nullptr),
+            _generation(0), _next_index(0), _num_dropped(0) {}
+
+    /**
+     * \brief Maps the ring read-only
+     */
+    void SickPLSScanSubscriber::Open() noexcept(false) {
+
+        if (_mapping) {
+            throw SickConfigException("SickPLSScanSubscriber::Open: Ring is already mapped!");
+        }
+
+        const int fd = shm_open(_name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            throw SickIOException("SickPLSScanSubscriber::Open: shm_open() failed (is a publisher running?)");
+        }
+
+        struct stat shm_stat = {};
+        if (fstat(fd, &shm_stat) < 0 || (size_t) shm_stat.st_size < sizeof(sick_pls_shm_header_t)) {
+            close(fd);
+            throw SickIOException("SickPLSScanSubscriber::Open: Ring is not initialized!");
+        }
+
+        const auto size = (size_t) shm_stat.st_size;
+        void* const mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            throw SickIOException("SickPLSScanSubscriber::Open: mmap() failed!");
+        }
+
+        /* Validate the layout */
+        const auto* const header = (const sick_pls_shm_header_t*) mapping;
+        if (header->magic.load(std::memory_order_acquire) != SICK_PLS_SHM_MAGIC ||
+            header->version != SICK_PLS_SHM_VERSION ||
+            header->slot_size != sizeof(sick_pls_shm_slot_t) ||
+            sick_pls_shm_size(header->num_slots) != size) {
+            munmap(mapping, size);
+            throw SickIOException("SickPLSScanSubscriber::Open: Incompatible or uninitialized ring!");
+        }
+
+        _mapping = mapping;
+        _mapping_size = size;
+        _header = header;
+        _slots = (const sick_pls_shm_slot_t*) ((const uint8_t*) mapping + sizeof(sick_pls_shm_header_t));
+
+        /* Start with the next scan to be published */
+        _generation = _header->generation.load(std::memory_order_acquire);
+        _next_index = _header->num_published.load(std::memory_order_acquire);
+        _num_dropped = 0;
+
+    }
+
+    /**
+     * \brief Unmaps the ring
+     */
+    void SickPLSScanSubscriber::Close() noexcept(false) {
+
+        if (_mapping) {
+            if (munmap(const_cast<void*>(_mapping), _mapping_size) < 0) {
+                throw SickIOException("SickPLSScanSubscriber::Close: munmap() failed!");
+            }
+            _mapping = nullptr;
+            _header = nullptr;
+            _slots = nullptr;
+        }
+
+    }
+
+    /**
+     * \brief Copies out the most recently published scan
+     * \param &scan The destination
+     * \return True if a scan was copied
+     */
+    bool SickPLSScanSubscriber::ReadLatest(sick_pls_shm_scan_t& scan) {
+
+        if (!_mapping) {
+            return false;
+        }
+
+        if (_header->generation.load(std::memory_order_acquire) != _generation && !_resync()) {
+            return false;
+        }
+
+        for (unsigned int i = 0; i < SICK_PLS_SHM_MAX_READ_RETRIES; i++) {
+
+            const uint64_t num_published = _header->num_published.load(std::memory_order_acquire);
+            if (num_published == 0) {
+                return false;
+            }
+
+            if (_readSlot(num_published - 1, scan)) {
+                return true;
+            }
+
+        }
+
+        return false;
+    }
+
+    /**
+     * \brief Copies out the scan following the last one returned
+     * \param &scan The destination
+     * \return True if a scan was copied, false if no new scan is available
+     *
+     * NOTE: If the reader has fallen more than a ring behind it resumes at the
+     *       oldest scan still in the ring and the skipped scans are counted.
+     */
+    bool SickPLSScanSubscriber::ReadNext(sick_pls_shm_scan_t& scan) {
+
+        if (!_mapping) {
+            return false;
+        }
+
+        if (_header->generation.load(std::memory_order_acquire) != _generation && !_resync()) {
+            return false;
+        }
+
+        for (unsigned int i = 0; i < SICK_PLS_SHM_MAX_READ_RETRIES; i++) {
+
+            const uint64_t num_published = _header->num_published.load(std::memory_order_acquire);
+            if (_next_index >= num_published) {
+                return false;
+            }
+
+            /* The slot after the newest may be mid-write, so only num_slots - 1 scans are safe */
+            const uint64_t oldest = (num_published > _header->num_slots - 1) ? num_published - (_header->num_slots - 1) : 0;
+            if (_next_index < oldest) {
+                _num_dropped += oldest - _next_index;
+                _next_index = oldest;
+            }
+
+            if (_readSlot(_next_index, scan)) {
+                _next_index++;
+                return true;
+            }
+
+        }
+
+        return false;
+    }
+
+    /**
+     * \brief Follows a change of the ring's generation
+     * \return True if a current ring is mapped
+     *
+     * NOTE: A retired ring stays mapped (and readable) until its
+     *       replacement can be opened.
+     */
+    bool SickPLSScanSubscriber::_resync() {
+
+        /* Move over to the object now under the name */
+        if (_header->magic.load(std::memory_order_acquire) != SICK_PLS_SHM_MAGIC) {
+
+            SickPLSScanSubscriber replacement(_name);
+            try {
+                replacement.Open();
+            }
+            catch (SickIOException&) {
+                return false;
+            }
+
+            munmap(const_cast<void*>(_mapping), _mapping_size);
+            _mapping = replacement._mapping;
+            _mapping_size = replacement._mapping_size;
+            _header = replacement._header;
+            _slots = replacement._slots;
+            replacement._mapping = nullptr;
+
+        }
+
+        /* The count started over, so every scan in the ring is new */
+        _generation = _header->generation.load(std::memory_order_acquire);
+        _next_index = 0;
+
+        return true;
+    }
+
+    /**
+     * \brief Gets the number of scans published into the ring
+     */
+    uint64_t SickPLSScanSubscriber::GetNumPublished() const {
+        return _header ? _header->num_published.load(std::memory_order_acquire) : 0;
+    }
+
+    /**
+     * \brief A standard destructor
+     */
+    SickPLSScanSubscriber::~SickPLSScanSubscriber() {
+
+        try {
+            Close();
+        }
+
+            /* Catch anything else */
+        catch (...) {
+            SICK_LOG_ERROR("SickPLSScanSubscriber::~SickPLSScanSubscriber: Unknown exception!");
+        }
+
+    }
+
+    /**
+     * \brief Copies a scan out of its slot (seqlock read side)
+     * \param scan_index The scan to copy
+     * \param &scan The destination
+     * \return True if the scan was copied consistently
+     */
+    bool SickPLSScanSubscriber::_readSlot(const uint64_t scan_index, sick_pls_shm_scan_t& scan) const {
+
+        const sick_pls_shm_slot_t& slot = _slots[scan_index % _header->num_slots];
+
+        for (unsigned int i = 0; i < SICK_PLS_SHM_MAX_READ_RETRIES; i++) {
+
+            /* Odd => the writer is in the middle of this slot */
+            const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence & 1) {
+                continue;
+            }
+
+            /* Copy the header first so that only the valid part of the ranges is copied */
+            scan.scan_index = slot.scan.scan_index;
+            scan.timestamp_usec = slot.scan.timestamp_usec;
+            scan.num_ranges = slot.scan.num_ranges;
+            const unsigned int num_ranges = (scan.num_ranges <= SickPLS::SICK_MAX_NUM_MEASUREMENTS)
+                                            ? scan.num_ranges : SickPLS::SICK_MAX_NUM_MEASUREMENTS;
+            memcpy(scan.ranges, slot.scan.ranges, num_ranges * sizeof(uint16_t));
+
+            /* Make sure the copy is ordered before the re-check */
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+                continue;
+            }
+
+            /* Consistent, but possibly a different scan than asked for */
+            return scan.scan_index == scan_index;
+        }
+
+        return false;
+    }
+
+} /* namespace sickpls */
@@ -0,0 +1,219 @@
+/*!
+ * \file SickPLSSharedMemory.hh
+ * \brief Defines a POSIX shared-memory scan ring for publishing
+ *        Sick PLS scans to any number of local processes.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_SHARED_MEMORY_HH
+#define SICK_PLS_SHARED_MEMORY_HH
+
+/* Definition dependencies */
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "SickPLS.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define DEFAULT_SICK_PLS_SHM_NAME                                     "/sickpls"  ///< Default shared-memory object name
+#define DEFAULT_SICK_PLS_SHM_NUM_SLOTS                                      (16)  ///< Default ring size (scans)
+#define SICK_PLS_SHM_MAGIC                                          (0x534B504CU)  ///< "SKPL"
+#define SICK_PLS_SHM_VERSION                                                 (2)  ///< Bumped whenever the layout changes
+#define SICK_PLS_SHM_MAX_READ_RETRIES                                       (64)  ///< Torn reads tolerated before giving up
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \struct sick_pls_shm_scan_tag
+     * \brief A structure holding one published scan.
+     */
+    /*!
+     * \typedef sick_pls_shm_scan_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct sick_pls_shm_scan_tag {
+        uint64_t scan_index;                                                       ///< Publication counter (0, 1, 2, ...)
+        uint64_t timestamp_usec;                                                   ///< Publisher supplied time stamp (usecs)
+        uint32_t num_ranges;                                                       ///< Number of range values
+        uint16_t ranges[SickPLS::SICK_MAX_NUM_MEASUREMENTS];                       ///< Range values (cm)
+    } sick_pls_shm_scan_t;
+
+    /*!
+     * \struct sick_pls_shm_slot_tag
+     * \brief A ring slot guarded by a sequence counter (odd => being written).
+     */
+    /*!
+     * \typedef sick_pls_shm_slot_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct alignas(64) sick_pls_shm_slot_tag {
+        std::atomic<uint64_t> sequence;                                            ///< Seqlock counter
+        sick_pls_shm_scan_t scan;                                                  ///< The payload
+    } sick_pls_shm_slot_t;
+
+    /*!
+     * \struct sick_pls_shm_header_tag
+     * \brief The header at the start of the shared-memory object.
+     */
+    /*!
+     * \typedef sick_pls_shm_header_t
+     * \brief Adopt c-style convention
+     */
+    typedef struct alignas(64) sick_pls_shm_header_tag {
+        std::atomic<uint32_t> magic;                                               ///< SICK_PLS_SHM_MAGIC once initialized
+        uint32_t version;                                                          ///< SICK_PLS_SHM_VERSION
+        uint32_t num_slots;                                                        ///< Ring size
+        uint32_t slot_size;                                                        ///< sizeof(sick_pls_shm_slot_t)
+        std::atomic<uint32_t> generation;                                          ///< Changes whenever the publication count restarts
+        alignas(64) std::atomic<uint64_t> num_published;                           ///< Scans published so far
+    } sick_pls_shm_header_t;
+
+    /*!
+     * \brief Publishes scans into a shared-memory ring
+     *
+     * The ring is a POSIX shared-memory object holding a fixed number of
+     * slots, each guarded by its own sequence counter (a seqlock). The
+     * writer never waits on readers: it bumps the counter to odd, copies the
+     * scan in, bumps it back to even and finally advances the published
+     * count. Only one publisher may own a ring at a time.
+     *
+     * A ring is never resized or reset under its subscribers. One whose
+     * geometry does not match is retired instead (its magic is cleared
+     * and its generation bumped, as Destroy(true) also does) and unlinked,
+     * and a fresh object takes over the name; subscribers see the change
+     * and move over to it.
+     */
+    class SickPLSScanPublisher {
+
+    public:
+
+        /** Constructs a publisher for the named ring */
+        explicit SickPLSScanPublisher(const std::string& name = DEFAULT_SICK_PLS_SHM_NAME,
+                                      unsigned int num_slots = DEFAULT_SICK_PLS_SHM_NUM_SLOTS);
+
+        /** Creates (or re-attaches to) the ring, replacing an incompatible one */
+        void Create() noexcept(false);
+
+        /** Unmaps the ring (and optionally retires and removes the shared-memory object) */
+        void Destroy(bool unlink = false) noexcept(false);
+
+        /** Publishes a decoded scan */
+        void Publish(const uint16_t* ranges, unsigned int num_ranges, uint64_t timestamp_usec) noexcept(false);
+
+        /** Publishes a scan as returned by SickPLS::GetSickScan */
+        void Publish(const unsigned int* ranges, unsigned int num_ranges, uint64_t timestamp_usec) noexcept(false);
+
+        /** Gets the number of scans published into the ring */
+        [[nodiscard]] uint64_t GetNumPublished() const;
+
+        /** A standard destructor */
+        ~SickPLSScanPublisher();
+
+    private:
+
+        /** The shared-memory object name */
+        std::string _name;
+
+        /** Ring size */
+        unsigned int _num_slots;
+
+        /** The mapping */
+        void* _mapping;
+        size_t _mapping_size;
+        sick_pls_shm_header_t* _header;
+        sick_pls_shm_slot_t* _slots;
+
+        /** Claims the next slot (marking it as being written) */
+        sick_pls_shm_slot_t& _beginWrite(uint64_t& scan_index, uint64_t& sequence) noexcept(false);
+
+        /** Releases a slot and publishes it */
+        void _endWrite(sick_pls_shm_slot_t& slot, uint64_t scan_index, uint64_t sequence);
+
+        /** Marks a ring as replaced so its subscribers move on */
+        static void _retire(sick_pls_shm_header_t* header);
+
+    };
+
+    /*!
+     * \brief Reads scans from a shared-memory ring
+     *
+     * Reading is lock-free and syscall-free once the ring is mapped: a reader
+     * copies a slot out and retries if its sequence counter changed while
+     * copying. Readers map the ring read-only, so they cannot disturb the
+     * writer or each other. A reader that falls more than a ring's worth of
+     * scans behind skips ahead and counts the scans it missed. When the
+     * ring's generation changes (a publisher started over, or retired the
+     * ring) the reader maps the current ring and resumes at its first scan;
+     * until a new publisher is up that costs a shm_open() per read.
+     */
+    class SickPLSScanSubscriber {
+
+    public:
+
+        /** Constructs a subscriber for the named ring */
+        explicit SickPLSScanSubscriber(const std::string& name = DEFAULT_SICK_PLS_SHM_NAME);
+
+        /** Maps the ring (which must have been created by a publisher) */
+        void Open() noexcept(false);
+
+        /** Unmaps the ring */
+        void Close() noexcept(false);
+
+        /** Copies out the most recently published scan */
+        bool ReadLatest(sick_pls_shm_scan_t& scan);
+
+        /** Copies out the scan following the last one read (false if none is available yet) */
+        bool ReadNext(sick_pls_shm_scan_t& scan);
+
+        /** Gets the number of scans published into the ring */
+        [[nodiscard]] uint64_t GetNumPublished() const;
+
+        /** Gets the number of scans ReadNext skipped because the reader fell behind */
+        [[nodiscard]] uint64_t GetNumDropped() const { return _num_dropped; }
+
+        /** A standard destructor */
+        ~SickPLSScanSubscriber();
+
+    private:
+
+        /** The shared-memory object name */
+        std::string _name;
+
+        /** The mapping */
+        const void* _mapping;
+        size_t _mapping_size;
+        const sick_pls_shm_header_t* _header;
+        const sick_pls_shm_slot_t* _slots;
+
+        /** The generation of the ring mapped */
+        uint32_t _generation;
+
+        /** Index of the next scan ReadNext returns */
+        uint64_t _next_index;
+
+        /** Scans skipped by ReadNext */
+        uint64_t _num_dropped;
+
+        /** Follows a change of generation (false if no current ring could be mapped) */
+        bool _resync();
+
+        /** Copies out the given scan (false if it was overwritten or could not be read consistently) */
+        bool _readSlot(uint64_t scan_index, sick_pls_shm_scan_t& scan) const;
+
+    };
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_SHARED_MEMORY_HH */
@@ -0,0 +1,60 @@
+/*!
+ * \file SickPLSSimd.hh
+ * \brief Defines helpers for dispatching to vectorized (AVX2/FMA)
+ *        code paths at runtime.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_SIMD_HH
+#define SICK_PLS_SIMD_HH
+
+/*
+ * NOTE: The library is built without any -m flags so that it runs on any
+ *       x86-64 host. Vectorized kernels are compiled per-function using the
+ *       target attribute and selected at runtime via sick_pls_cpu_has_avx2().
+ */
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+/** Indicates that x86 SIMD kernels are compiled in */
+#define SICK_PLS_HAVE_X86_SIMD 1
+
+/** Marks a function as an AVX2/FMA kernel */
+#define SICK_PLS_TARGET_AVX2 __attribute__((target("avx2,fma")))
+
+#else
+
+/** No vectorized kernels on this architecture */
+#define SICK_PLS_TARGET_AVX2
+
+#endif
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Indicates whether the host CPU supports the AVX2/FMA kernels
+     * \return True if the AVX2 code paths may be used, False otherwise
+     */
+    inline bool sick_pls_cpu_has_avx2() {
+#ifdef SICK_PLS_HAVE_X86_SIMD
+        static const bool has_avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        return has_avx2;
+#else
+        return false;
+#endif
+    }
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_SIMD_HH */
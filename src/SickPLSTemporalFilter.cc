@@ -0,0 +1,281 @@
+/*!
+ * \file SickPLSTemporalFilter.cc
+ * \brief Implements a per-beam temporal median/mean filter
+ *        over the most recent Sick PLS scans.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Auto-generated header */
+#include "SickConfig.hh"
+
+/* Implementation dependencies */
+#include <cstring>
+
+#include "SickPLSTemporalFilter.hh"
+#include "SickPLSSimd.hh"
+#include "SickException.hh"
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /**
+     * \brief Constructs a filter over the given number of scans
+     * \param window_size The number of recent scans to filter over (1 to SICK_PLS_TEMPORAL_FILTER_MAX_WINDOW)
+     * \param filter_mode The per-beam statistic to compute
+     */
+    SickPLSTemporalFilter::SickPLSTemporalFilter(const unsigned int window_size,
+                                                 const sick_pls_temporal_filter_mode_t filter_mode) noexcept(false) :
+            _window_size(window_size), _filter_mode(filter_mode), _num_scans(0), _next_row(0), _num_beams(0) {
+
+        /* A sanity check */
+        if (window_size == 0 || window_size > SICK_PLS_TEMPORAL_FILTER_MAX_WINDOW) {
+            throw SickConfigException("SickPLSTemporalFilter::SickPLSTemporalFilter: Invalid window size!");
+        }
+
+        /* Start off empty */
+        Reset();
+
+    }
+
+    /**
+     * \brief Adds a decoded scan to the ring and computes the filtered scan
+     * \param *ranges The newest scan
+     * \param num_ranges The number of values in the scan
+     * \param *filtered_ranges Destination buffer for the filtered scan (num_ranges values)
+     */
+    void SickPLSTemporalFilter::Update(const uint16_t* const ranges, const unsigned int num_ranges,
+                                       uint16_t* const filtered_ranges) noexcept(false) {
+
+        _insert(ranges, num_ranges);
+        _compute(filtered_ranges);
+
+    }
+
+    /**
+     * \brief Adds a scan as returned by SickPLS::GetSickScan and computes the filtered scan
+     * \param *ranges The newest scan
+     * \param num_ranges The number of values in the scan
+     * \param *filtered_ranges Destination buffer for the filtered scan (num_ranges values)
+     */
+    void SickPLSTemporalFilter::Update(const unsigned int* const ranges, const unsigned int num_ranges,
+                                       unsigned int* const filtered_ranges) noexcept(false) {
+
+        alignas(32) uint16_t filtered_buffer[SICK_PLS_TEMPORAL_FILTER_MAX_BEAMS];
+
+        _insert(ranges, num_ranges);
+        _compute(filtered_buffer);
+
+        /* Widen the result */
+        for (unsigned int i = 0; i < num_ranges; i++) {
+            filtered_ranges[i] = filtered_buffer[i];
+        }
+
+    }
+
+    /**
+     * \brief Discards all buffered scans
+     */
+    void SickPLSTemporalFilter::Reset() {
+
+        _num_scans = _next_row = _num_beams = 0;
+        memset(_ring, 0, sizeof(_ring));
+        memset(_sums, 0, sizeof(_sums));
+
+    }
+
+    /**
+     * \brief Inserts a scan into the ring, evicting the oldest one if necessary
+     */
+    template<class RANGE_TYPE>
+    void SickPLSTemporalFilter::_insert(const RANGE_TYPE* const ranges, const unsigned int num_ranges) noexcept(false) {
+
+        /* A sanity check */
+        if (num_ranges == 0 || num_ranges > SICK_PLS_TEMPORAL_FILTER_MAX_BEAMS) {
+            throw SickConfigException("SickPLSTemporalFilter::_insert: Invalid number of ranges!");
+        }
+
+        /* The scan geometry changed (e.g. a mode switch), so the history is meaningless */
+        if (num_ranges != _num_beams) {
+            Reset();
+            _num_beams = num_ranges;
+        }
+
+        uint16_t* const row = _ring[_next_row];
+
+        /* Retire the evicted scan from the running sums */
+        if (_num_scans == _window_size) {
+            for (unsigned int i = 0; i < _num_beams; i++) {
+                _sums[i] -= row[i];
+            }
+        } else {
+            _num_scans++;
+        }
+
+        /* Store the new scan */
+        for (unsigned int i = 0; i < _num_beams; i++) {
+            row[i] = (ranges[i] > 0xFFFF) ? 0xFFFF : (uint16_t) ranges[i];
+            _sums[i] += row[i];
+        }
+
+        _next_row = (_next_row + 1) % _window_size;
+
+    }
+
+    /**
+     * \brief Computes the filtered scan from the ring contents
+     */
+    void SickPLSTemporalFilter::_compute(uint16_t* const filtered_ranges) const {
+
+        if (_filter_mode == SICK_TEMPORAL_FILTER_MEDIAN) {
+            if (sick_pls_cpu_has_avx2()) {
+                _medianAVX2(filtered_ranges);
+            } else {
+                _medianScalar(filtered_ranges, 0, _num_beams);
+            }
+        } else {
+            if (sick_pls_cpu_has_avx2()) {
+                _meanAVX2(filtered_ranges);
+            } else {
+                _meanScalar(filtered_ranges, 0, _num_beams);
+            }
+        }
+
+    }
+
+    /**
+     * \brief Computes the per-beam median of beams [begin,end) one beam at a time
+     *
+     * NOTE: For even window sizes the upper median is returned.
+     */
+    void SickPLSTemporalFilter::_medianScalar(uint16_t* const filtered_ranges,
+                                              const unsigned int begin, const unsigned int end) const {
+
+        uint16_t values[SICK_PLS_TEMPORAL_FILTER_MAX_WINDOW];
+
+        for (unsigned int i = begin; i < end; i++) {
+
+            /* Insertion sort the (at most nine) samples */
+            for (unsigned int j = 0; j < _num_scans; j++) {
+                uint16_t value = _ring[j][i];
+                unsigned int k = j;
+                for (; k > 0 && values[k - 1] > value; k--) {
+                    values[k] = values[k - 1];
+                }
+                values[k] = value;
+            }
+
+            filtered_ranges[i] = values[_num_scans / 2];
+        }
+
+    }
+
+    /**
+     * \brief Computes the per-beam rounded mean of beams [begin,end) one beam at a time
+     */
+    void SickPLSTemporalFilter::_meanScalar(uint16_t* const filtered_ranges,
+                                            const unsigned int begin, const unsigned int end) const {
+
+        for (unsigned int i = begin; i < end; i++) {
+            filtered_ranges[i] = (uint16_t) ((_sums[i] + _num_scans / 2) / _num_scans);
+        }
+
+    }
+
+#ifdef SICK_PLS_HAVE_X86_SIMD
+
+    /**
+     * \brief Computes the per-beam median sixteen beams at a time
+     *
+     * The rows are sorted with an odd-even transposition network built from
+     * unsigned 16-bit min/max, which sorts each beam's samples independently.
+     */
+    SICK_PLS_TARGET_AVX2 void SickPLSTemporalFilter::_medianAVX2(uint16_t* const filtered_ranges) const {
+
+        __m256i rows[SICK_PLS_TEMPORAL_FILTER_MAX_WINDOW];
+
+        unsigned int i = 0;
+        for (; i + 16 <= _num_beams; i += 16) {
+
+            /* Gather the samples for these beams */
+            for (unsigned int j = 0; j < _num_scans; j++) {
+                rows[j] = _mm256_load_si256((const __m256i*) &_ring[j][i]);
+            }
+
+            /* Sorting network */
+            for (unsigned int pass = 0; pass < _num_scans; pass++) {
+                for (unsigned int j = pass & 1; j + 1 < _num_scans; j += 2) {
+                    const __m256i lo = _mm256_min_epu16(rows[j], rows[j + 1]);
+                    rows[j + 1] = _mm256_max_epu16(rows[j], rows[j + 1]);
+                    rows[j] = lo;
+                }
+            }
+
+            _mm256_storeu_si256((__m256i*) &filtered_ranges[i], rows[_num_scans / 2]);
+        }
+
+        /* Finish off the tail */
+        _medianScalar(filtered_ranges, i, _num_beams);
+
+    }
+
+    /**
+     * \brief Computes the per-beam rounded mean sixteen beams at a time
+     */
+    SICK_PLS_TARGET_AVX2 void SickPLSTemporalFilter::_meanAVX2(uint16_t* const filtered_ranges) const {
+
+        /*
+         * NOTE: (sum + n/2) / n is evaluated as trunc((sum + n/2) * (1/n) + 0.5/n).
+         *       Sums are < 2^24 so they convert exactly, and the 0.5/n bias absorbs
+         *       the reciprocal's rounding error without crossing the next integer.
+         */
+        const __m256i half = _mm256_set1_epi32((int) (_num_scans / 2));
+        const __m256 inv_n = _mm256_set1_ps(1.0f / (float) _num_scans);
+        const __m256 bias = _mm256_set1_ps(0.5f / (float) _num_scans);
+
+        unsigned int i = 0;
+        for (; i + 16 <= _num_beams; i += 16) {
+
+            const __m256i sum_lo = _mm256_add_epi32(_mm256_load_si256((const __m256i*) &_sums[i]), half);
+            const __m256i sum_hi = _mm256_add_epi32(_mm256_load_si256((const __m256i*) &_sums[i + 8]), half);
+
+            const __m256i mean_lo = _mm256_cvttps_epi32(_mm256_fmadd_ps(_mm256_cvtepi32_ps(sum_lo), inv_n, bias));
+            const __m256i mean_hi = _mm256_cvttps_epi32(_mm256_fmadd_ps(_mm256_cvtepi32_ps(sum_hi), inv_n, bias));
+
+            /* packus interleaves 128-bit lanes, so restore beam order afterwards */
+            const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(mean_lo, mean_hi), 0xD8);
+            _mm256_storeu_si256((__m256i*) &filtered_ranges[i], packed);
+        }
+
+        /* Finish off the tail */
+        _meanScalar(filtered_ranges, i, _num_beams);
+
+    }
+
+#else
+
+    /**
+     * \brief Fallback for architectures without the AVX2 kernels
+     */
+    void SickPLSTemporalFilter::_medianAVX2(uint16_t* const filtered_ranges) const {
+        _medianScalar(filtered_ranges, 0, _num_beams);
+    }
+
+    /**
+     * \brief Fallback for architectures without the AVX2 kernels
+     */
+    void SickPLSTemporalFilter::_meanAVX2(uint16_t* const filtered_ranges) const {
+        _meanScalar(filtered_ranges, 0, _num_beams);
+    }
+
+#endif
+
+} /* namespace sickpls */
@@ -0,0 +1,130 @@
+/*!
+ * \file SickPLSTemporalFilter.hh
+ * \brief Defines a per-beam temporal median/mean filter
+ *        over the most recent Sick PLS scans.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PLS_TEMPORAL_FILTER_HH
+#define SICK_PLS_TEMPORAL_FILTER_HH
+
+/* Definition dependencies */
+#include <cstdint>
+
+#include "SickPLS.hh"
+#include "SickException.hh"
+
+/* Macro definitions */
+#define SICK_PLS_TEMPORAL_FILTER_MAX_WINDOW                                  (9)  ///< Maximum number of scans kept in the ring
+#define SICK_PLS_TEMPORAL_FILTER_MAX_BEAMS                                 (736)  ///< SICK_MAX_NUM_MEASUREMENTS rounded up to a multiple of 16
+
+/* Associate the namespace */
+namespace sickpls {
+
+    /*!
+     * \brief Filters each beam over a ring of the last N scans
+     *
+     * Scans are kept in SoA form (one uint16_t row per scan) so that sixteen
+     * beams are processed per AVX2 instruction. The median is computed with a
+     * min/max sorting network across the rows; the mean is maintained as a
+     * running per-beam sum. Either way an update costs O(beams).
+     */
+    class SickPLSTemporalFilter {
+
+    public:
+
+        /*!
+         * \enum sick_pls_temporal_filter_mode_t
+         * \brief Defines the available filter statistics.
+         */
+        enum sick_pls_temporal_filter_mode_t {
+            SICK_TEMPORAL_FILTER_MEDIAN = 0x00,                                      ///< Per-beam median over the window
+            SICK_TEMPORAL_FILTER_MEAN = 0x01                                         ///< Per-beam (rounded) mean over the window
+        };
+
+        /** Constructs a filter over the given number of scans */
+        explicit SickPLSTemporalFilter(unsigned int window_size = 3,
+                                       sick_pls_temporal_filter_mode_t filter_mode = SICK_TEMPORAL_FILTER_MEDIAN)
+        noexcept(false);
+
+        /** Adds a decoded scan and writes the filtered scan */
+        void Update(const uint16_t* ranges, unsigned int num_ranges, uint16_t* filtered_ranges) noexcept(false);
+
+        /** Adds a scan as returned by SickPLS::GetSickScan and writes the filtered scan */
+        void Update(const unsigned int* ranges, unsigned int num_ranges, unsigned int* filtered_ranges)
+        noexcept(false);
+
+        /** Discards all buffered scans */
+        void Reset();
+
+        /** Gets the window size */
+        [[nodiscard]] unsigned int GetWindowSize() const { return _window_size; }
+
+        /** Gets the number of scans currently buffered (<= window size) */
+        [[nodiscard]] unsigned int GetNumBufferedScans() const { return _num_scans; }
+
+        /** Gets the filter statistic */
+        [[nodiscard]] sick_pls_temporal_filter_mode_t GetFilterMode() const { return _filter_mode; }
+
+    private:
+
+        /** Number of scans in the window */
+        unsigned int _window_size;
+
+        /** The statistic computed */
+        sick_pls_temporal_filter_mode_t _filter_mode;
+
+        /** Number of scans currently in the ring */
+        unsigned int _num_scans;
+
+        /** Ring row to be overwritten next */
+        unsigned int _next_row;
+
+        /** Number of beams per scan (fixed by the first scan after a reset) */
+        unsigned int _num_beams;
+
+        /** The ring of recent scans (one row per scan) */
+        alignas(32) uint16_t _ring[SICK_PLS_TEMPORAL_FILTER_MAX_WINDOW][SICK_PLS_TEMPORAL_FILTER_MAX_BEAMS];
+
+        /** Running per-beam sums over the ring */
+        alignas(32) uint32_t _sums[SICK_PLS_TEMPORAL_FILTER_MAX_BEAMS];
+
+        /** Inserts a scan into the ring */
+        template<class RANGE_TYPE>
+        void _insert(const RANGE_TYPE* ranges, unsigned int num_ranges) noexcept(false);
+
+        /** Computes the filtered scan */
+        void _compute(uint16_t* filtered_ranges) const;
+
+        /** Scalar median of beams [begin,end) */
+        void _medianScalar(uint16_t* filtered_ranges, unsigned int begin, unsigned int end) const;
+
+        /** Scalar mean of beams [begin,end) */
+        void _meanScalar(uint16_t* filtered_ranges, unsigned int begin, unsigned int end) const;
+
+        /** AVX2 median over all beams (16 at a time) */
+        void _medianAVX2(uint16_t* filtered_ranges) const;
+
+        /** AVX2 mean over all beams (8 at a time) */
+        void _meanAVX2(uint16_t* filtered_ranges) const;
+
+    };
+
+    /*!
+     * \typedef sick_pls_temporal_filter_mode_t
+     * \brief Makes working w/ SickPLSTemporalFilter::sick_pls_temporal_filter_mode_t a bit easier
+     */
+    typedef SickPLSTemporalFilter::sick_pls_temporal_filter_mode_t sick_pls_temporal_filter_mode_t;
+
+} /* namespace sickpls */
+
+#endif /* SICK_PLS_TEMPORAL_FILTER_HH */
@@ -0,0 +1,36 @@
+/*!
+ * \file SickProbes.cc
+ * \brief Defines the semaphores of the Sick drivers' USDT tracepoints.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+/* Implementation dependencies */
+#include "SickProbes.hh"
+
+#ifdef SICK_HAVE_SDT
+
+/* The kernel finds these through the probes' notes and bumps them while a tracer is attached */
+#define SICK_PROBE_DEFINE_SEMAPHORE(name) \
+    volatile unsigned short SICK_PROBE_SEMAPHORE(name) __attribute__((unused)) __attribute__((section(".probes"))) = 0
+
+extern "C" {
+SICK_PROBE_DEFINE_SEMAPHORE(frame_received);
+SICK_PROBE_DEFINE_SEMAPHORE(crc_failure);
+SICK_PROBE_DEFINE_SEMAPHORE(message_handoff);
+SICK_PROBE_DEFINE_SEMAPHORE(message_dequeued);
+SICK_PROBE_DEFINE_SEMAPHORE(request_sent);
+SICK_PROBE_DEFINE_SEMAPHORE(reply_matched);
+SICK_PROBE_DEFINE_SEMAPHORE(request_timeout);
+SICK_PROBE_DEFINE_SEMAPHORE(mode_switch);
+}
+
+#endif
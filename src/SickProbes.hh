@@ -0,0 +1,95 @@
+/*!
+ * \file SickProbes.hh
+ * \brief Defines statically defined (USDT) tracepoints for the
+ *        Sick drivers.
+ *
+ * The probes use <sys/sdt.h> from SystemTap, so bpftrace, perf and
+ * SystemTap can attach to them without rebuilding, e.g.
+ *
+ *   bpftrace -e 'usdt:/usr/lib/libsickpls.so:sickpls:crc_failure { @[arg1] = count(); }'
+ *
+ * Every probe has a semaphore that the kernel bumps while a tracer is
+ * attached. Sites guard themselves with SICK_PROBE_ENABLED(name), so an
+ * inactive probe costs one predicted branch on a global; arguments that
+ * need work (e.g. clock reads) are only computed inside the guard. When
+ * <sys/sdt.h> is missing, or SICK_DISABLE_SDT is defined, the guard is
+ * constant false and the probes compile to nothing (their arguments are
+ * only named in an unevaluated context).
+ *
+ * Probes (provider "sickpls"; times are CLOCK_MONOTONIC nsecs):
+ *
+ *   frame_received(payload_length, command_code, first_byte_nsec, crc_verified_nsec)
+ *   crc_failure(payload_length, received_crc, computed_crc, nsec)
+ *   message_handoff(message_length, enqueued_nsec)
+ *   message_dequeued(message_length, enqueued_nsec, dequeued_nsec)
+ *   request_sent(message_length, reply_code, try, nsec)
+ *   reply_matched(payload_length, reply_code, try, sent_nsec, matched_nsec)
+ *   request_timeout(reply_code, try, tries_remaining, nsec)
+ *   mode_switch(from_mode, to_mode, status, begin_nsec, end_nsec)
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#ifndef SICK_PROBES_HH
+#define SICK_PROBES_HH
+
+#if !defined(SICK_DISABLE_SDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+#define SICK_HAVE_SDT 1
+#endif
+#endif
+
+/**
+ * \def SICK_PROBE_SEMAPHORE
+ * \brief The semaphore of the named sickpls tracepoint (defined in SickProbes.cc)
+ */
+#define SICK_PROBE_SEMAPHORE(name) sickpls_##name##_semaphore
+
+#ifdef SICK_HAVE_SDT
+
+/* The note of each probe refers to its semaphore by its (unmangled) symbol name */
+extern "C" {
+extern volatile unsigned short SICK_PROBE_SEMAPHORE(frame_received);
+extern volatile unsigned short SICK_PROBE_SEMAPHORE(crc_failure);
+extern volatile unsigned short SICK_PROBE_SEMAPHORE(message_handoff);
+extern volatile unsigned short SICK_PROBE_SEMAPHORE(message_dequeued);
+extern volatile unsigned short SICK_PROBE_SEMAPHORE(request_sent);
+extern volatile unsigned short SICK_PROBE_SEMAPHORE(reply_matched);
+extern volatile unsigned short SICK_PROBE_SEMAPHORE(request_timeout);
+extern volatile unsigned short SICK_PROBE_SEMAPHORE(mode_switch);
+}
+
+/**
+ * \def SICK_PROBE_ENABLED
+ * \brief True while a tracer is attached to the named sickpls tracepoint
+ */
+#define SICK_PROBE_ENABLED(name) __builtin_expect(SICK_PROBE_SEMAPHORE(name) != 0, 0)
+
+/**
+ * \def SICK_PROBE
+ * \brief Fires the named sickpls tracepoint with up to twelve arguments
+ */
+#define SICK_PROBE(name, ...) STAP_PROBEV(sickpls, name, __VA_ARGS__)
+
+#else
+
+/** Names probe arguments without evaluating them (never defined) */
+template<class... SICK_PROBE_ARGS>
+int sick_probe_unevaluated(const SICK_PROBE_ARGS&...);
+
+#define SICK_PROBE_ENABLED(name) (false)
+#define SICK_PROBE(name, ...) do { (void) sizeof(sick_probe_unevaluated(__VA_ARGS__)); } while (0)
+
+#endif
+
+#endif /* SICK_PROBES_HH */
@@ -0,0 +1,286 @@
+/*!
+ * \file codeccheck.cpp
+ * \brief Checks the scan codec: round trips, scalar/SIMD equivalence,
+ *        compression and throughput.
+ *
+ * Every scan of a synthetic corpus (indoor scenes plus edge cases) is
+ * encoded by the library's codec and by a scalar build of the same codec
+ * (see codeccheck_scalar.cpp). The two encodings must be byte for byte
+ * identical, and each must decode, in either build, back to the scan.
+ * The compression of the indoor scans and the codec's throughput on them
+ * are then reported. Exits non-zero on the first mismatch.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+#include "SickPLSCodec.hh"
+#include "SickException.hh"
+
+#define DEFAULT_SICK_PLS_CODECCHECK_NUM_SCANS                             (2000)  ///< Indoor scans in the corpus
+#define SICK_PLS_CODECCHECK_NUM_VALUES                                      (361)  ///< Values in an indoor scan (180 deg at 0.5 deg)
+#define SICK_PLS_CODECCHECK_BENCH_PASSES                                    (200)  ///< Timed passes over the indoor scans
+
+/** Encodes with the scalar build of the codec (codeccheck_scalar.cpp) */
+size_t codeccheck_scalar_encode(const uint16_t* values, unsigned int num_values, uint8_t* encoded) noexcept(false);
+
+/** Decodes with the scalar build of the codec (codeccheck_scalar.cpp) */
+void codeccheck_scalar_decode(const uint8_t* encoded, size_t encoded_length, uint16_t* values,
+                              unsigned int& num_values) noexcept(false);
+
+using namespace std;
+using namespace sickpls;
+
+/** A scan of the corpus */
+typedef struct sick_pls_codeccheck_scan_tag {
+    vector<uint16_t> values;                                                       ///< Measurement words
+    bool indoor;                                                                   ///< True for the synthetic indoor scenes
+} sick_pls_codeccheck_scan_t;
+
+/** A small deterministic generator (xorshift64) */
+static uint64_t sick_pls_codeccheck_state = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t codeccheck_random() {
+    sick_pls_codeccheck_state ^= sick_pls_codeccheck_state << 13;
+    sick_pls_codeccheck_state ^= sick_pls_codeccheck_state >> 7;
+    sick_pls_codeccheck_state ^= sick_pls_codeccheck_state << 17;
+    return (uint32_t) (sick_pls_codeccheck_state >> 32);
+}
+
+/** Gets a uniform integer in [0,bound) */
+static unsigned int codeccheck_uniform(const unsigned int bound) {
+    return codeccheck_random() % bound;
+}
+
+/**
+ * \brief Builds an indoor scan: a rectangular room seen from a random
+ *        spot, with a few boxes in it, sensor noise and the odd dropout
+ */
+static void codeccheck_indoor_scan(vector<uint16_t>& values) {
+
+    const double width = 300 + codeccheck_uniform(1200);                           // cm
+    const double depth = 300 + codeccheck_uniform(1500);                           // cm
+    const double x0 = width * (0.2 + 0.6 * codeccheck_uniform(1000) / 1000.0);
+    const double heading = (codeccheck_uniform(41) - 20.0) * M_PI / 180.0;
+
+    /* Boxes: beam range [begin,end) at a given range */
+    const unsigned int num_boxes = codeccheck_uniform(5);
+    unsigned int box_begin[4] = {}, box_end[4] = {}, box_range[4] = {};
+    for (unsigned int b = 0; b < num_boxes && b < 4; b++) {
+        box_begin[b] = codeccheck_uniform(SICK_PLS_CODECCHECK_NUM_VALUES);
+        box_end[b] = box_begin[b] + 5 + codeccheck_uniform(40);
+        box_range[b] = 50 + codeccheck_uniform(250);
+    }
+
+    const bool flagged = (codeccheck_uniform(10) == 0);
+
+    values.resize(SICK_PLS_CODECCHECK_NUM_VALUES);
+    for (unsigned int i = 0; i < SICK_PLS_CODECCHECK_NUM_VALUES; i++) {
+
+        /* Nearest wall along the beam */
+        const double angle = heading + i * M_PI / (SICK_PLS_CODECCHECK_NUM_VALUES - 1);
+        const double dx = cos(angle), dy = sin(angle);
+        double range = 1e9;
+        if (dx > 1e-9) range = min(range, (width - x0) / dx);
+        if (dx < -1e-9) range = min(range, -x0 / dx);
+        if (dy > 1e-9) range = min(range, depth / dy);
+
+        for (unsigned int b = 0; b < num_boxes && b < 4; b++) {
+            if (i >= box_begin[b] && i < box_end[b]) {
+                range = min(range, (double) box_range[b]);
+            }
+        }
+
+        auto value = (unsigned int) min(range + (double) codeccheck_uniform(5) - 2.0, (double) SICK_PLS_CODEC_RANGE_MASK);
+        if (codeccheck_uniform(200) == 0) {
+            value = SICK_PLS_CODEC_RANGE_MASK;                                     // No return
+        }
+        if (flagged && codeccheck_uniform(50) == 0) {
+            value |= (1 + codeccheck_uniform(7)) << SICK_PLS_CODEC_FLAGS_SHIFT;
+        }
+
+        values[i] = (uint16_t) value;
+    }
+
+}
+
+/**
+ * \brief Builds the corpus: indoor scans followed by edge cases (every
+ *        length around the block size, flat, saw-tooth and random words)
+ */
+static void codeccheck_build_corpus(const unsigned int num_scans, vector<sick_pls_codeccheck_scan_t>& corpus) {
+
+    for (unsigned int s = 0; s < num_scans; s++) {
+        sick_pls_codeccheck_scan_t scan;
+        scan.indoor = true;
+        codeccheck_indoor_scan(scan.values);
+        corpus.push_back(scan);
+    }
+
+    const unsigned int lengths[] = {0, 1, 2, 3, 7, 8, 9, 127, 128, 129, 130, 255, 256, 257, 258,
+                                    361, 384, 385, 401, 720, SickPLS::SICK_MAX_NUM_MEASUREMENTS};
+
+    for (const unsigned int num_values: lengths) {
+        for (unsigned int pattern = 0; pattern < 5; pattern++) {
+
+            sick_pls_codeccheck_scan_t scan;
+            scan.indoor = false;
+            scan.values.resize(num_values);
+
+            for (unsigned int i = 0; i < num_values; i++) {
+                switch (pattern) {
+                    case 0:
+                        scan.values[i] = 0;                                        // Flat
+                        break;
+                    case 1:
+                        scan.values[i] = SICK_PLS_CODEC_RANGE_MASK;                // Flat at the top
+                        break;
+                    case 2:
+                        scan.values[i] = (i % 2) ? SICK_PLS_CODEC_RANGE_MASK : 0;  // Widest deltas
+                        break;
+                    case 3:
+                        scan.values[i] = (uint16_t) codeccheck_random();           // Random words, flags included
+                        break;
+                    default:
+                        scan.values[i] = (uint16_t) ((i % 16 == 0) ? codeccheck_uniform(8192) : 1000 + (i % 3));
+                }
+            }
+
+            corpus.push_back(scan);
+        }
+    }
+
+}
+
+/**
+ * \brief Checks one scan, printing what went wrong
+ * \return True if both builds agree and round trip
+ */
+static bool codeccheck_scan(const unsigned int index, const sick_pls_codeccheck_scan_t& scan) {
+
+    const auto num_values = (unsigned int) scan.values.size();
+    const size_t max_length = SickPLSScanCodec::GetMaxEncodedSize(num_values);
+
+    vector<uint8_t> simd_encoded(max_length), scalar_encoded(max_length);
+    const size_t simd_length = SickPLSScanCodec::Encode(scan.values.data(), num_values, simd_encoded.data());
+    const size_t scalar_length = codeccheck_scalar_encode(scan.values.data(), num_values, scalar_encoded.data());
+
+    if (simd_length > max_length || simd_length != scalar_length ||
+        memcmp(simd_encoded.data(), scalar_encoded.data(), simd_length) != 0) {
+        cerr << "Scan " << index << " (" << num_values << " values): scalar and SIMD encodings differ!" << endl;
+        return false;
+    }
+
+    /* Each build decodes the (shared) encoding */
+    uint16_t simd_decoded[SickPLS::SICK_MAX_NUM_MEASUREMENTS], scalar_decoded[SickPLS::SICK_MAX_NUM_MEASUREMENTS];
+    unsigned int simd_num_values = 0, scalar_num_values = 0;
+    SickPLSScanCodec::Decode(simd_encoded.data(), simd_length, simd_decoded, simd_num_values);
+    codeccheck_scalar_decode(simd_encoded.data(), simd_length, scalar_decoded, scalar_num_values);
+
+    if (simd_num_values != num_values || scalar_num_values != num_values ||
+        memcmp(simd_decoded, scan.values.data(), num_values * sizeof(uint16_t)) != 0 ||
+        memcmp(scalar_decoded, scan.values.data(), num_values * sizeof(uint16_t)) != 0) {
+        cerr << "Scan " << index << " (" << num_values << " values): round trip failed!" << endl;
+        return false;
+    }
+
+    /* The GetSickScan format drops the flags */
+    unsigned int ranges[SickPLS::SICK_MAX_NUM_MEASUREMENTS], num_ranges = 0;
+    SickPLSScanCodec::Decode(simd_encoded.data(), simd_length, ranges, num_ranges);
+    for (unsigned int i = 0; i < num_values; i++) {
+        if (ranges[i] != (scan.values[i] & SICK_PLS_CODEC_RANGE_MASK)) {
+            cerr << "Scan " << index << ": range " << i << " decoded as " << ranges[i] << "!" << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** Gets CLOCK_MONOTONIC in secs */
+static double codeccheck_now() {
+    struct timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+
+    unsigned int num_scans = DEFAULT_SICK_PLS_CODECCHECK_NUM_SCANS;
+
+    if (argc > 2 || (argc == 2 && (num_scans = (unsigned int) strtoul(argv[1], nullptr, 10)) == 0)) {
+        cerr << "Usage: codeccheck [NUM INDOOR SCANS]" << endl
+             << "Ex: codeccheck 2000" << endl;
+        return -1;
+    }
+
+    vector<sick_pls_codeccheck_scan_t> corpus;
+    codeccheck_build_corpus(num_scans, corpus);
+
+    /* Equivalence and round trips */
+    try {
+        for (unsigned int s = 0; s < corpus.size(); s++) {
+            if (!codeccheck_scan(s, corpus[s])) {
+                return 1;
+            }
+        }
+    }
+    catch (...) {
+        cerr << "The codec threw!" << endl;
+        return 1;
+    }
+
+    cout << corpus.size() << " scans: scalar and SIMD encodings identical, all round trips exact" << endl;
+
+    /* Compression and throughput on the indoor scans */
+    vector<uint8_t> encoded(num_scans * SickPLSScanCodec::GetMaxEncodedSize(SICK_PLS_CODECCHECK_NUM_VALUES));
+    vector<size_t> offsets(num_scans + 1, 0);
+    for (unsigned int s = 0; s < num_scans; s++) {
+        offsets[s + 1] = offsets[s] + SickPLSScanCodec::Encode(corpus[s].values.data(), SICK_PLS_CODECCHECK_NUM_VALUES,
+                                                               &encoded[offsets[s]]);
+    }
+
+    const double raw_bytes = (double) num_scans * SICK_PLS_CODECCHECK_NUM_VALUES * sizeof(uint16_t);
+    cout << "Indoor compression: " << raw_bytes / (double) offsets[num_scans] << "x of 16-bit words, "
+         << 2 * raw_bytes / (double) offsets[num_scans] << "x of GetSickScan's 32-bit values" << endl;
+
+    vector<uint8_t> scratch(SickPLSScanCodec::GetMaxEncodedSize(SICK_PLS_CODECCHECK_NUM_VALUES));
+    volatile size_t sink = 0;
+    double start = codeccheck_now();
+    for (unsigned int pass = 0; pass < SICK_PLS_CODECCHECK_BENCH_PASSES; pass++) {
+        for (unsigned int s = 0; s < num_scans; s++) {
+            sink = sink + SickPLSScanCodec::Encode(corpus[s].values.data(), SICK_PLS_CODECCHECK_NUM_VALUES, scratch.data());
+        }
+    }
+    const double encode_rate = SICK_PLS_CODECCHECK_BENCH_PASSES * raw_bytes / (codeccheck_now() - start) / 1e9;
+
+    uint16_t values[SickPLS::SICK_MAX_NUM_MEASUREMENTS];
+    unsigned int num_values = 0;
+    start = codeccheck_now();
+    for (unsigned int pass = 0; pass < SICK_PLS_CODECCHECK_BENCH_PASSES; pass++) {
+        for (unsigned int s = 0; s < num_scans; s++) {
+            SickPLSScanCodec::Decode(&encoded[offsets[s]], offsets[s + 1] - offsets[s], values, num_values);
+            sink = sink + values[0];
+        }
+    }
+    const double decode_rate = SICK_PLS_CODECCHECK_BENCH_PASSES * raw_bytes / (codeccheck_now() - start) / 1e9;
+
+    cout << "Throughput (16-bit words in/out): encode " << encode_rate << " GB/s, decode " << decode_rate
+         << " GB/s" << endl;
+
+    return 0;
+}
@@ -0,0 +1,43 @@
+/*!
+ * \file codeccheck_scalar.cpp
+ * \brief Builds the scan codec's scalar kernels for codeccheck.
+ *
+ * The library's codec uses the SSE2 kernels wherever they are available,
+ * so codeccheck needs a second, scalar copy to compare them against. This
+ * compiles SickPLSCodec.cc again with SICK_PLS_CODEC_DISABLE_SIMD and
+ * with the namespace renamed to sickpls_scalar, so the two copies can be
+ * linked into one program.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#define SICK_PLS_CODEC_DISABLE_SIMD
+#define sickpls sickpls_scalar
+
+#include "SickPLSCodec.cc"
+
+#undef sickpls
+
+/**
+ * \brief Encodes with the scalar kernels (see SickPLSScanCodec::Encode)
+ */
+size_t codeccheck_scalar_encode(const uint16_t* const values, const unsigned int num_values,
+                                uint8_t* const encoded) noexcept(false) {
+    return sickpls_scalar::SickPLSScanCodec::Encode(values, num_values, encoded);
+}
+
+/**
+ * \brief Decodes with the scalar kernels (see SickPLSScanCodec::Decode)
+ */
+void codeccheck_scalar_decode(const uint8_t* const encoded, const size_t encoded_length, uint16_t* const values,
+                              unsigned int& num_values) noexcept(false) {
+    sickpls_scalar::SickPLSScanCodec::Decode(encoded, encoded_length, values, num_values);
+}
@@ -0,0 +1,167 @@
+/*!
+ * \file sickplscalib.cpp
+ * \brief Estimates the mounting pose of one Sick PLS relative to another
+ *        from two scan archives recorded at the same time.
+ *
+ * Scans of the sensor archive are paired with the reference scan nearest
+ * in time (pairs further apart than the maximum skew are skipped) and the
+ * batch is handed to SickPLSCalibrator. Both recordings must be of a
+ * static scene the two units see in part, and must share a clock. Each
+ * archive's geometry is taken to be a 180 degree scan spread evenly over
+ * its beams.
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <strings.h>
+
+#include "SickPLSArchive.hh"
+#include "SickPLSCalibration.hh"
+#include "SickException.hh"
+
+#define DEFAULT_SICK_PLS_CALIB_MAX_SKEW                                  (20000)  ///< Largest time difference within a pair (usecs)
+
+using namespace std;
+using namespace sickpls;
+
+/** A recorded scan */
+typedef struct sick_pls_calib_scan_tag {
+    uint64_t timestamp_usec;                                                       ///< Recorded time stamp (usecs)
+    vector<uint16_t> ranges;                                                       ///< Range values (cm)
+} sick_pls_calib_scan_t;
+
+/**
+ * \brief Reads every scan of an archive
+ */
+static unsigned int read_archive(const string& path, vector<sick_pls_calib_scan_t>& scans) {
+
+    SickPLSArchiveReader reader(path);
+    reader.Open();
+
+    uint16_t values[SickPLS::SICK_MAX_NUM_MEASUREMENTS];
+    for (unsigned int block = 0; block < reader.GetNumBlocks(); block++) {
+        for (unsigned int row = 0; row < reader.GetBlockNumScans(block); row++) {
+            unsigned int num_values = 0;
+            sick_pls_calib_scan_t scan;
+            reader.ReadScan(block, row, values, num_values, &scan.timestamp_usec);
+            scan.ranges.assign(values, values + num_values);
+            scans.push_back(scan);
+        }
+    }
+
+    const unsigned int num_beams = reader.GetNumBeams();
+    reader.Close();
+    return num_beams;
+}
+
+int main(int argc, char* argv[]) {
+
+    uint64_t max_skew_usec = DEFAULT_SICK_PLS_CALIB_MAX_SKEW;
+    unsigned long num_threads = 0;
+
+    if (argc < 3 || argc > 5 || strcasecmp(argv[1], "--help") == 0) {
+        cout << "Usage: sickplscalib REFERENCE_ARCHIVE SENSOR_ARCHIVE [MAX SKEW (usecs)] [THREADS (0 => one per core)]"
+             << endl
+             << "Ex: sickplscalib front.spa rear.spa " << DEFAULT_SICK_PLS_CALIB_MAX_SKEW << endl;
+        return -1;
+    }
+
+    if (argc > 3) {
+        char* end = nullptr;
+        max_skew_usec = strtoull(argv[3], &end, 10);
+        if (*end != '\0') {
+            cerr << "Invalid maximum skew!" << endl;
+            return -1;
+        }
+    }
+
+    if (argc > 4) {
+        char* end = nullptr;
+        num_threads = strtoul(argv[4], &end, 10);
+        if (*end != '\0') {
+            cerr << "Invalid number of threads!" << endl;
+            return -1;
+        }
+    }
+
+    try {
+
+        vector<sick_pls_calib_scan_t> reference_scans, sensor_scans;
+        const unsigned int reference_beams = read_archive(argv[1], reference_scans);
+        const unsigned int sensor_beams = read_archive(argv[2], sensor_scans);
+        if (reference_beams < 2 || sensor_beams < 2) {
+            cerr << "Archives must hold at least two beams per scan!" << endl;
+            return -1;
+        }
+
+        const SickPLSCartesianConverter reference(180.0, 180.0 / (reference_beams - 1));
+        const SickPLSCartesianConverter sensor(180.0, 180.0 / (sensor_beams - 1));
+        SickPLSCalibrator calibrator(reference, sensor);
+
+        /* Pair each sensor scan with the nearest reference scan (both archives are in time order) */
+        const auto skew_of = [](const uint64_t a, const uint64_t b) { return (a > b) ? a - b : b - a; };
+        size_t j = 0;
+        for (const auto& sensor_scan: sensor_scans) {
+
+            if (reference_scans.empty() || calibrator.GetNumPairs() == SICK_PLS_CALIBRATION_MAX_PAIRS) {
+                break;
+            }
+
+            while (j + 1 < reference_scans.size() &&
+                   skew_of(reference_scans[j + 1].timestamp_usec, sensor_scan.timestamp_usec) <=
+                   skew_of(reference_scans[j].timestamp_usec, sensor_scan.timestamp_usec)) {
+                j++;
+            }
+
+            if (skew_of(reference_scans[j].timestamp_usec, sensor_scan.timestamp_usec) > max_skew_usec) {
+                continue;
+            }
+
+            calibrator.AddScans(reference_scans[j].ranges.data(), (unsigned int) reference_scans[j].ranges.size(),
+                                sensor_scan.ranges.data(), (unsigned int) sensor_scan.ranges.size());
+
+        }
+
+        if (calibrator.GetNumPairs() == 0) {
+            cerr << "No scans were recorded within " << max_skew_usec << " usecs of each other!" << endl;
+            return -1;
+        }
+
+        sick_pls_calibration_result_t result;
+        calibrator.Solve(result, (unsigned int) num_threads);
+
+        cout << "\tPairs: " << result.num_pairs << " (" << result.num_converged << " converged, "
+             << result.num_inliers << " inliers)" << endl;
+
+        if (!result.converged) {
+            cerr << "No alignment converged! Do the two views overlap?" << endl;
+            return -1;
+        }
+
+        cout << "\tPose: x = " << result.x << " m, y = " << result.y << " m, theta = "
+             << result.theta * 180.0 / M_PI << " deg" << endl;
+        cout << "\tSpread: x = " << result.std_x << " m, y = " << result.std_y << " m, theta = "
+             << result.std_theta * 180.0 / M_PI << " deg" << endl;
+        cout << "\tResidual: " << result.rms_error << " m" << endl;
+
+    }
+
+    catch (SickException& sick_exception) {
+        cerr << "sickplscalib: " << sick_exception.what() << endl;
+        return -1;
+    }
+
+    return 0;
+}
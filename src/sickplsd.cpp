@@ -0,0 +1,744 @@
+/*!
+ * \file sickplsd.cpp
+ * \brief A daemon that owns a Sick PLS and brokers it to any
+ *        number of local clients.
+ *
+ * The serial line is owned by a single device thread, which executes
+ * client commands one at a time and, while the device is streaming,
+ * publishes every scan into a shared-memory ring (SickPLSScanPublisher).
+ * Clients talk to the daemon over a Unix domain SOCK_SEQPACKET socket
+ * (see SickPLSDaemonProtocol.hh and SickPLSDaemonClient). Status queries
+ * that arrive while another one is pending are answered by that same
+ * device transaction.
+ *
+ * With --replay the daemon serves a recorded scan archive through the
+ * same interface (see SickPLSReplay), stamping scans with their recorded
+ * time stamps.
+ *
+ * With --metrics PORT the daemon also serves the driver's counters and
+ * latencies at http://127.0.0.1:PORT/metrics (see SickPLSMetricsServer).
+ *
+ * Code by Jason C. Derenick and Thomas H. Miller.
+ * Contact derenick(at)lehigh(dot)edu
+ *
+ * The Sick LIDAR Matlab/C++ Toolbox
+ * Copyright (c) 2008, Jason C. Derenick and Thomas H. Miller
+ * All rights reserved.
+ *
+ * This software is released under a BSD Open-Source License.
+ * See http://sicktoolbox.sourceforge.net
+ */
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "SickPLS.hh"
+#include "SickPLSReplay.hh"
+#include "SickPLSMetrics.hh"
+#include "SickPLSDaemonProtocol.hh"
+#include "SickPLSSharedMemory.hh"
+#include "SickException.hh"
+
+#define SICK_PLS_DAEMON_MAX_CLIENTS                                         (32)  ///< Simultaneous client connections
+#define SICK_PLS_DAEMON_IDLE_WAIT                                (unsigned int)(1e5)  ///< Job queue wait while not streaming (usecs)
+
+using namespace std;
+using namespace sickpls;
+
+/** A client waiting on a job */
+typedef struct sick_pls_daemon_waiter_tag {
+    unsigned int client;                                                           ///< Index into the client table
+    uint64_t generation;                                                           ///< Connection the request came from
+    uint32_t request_id;                                                           ///< Request to answer
+} sick_pls_daemon_waiter_t;
+
+/** A command for the device thread */
+typedef struct sick_pls_daemon_job_tag {
+    sick_pls_daemon_command_t command;                                             ///< GET_STATUS, SET_MODE or RESET
+    uint32_t argument;                                                             ///< The command's argument
+    vector<sick_pls_daemon_waiter_t> waiters;                                      ///< Clients to answer
+} sick_pls_daemon_job_t;
+
+/** What the device thread works with */
+typedef struct sick_pls_daemon_device_tag {
+    SickPLS* sick_pls;                                                             ///< The device
+    SickPLSScanPublisher* publisher;                                               ///< The scan ring
+} sick_pls_daemon_device_t;
+
+/** A connected client */
+typedef struct sick_pls_daemon_client_tag {
+    int fd;                                                                        ///< Socket (-1 => free)
+    uint64_t generation;                                                           ///< Tells reused table entries apart
+    bool subscribed;                                                               ///< Wants scan notices
+} sick_pls_daemon_client_t;
+
+/* Shutdown flag and the pipe waking up the I/O loop */
+static volatile sig_atomic_t shutdown_requested = 0;
+static int shutdown_pipe[2] = {-1, -1};
+
+/* Client table */
+static pthread_mutex_t clients_mutex = PTHREAD_MUTEX_INITIALIZER;
+static sick_pls_daemon_client_t clients[SICK_PLS_DAEMON_MAX_CLIENTS];
+static uint64_t next_generation = 1;
+
+/* Job queue (the front job is the one executing, if any) */
+static pthread_mutex_t jobs_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobs_cond = PTHREAD_COND_INITIALIZER;
+static list<sick_pls_daemon_job_t> jobs;
+
+/* Latest scan */
+static pthread_mutex_t scan_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint16_t latest_ranges[SickPLS::SICK_MAX_NUM_MEASUREMENTS];
+static unsigned int latest_num_ranges = 0;
+static uint64_t latest_scan_index = 0;
+static uint64_t latest_timestamp_usec = 0;
+static bool latest_valid = false;
+
+/* Device state visible to the I/O thread */
+static atomic<uint32_t> current_operating_mode(SickPLS::SICK_OP_MODE_UNKNOWN);
+static string shm_name = DEFAULT_SICK_PLS_SHM_NAME;
+
+/* Set when serving a recording */
+static SickPLSReplay* replay = nullptr;
+
+/**
+ * \brief Handles SIGINT/SIGTERM
+ */
+static void handle_signal(int) {
+    shutdown_requested = 1;
+    if (write(shutdown_pipe[1], "x", 1) < 0) {
+        /* Nothing more we can do here */
+    }
+}
+
+/**
+ * \brief Gets the time of day (usecs since the epoch)
+ */
+static uint64_t now_usec() {
+    struct timeval now = {};
+    gettimeofday(&now, nullptr);
+    return (uint64_t) now.tv_sec * 1000000 + now.tv_usec;
+}
+
+/**
+ * \brief Fills in the common fields of a reply
+ */
+static void init_reply(sick_pls_daemon_reply_t& reply, const uint32_t command, const uint32_t request_id,
+                       const int32_t result) {
+    memset(&reply, 0, sizeof(reply));
+    reply.magic = SICK_PLS_DAEMON_MAGIC;
+    reply.command = command;
+    reply.request_id = request_id;
+    reply.result = result;
+}
+
+/**
+ * \brief Sends a packet to a client, if it is still the same connection
+ *
+ * NOTE: Never blocks; a client whose socket is full simply misses the packet.
+ */
+static void send_to_client(const unsigned int client, const uint64_t generation, const void* packet,
+                           const size_t length) {
+    pthread_mutex_lock(&clients_mutex);
+    if (clients[client].fd >= 0 && clients[client].generation == generation) {
+        send(clients[client].fd, packet, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+    }
+    pthread_mutex_unlock(&clients_mutex);
+}
+
+/**
+ * \brief Executes a job on the device
+ * \param &sick_pls The device
+ * \param &job The job
+ * \param &value Command specific result value
+ * \return A sick_pls_daemon_result_t
+ */
+static int32_t execute_job(SickPLS& sick_pls, const sick_pls_daemon_job_t& job, uint32_t& value) {
+
+    value = 0;
+
+    try {
+
+        switch (job.command) {
+
+            case SICK_PLS_DAEMON_CMD_GET_STATUS:
+                value = sick_pls.GetSickStatus();
+                break;
+
+            case SICK_PLS_DAEMON_CMD_SET_MODE:
+                sick_pls.SetSickOperatingMode((sick_pls_operating_mode_t) job.argument);
+                value = sick_pls.GetSickOperatingMode();
+                break;
+
+            case SICK_PLS_DAEMON_CMD_RESET:
+                sick_pls.ResetSick();
+                break;
+
+            default:
+                return SICK_PLS_DAEMON_ERROR_BAD_REQUEST;
+
+        }
+
+    }
+
+    catch (SickTimeoutException& sick_timeout_exception) {
+        cerr << "sickplsd: " << sick_timeout_exception.what() << endl;
+        return SICK_PLS_DAEMON_ERROR_TIMEOUT;
+    }
+
+    catch (SickConfigException& sick_config_exception) {
+        cerr << "sickplsd: " << sick_config_exception.what() << endl;
+        return SICK_PLS_DAEMON_ERROR_BAD_REQUEST;
+    }
+
+    catch (SickException& sick_exception) {
+        cerr << "sickplsd: " << sick_exception.what() << endl;
+        return SICK_PLS_DAEMON_ERROR_DEVICE;
+    }
+
+    return SICK_PLS_DAEMON_OK;
+}
+
+/**
+ * \brief Reads a scan from the stream and publishes it
+ */
+static void publish_scan(SickPLS& sick_pls, SickPLSScanPublisher& publisher) {
+
+    unsigned int values[SickPLS::SICK_MAX_NUM_MEASUREMENTS] = {0};
+    unsigned int num_values = 0;
+    uint64_t timestamp_usec = 0;
+
+    try {
+        if (replay) {
+            replay->GetSickScan(values, num_values, timestamp_usec);
+        } else {
+            sick_pls.GetSickScan(values, num_values);
+            timestamp_usec = now_usec();
+        }
+    }
+
+    catch (SickException& sick_exception) {
+        cerr << "sickplsd: " << sick_exception.what() << endl;
+        return;
+    }
+
+    publisher.Publish(values, num_values, timestamp_usec);
+    const uint64_t scan_index = publisher.GetNumPublished() - 1;
+
+    /* Update the cache for GET_SCAN */
+    pthread_mutex_lock(&scan_mutex);
+    for (unsigned int i = 0; i < num_values; i++) {
+        latest_ranges[i] = (uint16_t) values[i];
+    }
+    latest_num_ranges = num_values;
+    latest_scan_index = scan_index;
+    latest_timestamp_usec = timestamp_usec;
+    latest_valid = true;
+    pthread_mutex_unlock(&scan_mutex);
+
+    /* Notify subscribers (the payload is in the ring) */
+    sick_pls_daemon_reply_t notice;
+    init_reply(notice, SICK_PLS_DAEMON_NOTIFY_SCAN, 0, SICK_PLS_DAEMON_OK);
+    notice.num_ranges = num_values;
+    notice.scan_index = scan_index;
+    notice.timestamp_usec = timestamp_usec;
+
+    pthread_mutex_lock(&clients_mutex);
+    for (auto& client: clients) {
+        if (client.fd >= 0 && client.subscribed) {
+            send(client.fd, &notice, sizeof(notice), MSG_DONTWAIT | MSG_NOSIGNAL);
+        }
+    }
+    pthread_mutex_unlock(&clients_mutex);
+
+}
+
+/**
+ * \brief Runs the device: executes queued jobs and streams scans in between
+ * \param &sick_pls The device
+ * \param &publisher The scan ring
+ */
+static void run_device(SickPLS& sick_pls, SickPLSScanPublisher& publisher) {
+
+    while (!shutdown_requested) {
+
+        pthread_mutex_lock(&jobs_mutex);
+
+        if (jobs.empty()) {
+
+            /* A finished replay stays idle until it is reset */
+            if (current_operating_mode == SickPLS::SICK_OP_MODE_MONITOR_STREAM_VALUES &&
+                !(replay && replay->IsFinished())) {
+                pthread_mutex_unlock(&jobs_mutex);
+                publish_scan(sick_pls, publisher);
+                continue;
+            }
+
+            /* Nothing to stream, so wait for work */
+            struct timespec deadline = {};
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += SICK_PLS_DAEMON_IDLE_WAIT * 1000;
+            deadline.tv_sec += deadline.tv_nsec / 1000000000;
+            deadline.tv_nsec %= 1000000000;
+            pthread_cond_timedwait(&jobs_cond, &jobs_mutex, &deadline);
+            pthread_mutex_unlock(&jobs_mutex);
+            continue;
+
+        }
+
+        /* Execute the front job (GET_STATUS requests may still join it) */
+        sick_pls_daemon_job_t& job = jobs.front();
+        pthread_mutex_unlock(&jobs_mutex);
+
+        uint32_t value = 0;
+        const int32_t result = execute_job(sick_pls, job, value);
+        current_operating_mode = sick_pls.GetSickOperatingMode();
+
+        /* Retire it */
+        pthread_mutex_lock(&jobs_mutex);
+        const sick_pls_daemon_command_t command = job.command;
+        const vector<sick_pls_daemon_waiter_t> waiters = std::move(job.waiters);
+        jobs.pop_front();
+        pthread_mutex_unlock(&jobs_mutex);
+
+        /* Answer everyone who asked */
+        for (const auto& waiter: waiters) {
+            sick_pls_daemon_reply_t reply;
+            init_reply(reply, command, waiter.request_id, result);
+            reply.value = value;
+            send_to_client(waiter.client, waiter.generation, &reply, sizeof(reply));
+        }
+
+    }
+
+}
+
+/**
+ * \brief The device thread
+ */
+static void* device_thread(void* thread_args) {
+
+    const auto* const device = (const sick_pls_daemon_device_t*) thread_args;
+    run_device(*device->sick_pls, *device->publisher);
+    return nullptr;
+
+}
+
+/**
+ * \brief Queues a device job for a client
+ */
+static void enqueue_job(const unsigned int client, const sick_pls_daemon_request_t& request) {
+
+    const sick_pls_daemon_waiter_t waiter = {client, clients[client].generation, request.request_id};
+
+    pthread_mutex_lock(&jobs_mutex);
+
+    /* Status queries join a pending one rather than going on the wire again */
+    if (request.command == SICK_PLS_DAEMON_CMD_GET_STATUS) {
+        for (auto& job: jobs) {
+            if (job.command == SICK_PLS_DAEMON_CMD_GET_STATUS) {
+                job.waiters.push_back(waiter);
+                pthread_mutex_unlock(&jobs_mutex);
+                return;
+            }
+        }
+    }
+
+    jobs.push_back({(sick_pls_daemon_command_t) request.command, request.argument, {waiter}});
+    pthread_cond_signal(&jobs_cond);
+    pthread_mutex_unlock(&jobs_mutex);
+
+}
+
+/**
+ * \brief Handles a request from a client
+ */
+static void handle_request(const unsigned int client, const sick_pls_daemon_request_t& request) {
+
+    uint8_t packet[SICK_PLS_DAEMON_MAX_PACKET_SIZE];
+    auto& reply = *(sick_pls_daemon_reply_t*) packet;
+    size_t length = sizeof(sick_pls_daemon_reply_t);
+
+    init_reply(reply, request.command, request.request_id, SICK_PLS_DAEMON_OK);
+
+    switch (request.command) {
+
+        case SICK_PLS_DAEMON_CMD_GET_INFO:
+            reply.value = current_operating_mode;
+            strncpy(reply.shm_name, shm_name.c_str(), SICK_PLS_DAEMON_SHM_NAME_LENGTH - 1);
+            break;
+
+        case SICK_PLS_DAEMON_CMD_GET_STATUS:
+        case SICK_PLS_DAEMON_CMD_SET_MODE:
+        case SICK_PLS_DAEMON_CMD_RESET:
+            enqueue_job(client, request);
+            return;
+
+        case SICK_PLS_DAEMON_CMD_GET_SCAN:
+            pthread_mutex_lock(&scan_mutex);
+            if (latest_valid) {
+                reply.num_ranges = latest_num_ranges;
+                reply.scan_index = latest_scan_index;
+                reply.timestamp_usec = latest_timestamp_usec;
+                memcpy(&packet[length], latest_ranges, latest_num_ranges * sizeof(uint16_t));
+                length += latest_num_ranges * sizeof(uint16_t);
+            } else {
+                reply.result = SICK_PLS_DAEMON_ERROR_NO_SCAN;
+            }
+            pthread_mutex_unlock(&scan_mutex);
+            break;
+
+        case SICK_PLS_DAEMON_CMD_SUBSCRIBE:
+        case SICK_PLS_DAEMON_CMD_UNSUBSCRIBE:
+            pthread_mutex_lock(&clients_mutex);
+            clients[client].subscribed = (request.command == SICK_PLS_DAEMON_CMD_SUBSCRIBE);
+            pthread_mutex_unlock(&clients_mutex);
+            break;
+
+        default:
+            reply.result = SICK_PLS_DAEMON_ERROR_BAD_REQUEST;
+
+    }
+
+    send_to_client(client, clients[client].generation, packet, length);
+
+}
+
+/**
+ * \brief Drops a client connection
+ */
+static void drop_client(const unsigned int client) {
+    pthread_mutex_lock(&clients_mutex);
+    close(clients[client].fd);
+    clients[client].fd = -1;
+    clients[client].subscribed = false;
+    pthread_mutex_unlock(&clients_mutex);
+}
+
+/**
+ * \brief Serves the socket until shutdown
+ * \param listen_fd The listening socket
+ */
+static void run_io(const int listen_fd) {
+
+    struct pollfd poll_fds[SICK_PLS_DAEMON_MAX_CLIENTS + 2];
+    unsigned int poll_clients[SICK_PLS_DAEMON_MAX_CLIENTS];
+
+    while (!shutdown_requested) {
+
+        /* Only this thread changes the client table's fds, so they can be read unlocked */
+        poll_fds[0] = {listen_fd, POLLIN, 0};
+        poll_fds[1] = {shutdown_pipe[0], POLLIN, 0};
+        unsigned int num_fds = 2;
+        for (unsigned int i = 0; i < SICK_PLS_DAEMON_MAX_CLIENTS; i++) {
+            if (clients[i].fd >= 0) {
+                poll_clients[num_fds - 2] = i;
+                poll_fds[num_fds++] = {clients[i].fd, POLLIN, 0};
+            }
+        }
+
+        if (poll(poll_fds, num_fds, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cerr << "sickplsd: poll() failed: " << strerror(errno) << endl;
+            return;
+        }
+
+        /* Serve the connected clients */
+        for (unsigned int i = 2; i < num_fds; i++) {
+
+            if (!poll_fds[i].revents) {
+                continue;
+            }
+
+            const unsigned int client = poll_clients[i - 2];
+            sick_pls_daemon_request_t request;
+            const ssize_t length = recv(clients[client].fd, &request, sizeof(request), MSG_DONTWAIT);
+
+            if (length == 0 || (length < 0 && errno != EAGAIN && errno != EINTR)) {
+                drop_client(client);
+                continue;
+            }
+
+            if (length > 0) {
+                if (length != (ssize_t) sizeof(request) || request.magic != SICK_PLS_DAEMON_MAGIC) {
+                    cerr << "sickplsd: Dropping a client that sent a malformed request" << endl;
+                    drop_client(client);
+                    continue;
+                }
+                handle_request(client, request);
+            }
+
+        }
+
+        /* Accept a new client */
+        if (poll_fds[0].revents & POLLIN) {
+
+            const int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client_fd < 0) {
+                continue;
+            }
+
+            pthread_mutex_lock(&clients_mutex);
+            unsigned int client = 0;
+            while (client < SICK_PLS_DAEMON_MAX_CLIENTS && clients[client].fd >= 0) {
+                client++;
+            }
+            if (client < SICK_PLS_DAEMON_MAX_CLIENTS) {
+                clients[client] = {client_fd, next_generation++, false};
+            }
+            pthread_mutex_unlock(&clients_mutex);
+
+            if (client == SICK_PLS_DAEMON_MAX_CLIENTS) {
+                cerr << "sickplsd: Too many clients!" << endl;
+                close(client_fd);
+            }
+
+        }
+
+    }
+
+}
+
+/**
+ * \brief Creates the listening socket
+ */
+static int open_socket(const string& socket_path) {
+
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        cerr << "sickplsd: Socket path is too long!" << endl;
+        return -1;
+    }
+    strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    const int listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        cerr << "sickplsd: socket() failed: " << strerror(errno) << endl;
+        return -1;
+    }
+
+    /* Remove a stale socket left behind by a previous run */
+    unlink(socket_path.c_str());
+
+    if (bind(listen_fd, (const struct sockaddr*) &address, sizeof(address)) < 0 || listen(listen_fd, 8) < 0) {
+        cerr << "sickplsd: Cannot listen on " << socket_path << ": " << strerror(errno) << endl;
+        close(listen_fd);
+        return -1;
+    }
+
+    return listen_fd;
+}
+
+int main(int argc, char* argv[]) {
+
+    string device_str;
+    string socket_path = DEFAULT_SICK_PLS_DAEMON_SOCKET_PATH;
+    SickPLS::sick_pls_baud_t desired_baud = SickPLS::SICK_BAUD_38400;
+    double replay_speed = DEFAULT_SICK_PLS_REPLAY_SPEED;
+    long metrics_port = -1;
+
+    /* Serving metrics? (drop the option so the rest parses as usual) */
+    if (argc > 2 && strcasecmp(argv[1], "--metrics") == 0) {
+        char* end = nullptr;
+        metrics_port = strtol(argv[2], &end, 10);
+        if (*end != '\0' || metrics_port <= 0 || metrics_port > 65535) {
+            cerr << "Invalid metrics port!" << endl;
+            return -1;
+        }
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
+
+    /* Serving a recording? */
+    const bool replaying = (argc > 1 && strcasecmp(argv[1], "--replay") == 0);
+    const int first_arg = replaying ? 2 : 1;
+
+    /* Check for a device path.  If it's not present, print a usage statement. */
+    if (argc < first_arg + 1 || argc > first_arg + 4 || strcasecmp(argv[1], "--help") == 0) {
+        cout << "Usage: sickplsd [--metrics PORT] PATH [BAUD RATE] [SOCKET PATH] [SHM NAME]" << endl
+             << "       sickplsd [--metrics PORT] --replay ARCHIVE [SPEED (0 => max)] [SOCKET PATH] [SHM NAME]" << endl
+             << "Ex: sickplsd /dev/ttyUSB0 38400 " << DEFAULT_SICK_PLS_DAEMON_SOCKET_PATH << " "
+             << DEFAULT_SICK_PLS_SHM_NAME << endl;
+        return -1;
+    }
+
+    device_str = argv[first_arg];
+
+    if (argc > first_arg + 1) {
+
+        if (replaying) {
+            char* end = nullptr;
+            replay_speed = strtod(argv[first_arg + 1], &end);
+            if (*end != '\0' || !(replay_speed >= 0)) {
+                cerr << "Invalid replay speed! Use 1 for real time, N for N times faster or 0 for max speed" << endl;
+                return -1;
+            }
+        } else if ((desired_baud = SickPLS::StringToSickBaud(argv[first_arg + 1])) == SickPLS::SICK_BAUD_UNKNOWN) {
+            cerr << "Invalid baud value! Valid values are: 9600, 19200, 38400, and 500000" << endl;
+            return -1;
+        }
+
+    }
+
+    if (argc > first_arg + 2) {
+        socket_path = argv[first_arg + 2];
+    }
+
+    if (argc > first_arg + 3) {
+        shm_name = argv[first_arg + 3];
+    }
+
+    if (shm_name.size() >= SICK_PLS_DAEMON_SHM_NAME_LENGTH) {
+        cerr << "Shared-memory name is too long!" << endl;
+        return -1;
+    }
+
+    for (auto& client: clients) {
+        client = {-1, 0, false};
+    }
+
+    /* Route SIGINT/SIGTERM to the I/O loop */
+    if (pipe2(shutdown_pipe, O_CLOEXEC | O_NONBLOCK) < 0) {
+        cerr << "sickplsd: pipe2() failed!" << endl;
+        return -1;
+    }
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    /*
+     * Initialize the Sick PLS (or the recording standing in for it)
+     */
+    unique_ptr<SickPLS> device_ptr;
+    if (replaying) {
+        auto replay_ptr = make_unique<SickPLSReplay>(device_str, replay_speed);
+        replay = replay_ptr.get();
+        device_ptr = std::move(replay_ptr);
+    } else {
+        device_ptr = make_unique<SickPLS>(device_str);
+    }
+    SickPLS& sick_pls = *device_ptr;
+
+    try {
+        sick_pls.Initialize(desired_baud);
+        sick_pls.SetSickOperatingMode(SickPLS::SICK_OP_MODE_MONITOR_STREAM_VALUES);
+        current_operating_mode = sick_pls.GetSickOperatingMode();
+    }
+
+    catch (...) {
+        cerr << "Initialize failed! Are you using the correct device path?" << endl;
+        return -1;
+    }
+
+    /*
+     * Create the scan ring and the socket
+     */
+    SickPLSScanPublisher publisher(shm_name);
+
+    try {
+        publisher.Create();
+    }
+
+    catch (SickException& sick_exception) {
+        cerr << "sickplsd: " << sick_exception.what() << endl;
+        sick_pls.Uninitialize();
+        return -1;
+    }
+
+    const int listen_fd = open_socket(socket_path);
+    if (listen_fd < 0) {
+        sick_pls.Uninitialize();
+        return -1;
+    }
+
+    /*
+     * Export metrics if asked to
+     */
+    SickPLSMetricsRegistry metrics;
+    metrics.AddSickPLS(sick_pls, device_str);
+    SickPLSMetricsServer metrics_server(metrics, (unsigned int) (metrics_port > 0 ? metrics_port : 0));
+
+    if (metrics_port > 0) {
+
+        try {
+            metrics_server.Start();
+        }
+
+        catch (SickException& sick_exception) {
+            cerr << "sickplsd: " << sick_exception.what() << endl;
+            close(listen_fd);
+            unlink(socket_path.c_str());
+            sick_pls.Uninitialize();
+            return -1;
+        }
+
+        cout << "sickplsd: Serving metrics on http://" << DEFAULT_SICK_PLS_METRICS_ADDRESS << ":" << metrics_port
+             << "/metrics" << endl;
+
+    }
+
+    /*
+     * Serve until asked to stop
+     */
+    pthread_t device_thread_id;
+    sick_pls_daemon_device_t device = {&sick_pls, &publisher};
+    if (pthread_create(&device_thread_id, nullptr, device_thread, &device) != 0) {
+        cerr << "sickplsd: pthread_create() failed!" << endl;
+        sick_pls.Uninitialize();
+        return -1;
+    }
+
+    cout << "sickplsd: Serving " << device_str << " on " << socket_path << " (scans in " << shm_name << ")" << endl;
+
+    run_io(listen_fd);
+
+    shutdown_requested = 1;
+    pthread_mutex_lock(&jobs_mutex);
+    pthread_cond_signal(&jobs_cond);
+    pthread_mutex_unlock(&jobs_mutex);
+    pthread_join(device_thread_id, nullptr);
+    metrics_server.Stop();
+
+    /*
+     * Tear everything down
+     */
+    for (unsigned int i = 0; i < SICK_PLS_DAEMON_MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0) {
+            drop_client(i);
+        }
+    }
+    close(listen_fd);
+    unlink(socket_path.c_str());
+
+    try {
+        publisher.Destroy(true);
+        sick_pls.Uninitialize();
+    }
+
+    catch (...) {
+        cerr << "Uninitialize failed!" << endl;
+        return -1;
+    }
+
+    /* Success! */
+    return 0;
+}